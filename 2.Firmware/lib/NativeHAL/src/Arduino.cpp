@@ -0,0 +1,224 @@
+#include "Arduino.h"
+#include "NativeHAL.h"
+#include <esp_timer.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdarg.h>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+unsigned long millis() {
+    return (unsigned long)(uint32_t)(esp_timer_get_time() / 1000);     // 与 ESP32 一样 32 位回绕
+}
+
+unsigned long micros() {
+    return (unsigned long)(uint32_t)esp_timer_get_time();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    if (inMax == inMin) return outMin;
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// ---------- LEDC ----------
+
+static const uint8_t LEDC_CHANNELS = 16;
+static const uint8_t GPIO_PINS = 40;
+
+struct LedcChannel {
+    double frequency = 0;
+    uint8_t resolution = 0;
+    uint32_t duty = 0;
+    uint32_t writes = 0;
+};
+
+static std::mutex s_ledcLock;
+static LedcChannel s_channels[LEDC_CHANNELS];
+static int8_t s_pinChannel[GPIO_PINS];
+static uint8_t s_pinLevel[GPIO_PINS];
+static bool s_pinsInitialized = false;
+
+static void initPins() {
+    if (s_pinsInitialized) return;
+    memset(s_pinChannel, -1, sizeof(s_pinChannel));
+    memset(s_pinLevel, 0, sizeof(s_pinLevel));
+    s_pinsInitialized = true;
+}
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolutionBits) {
+    if (channel >= LEDC_CHANNELS || resolutionBits == 0 || resolutionBits > 20) return 0;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    s_channels[channel].frequency = freq;
+    s_channels[channel].resolution = resolutionBits;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+    if (pin >= GPIO_PINS || channel >= LEDC_CHANNELS) return;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    initPins();
+    s_pinChannel[pin] = (int8_t)channel;
+}
+
+void ledcDetachPin(uint8_t pin) {
+    if (pin >= GPIO_PINS) return;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    initPins();
+    s_pinChannel[pin] = -1;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    if (channel >= LEDC_CHANNELS) return;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    s_channels[channel].duty = duty;
+    s_channels[channel].writes++;
+}
+
+uint32_t ledcRead(uint8_t channel) {
+    return NativeLedc::duty(channel);
+}
+
+uint32_t NativeLedc::duty(uint8_t channel) {
+    if (channel >= LEDC_CHANNELS) return 0;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    return s_channels[channel].duty;
+}
+
+uint32_t NativeLedc::writes(uint8_t channel) {
+    if (channel >= LEDC_CHANNELS) return 0;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    return s_channels[channel].writes;
+}
+
+uint8_t NativeLedc::resolution(uint8_t channel) {
+    if (channel >= LEDC_CHANNELS) return 0;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    return s_channels[channel].resolution;
+}
+
+double NativeLedc::frequency(uint8_t channel) {
+    if (channel >= LEDC_CHANNELS) return 0;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    return s_channels[channel].frequency;
+}
+
+int NativeLedc::channelOfPin(uint8_t pin) {
+    if (pin >= GPIO_PINS) return -1;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    initPins();
+    return s_pinChannel[pin];
+}
+
+void NativeLedc::reset() {
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    for (uint8_t i = 0; i < LEDC_CHANNELS; i++) s_channels[i] = LedcChannel();
+    s_pinsInitialized = false;
+    initPins();
+}
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin >= GPIO_PINS) return;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    initPins();
+    s_pinLevel[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= GPIO_PINS) return LOW;
+    std::lock_guard<std::mutex> guard(s_ledcLock);
+    initPins();
+    return s_pinLevel[pin];
+}
+
+// ---------- Serial ----------
+
+static std::atomic<int> s_serialMode(NativeSerial::MODE_STDOUT);
+static std::atomic<uint64_t> s_serialBytes(0);
+static std::mutex s_serialLock;
+static std::string s_serialCaptured;
+
+static size_t serialOut(const void* data, size_t len) {
+    s_serialBytes.fetch_add(len, std::memory_order_relaxed);
+    switch (s_serialMode.load(std::memory_order_relaxed)) {
+        case NativeSerial::MODE_CAPTURE: {
+            std::lock_guard<std::mutex> guard(s_serialLock);
+            s_serialCaptured.append((const char*)data, len);
+            return len;
+        }
+        case NativeSerial::MODE_DISCARD:
+            return len;
+        default:
+            return fwrite(data, 1, len, stdout);
+    }
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return serialOut(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t len) {
+    return serialOut(data, len);
+}
+
+size_t HardwareSerial::print(const char* str) {
+    return serialOut(str, strlen(str));
+}
+
+size_t HardwareSerial::println(const char* str) {
+    return print(str) + print("\n");
+}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (written < 0) return 0;
+    if ((size_t)written < sizeof(buffer)) return serialOut(buffer, (size_t)written);
+    std::string longer((size_t)written + 1, '\0');     // 超出栈缓冲的长行重新格式化一次
+    va_start(args, format);
+    vsnprintf(&longer[0], longer.size(), format, args);
+    va_end(args);
+    return serialOut(longer.data(), (size_t)written);
+}
+
+void NativeSerial::setMode(Mode mode) {
+    fflush(stdout);
+    s_serialMode = mode;
+}
+
+std::string NativeSerial::take() {
+    std::lock_guard<std::mutex> guard(s_serialLock);
+    std::string out;
+    out.swap(s_serialCaptured);
+    return out;
+}
+
+uint64_t NativeSerial::bytesWritten() {
+    return s_serialBytes.load(std::memory_order_relaxed);
+}
+
+void NativeSerial::reset() {
+    setMode(MODE_STDOUT);
+    std::lock_guard<std::mutex> guard(s_serialLock);
+    s_serialCaptured.clear();
+    s_serialBytes = 0;
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
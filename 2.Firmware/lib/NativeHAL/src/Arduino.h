@@ -0,0 +1,74 @@
+#pragma once
+// 主机上的 Arduino 核心替身：时间函数、LEDC、Serial（写到 stdout）和 ESP 对象
+// 与 arduino-esp32 一样顺带引入 FreeRTOS 与 esp_system，固件源码的 include 关系不用为主机改动
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_system.h"
+#include "esp_err.h"
+
+using std::min;
+using std::max;
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// LEDC：只记录配置与占空比，NativeLedc（NativeHAL.h）读回
+double ledcSetup(uint8_t channel, double freq, uint8_t resolutionBits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcDetachPin(uint8_t pin);
+void ledcWrite(uint8_t channel, uint32_t duty);
+uint32_t ledcRead(uint8_t channel);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* data, size_t len);
+    size_t print(const char* str);
+    size_t println(const char* str = "");
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    int available() { return 0; }                   // 主机上不读 stdin，避免测试阻塞
+    int read() { return -1; }
+    void flush();
+    explicit operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return esp_get_free_heap_size(); }
+    uint32_t getMinFreeHeap() { return esp_get_minimum_free_heap_size(); }
+    uint32_t getHeapSize() { return NATIVE_HEAP_SIZE; }
+    uint32_t getMaxAllocHeap() { return esp_get_free_heap_size(); }
+    uint32_t getCpuFreqMHz() { return 240; }
+    const char* getSdkVersion() { return "native"; }
+    void restart() { esp_restart(); }
+};
+extern EspClass ESP;
@@ -0,0 +1,163 @@
+#pragma once
+// 主机上的 BLE 特征层替身（接口取 arduino-esp32 BLE 库中固件用到的部分）
+// 没有协议栈：特征值存在内存里，NativeBLE（NativeHAL.h）扮演中心设备——写特征会像 Bluedroid 任务一样
+// 同步调用 onWrite 回调，notify() 在已连接时交给测试注册的钩子
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "esp_gap_ble_api.h"
+
+class BLEServer;
+class BLEService;
+class BLECharacteristic;
+
+class BLEUUID {
+public:
+    BLEUUID() {}
+    BLEUUID(const char* uuid) : _uuid(uuid ? uuid : "") {}
+    BLEUUID(const std::string& uuid) : _uuid(uuid) {}
+    explicit BLEUUID(uint16_t uuid16);
+    std::string toString() const { return _uuid; }
+    bool equals(const BLEUUID& other) const;
+    bool operator==(const BLEUUID& other) const { return equals(other); }
+
+private:
+    std::string _uuid;                              // 小写，16 位 UUID 展开为 0000xxxx-0000-1000-8000-00805f9b34fb
+};
+
+class BLEDescriptor {
+public:
+    explicit BLEDescriptor(const BLEUUID& uuid) : _uuid(uuid) {}
+    explicit BLEDescriptor(const char* uuid) : _uuid(uuid) {}
+    virtual ~BLEDescriptor() {}
+    BLEUUID getUUID() const { return _uuid; }
+    void setValue(const uint8_t* data, size_t length) { _value.assign((const char*)data, length); }
+    void setValue(const std::string& value) { _value = value; }
+    std::string getValue() const { return _value; }
+
+private:
+    BLEUUID _uuid;
+    std::string _value;
+};
+
+class BLECharacteristicCallbacks {
+public:
+    virtual ~BLECharacteristicCallbacks() {}
+    virtual void onRead(BLECharacteristic* characteristic) { (void)characteristic; }
+    virtual void onWrite(BLECharacteristic* characteristic) { (void)characteristic; }
+    virtual void onNotify(BLECharacteristic* characteristic) { (void)characteristic; }
+};
+
+class BLECharacteristic {
+public:
+    static const uint32_t PROPERTY_READ = 1 << 0;
+    static const uint32_t PROPERTY_WRITE = 1 << 1;
+    static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+    static const uint32_t PROPERTY_BROADCAST = 1 << 3;
+    static const uint32_t PROPERTY_INDICATE = 1 << 4;
+    static const uint32_t PROPERTY_WRITE_NR = 1 << 5;
+
+    BLECharacteristic(const BLEUUID& uuid, uint32_t properties) : _uuid(uuid), _properties(properties) {}
+    virtual ~BLECharacteristic() {}
+
+    BLEUUID getUUID() const { return _uuid; }
+    uint32_t getProperties() const { return _properties; }
+    BLEService* getService() const { return _service; }
+
+    void setValue(uint8_t* data, size_t length) { _value.assign((const char*)data, length); }
+    void setValue(const std::string& value) { _value = value; }
+    void setValue(uint16_t& data16) { setValue((uint8_t*)&data16, sizeof(data16)); }
+    void setValue(uint32_t& data32) { setValue((uint8_t*)&data32, sizeof(data32)); }
+    std::string getValue() const { return _value; }
+    uint8_t* getData() { return (uint8_t*)&_value[0]; }
+    size_t getLength() const { return _value.size(); }
+
+    void setCallbacks(BLECharacteristicCallbacks* callbacks) { _callbacks = callbacks; }
+    BLECharacteristicCallbacks* getCallbacks() const { return _callbacks; }
+    void addDescriptor(BLEDescriptor* descriptor) { _descriptors.push_back(descriptor); }
+    BLEDescriptor* getDescriptorByUUID(const char* uuid);
+    void notify(bool isNotification = true);        // 未连接时丢弃（与协议栈一致）
+    void indicate() { notify(false); }
+
+private:
+    friend class BLEService;
+    BLEUUID _uuid;
+    uint32_t _properties;
+    std::string _value;
+    BLECharacteristicCallbacks* _callbacks = nullptr;
+    std::vector<BLEDescriptor*> _descriptors;
+    BLEService* _service = nullptr;
+};
+
+class BLEService {
+public:
+    explicit BLEService(const BLEUUID& uuid) : _uuid(uuid) {}
+    BLEUUID getUUID() const { return _uuid; }
+    BLECharacteristic* createCharacteristic(const char* uuid, uint32_t properties);
+    BLECharacteristic* createCharacteristic(const BLEUUID& uuid, uint32_t properties);
+    BLECharacteristic* getCharacteristic(const char* uuid);
+    void start() { _started = true; }
+    void stop() { _started = false; }
+    bool started() const { return _started; }
+
+private:
+    BLEUUID _uuid;
+    std::vector<BLECharacteristic*> _characteristics;
+    bool _started = false;
+};
+
+class BLEServerCallbacks {
+public:
+    virtual ~BLEServerCallbacks() {}
+    virtual void onConnect(BLEServer* server) { (void)server; }
+    virtual void onConnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) { (void)server; (void)param; }   // 在上一个之后调用
+    virtual void onDisconnect(BLEServer* server) { (void)server; }
+};
+
+class BLEAdvertising {
+public:
+    void addServiceUUID(const char* uuid) { _serviceUUIDs.push_back(BLEUUID(uuid)); }
+    void addServiceUUID(const BLEUUID& uuid) { _serviceUUIDs.push_back(uuid); }
+    void start() { _started = true; }
+    void stop() { _started = false; }
+    bool started() const { return _started; }
+    size_t serviceCount() const { return _serviceUUIDs.size(); }
+
+private:
+    std::vector<BLEUUID> _serviceUUIDs;
+    bool _started = false;
+};
+
+class BLEServer {
+public:
+    BLEService* createService(const char* uuid);
+    BLEService* createService(const BLEUUID& uuid);
+    BLEService* getServiceByUUID(const char* uuid);
+    void setCallbacks(BLEServerCallbacks* callbacks) { _callbacks = callbacks; }
+    BLEServerCallbacks* getCallbacks() const { return _callbacks; }
+    BLEAdvertising* getAdvertising();
+    uint16_t getConnId() const { return 0; }
+    uint16_t getPeerMTU(uint16_t connId) const;
+    uint32_t getConnectedCount() const;
+    void startAdvertising();
+
+private:
+    friend class NativeBLE;
+    std::vector<BLEService*> _services;
+    BLEServerCallbacks* _callbacks = nullptr;
+};
+
+typedef void (*gap_event_handler)(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+
+class BLEDevice {
+public:
+    static void init(const std::string& deviceName);
+    static void deinit(bool releaseMemory = false) { (void)releaseMemory; }
+    static BLEServer* createServer();
+    static BLEAdvertising* getAdvertising();
+    static void setMTU(uint16_t mtu);
+    static uint16_t getMTU();
+    static std::string deviceName();
+    static void setCustomGapHandler(gap_event_handler handler);
+};
@@ -0,0 +1,96 @@
+#include "FS.h"
+#include "SPIFFS.h"
+#include <sys/stat.h>
+
+#ifndef NATIVE_SPIFFS_DIR
+#ifdef NATIVE_PROJECT_DIR
+#define NATIVE_SPIFFS_DIR NATIVE_PROJECT_DIR "/data"
+#else
+#define NATIVE_SPIFFS_DIR "data"
+#endif
+#endif
+
+namespace fs {
+
+File::File(FILE* handle, const std::string& name) : _handle(handle, fclose), _name(name) {}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    return _handle ? fwrite(buf, 1, size, _handle.get()) : 0;
+}
+
+int File::available() {
+    if (!_handle) return 0;
+    return (int)(size() - position());
+}
+
+int File::read() {
+    return _handle ? fgetc(_handle.get()) : -1;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    return _handle ? fread(buf, 1, size, _handle.get()) : 0;
+}
+
+int File::peek() {
+    if (!_handle) return -1;
+    int c = fgetc(_handle.get());
+    if (c != EOF) ungetc(c, _handle.get());
+    return c;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    return _handle && fseek(_handle.get(), pos, mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END) == 0;
+}
+
+size_t File::position() const {
+    return _handle ? (size_t)ftell(_handle.get()) : 0;
+}
+
+size_t File::size() const {
+    if (!_handle) return 0;
+    struct stat info;
+    return fstat(fileno(_handle.get()), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+void File::flush() {
+    if (_handle) fflush(_handle.get());
+}
+
+void File::close() {
+    _handle.reset();
+}
+
+std::string FS::resolve(const char* path) const {
+    return _root + (path && path[0] == '/' ? "" : "/") + (path ? path : "");
+}
+
+File FS::open(const char* path, const char* mode, bool) {
+    std::string full = resolve(path);
+    std::string fopenMode = std::string(mode) + "b";
+    FILE* handle = fopen(full.c_str(), fopenMode.c_str());
+    return handle ? File(handle, path) : File();
+}
+
+bool FS::exists(const char* path) {
+    struct stat info;
+    return stat(resolve(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return ::remove(resolve(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return ::rename(resolve(from).c_str(), resolve(to).c_str()) == 0;
+}
+
+SPIFFSFS::SPIFFSFS() : FS(NATIVE_SPIFFS_DIR) {}
+
+bool SPIFFSFS::begin(bool, const char*, uint8_t, const char*) {
+    struct stat info;
+    return stat(_root.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+}  // namespace fs
+
+fs::SPIFFSFS SPIFFS;
@@ -0,0 +1,57 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <memory>
+#include <string>
+
+// 主机上的文件系统替身：路径映射到宿主机目录（SPIFFS 为 NATIVE_SPIFFS_DIR，默认项目的 data/，与 upload-fs 的内容一致）
+namespace fs {
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File {
+public:
+    File() {}
+    File(FILE* handle, const std::string& name);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size);
+    int available();
+    int read();
+    size_t read(uint8_t* buf, size_t size);
+    size_t readBytes(char* buffer, size_t length) { return read((uint8_t*)buffer, length); }
+    int peek();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void flush();
+    void close();
+    const char* name() const { return _name.c_str(); }
+    explicit operator bool() const { return _handle != nullptr; }
+
+private:
+    std::shared_ptr<FILE> _handle;                  // 与 Arduino 的 File 一样可以拷贝，最后一个副本关闭文件
+    std::string _name;
+};
+
+class FS {
+public:
+    explicit FS(const std::string& root) : _root(root) {}
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* from, const char* to);
+
+protected:
+    std::string resolve(const char* path) const;
+    std::string _root;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
@@ -0,0 +1,382 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <esp_timer.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include <stdio.h>
+
+// 任务控制块：线程退出后句柄仍可能被别处持有（例如 MessageDispatcher 登记的消费者任务），因此从不释放
+struct NativeTask {
+    std::string name;
+    uint32_t stackDepth = 0;
+    std::mutex lock;
+    std::condition_variable cv;
+    uint32_t notifyValue = 0;
+    bool notifyPending = false;
+};
+
+// 队列与信号量共用的控制块：itemSize 为 0 时是信号量，count 即信号量计数
+struct NativeQueue {
+    std::mutex lock;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    size_t itemSize = 0;
+    size_t capacity = 0;
+    size_t count = 0;
+    size_t head = 0;
+    std::vector<uint8_t> storage;
+    bool recursive = false;                         // 递归互斥量：记录持有者与重入次数
+    NativeTask* holder = nullptr;
+    uint32_t depth = 0;
+};
+
+struct NativeTaskExit {};                           // vTaskDelete(NULL) 通过异常退出线程
+
+static thread_local NativeTask* t_currentTask = nullptr;
+static thread_local char t_criticalToken;           // 每个线程一个地址，作为自旋锁的持有者标识
+
+// ---------- 等待辅助 ----------
+
+template <typename Predicate>
+static bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, TickType_t ticks,
+                    Predicate ready) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready);
+}
+
+// ---------- 临界区 ----------
+
+void nativeEnterCritical(portMUX_TYPE* mux) {
+    uintptr_t self = (uintptr_t)&t_criticalToken;
+    if (__atomic_load_n(&mux->owner, __ATOMIC_ACQUIRE) == self) {
+        mux->count++;
+        return;
+    }
+    uintptr_t expected = 0;
+    while (!__atomic_compare_exchange_n(&mux->owner, &expected, self, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        expected = 0;
+        std::this_thread::yield();
+    }
+    mux->count = 1;
+}
+
+void nativeExitCritical(portMUX_TYPE* mux) {
+    if (--mux->count == 0) {
+        __atomic_store_n(&mux->owner, (uintptr_t)0, __ATOMIC_RELEASE);
+    }
+}
+
+void nativeYield() {
+    std::this_thread::yield();
+}
+
+// ---------- 任务 ----------
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t entry, const char* name, uint32_t stackDepth, void* arg,
+                                   UBaseType_t, TaskHandle_t* created, BaseType_t) {
+    NativeTask* task = new NativeTask();
+    task->name = name ? name : "";
+    task->stackDepth = stackDepth;
+    if (created) *created = task;
+    std::thread([task, entry, arg]() {
+        t_currentTask = task;
+        try {
+            entry(arg);
+        } catch (const NativeTaskExit&) {
+        }
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t entry, const char* name, uint32_t stackDepth, void* arg,
+                       UBaseType_t priority, TaskHandle_t* created) {
+    return xTaskCreatePinnedToCore(entry, name, stackDepth, arg, priority, created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == t_currentTask) throw NativeTaskExit();
+    fprintf(stderr, "[NativeHAL] vTaskDelete: 主机上只能删除当前任务（%s）\n", task->name.c_str());
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period) {
+    *previousWake += period;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previousWake - now) > 0) vTaskDelay(*previousWake - now);
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(esp_timer_get_time() / (1000 * portTICK_PERIOD_MS));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (!t_currentTask) {
+        t_currentTask = new NativeTask();
+        t_currentTask->name = "native";
+    }
+    return t_currentTask;
+}
+
+const char* pcTaskGetTaskName(TaskHandle_t task) {
+    if (!task) task = xTaskGetCurrentTaskHandle();
+    return task->name.c_str();
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    if (!task) task = xTaskGetCurrentTaskHandle();
+    return task->stackDepth;
+}
+
+// ---------- 任务通知 ----------
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotify(task, 0, eIncrement);
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    if (!task) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> guard(task->lock);
+        switch (action) {
+            case eSetBits: task->notifyValue |= value; break;
+            case eIncrement: task->notifyValue++; break;
+            case eSetValueWithOverwrite: task->notifyValue = value; break;
+            case eSetValueWithoutOverwrite:
+                if (task->notifyPending) return pdFAIL;
+                task->notifyValue = value;
+                break;
+            case eNoAction: break;
+        }
+        task->notifyPending = true;
+    }
+    task->cv.notify_all();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    NativeTask* self = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(self->lock);
+    waitFor(self->cv, lock, ticksToWait, [self]() { return self->notifyValue != 0; });
+    uint32_t value = self->notifyValue;
+    if (value != 0) self->notifyValue = clearCountOnExit ? 0 : value - 1;
+    self->notifyPending = false;
+    return value;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t* value, TickType_t ticksToWait) {
+    NativeTask* self = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(self->lock);
+    if (!self->notifyPending) self->notifyValue &= ~clearOnEntry;
+    bool notified = waitFor(self->cv, lock, ticksToWait, [self]() { return self->notifyPending; });
+    if (value) *value = self->notifyValue;
+    if (!notified) return pdFALSE;
+    self->notifyValue &= ~clearOnExit;
+    self->notifyPending = false;
+    return pdTRUE;
+}
+
+// ---------- 队列 ----------
+
+static NativeQueue* createQueue(size_t capacity, size_t itemSize, size_t initialCount) {
+    NativeQueue* queue = new NativeQueue();
+    queue->itemSize = itemSize;
+    queue->capacity = capacity;
+    queue->count = initialCount;
+    queue->storage.resize(capacity * itemSize);
+    return queue;
+}
+
+static BaseType_t queuePut(QueueHandle_t queue, const void* item, TickType_t ticksToWait, bool front) {
+    if (!queue) return pdFAIL;
+    std::unique_lock<std::mutex> lock(queue->lock);
+    if (!waitFor(queue->notFull, lock, ticksToWait, [queue]() { return queue->count < queue->capacity; })) {
+        return errQUEUE_FULL;
+    }
+    if (queue->itemSize) {
+        size_t index;
+        if (front) {
+            queue->head = (queue->head + queue->capacity - 1) % queue->capacity;
+            index = queue->head;
+        } else {
+            index = (queue->head + queue->count) % queue->capacity;
+        }
+        memcpy(&queue->storage[index * queue->itemSize], item, queue->itemSize);
+    }
+    queue->count++;
+    lock.unlock();
+    queue->notEmpty.notify_one();
+    return pdPASS;
+}
+
+static BaseType_t queueGet(QueueHandle_t queue, void* item, TickType_t ticksToWait, bool remove) {
+    if (!queue) return pdFAIL;
+    std::unique_lock<std::mutex> lock(queue->lock);
+    if (!waitFor(queue->notEmpty, lock, ticksToWait, [queue]() { return queue->count > 0; })) {
+        return errQUEUE_EMPTY;
+    }
+    if (queue->itemSize && item) {
+        memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    }
+    if (remove) {
+        if (queue->itemSize) queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+        lock.unlock();
+        queue->notFull.notify_one();
+    }
+    return pdPASS;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    return createQueue(length, itemSize, 0);
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queuePut(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queuePut(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queuePut(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+    return queuePut(queue, item, 0, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    if (!queue) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> guard(queue->lock);
+        queue->head = 0;
+        queue->count = 1;
+        if (queue->itemSize) memcpy(&queue->storage[0], item, queue->itemSize);
+    }
+    queue->notEmpty.notify_one();
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    return queueGet(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    return queueGet(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    if (!queue) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> guard(queue->lock);
+        queue->head = 0;
+        queue->count = 0;
+    }
+    queue->notFull.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    if (!queue) return 0;
+    std::lock_guard<std::mutex> guard(queue->lock);
+    return (UBaseType_t)queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    if (!queue) return 0;
+    std::lock_guard<std::mutex> guard(queue->lock);
+    return (UBaseType_t)(queue->capacity - queue->count);
+}
+
+// ---------- 信号量 ----------
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return createQueue(1, 0, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+    NativeQueue* mutex = createQueue(1, 0, 1);
+    mutex->recursive = true;
+    return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return createQueue(1, 0, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    return createQueue(maxCount, 0, initialCount);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    return queueGet(semaphore, nullptr, ticksToWait, true);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    return queuePut(semaphore, nullptr, 0, false);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    if (!semaphore) return pdFAIL;
+    NativeTask* self = xTaskGetCurrentTaskHandle();
+    {
+        std::lock_guard<std::mutex> guard(semaphore->lock);
+        if (semaphore->holder == self) {
+            semaphore->depth++;
+            return pdPASS;
+        }
+    }
+    if (queueGet(semaphore, nullptr, ticksToWait, true) != pdPASS) return pdFAIL;
+    std::lock_guard<std::mutex> guard(semaphore->lock);
+    semaphore->holder = self;
+    semaphore->depth = 1;
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+    if (!semaphore) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> guard(semaphore->lock);
+        if (semaphore->holder != xTaskGetCurrentTaskHandle()) return pdFAIL;
+        if (--semaphore->depth > 0) return pdPASS;
+        semaphore->holder = nullptr;
+    }
+    return queuePut(semaphore, nullptr, 0, false);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+    return xSemaphoreGive(semaphore);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore) {
+    return uxQueueMessagesWaiting(semaphore);
+}
@@ -0,0 +1,309 @@
+#include "BLEDevice.h"
+#include "NativeHAL.h"
+#include <atomic>
+#include <ctype.h>
+#include <mutex>
+#include <string.h>
+
+namespace {
+struct BLEState {
+    std::mutex lock;
+    std::string deviceName;
+    uint16_t localMTU = 23;
+    uint16_t peerMTU = 23;
+    bool connected = false;
+    BLEServer* server = nullptr;
+    BLEAdvertising advertising;
+    std::vector<BLECharacteristic*> characteristics;
+    NativeBLE::NotifyHook notifyHook;
+    gap_event_handler gapHandler = nullptr;
+    bool acceptLink = true;
+    uint32_t connParamRequests = 0;
+    esp_ble_conn_update_params_t lastConnParams = {};
+    uint16_t dataLength = 27;
+};
+
+BLEState& state() {
+    static BLEState* s = new BLEState();            // 不析构：进程退出时后台任务可能仍在通知
+    return *s;
+}
+
+std::string normalize(const std::string& uuid) {
+    std::string out(uuid);
+    for (char& c : out) c = (char)tolower((unsigned char)c);
+    if (out.size() == 4) out = "0000" + out + "-0000-1000-8000-00805f9b34fb";
+    return out;
+}
+
+std::atomic<uint32_t> s_notifyCount(0);
+}  // namespace
+
+// ---------- BLE 库替身 ----------
+
+BLEUUID::BLEUUID(uint16_t uuid16) {
+    char buffer[40];
+    snprintf(buffer, sizeof(buffer), "%04x", uuid16);
+    _uuid = buffer;
+}
+
+bool BLEUUID::equals(const BLEUUID& other) const {
+    return normalize(_uuid) == normalize(other._uuid);
+}
+
+BLEDescriptor* BLECharacteristic::getDescriptorByUUID(const char* uuid) {
+    for (BLEDescriptor* descriptor : _descriptors) {
+        if (descriptor->getUUID().equals(BLEUUID(uuid))) return descriptor;
+    }
+    return nullptr;
+}
+
+void BLECharacteristic::notify(bool) {
+    NativeBLE::NotifyHook hook;
+    {
+        std::lock_guard<std::mutex> guard(state().lock);
+        if (!state().connected) return;
+        hook = state().notifyHook;
+    }
+    s_notifyCount++;
+    std::string uuid = _uuid.toString();
+    if (hook) hook(uuid.c_str(), (const uint8_t*)_value.data(), _value.size());
+    if (_callbacks) _callbacks->onNotify(this);
+}
+
+BLECharacteristic* BLEService::createCharacteristic(const char* uuid, uint32_t properties) {
+    return createCharacteristic(BLEUUID(uuid), properties);
+}
+
+BLECharacteristic* BLEService::createCharacteristic(const BLEUUID& uuid, uint32_t properties) {
+    BLECharacteristic* characteristic = new BLECharacteristic(uuid, properties);
+    characteristic->_service = this;
+    _characteristics.push_back(characteristic);
+    std::lock_guard<std::mutex> guard(state().lock);
+    state().characteristics.push_back(characteristic);
+    return characteristic;
+}
+
+BLECharacteristic* BLEService::getCharacteristic(const char* uuid) {
+    for (BLECharacteristic* characteristic : _characteristics) {
+        if (characteristic->getUUID().equals(BLEUUID(uuid))) return characteristic;
+    }
+    return nullptr;
+}
+
+BLEService* BLEServer::createService(const char* uuid) {
+    return createService(BLEUUID(uuid));
+}
+
+BLEService* BLEServer::createService(const BLEUUID& uuid) {
+    BLEService* service = new BLEService(uuid);
+    _services.push_back(service);
+    return service;
+}
+
+BLEService* BLEServer::getServiceByUUID(const char* uuid) {
+    for (BLEService* service : _services) {
+        if (service->getUUID().equals(BLEUUID(uuid))) return service;
+    }
+    return nullptr;
+}
+
+BLEAdvertising* BLEServer::getAdvertising() {
+    return BLEDevice::getAdvertising();
+}
+
+uint16_t BLEServer::getPeerMTU(uint16_t) const {
+    std::lock_guard<std::mutex> guard(state().lock);
+    return state().connected ? state().peerMTU : 23;
+}
+
+uint32_t BLEServer::getConnectedCount() const {
+    return NativeBLE::connected() ? 1 : 0;
+}
+
+void BLEServer::startAdvertising() {
+    BLEDevice::getAdvertising()->start();
+}
+
+void BLEDevice::init(const std::string& deviceName) {
+    std::lock_guard<std::mutex> guard(state().lock);
+    state().deviceName = deviceName;
+}
+
+BLEServer* BLEDevice::createServer() {
+    BLEServer* server = new BLEServer();
+    std::lock_guard<std::mutex> guard(state().lock);
+    state().server = server;
+    return server;
+}
+
+BLEAdvertising* BLEDevice::getAdvertising() {
+    return &state().advertising;
+}
+
+void BLEDevice::setMTU(uint16_t mtu) {
+    std::lock_guard<std::mutex> guard(state().lock);
+    state().localMTU = mtu;
+}
+
+uint16_t BLEDevice::getMTU() {
+    std::lock_guard<std::mutex> guard(state().lock);
+    return state().localMTU;
+}
+
+std::string BLEDevice::deviceName() {
+    std::lock_guard<std::mutex> guard(state().lock);
+    return state().deviceName;
+}
+
+void BLEDevice::setCustomGapHandler(gap_event_handler handler) {
+    std::lock_guard<std::mutex> guard(state().lock);
+    state().gapHandler = handler;
+}
+
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t* params) {
+    gap_event_handler handler;
+    bool accept;
+    {
+        std::lock_guard<std::mutex> guard(state().lock);
+        if (!state().connected) return ESP_ERR_INVALID_STATE;
+        state().connParamRequests++;
+        state().lastConnParams = *params;
+        handler = state().gapHandler;
+        accept = state().acceptLink;
+    }
+    if (handler) {
+        esp_ble_gap_cb_param_t event = {};
+        event.update_conn_params.status = accept ? ESP_BT_STATUS_SUCCESS : ESP_BT_STATUS_FAIL;
+        memcpy(event.update_conn_params.bda, params->bda, sizeof(esp_bd_addr_t));
+        event.update_conn_params.min_int = params->min_int;
+        event.update_conn_params.max_int = params->max_int;
+        event.update_conn_params.conn_int = params->min_int;
+        event.update_conn_params.latency = params->latency;
+        event.update_conn_params.timeout = params->timeout;
+        handler(ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT, &event);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_set_pkt_data_len(esp_bd_addr_t, uint16_t tx_data_length) {
+    if (tx_data_length < 27 || tx_data_length > 251) return ESP_ERR_INVALID_ARG;
+    gap_event_handler handler;
+    bool accept;
+    {
+        std::lock_guard<std::mutex> guard(state().lock);
+        if (!state().connected) return ESP_ERR_INVALID_STATE;
+        accept = state().acceptLink;
+        if (accept) state().dataLength = tx_data_length;
+        handler = state().gapHandler;
+    }
+    if (handler) {
+        esp_ble_gap_cb_param_t event = {};
+        event.pkt_data_lenth_cmpl.status = accept ? ESP_BT_STATUS_SUCCESS : ESP_BT_STATUS_FAIL;
+        event.pkt_data_lenth_cmpl.params.tx_len = tx_data_length;
+        event.pkt_data_lenth_cmpl.params.rx_len = tx_data_length;
+        handler(ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT, &event);
+    }
+    return ESP_OK;
+}
+
+// ---------- 主机控制接口 ----------
+
+BLECharacteristic* NativeBLE::characteristic(const char* uuid) {
+    BLEUUID target(uuid);
+    std::lock_guard<std::mutex> guard(state().lock);
+    for (BLECharacteristic* characteristic : state().characteristics) {
+        if (characteristic->getUUID().equals(target)) return characteristic;
+    }
+    return nullptr;
+}
+
+bool NativeBLE::write(const char* uuid, const uint8_t* data, size_t len) {
+    BLECharacteristic* target = characteristic(uuid);
+    if (!target) return false;
+    uint32_t props = target->getProperties();
+    if (!(props & (BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR))) return false;
+    target->setValue(const_cast<uint8_t*>(data), len);
+    if (target->getCallbacks()) target->getCallbacks()->onWrite(target);
+    return true;
+}
+
+void NativeBLE::connect(uint16_t mtu) {
+    BLEServer* server;
+    {
+        std::lock_guard<std::mutex> guard(state().lock);
+        if (state().connected) return;
+        state().connected = true;
+        state().peerMTU = mtu < state().localMTU ? mtu : state().localMTU;     // 取双方较小值
+        server = state().server;
+    }
+    if (server && server->getCallbacks()) {
+        esp_ble_gatts_cb_param_t param = {};
+        const uint8_t peer[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};     // 随机静态地址
+        memcpy(param.connect.remote_bda, peer, sizeof(peer));
+        server->getCallbacks()->onConnect(server);
+        server->getCallbacks()->onConnect(server, &param);
+    }
+}
+
+void NativeBLE::disconnect() {
+    BLEServer* server;
+    {
+        std::lock_guard<std::mutex> guard(state().lock);
+        if (!state().connected) return;
+        state().connected = false;
+        state().dataLength = 27;
+        server = state().server;
+    }
+    if (server && server->getCallbacks()) server->getCallbacks()->onDisconnect(server);
+}
+
+bool NativeBLE::connected() {
+    std::lock_guard<std::mutex> guard(state().lock);
+    return state().connected;
+}
+
+void NativeBLE::onNotify(const NotifyHook& hook) {
+    std::lock_guard<std::mutex> guard(state().lock);
+    state().notifyHook = hook;
+}
+
+uint32_t NativeBLE::notifyCount() {
+    return s_notifyCount.load();
+}
+
+void NativeBLE::acceptLinkRequests(bool accept) {
+    std::lock_guard<std::mutex> guard(state().lock);
+    state().acceptLink = accept;
+}
+
+uint32_t NativeBLE::connParamRequests() {
+    std::lock_guard<std::mutex> guard(state().lock);
+    return state().connParamRequests;
+}
+
+esp_ble_conn_update_params_t NativeBLE::lastConnParams() {
+    std::lock_guard<std::mutex> guard(state().lock);
+    return state().lastConnParams;
+}
+
+uint16_t NativeBLE::dataLength() {
+    std::lock_guard<std::mutex> guard(state().lock);
+    return state().dataLength;
+}
+
+void NativeBLE::reset() {
+    std::lock_guard<std::mutex> guard(state().lock);
+    state().connected = false;
+    state().peerMTU = 23;
+    state().localMTU = 23;
+    state().server = nullptr;
+    state().characteristics.clear();
+    state().notifyHook = nullptr;
+    state().gapHandler = nullptr;
+    state().acceptLink = true;
+    state().connParamRequests = 0;
+    state().lastConnParams = esp_ble_conn_update_params_t();
+    state().dataLength = 27;
+    state().advertising = BLEAdvertising();
+    s_notifyCount = 0;
+}
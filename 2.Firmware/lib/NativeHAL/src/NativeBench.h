@@ -0,0 +1,49 @@
+#pragma once
+// 主机基准测试辅助：计时、分位数，以及机器可读的结果行
+//
+//   BENCH <名称> <数值> <单位>
+//
+// CI 用 grep '^BENCH ' 收集这些行与基线比较；名称用 snake_case，同一项指标在不同提交间保持不变
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+class NativeBench {
+public:
+    static uint64_t nowNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    static void report(const char* name, double value, const char* unit) {
+        printf("BENCH %s %.3f %s\n", name, value, unit);
+        fflush(stdout);
+    }
+
+    // 重复执行 fn，返回每次的平均耗时（纳秒）；先跑 iterations / 10 次预热
+    template <typename Fn>
+    static double nsPerOp(size_t iterations, Fn fn) {
+        for (size_t i = 0; i < iterations / 10; i++) fn();
+        uint64_t start = nowNs();
+        for (size_t i = 0; i < iterations; i++) fn();
+        return (double)(nowNs() - start) / (double)iterations;
+    }
+
+    // 样本的 p 分位（0..100），会对样本排序
+    static double percentile(std::vector<double>& samples, double p) {
+        if (samples.empty()) return 0;
+        std::sort(samples.begin(), samples.end());
+        size_t index = (size_t)((p / 100.0) * (double)(samples.size() - 1) + 0.5);
+        return samples[std::min(index, samples.size() - 1)];
+    }
+};
+
+// 防止编译器把被测结果优化掉
+template <typename T>
+inline void benchKeep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
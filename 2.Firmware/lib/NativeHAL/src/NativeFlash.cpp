@@ -0,0 +1,264 @@
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "NativeHAL.h"
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef NATIVE_FLASH_FILE
+#define NATIVE_FLASH_FILE "native_flash.bin"
+#endif
+
+static const uint32_t FLASH_SIZE = 4 * 1024 * 1024;
+static const uint32_t FLASH_SECTOR = 4096;
+static const uint8_t IMAGE_MAGIC = 0xE9;            // esp_image_header_t::magic
+
+// 与 partitions.csv 保持一致
+static const esp_partition_t s_partitions[] = {
+    {nullptr, ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS, 0x9000, 0x4000, "nvs", false},
+    {nullptr, ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_OTA, 0xd000, 0x2000, "otadata", false},
+    {nullptr, ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_PHY, 0xf000, 0x1000, "phy_init", false},
+    {nullptr, ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_FACTORY, 0x10000, 0x140000, "factory", false},
+    {nullptr, ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x150000, 0x140000, "ota_0", false},
+    {nullptr, ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, 0x290000, 0x170000, "storage", false},
+};
+static const size_t PARTITION_COUNT = sizeof(s_partitions) / sizeof(s_partitions[0]);
+
+struct OtaSession {
+    const esp_partition_t* partition;
+    uint32_t written;
+    uint32_t erasedEnd;                             // 顺序写模式下已擦除到的偏移
+};
+
+static std::mutex s_flashLock;
+static int s_fd = -1;
+static const esp_partition_t* s_running = &s_partitions[3];
+static const esp_partition_t* s_boot = nullptr;
+static std::map<esp_ota_handle_t, OtaSession> s_sessions;
+static esp_ota_handle_t s_nextHandle = 1;
+
+// ---------- 文件后端（调用方持有 s_flashLock） ----------
+
+static bool eraseLocked(uint32_t address, uint32_t size) {
+    static uint8_t blank[FLASH_SECTOR];
+    memset(blank, 0xFF, sizeof(blank));
+    for (uint32_t done = 0; done < size; done += FLASH_SECTOR) {
+        uint32_t chunk = size - done < FLASH_SECTOR ? size - done : FLASH_SECTOR;
+        if (pwrite(s_fd, blank, chunk, address + done) != (ssize_t)chunk) return false;
+    }
+    return true;
+}
+
+static bool openLocked() {
+    if (s_fd >= 0) return true;
+    s_fd = open(NATIVE_FLASH_FILE, O_RDWR | O_CREAT, 0644);
+    if (s_fd < 0) {
+        fprintf(stderr, "[NativeHAL] 无法打开模拟 Flash 文件 %s\n", NATIVE_FLASH_FILE);
+        return false;
+    }
+    struct stat info;
+    if (fstat(s_fd, &info) != 0 || info.st_size != (off_t)FLASH_SIZE) {   // 新文件：整片擦除为 0xFF
+        if (ftruncate(s_fd, FLASH_SIZE) != 0 || !eraseLocked(0, FLASH_SIZE)) return false;
+    }
+    return true;
+}
+
+static bool readLocked(uint32_t address, void* dst, size_t size) {
+    if (!openLocked() || address + size > FLASH_SIZE) return false;
+    return pread(s_fd, dst, size, address) == (ssize_t)size;
+}
+
+// NOR Flash 语义：编程只能把 1 变成 0，新值 = 旧值 & 写入值，必须先擦除
+static bool programLocked(uint32_t address, const void* src, size_t size) {
+    if (!openLocked() || address + size > FLASH_SIZE) return false;
+    uint8_t buffer[FLASH_SECTOR];
+    const uint8_t* in = (const uint8_t*)src;
+    for (size_t done = 0; done < size;) {
+        size_t chunk = size - done < sizeof(buffer) ? size - done : sizeof(buffer);
+        if (pread(s_fd, buffer, chunk, address + done) != (ssize_t)chunk) return false;
+        for (size_t i = 0; i < chunk; i++) buffer[i] &= in[done + i];
+        if (pwrite(s_fd, buffer, chunk, address + done) != (ssize_t)chunk) return false;
+        done += chunk;
+    }
+    return true;
+}
+
+static bool isOtaApp(const esp_partition_t* partition) {
+    return partition && partition->type == ESP_PARTITION_TYPE_APP &&
+           partition->subtype >= ESP_PARTITION_SUBTYPE_APP_OTA_MIN &&
+           partition->subtype < ESP_PARTITION_SUBTYPE_APP_OTA_MAX;
+}
+
+// ---------- esp_partition ----------
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+    for (size_t i = 0; i < PARTITION_COUNT; i++) {
+        const esp_partition_t& p = s_partitions[i];
+        if (type != ESP_PARTITION_TYPE_ANY && p.type != type) continue;
+        if (subtype != ESP_PARTITION_SUBTYPE_ANY && p.subtype != subtype) continue;
+        if (label && strcmp(label, p.label) != 0) continue;
+        return &p;
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size) {
+    if (!partition || !dst) return ESP_ERR_INVALID_ARG;
+    if (offset > partition->size || size > partition->size - offset) return ESP_ERR_INVALID_SIZE;
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    return readLocked(partition->address + offset, dst, size) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* src, size_t size) {
+    if (!partition || !src) return ESP_ERR_INVALID_ARG;
+    if (offset > partition->size || size > partition->size - offset) return ESP_ERR_INVALID_SIZE;
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    return programLocked(partition->address + offset, src, size) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+    if (!partition) return ESP_ERR_INVALID_ARG;
+    if (offset % FLASH_SECTOR || size % FLASH_SECTOR) return ESP_ERR_INVALID_SIZE;
+    if (offset > partition->size || size > partition->size - offset) return ESP_ERR_INVALID_SIZE;
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    return openLocked() && eraseLocked(partition->address + offset, size) ? ESP_OK : ESP_FAIL;
+}
+
+// ---------- esp_ota ----------
+
+esp_err_t esp_ota_begin(const esp_partition_t* partition, size_t imageSize, esp_ota_handle_t* outHandle) {
+    if (!isOtaApp(partition) || !outHandle) return ESP_ERR_INVALID_ARG;
+    if (partition == s_running) return ESP_ERR_OTA_PARTITION_CONFLICT;
+    if (imageSize != OTA_SIZE_UNKNOWN && imageSize != OTA_WITH_SEQUENTIAL_WRITES && imageSize > partition->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    if (!openLocked()) return ESP_FAIL;
+    for (auto& entry : s_sessions) {
+        if (entry.second.partition == partition) return ESP_ERR_OTA_PARTITION_CONFLICT;
+    }
+    OtaSession session = {partition, 0, 0};
+    if (imageSize != OTA_WITH_SEQUENTIAL_WRITES) {  // 与 IDF 相同：非顺序写模式在 begin 时同步擦除
+        uint32_t eraseSize = imageSize == OTA_SIZE_UNKNOWN ? partition->size
+                                                           : (imageSize + FLASH_SECTOR - 1) / FLASH_SECTOR * FLASH_SECTOR;
+        if (!eraseLocked(partition->address, eraseSize)) return ESP_FAIL;
+        session.erasedEnd = eraseSize;
+    }
+    *outHandle = s_nextHandle++;
+    s_sessions[*outHandle] = session;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void* data, size_t size) {
+    if (!data) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    auto it = s_sessions.find(handle);
+    if (it == s_sessions.end()) return ESP_ERR_INVALID_ARG;
+    OtaSession& session = it->second;
+    if (size == 0) return ESP_OK;
+    if (session.written == 0 && ((const uint8_t*)data)[0] != IMAGE_MAGIC) return ESP_ERR_OTA_VALIDATE_FAILED;
+    if (session.written + size > session.partition->size) return ESP_ERR_INVALID_SIZE;
+
+    uint32_t end = session.written + size;
+    if (end > session.erasedEnd) {                  // 顺序写：写到哪个扇区擦到哪个扇区
+        uint32_t eraseEnd = (end + FLASH_SECTOR - 1) / FLASH_SECTOR * FLASH_SECTOR;
+        if (!eraseLocked(session.partition->address + session.erasedEnd, eraseEnd - session.erasedEnd)) return ESP_FAIL;
+        session.erasedEnd = eraseEnd;
+    }
+    if (!programLocked(session.partition->address + session.written, data, size)) return ESP_FAIL;
+    session.written = end;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle) {
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    auto it = s_sessions.find(handle);
+    if (it == s_sessions.end()) return ESP_ERR_NOT_FOUND;
+    OtaSession session = it->second;
+    s_sessions.erase(it);                           // 与 IDF 相同：无论校验是否通过句柄都失效
+    if (session.written == 0) return ESP_ERR_INVALID_ARG;
+    uint8_t magic = 0;
+    if (!readLocked(session.partition->address, &magic, 1) || magic != IMAGE_MAGIC) return ESP_ERR_OTA_VALIDATE_FAILED;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle) {
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    return s_sessions.erase(handle) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+    if (!partition || partition->type != ESP_PARTITION_TYPE_APP) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    uint8_t magic = 0;
+    if (!readLocked(partition->address, &magic, 1) || magic != IMAGE_MAGIC) return ESP_ERR_OTA_VALIDATE_FAILED;
+    s_boot = partition;
+    return ESP_OK;
+}
+
+const esp_partition_t* esp_ota_get_boot_partition() {
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    return s_boot ? s_boot : s_running;
+}
+
+const esp_partition_t* esp_ota_get_running_partition() {
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    return s_running;
+}
+
+// 与 IDF 相同：取 startFrom（默认运行分区）之后的第一个 OTA 分区，找不到则回到第一个 OTA 分区
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* startFrom) {
+    if (!startFrom) startFrom = esp_ota_get_running_partition();
+    const esp_partition_t* first = nullptr;
+    bool passed = !isOtaApp(startFrom);             // 从 factory 启动时第一个 OTA 分区就是目标
+    for (size_t i = 0; i < PARTITION_COUNT; i++) {
+        const esp_partition_t* p = &s_partitions[i];
+        if (!isOtaApp(p)) continue;
+        if (!first) first = p;
+        if (passed) return p;
+        if (p == startFrom) passed = true;
+    }
+    return first;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback() {
+    return ESP_OK;
+}
+
+// ---------- 主机控制接口 ----------
+
+const char* NativeFlash::path() {
+    return NATIVE_FLASH_FILE;
+}
+
+bool NativeFlash::read(uint32_t address, void* dst, size_t size) {
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    return readLocked(address, dst, size);
+}
+
+bool NativeFlash::program(uint32_t address, const void* src, size_t size) {
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    if (!openLocked()) return false;
+    uint32_t start = address / FLASH_SECTOR * FLASH_SECTOR;
+    uint32_t end = (uint32_t)((address + size + FLASH_SECTOR - 1) / FLASH_SECTOR * FLASH_SECTOR);
+    return eraseLocked(start, end - start) && programLocked(address, src, size);
+}
+
+void NativeFlash::setRunningPartition(const char* label) {
+    const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, label);
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    if (partition) s_running = partition;
+}
+
+void NativeFlash::reset() {
+    std::lock_guard<std::mutex> guard(s_flashLock);
+    s_sessions.clear();
+    s_running = &s_partitions[3];
+    s_boot = nullptr;
+    if (openLocked()) eraseLocked(0, FLASH_SIZE);
+}
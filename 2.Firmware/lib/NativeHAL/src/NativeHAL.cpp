@@ -0,0 +1,36 @@
+#include "NativeHAL.h"
+#include "serial_color_debug.h"
+#include <atomic>
+#include <mutex>
+#include <stdarg.h>
+
+static std::atomic<int> s_logLevel(NativeLog::LEVEL_INFO);
+static std::mutex s_logLock;
+
+void nativeLog(int level, const char* tag, const char* format, ...) {
+    if (level > s_logLevel.load()) return;
+    std::lock_guard<std::mutex> guard(s_logLock);  // 多个任务线程同时打印时整行输出
+    printf("[%s] ", tag);
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
+
+void NativeLog::setLevel(Level level) {
+    s_logLevel = level;
+}
+
+NativeLog::Level NativeLog::level() {
+    return (Level)s_logLevel.load();
+}
+
+void NativeHAL::reset() {
+    NativeLedc::reset();
+    NativeFlash::reset();
+    NativeBLE::reset();
+    NativeNVS::clear();
+    NativeSystem::reset();
+    NativeSerial::reset();
+}
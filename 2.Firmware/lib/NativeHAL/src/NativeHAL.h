@@ -0,0 +1,89 @@
+#pragma once
+// env:native 的主机控制接口：测试和基准用它观察/驱动替身硬件，固件源码不应 include 本文件
+//
+//   NativeLedc   读回 LEDC 通道配置与占空比（PWMServoController / MotionController 的输出）
+//   NativeFlash  文件模拟的 4MB Flash（NATIVE_FLASH_FILE），分区表同 partitions.csv，esp_ota_* 在其上工作
+//   NativeBLE    扮演中心设备：连接/断开、写特征（触发 onWrite）、接收通知
+//   NativeNVS    内存中的 Preferences 存储
+//   NativeSystem esp_restart 计数
+//   NativeLog    DEBUG_* 宏的输出级别（基准测试时关掉逐条日志）
+//   NativeSerial Serial 的去向：stdout（默认）、收集到缓冲供断言，或丢弃只计字节数
+//
+// 每个测试用例开始前调用 NativeHAL::reset() 把全部替身恢复到上电状态
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include "esp_gap_ble_api.h"
+
+class BLECharacteristic;
+
+class NativeLedc {
+public:
+    static uint32_t duty(uint8_t channel);
+    static uint32_t writes(uint8_t channel);        // ledcWrite 调用次数
+    static uint8_t resolution(uint8_t channel);
+    static double frequency(uint8_t channel);
+    static int channelOfPin(uint8_t pin);           // 未绑定返回 -1
+    static void reset();
+};
+
+class NativeFlash {
+public:
+    static const char* path();
+    static bool read(uint32_t address, void* dst, size_t size);
+    static bool program(uint32_t address, const void* src, size_t size);   // 擦除所在扇区后写入（准备运行分区内容）
+    static void setRunningPartition(const char* label);                   // 默认 "factory"
+    static void reset();                            // 整片擦除，清空 OTA 会话与启动分区
+};
+
+class NativeBLE {
+public:
+    typedef std::function<void(const char* uuid, const uint8_t* data, size_t len)> NotifyHook;
+
+    static BLECharacteristic* characteristic(const char* uuid);
+    static bool write(const char* uuid, const uint8_t* data, size_t len);   // 中心设备写入，同步调用 onWrite
+    static void connect(uint16_t mtu = 517);
+    static void disconnect();
+    static bool connected();
+    static void onNotify(const NotifyHook& hook);   // 在发出通知的线程（NotifyQueue 发送任务）中调用
+    static uint32_t notifyCount();
+    // 链路参数：中心设备默认接受外设的请求（连接间隔取请求区间的下限），acceptLinkRequests(false) 模拟拒绝
+    static void acceptLinkRequests(bool accept);
+    static uint32_t connParamRequests();            // esp_ble_gap_update_conn_params 调用次数
+    static esp_ble_conn_update_params_t lastConnParams();
+    static uint16_t dataLength();                   // 最近一次请求的 LL 数据长度（未请求为 27）
+    static void reset();                            // 断开并清空特征注册（已创建的对象不释放，仍被固件持有）
+};
+
+class NativeNVS {
+public:
+    static void clear();
+};
+
+class NativeSystem {
+public:
+    static uint32_t restartCount();
+    static void reset();
+};
+
+class NativeLog {
+public:
+    enum Level { LEVEL_NONE = 0, LEVEL_ERROR = 1, LEVEL_WARN = 2, LEVEL_INFO = 3 };
+    static void setLevel(Level level);
+    static Level level();
+};
+
+class NativeSerial {
+public:
+    enum Mode { MODE_STDOUT = 0, MODE_CAPTURE = 1, MODE_DISCARD = 2 };
+    static void setMode(Mode mode);
+    static std::string take();                      // 取出并清空 MODE_CAPTURE 下收集的输出
+    static uint64_t bytesWritten();                 // 经 Serial 写出的总字节数（三种模式都计数）
+    static void reset();                            // 回到 MODE_STDOUT，清空缓冲与计数
+};
+
+class NativeHAL {
+public:
+    static void reset();
+};
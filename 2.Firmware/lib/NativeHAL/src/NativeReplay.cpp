@@ -0,0 +1,263 @@
+#include "NativeReplay.h"
+#include "NativeBench.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+bool ReplayConnection::connect(const char* endpoint) {
+    close();
+    if (strncmp(endpoint, "unix:", 5) == 0) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (strlen(endpoint + 5) >= sizeof(addr.sun_path)) return false;
+        strcpy(addr.sun_path, endpoint + 5);
+        _fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (_fd >= 0 && ::connect(_fd, (sockaddr*)&addr, sizeof(addr)) == 0) return true;
+    } else if (strncmp(endpoint, "tcp:", 4) == 0) {
+        const char* colon = strrchr(endpoint + 4, ':');
+        if (!colon) return false;
+        std::string host(endpoint + 4, colon);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)atoi(colon + 1));
+        if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) return false;
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        if (_fd >= 0) setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (_fd >= 0 && ::connect(_fd, (sockaddr*)&addr, sizeof(addr)) == 0) return true;
+    }
+    close();
+    return false;
+}
+
+void ReplayConnection::close() {
+    if (_fd >= 0) ::close(_fd);
+    _fd = -1;
+    _rx.clear();
+}
+
+bool ReplayConnection::write(const char* uuid, const uint8_t* data, size_t len) {
+    uint8_t frame[TRANSPORT_MAX_FRAME];
+    size_t frameLength = encodeTransportFrame(frame, sizeof(frame), TRANSPORT_OP_WRITE, uuid, data, len);
+    if (!frameLength || _fd < 0) return false;
+    size_t sent = 0;
+    while (sent < frameLength) {
+        ssize_t n = send(_fd, frame + sent, frameLength - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+bool ReplayConnection::readFrame(uint8_t& op, std::string& uuid, std::vector<uint8_t>& payload, uint32_t timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (_fd >= 0) {
+        TransportFrame frame;
+        int used = parseTransportFrame(_rx.data(), _rx.size(), frame);
+        if (used < 0) {
+            close();
+            return false;
+        }
+        if (used > 0) {
+            op = frame.op;
+            uuid.assign(frame.uuid, frame.uuidLength);
+            payload.assign(frame.payload, frame.payload + frame.payloadLength);
+            _rx.erase(_rx.begin(), _rx.begin() + used);
+            if (op == TRANSPORT_OP_NOTIFY) ++_notifications;
+            return true;
+        }
+
+        int waitMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                         deadline - std::chrono::steady_clock::now()).count();
+        pollfd pfd = {_fd, POLLIN, 0};
+        if (poll(&pfd, 1, waitMs > 0 ? waitMs : 0) <= 0) return false;
+        uint8_t buffer[4096];
+        ssize_t n = recv(_fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            close();
+            return false;
+        }
+        _rx.insert(_rx.end(), buffer, buffer + n);
+    }
+    return false;
+}
+
+bool ReplayConnection::waitNotification(const char* uuid, std::vector<uint8_t>& payload, uint32_t timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    uint8_t op;
+    std::string from;
+    for (;;) {
+        int leftMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                         deadline - std::chrono::steady_clock::now()).count();
+        if (!readFrame(op, from, payload, leftMs > 0 ? (uint32_t)leftMs : 0)) return false;
+        if (op == TRANSPORT_OP_NOTIFY && strcasecmp(from.c_str(), uuid) == 0) return true;
+    }
+}
+
+bool ReplayConnection::requestStats(TransportStats& stats, bool resetLatency, uint32_t timeoutMs) {
+    uint8_t flags = resetLatency ? TRANSPORT_STATS_RESET_LATENCY : 0;
+    uint8_t frame[TRANSPORT_FRAME_HEADER + 1];
+    size_t frameLength = encodeTransportFrame(frame, sizeof(frame), TRANSPORT_OP_STATS, nullptr, &flags, 1);
+    if (_fd < 0 || send(_fd, frame, frameLength, MSG_NOSIGNAL) != (ssize_t)frameLength) return false;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    uint8_t op;
+    std::string uuid;
+    std::vector<uint8_t> payload;
+    for (;;) {
+        int leftMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                         deadline - std::chrono::steady_clock::now()).count();
+        if (!readFrame(op, uuid, payload, leftMs > 0 ? (uint32_t)leftMs : 0)) return false;
+        if (op == TRANSPORT_OP_STATS) return decodeTransportStats(payload.data(), payload.size(), stats);
+    }
+}
+
+void ReplayConnection::drain() {
+    uint8_t op;
+    std::string uuid;
+    std::vector<uint8_t> payload;
+    while (readFrame(op, uuid, payload, 0)) {}
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool NativeReplay::loadCapture(const char* path, std::vector<ReplayFrame>& frames) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    char line[2048];
+    unsigned lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        ++lineNumber;
+        char uuid[64];
+        char hex[1100] = "";
+        unsigned long atUs;
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (sscanf(line, "%lu %63s %1099s", &atUs, uuid, hex) < 2) {
+            fprintf(stderr, "%s:%u: 格式应为 <μs> <UUID> <十六进制负载>\n", path, lineNumber);
+            ok = false;
+            break;
+        }
+        ReplayFrame frame;
+        frame.atUs = (uint32_t)atUs;
+        frame.uuid = uuid;
+        size_t hexLength = strlen(hex);
+        for (size_t i = 0; i < hexLength; i += 2) {
+            int hi = hexValue(hex[i]);
+            int lo = i + 1 < hexLength ? hexValue(hex[i + 1]) : -1;
+            if (hi < 0 || lo < 0) {
+                fprintf(stderr, "%s:%u: 负载不是偶数长度的十六进制\n", path, lineNumber);
+                ok = false;
+                break;
+            }
+            frame.payload.push_back((uint8_t)(hi << 4 | lo));
+        }
+        frames.push_back(frame);
+    }
+    fclose(file);
+    return ok;
+}
+
+bool NativeReplay::run(const char* endpoint, const std::vector<ReplayFrame>& frames, size_t clients,
+                       ReplayReport& report, double speed) {
+    report = ReplayReport();
+    report.clients = (uint32_t)clients;
+
+    ReplayConnection control;                       // 查询统计用的独立连接，不参与回放
+    TransportStats before;
+    if (!control.connect(endpoint) || !control.requestStats(before, true)) return false;
+
+    std::vector<std::unique_ptr<ReplayConnection>> connections;
+    for (size_t i = 0; i < clients; ++i) {
+        connections.emplace_back(new ReplayConnection());
+        if (!connections.back()->connect(endpoint)) return false;
+    }
+
+    std::atomic<uint32_t> sent{0};
+    std::vector<std::vector<double>> lags(clients);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);   // 所有连接同时开始
+    for (size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c]() {
+            ReplayConnection& connection = *connections[c];
+            std::vector<double>& lag = lags[c];
+            lag.reserve(frames.size());
+            std::this_thread::sleep_until(start);
+            for (const ReplayFrame& frame : frames) {
+                auto due = start;
+                if (speed > 0) {
+                    due += std::chrono::microseconds((int64_t)(frame.atUs / speed));
+                    std::this_thread::sleep_until(due);
+                }
+                auto now = std::chrono::steady_clock::now();
+                lag.push_back(speed > 0 ? (double)std::chrono::duration_cast<std::chrono::microseconds>(now - due).count() : 0);
+                if (!connection.write(frame.uuid.c_str(), frame.payload.data(), frame.payload.size())) break;
+                sent.fetch_add(1, std::memory_order_relaxed);
+                connection.drain();
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    report.sent = sent.load();
+
+    // 等服务端把回放期间入队的消息处理完（处理 + 丢弃 + 拒绝 = 发出），最多 5 秒
+    TransportStats after;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    do {
+        for (auto& connection : connections) connection->drain();
+        if (!control.requestStats(after)) return false;
+        if (after.handled + (after.dropped - before.dropped) + (after.rejected - before.rejected) >= report.sent &&
+            after.queueDepth == 0) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    } while (std::chrono::steady_clock::now() < deadline);
+    auto end = std::chrono::steady_clock::now();
+
+    report.seconds = std::chrono::duration<double>(end - start).count();
+    report.messagesPerSecond = report.seconds > 0 ? report.sent / report.seconds : 0;
+    report.handledPerSecond = report.seconds > 0 ? after.handled / report.seconds : 0;
+    report.dropped = after.dropped - before.dropped;
+    report.rejected = after.rejected - before.rejected;
+    report.handled = after.handled;
+    report.latencyP50Us = after.latencyP50Us;
+    report.latencyP99Us = after.latencyP99Us;
+    report.latencyMaxUs = after.latencyMaxUs;
+    std::vector<double> allLags;
+    for (auto& lag : lags) allLags.insert(allLags.end(), lag.begin(), lag.end());
+    report.sendLagP99Us = NativeBench::percentile(allLags, 99);
+    for (auto& connection : connections) report.notifications += connection->notificationCount();
+    return true;
+}
+
+void NativeReplay::print(const char* name, const ReplayReport& report) {
+    std::string prefix(name);
+    NativeBench::report((prefix + "_clients").c_str(), report.clients, "clients");
+    NativeBench::report((prefix + "_throughput").c_str(), report.messagesPerSecond, "msg/s");
+    NativeBench::report((prefix + "_handled_rate").c_str(), report.handledPerSecond, "msg/s");
+    NativeBench::report((prefix + "_sent").c_str(), report.sent, "msg");
+    NativeBench::report((prefix + "_dropped").c_str(), report.dropped, "msg");
+    NativeBench::report((prefix + "_latency_p50").c_str(), report.latencyP50Us, "us");
+    NativeBench::report((prefix + "_latency_p99").c_str(), report.latencyP99Us, "us");
+    NativeBench::report((prefix + "_latency_max").c_str(), report.latencyMaxUs, "us");
+    NativeBench::report((prefix + "_send_lag_p99").c_str(), report.sendLagP99Us, "us");
+}
@@ -0,0 +1,74 @@
+#pragma once
+// 套接字传输（SocketTransport）的主机回放客户端：模拟多个中心设备按真实时间重放写入，报告吞吐、丢弃与延迟
+//
+//   ReplayConnection   一个模拟中心设备：写特征、等待通知、查询服务端统计（TransportFrame 格式）
+//   NativeReplay::run  N 个连接各自在线程中按时间表重放同一组帧，结束后等服务端处理完再取统计
+//
+// 回放文件（loadCapture）是文本，每行一条写入，# 开头为注释：
+//
+//   <距开始的 μs> <特征 UUID> <负载十六进制>
+//   0      ef010001-1000-8000-0080-5f9b34fb0000 1001010300000000
+//   20000  ef010001-1000-8000-0080-5f9b34fb0000 1002010300000000
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "drivers/Transport/TransportFrame.h"
+
+struct ReplayFrame {
+    uint32_t atUs = 0;                              // 距回放开始的时刻（每个连接各自从 0 开始）
+    std::string uuid;
+    std::vector<uint8_t> payload;
+};
+
+struct ReplayReport {
+    uint32_t clients = 0;
+    uint32_t sent = 0;                              // 所有连接写出的帧
+    double seconds = 0;                             // 第一帧发出到服务端处理完最后一帧
+    double messagesPerSecond = 0;                   // 写出速率
+    double handledPerSecond = 0;                    // 服务端处理速率（发得比处理快时两者的差就是丢弃）
+    uint32_t dropped = 0;                           // 回放期间服务端 dispatcher 的丢弃增量（队列满 / 池耗尽 / 超长）
+    uint32_t rejected = 0;                          // 写入没有订阅者的特征
+    uint32_t handled = 0;                           // 回放期间消费者处理完的消息
+    uint32_t latencyP50Us = 0;                      // 服务端入队→处理延迟（LatencyHistogram，桶上界）
+    uint32_t latencyP99Us = 0;
+    uint32_t latencyMaxUs = 0;
+    double sendLagP99Us = 0;                        // 实际发出时刻落后时间表的 p99（客户端跟不上时变大）
+    uint32_t notifications = 0;                     // 所有连接收到的通知
+};
+
+class ReplayConnection {
+public:
+    ReplayConnection() = default;
+    ReplayConnection(const ReplayConnection&) = delete;
+    ReplayConnection& operator=(const ReplayConnection&) = delete;
+    ~ReplayConnection() { close(); }
+
+    bool connect(const char* endpoint);             // "unix:<路径>" 或 "tcp:<地址>:<端口>"
+    void close();
+    bool connected() const { return _fd >= 0; }
+
+    bool write(const char* uuid, const uint8_t* data, size_t len);
+    // 等待指定特征的下一条通知（其它特征的通知计数后丢弃），超时返回 false
+    bool waitNotification(const char* uuid, std::vector<uint8_t>& payload, uint32_t timeoutMs);
+    bool requestStats(TransportStats& stats, bool resetLatency = false, uint32_t timeoutMs = 1000);
+    void drain();                                   // 非阻塞地读走已到达的通知，避免服务端发送阻塞
+    uint32_t notificationCount() const { return _notifications; }
+
+private:
+    // 读取一帧（timeoutMs 为 0 时不阻塞），op 为 NOTIFY 时计数；返回 false 表示超时或连接断开
+    bool readFrame(uint8_t& op, std::string& uuid, std::vector<uint8_t>& payload, uint32_t timeoutMs);
+
+    int _fd = -1;
+    std::vector<uint8_t> _rx;
+    uint32_t _notifications = 0;
+};
+
+class NativeReplay {
+public:
+    static bool loadCapture(const char* path, std::vector<ReplayFrame>& frames);
+    // speed > 1 加快时间表，0 表示不按时间表、尽快发送（找吞吐上限）
+    static bool run(const char* endpoint, const std::vector<ReplayFrame>& frames, size_t clients,
+                    ReplayReport& report, double speed = 1.0);
+    static void print(const char* name, const ReplayReport& report);   // 以 BENCH 行输出（NativeBench::report）
+};
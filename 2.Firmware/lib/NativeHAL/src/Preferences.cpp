@@ -0,0 +1,86 @@
+#include "Preferences.h"
+#include "NativeHAL.h"
+#include <map>
+#include <mutex>
+#include <string.h>
+#include <vector>
+
+typedef std::map<std::string, std::vector<uint8_t>> Namespace;
+
+static std::mutex s_nvsLock;
+static std::map<std::string, Namespace> s_nvs;
+
+static const size_t NVS_KEY_NAME_MAX = 15;          // 与 NVS 相同：键名和命名空间最长 15 字符
+
+bool Preferences::begin(const char* name, bool readOnly, const char*) {
+    if (_started || !name || strlen(name) > NVS_KEY_NAME_MAX) return false;
+    _namespace = name;
+    _readOnly = readOnly;
+    _started = true;
+    return true;
+}
+
+void Preferences::end() {
+    _started = false;
+}
+
+bool Preferences::clear() {
+    if (!_started || _readOnly) return false;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    s_nvs.erase(_namespace);
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!_started || _readOnly || !key) return false;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    return s_nvs[_namespace].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    if (!_started || !key) return false;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    Namespace& ns = s_nvs[_namespace];
+    return ns.find(key) != ns.end();
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    if (!_started || _readOnly || !key || strlen(key) > NVS_KEY_NAME_MAX || !value || !len) return 0;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    const uint8_t* bytes = (const uint8_t*)value;
+    s_nvs[_namespace][key].assign(bytes, bytes + len);
+    return len;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!_started || !key) return 0;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    Namespace& ns = s_nvs[_namespace];
+    auto it = ns.find(key);
+    return it == ns.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    if (!_started || !key || !buf) return 0;
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    Namespace& ns = s_nvs[_namespace];
+    auto it = ns.find(key);
+    if (it == ns.end() || it->second.size() > maxLen) return 0;    // 与 NVS 相同：缓冲不够时不做截断
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+    uint32_t value = defaultValue;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) {
+    uint8_t value = defaultValue;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+void NativeNVS::clear() {
+    std::lock_guard<std::mutex> guard(s_nvsLock);
+    s_nvs.clear();
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "FS.h"
+
+namespace fs {
+
+class SPIFFSFS : public FS {
+public:
+    SPIFFSFS();
+    bool begin(bool formatOnFail = false, const char* basePath = "/spiffs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = nullptr);
+    void end() {}
+    bool format() { return false; }                 // 主机上不清空宿主机目录
+    size_t totalBytes() { return 0x170000; }         // storage 分区大小
+    size_t usedBytes() { return 0; }
+};
+
+}  // namespace fs
+
+extern fs::SPIFFSFS SPIFFS;
@@ -0,0 +1,2 @@
+#pragma once
+// OTAController 直接使用 esp_ota_* 接口，只 include 了 Update.h 而不使用 UpdateClass；主机上留空
@@ -0,0 +1,58 @@
+#pragma once
+// 主机上的 Bluedroid GAP / GATTS 类型与接口（只取固件用到的部分，字段名与 ESP-IDF 4.4 一致）
+// 经典 ESP32 没有 BLE 5.0 特性：与设备上相同，不定义 CONFIG_BT_BLE_50_FEATURES_SUPPORTED，PHY 相关接口不存在
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef uint8_t esp_bd_addr_t[6];
+
+typedef enum {
+    ESP_BT_STATUS_SUCCESS = 0,
+    ESP_BT_STATUS_FAIL = 1,
+    ESP_BT_STATUS_UNSUPPORTED = 6,
+} esp_bt_status_t;
+
+typedef enum {
+    ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT = 20,
+    ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT = 21,
+} esp_gap_ble_cb_event_t;
+
+typedef struct {
+    esp_bd_addr_t bda;
+    uint16_t min_int;
+    uint16_t max_int;
+    uint16_t latency;
+    uint16_t timeout;
+} esp_ble_conn_update_params_t;
+
+typedef struct {
+    uint16_t rx_len;
+    uint16_t tx_len;
+} esp_ble_pkt_data_length_params_t;
+
+typedef union {
+    struct ble_update_conn_params_evt_param {
+        esp_bt_status_t status;
+        esp_bd_addr_t bda;
+        uint16_t min_int;
+        uint16_t max_int;
+        uint16_t latency;
+        uint16_t conn_int;
+        uint16_t timeout;
+    } update_conn_params;
+    struct ble_pkt_data_length_cmpl_evt_param {
+        esp_bt_status_t status;
+        esp_ble_pkt_data_length_params_t params;
+    } pkt_data_lenth_cmpl;                          // IDF 中的拼写即如此
+} esp_ble_gap_cb_param_t;
+
+typedef union {
+    struct gatts_connect_evt_param {
+        uint16_t conn_id;
+        esp_bd_addr_t remote_bda;
+    } connect;
+} esp_ble_gatts_cb_param_t;
+
+// 请求与协议栈回调一样同步完成：NativeBLE 扮演的中心设备接受请求后立即调用 setCustomGapHandler 登记的处理函数
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t* params);
+esp_err_t esp_ble_gap_set_pkt_data_len(esp_bd_addr_t remote_device, uint16_t tx_data_length);
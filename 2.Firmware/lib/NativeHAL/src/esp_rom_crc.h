@@ -0,0 +1,5 @@
+#pragma once
+#include <stdint.h>
+
+// 与 ROM 中的 crc32_le 相同（zlib 兼容：调用方传入上一次的结果即可续算，初值 0）
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
@@ -0,0 +1,53 @@
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "NativeHAL.h"
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <zlib.h>
+
+static std::atomic<uint32_t> s_restarts(0);
+
+void esp_restart() {
+    s_restarts++;
+}
+
+uint32_t NativeSystem::restartCount() {
+    return s_restarts.load();
+}
+
+void NativeSystem::reset() {
+    s_restarts = 0;
+}
+
+uint32_t esp_random() {
+    static std::mt19937 generator(std::random_device{}());
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock);
+    return generator();
+}
+
+uint32_t esp_get_free_heap_size() {
+    return NATIVE_FREE_HEAP;
+}
+
+uint32_t esp_get_minimum_free_heap_size() {
+    return NATIVE_FREE_HEAP;
+}
+
+size_t heap_caps_get_free_size(uint32_t) {
+    return NATIVE_FREE_HEAP;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t) {
+    return NATIVE_FREE_HEAP;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t) {
+    return NATIVE_FREE_HEAP;
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    return (uint32_t)crc32(crc, buf, len);
+}
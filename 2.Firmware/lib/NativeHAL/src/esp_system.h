@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifndef NATIVE_HEAP_SIZE
+#define NATIVE_HEAP_SIZE 327680         // ESP.getHeapSize() 的返回值（与 esp32dev 启动后的内部 RAM 同量级）
+#endif
+#ifndef NATIVE_FREE_HEAP
+#define NATIVE_FREE_HEAP 200000         // 主机上不统计堆：getFreeHeap / getMinFreeHeap 恒为此值，堆差值日志因此为 0
+#endif
+
+// esp_restart 在主机上不会终止进程：只计数，测试用 NativeSystem::restartCount() 检查“是否请求了重启”
+void esp_restart();
+uint32_t esp_random();
+uint32_t esp_get_free_heap_size();
+uint32_t esp_get_minimum_free_heap_size();
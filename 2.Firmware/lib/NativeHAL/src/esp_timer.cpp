@@ -0,0 +1,104 @@
+#include "esp_timer.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct NativeTimer {
+    esp_timer_create_args_t args;
+    std::mutex lock;
+    std::condition_variable cv;
+    std::thread worker;
+    bool active = false;
+    bool periodic = false;
+    uint64_t periodUs = 0;
+    uint32_t generation = 0;                        // 每次 start/stop 递增，旧线程据此退出
+};
+
+static const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_epoch).count();
+}
+
+static void timerLoop(NativeTimer* timer, uint32_t generation) {
+    auto next = std::chrono::steady_clock::now() + std::chrono::microseconds(timer->periodUs);
+    std::unique_lock<std::mutex> lock(timer->lock);
+    while (timer->generation == generation) {
+        if (timer->cv.wait_until(lock, next, [timer, generation]() { return timer->generation != generation; })) break;
+        bool periodic = timer->periodic;
+        if (!periodic) timer->active = false;
+        lock.unlock();
+        timer->args.callback(timer->args.arg);      // 回调在锁外执行，回调里可以 stop 自己
+        lock.lock();
+        if (!periodic) break;
+        next += std::chrono::microseconds(timer->periodUs);
+    }
+}
+
+static esp_err_t startTimer(esp_timer_handle_t timer, uint64_t periodUs, bool periodic) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    std::unique_lock<std::mutex> lock(timer->lock);
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    if (timer->worker.joinable()) {                 // 上一次运行的线程已经结束或正在退出
+        lock.unlock();
+        timer->worker.join();
+        lock.lock();
+    }
+    timer->active = true;
+    timer->periodic = periodic;
+    timer->periodUs = periodUs;
+    uint32_t generation = ++timer->generation;
+    timer->worker = std::thread(timerLoop, timer, generation);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    if (!args || !args->callback || !out) return ESP_ERR_INVALID_ARG;
+    NativeTimer* timer = new NativeTimer();
+    timer->args = *args;
+    *out = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    return startTimer(timer, periodUs, true);
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    return startTimer(timer, timeoutUs, false);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    std::thread worker;
+    {
+        std::lock_guard<std::mutex> guard(timer->lock);
+        if (!timer->active) return ESP_ERR_INVALID_STATE;
+        timer->active = false;
+        timer->generation++;
+        worker.swap(timer->worker);
+    }
+    timer->cv.notify_all();
+    // 回调里 stop 自己时不能 join 自己：分离后线程看到 generation 变化自行退出
+    if (worker.get_id() == std::this_thread::get_id()) worker.detach();
+    else if (worker.joinable()) worker.join();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    {
+        std::lock_guard<std::mutex> guard(timer->lock);
+        if (timer->active) return ESP_ERR_INVALID_STATE;
+    }
+    if (timer->worker.joinable()) timer->worker.join();
+    delete timer;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    if (!timer) return false;
+    std::lock_guard<std::mutex> guard(timer->lock);
+    return timer->active;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+
+// 主机上的 esp_timer：esp_timer_get_time 是进程启动后的单调微秒数（millis/micros/tick 都由它派生），
+// 每个定时器一个后台线程，按绝对时间点周期触发（回调耗时不会累积成漂移）
+struct NativeTimer;
+typedef NativeTimer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+
+typedef enum {
+    ESP_TIMER_TASK,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void* arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+int64_t esp_timer_get_time();
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);     // 必须先 stop（与 IDF 相同，运行中删除返回 ESP_ERR_INVALID_STATE）
+bool esp_timer_is_active(esp_timer_handle_t timer);
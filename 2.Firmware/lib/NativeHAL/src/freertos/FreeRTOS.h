@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// 主机上的 FreeRTOS 替身：任务是 std::thread，队列/信号量/任务通知用互斥锁 + 条件变量实现
+// 只覆盖固件用到的 API，语义按 ESP-IDF 4.4 的 FreeRTOS：1 tick = 1ms，核心编号和优先级只记录不生效
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+struct NativeTask;
+struct NativeQueue;
+typedef NativeTask* TaskHandle_t;
+typedef NativeQueue* QueueHandle_t;
+typedef NativeQueue* SemaphoreHandle_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define errQUEUE_EMPTY 0
+#define errQUEUE_FULL 0
+
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 25
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFu)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// portMUX：ESP32 上是跨核自旋锁，这里是可重入的自旋锁（临界区只拷贝几十字节，不会长时间自旋）
+typedef struct {
+    volatile uintptr_t owner;                       // 0 表示未上锁
+    volatile uint32_t count;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+
+void nativeEnterCritical(portMUX_TYPE* mux);
+void nativeExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux) nativeEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) nativeExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) nativeEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) nativeExitCritical(mux)
+#define taskENTER_CRITICAL(mux) nativeEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux) nativeExitCritical(mux)
+
+void nativeYield();
+#define portYIELD() nativeYield()
+#define taskYIELD() nativeYield()
+#define portYIELD_FROM_ISR(...) do {} while (0)
+
+#define xPortGetCoreID() 0
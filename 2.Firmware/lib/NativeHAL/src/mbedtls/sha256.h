@@ -0,0 +1,30 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// 软件 SHA-256，接口与 mbedTLS 2.x（IDF 4.4 自带版本）一致；ESP32 上的硬件加速版本结果相同
+typedef struct {
+    uint32_t total[2];
+    uint32_t state[8];
+    unsigned char buffer[64];
+    int is224;
+} mbedtls_sha256_context;
+
+void mbedtls_sha256_init(mbedtls_sha256_context* ctx);
+void mbedtls_sha256_free(mbedtls_sha256_context* ctx);
+void mbedtls_sha256_clone(mbedtls_sha256_context* dst, const mbedtls_sha256_context* src);
+int mbedtls_sha256_starts_ret(mbedtls_sha256_context* ctx, int is224);
+int mbedtls_sha256_update_ret(mbedtls_sha256_context* ctx, const unsigned char* input, size_t ilen);
+int mbedtls_sha256_finish_ret(mbedtls_sha256_context* ctx, unsigned char output[32]);
+int mbedtls_sha256_ret(const unsigned char* input, size_t ilen, unsigned char output[32], int is224);
+
+inline void mbedtls_sha256_starts(mbedtls_sha256_context* ctx, int is224) { mbedtls_sha256_starts_ret(ctx, is224); }
+inline void mbedtls_sha256_update(mbedtls_sha256_context* ctx, const unsigned char* input, size_t ilen) {
+    mbedtls_sha256_update_ret(ctx, input, ilen);
+}
+inline void mbedtls_sha256_finish(mbedtls_sha256_context* ctx, unsigned char output[32]) {
+    mbedtls_sha256_finish_ret(ctx, output);
+}
+inline void mbedtls_sha256(const unsigned char* input, size_t ilen, unsigned char output[32], int is224) {
+    mbedtls_sha256_ret(input, ilen, output, is224);
+}
@@ -0,0 +1,67 @@
+#include "miniz.h"
+
+static const uint32_t STATE_RUNNING = 1;
+static const uint32_t STATE_DONE = 2;
+
+static voidpf arenaAlloc(voidpf opaque, uInt items, uInt size) {
+    tinfl_decompressor* r = (tinfl_decompressor*)opaque;
+    size_t bytes = ((size_t)items * size + 15) & ~(size_t)15;
+    if (r->arenaUsed + bytes > sizeof(r->arena)) return Z_NULL;
+    voidpf ptr = r->arena + r->arenaUsed;
+    r->arenaUsed += bytes;
+    return ptr;
+}
+
+static void arenaFree(voidpf, voidpf) {}            // 整块区域随结构体一起释放
+
+// tinfl 的循环字典大小 → zlib windowBits（9..15）
+static int windowBitsFor(size_t dictSize) {
+    int bits = 9;
+    while (bits < 15 && ((size_t)1 << bits) < dictSize) bits++;
+    return bits;
+}
+
+tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* pIn_buf_next, size_t* pIn_buf_size,
+                              uint8_t* pOut_buf_start, uint8_t* pOut_buf_next, size_t* pOut_buf_size,
+                              const uint32_t decomp_flags) {
+    size_t inSize = *pIn_buf_size;
+    size_t outSize = *pOut_buf_size;
+    *pIn_buf_size = 0;
+    *pOut_buf_size = 0;
+    if (!r || pOut_buf_next < pOut_buf_start) return TINFL_STATUS_BAD_PARAM;
+    if (r->m_state == STATE_DONE) return TINFL_STATUS_DONE;
+
+    if (r->m_state == 0) {
+        int bits = 15;
+        if (!(decomp_flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF)) {
+            size_t dictSize = (size_t)(pOut_buf_next - pOut_buf_start) + outSize;
+            if (dictSize & (dictSize - 1)) return TINFL_STATUS_BAD_PARAM;   // 循环字典必须是 2 的幂
+            bits = windowBitsFor(dictSize);
+        }
+        r->arenaUsed = 0;
+        r->stream = z_stream();
+        r->stream.zalloc = arenaAlloc;
+        r->stream.zfree = arenaFree;
+        r->stream.opaque = r;
+        int windowBits = (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER) ? bits : -bits;
+        if (inflateInit2(&r->stream, windowBits) != Z_OK) return TINFL_STATUS_FAILED;
+        r->m_state = STATE_RUNNING;
+    }
+
+    r->stream.next_in = (Bytef*)pIn_buf_next;
+    r->stream.avail_in = (uInt)inSize;
+    r->stream.next_out = pOut_buf_next;
+    r->stream.avail_out = (uInt)outSize;
+    int ret = inflate(&r->stream, Z_NO_FLUSH);
+    *pIn_buf_size = inSize - r->stream.avail_in;
+    *pOut_buf_size = outSize - r->stream.avail_out;
+
+    if (ret == Z_STREAM_END) {
+        r->m_state = STATE_DONE;
+        return TINFL_STATUS_DONE;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR) return TINFL_STATUS_FAILED;
+    if (r->stream.avail_out == 0) return TINFL_STATUS_HAS_MORE_OUTPUT;
+    if (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT) return TINFL_STATUS_NEEDS_MORE_INPUT;
+    return TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS;
+}
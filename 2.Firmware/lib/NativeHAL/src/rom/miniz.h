@@ -0,0 +1,45 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+// ROM miniz 的 tinfl 接口，主机上由 zlib 的 raw inflate 实现
+// 与 tinfl 相同：输出缓冲不带 NON_WRAPPING 标志时是 2 的幂大小的循环字典，回溯距离受它限制
+// （zlib windowBits 按缓冲大小取值，超出字典的流在主机上同样解压失败，不会比设备宽松）
+// 解压状态（含 zlib 的窗口）全部放在结构体内的定长区域里：调用方 malloc / free 整个结构体即可，与 ROM 版本用法一致
+
+typedef enum {
+    TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+enum {
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+    TINFL_FLAG_COMPUTE_ADLER32 = 8,
+};
+
+#define TINFL_LZ_DICT_SIZE 32768
+#define TINFL_NATIVE_ARENA_BYTES (48 * 1024)      // inflate_state + 最大 32KB 窗口
+
+typedef struct {
+    uint32_t m_state;                               // 0 = 尚未开始（tinfl_init 只清这个字段，与 miniz 相同）
+    z_stream stream;
+    size_t arenaUsed;
+    alignas(16) unsigned char arena[TINFL_NATIVE_ARENA_BYTES];
+} tinfl_decompressor;
+
+#define tinfl_init(r) \
+    do {              \
+        (r)->m_state = 0; \
+    } while (0)
+
+tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* pIn_buf_next, size_t* pIn_buf_size,
+                              uint8_t* pOut_buf_start, uint8_t* pOut_buf_next, size_t* pOut_buf_size,
+                              const uint32_t decomp_flags);
@@ -0,0 +1,13 @@
+#pragma once
+// serial-color-debug 库的主机版本：同名宏输出到 stdout，级别由 NativeLog::setLevel 控制
+// 只在 env:native 中生效（设备上使用 lib_deps 里的原库）
+#include <stdio.h>
+
+void nativeLog(int level, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+#define DEBUG_ERROR(msg) nativeLog(1, "ERROR", "%s", (const char*)(msg))
+#define DEBUG_ERRORF(format, ...) nativeLog(1, "ERROR", format, ##__VA_ARGS__)
+#define DEBUG_WARN(msg) nativeLog(2, "WARN", "%s", (const char*)(msg))
+#define DEBUG_WARNF(format, ...) nativeLog(2, "WARN", format, ##__VA_ARGS__)
+#define DEBUG_INFO(msg) nativeLog(3, "INFO", "%s", (const char*)(msg))
+#define DEBUG_INFOF(format, ...) nativeLog(3, "INFO", format, ##__VA_ARGS__)
@@ -0,0 +1,145 @@
+# 动作片段编译器：clips/*.json → data/clips/<id>.clip（二进制格式见 src/controllers/AnimationController/MotionClip.h）
+#
+# - 作为 PlatformIO 预构建脚本运行（platformio.ini: extra_scripts = pre:scripts/build-clips.py），
+#   也可以单独运行：python scripts/build-clips.py；生成的文件随 npm run upload-fs 写入 SPIFFS
+# - 每个轴一条轨道，轨道是按时间排列的关键帧 {"t": 毫秒, "angle": 度, "ease": 缓动}，第一帧必须是 t = 0（起始姿态）
+# - 相邻两帧之间生成一段补间：从上一帧的时刻开始，用两帧的时间差缓动到这一帧的角度；角度不变的帧不生成补间
+# - 所有轨道的补间按起始时刻合并排序，播放端顺序读取即可
+# - 内容没有变化时不重写文件
+
+import glob
+import json
+import os
+import struct
+import sys
+
+MAGIC = 0x314C434D                      # "MCL1"，与 MOTION_CLIP_MAGIC 一致
+VERSION = 1
+MAX_AXES = 4
+FLAG_LOOP = 0x01
+EASINGS = {"linear": 0, "in_out": 1, "trapezoid": 2}
+DEFAULT_EASE = "in_out"
+HEADER = struct.Struct("<IBBBBHHI%dh" % MAX_AXES)       # MotionClipHeader，24 字节
+KEYFRAME = struct.Struct("<HHBBh")                      # MotionKeyframe，8 字节
+
+
+class ClipError(Exception):
+    pass
+
+
+def centi_degrees(angle, where):
+    if not isinstance(angle, (int, float)) or isinstance(angle, bool):
+        raise ClipError("%s: angle 应为数字" % where)
+    value = int(round(angle * 100))
+    if not -32768 <= value <= 32767:
+        raise ClipError("%s: angle %r 超出范围" % (where, angle))
+    return value
+
+
+def compile_clip(clip, where):
+    clip_id = clip.get("id")
+    if not isinstance(clip_id, int) or isinstance(clip_id, bool) or not 0 <= clip_id <= 0xFFFF:
+        raise ClipError("%s: id 应为 0 ~ 65535 的整数" % where)
+    tracks = clip.get("tracks")
+    if not isinstance(tracks, dict) or not tracks:
+        raise ClipError("%s: tracks 不能为空" % where)
+
+    axis_mask = 0
+    start_pose = [0] * MAX_AXES
+    segments = []                       # (start, axis, duration, easing, centi_degrees)
+    end_ms = 0
+    for key, frames in tracks.items():
+        if not key.isdigit() or int(key) >= MAX_AXES:
+            raise ClipError("%s: 轴编号 %r 应为 0 ~ %d" % (where, key, MAX_AXES - 1))
+        axis = int(key)
+        track_where = "%s.tracks[%s]" % (where, key)
+        if not isinstance(frames, list) or not frames:
+            raise ClipError("%s: 至少需要一个关键帧" % track_where)
+        if frames[0].get("t") != 0:
+            raise ClipError("%s: 第一帧必须是 t = 0（起始姿态）" % track_where)
+        axis_mask |= 1 << axis
+        start_pose[axis] = centi_degrees(frames[0].get("angle"), track_where + "[0]")
+
+        previous_t, previous_angle = 0, start_pose[axis]
+        for i, frame in enumerate(frames[1:], 1):
+            frame_where = "%s[%d]" % (track_where, i)
+            t = frame.get("t")
+            if not isinstance(t, int) or isinstance(t, bool) or t <= previous_t:
+                raise ClipError("%s: t 应为递增的整数毫秒" % frame_where)
+            if t - previous_t > 0xFFFF:
+                raise ClipError("%s: 与上一帧间隔超过 65535 ms" % frame_where)
+            angle = centi_degrees(frame.get("angle"), frame_where)
+            ease = frame.get("ease", DEFAULT_EASE)
+            if ease not in EASINGS:
+                raise ClipError("%s: ease %r 不在 %s 中" % (frame_where, ease, sorted(EASINGS)))
+            if angle != previous_angle:
+                segments.append((previous_t, axis, t - previous_t, EASINGS[ease], angle))
+            previous_t, previous_angle = t, angle
+        end_ms = max(end_ms, previous_t)
+
+    duration = clip.get("duration_ms", end_ms)  # 可以比最后一帧长，在结尾（或循环之间）停顿
+    if not isinstance(duration, int) or duration < end_ms:
+        raise ClipError("%s: duration_ms 不能短于最后一帧 (%d ms)" % (where, end_ms))
+    loop = clip.get("loop", False)
+    if loop and duration == 0:
+        raise ClipError("%s: 循环片段的时长不能为 0" % where)
+    if len(segments) > 0xFFFF:
+        raise ClipError("%s: 补间过多" % where)
+
+    segments.sort(key=lambda s: (s[0], s[1]))
+    body = bytearray()
+    last_start = 0
+    for start, axis, length, easing, angle in segments:
+        if start - last_start > 0xFFFF:
+            raise ClipError("%s: 两段补间的起始间隔超过 65535 ms" % where)
+        body += KEYFRAME.pack(start - last_start, length, axis, easing, angle)
+        last_start = start
+    header = HEADER.pack(MAGIC, VERSION, axis_mask, FLAG_LOOP if loop else 0, 0,
+                         len(segments), 0, duration, *start_pose)
+    return clip_id, header + bytes(body), len(segments), duration
+
+
+def build(project_dir):
+    source_dir = os.path.join(project_dir, "clips")
+    out_dir = os.path.join(project_dir, "data", "clips")
+    sources = sorted(glob.glob(os.path.join(source_dir, "*.json")))
+    if not sources:
+        return
+    os.makedirs(out_dir, exist_ok=True)
+
+    seen = {}
+    for path in sources:
+        name = os.path.relpath(path, project_dir).replace(os.sep, "/")
+        with open(path, encoding="utf-8") as f:
+            clip = json.load(f)
+        clip_id, blob, count, duration = compile_clip(clip, name)
+        if clip_id in seen:
+            raise ClipError("%s: id %d 与 %s 重复" % (name, clip_id, seen[clip_id]))
+        seen[clip_id] = name
+
+        out_path = os.path.join(out_dir, "%d.clip" % clip_id)
+        old = None
+        if os.path.exists(out_path):
+            with open(out_path, "rb") as f:
+                old = f.read()
+        if old != blob:
+            with open(out_path, "wb") as f:
+                f.write(blob)
+            print("🎬 已生成动作片段 %d（%s）: %d 段补间，%d ms，%d 字节" % (
+                clip_id, clip.get("name", name), count, duration, len(blob)))
+
+
+def _run(project_dir):
+    try:
+        build(project_dir)
+    except (ClipError, ValueError) as e:
+        print("❌ 动作片段编译失败: %s" % e)
+        sys.exit(1)
+
+
+try:
+    Import("env")                               # noqa: F821  由 PlatformIO 注入
+    _run(env.subst("$PROJECT_DIR"))             # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        _run(os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")))
@@ -1,5 +1,7 @@
 const fs = require('fs');
 const path = require('path');
+const zlib = require('zlib');
+const delta = require('./make-delta');
 const { execSync } = require('child_process');
 
 // 构建固件
@@ -23,15 +25,59 @@ const releasePath = path.join(versionDir, 'firmware.bin');
 
 fs.copyFileSync(firmwarePath, releasePath);
 
+// 生成压缩镜像（OTA 压缩传输用）：raw deflate，窗口 4KB，与设备端 OTAInflater 的解压字典一致
+const firmware = fs.readFileSync(firmwarePath);
+const compressed = zlib.deflateRawSync(firmware, { level: 9, windowBits: 12, memLevel: 9 });
+fs.writeFileSync(path.join(versionDir, 'firmware.bin.deflate'), compressed);
+
+// 指定基准固件（设备上正在运行的版本）时，同时生成差分补丁
+let patchInfo = null;
+if (process.env.BASE_FIRMWARE) {
+    const base = fs.readFileSync(process.env.BASE_FIRMWARE);
+    const patch = delta.serialize(delta.generate(base, firmware), base, firmware);
+    const patchCompressed = zlib.deflateRawSync(patch, { level: 9, windowBits: 12, memLevel: 9 });
+    if (!delta.apply(base, patch).equals(firmware)) {
+        throw new Error('差分补丁往返校验失败');
+    }
+    fs.writeFileSync(path.join(versionDir, 'firmware.patch.deflate'), patchCompressed);
+    patchInfo = {
+        baseSize: base.length,
+        baseCrc32: delta.crc32(base).toString(16).padStart(8, '0'),
+        compressedSize: patchCompressed.length
+    };
+}
+
 // 创建固件信息文件
 const info = {
     version,
     buildDate,
-    size: fs.statSync(firmwarePath).size,
+    size: firmware.length,
     md5: require('crypto')
         .createHash('md5')
-        .update(fs.readFileSync(firmwarePath))
-        .digest('hex')
+        .update(firmware)
+        .digest('hex'),
+    sha256: require('crypto')
+        .createHash('sha256')
+        .update(firmware)
+        .digest('hex'),
+    compression: 'deflate-raw-w12',
+    compressedSize: compressed.length,
+    patch: patchInfo
+};
+
+// 链路模型（与 test_ota 的 bench_ota_link_model 相同）：v1 协议每包 244 字节中 8 字节是包头，
+// 按链路有效吞吐 OTA_LINK_KBPS（kbit/s，用实测值覆盖，默认 160）估算上传时间，设备端写入与接收并行，不计入
+const linkKbps = parseFloat(process.env.OTA_LINK_KBPS || '160');
+const OTA_PACKET_PAYLOAD = 244 - 8;
+const transferSeconds = (bytes) => {
+    const packets = Math.ceil(bytes / OTA_PACKET_PAYLOAD);
+    return (bytes + packets * 8) * 8 / (linkKbps * 1000);
+};
+info.transfer = {
+    linkKbps,
+    rawSeconds: +transferSeconds(info.size).toFixed(1),
+    compressedSeconds: +transferSeconds(info.compressedSize).toFixed(1),
+    patchSeconds: patchInfo ? +transferSeconds(patchInfo.compressedSize).toFixed(1) : null
 };
 
 fs.writeFileSync(
@@ -47,6 +93,8 @@ const readme = `# 固件版本 v${version}
 - 构建日期：${buildDate}
 - 文件大小：${(info.size / 1024).toFixed(2)} KB
 - MD5校验和：${info.md5}
+- SHA-256：${info.sha256}（OTA START 命令携带，设备写入时校验）
+- 压缩镜像：firmware.bin.deflate，${(info.compressedSize / 1024).toFixed(2)} KB（${(info.compressedSize / info.size * 100).toFixed(1)}%）
 
 ## 更新说明
 请在此处添加本次更新的具体内容。
@@ -64,4 +112,11 @@ fs.writeFileSync(
 
 console.log('✅ 固件打包完成！');
 console.log(`📦 固件目录: ${versionDir}`);
-console.log(`📄 固件信息: ${JSON.stringify(info, null, 2)}`); 
\ No newline at end of file
+console.log(`📄 固件信息: ${JSON.stringify(info, null, 2)}`);
+console.log(`📉 压缩率: ${(info.compressedSize / info.size * 100).toFixed(1)}%`);
+const speedup = (seconds) => (info.transfer.rawSeconds / seconds).toFixed(2);
+console.log(`⏱️ 预计 OTA 传输时间（链路 ${linkKbps} kbit/s）: 原始 ${info.transfer.rawSeconds} s，` +
+            `压缩 ${info.transfer.compressedSeconds} s（${speedup(info.transfer.compressedSeconds)}x）`);
+if (patchInfo) {
+    console.log(`🩹 差分补丁: ${patchInfo.compressedSize} 字节，预计传输 ${info.transfer.patchSeconds} s（${speedup(info.transfer.patchSeconds)}x）`);
+} 
\ No newline at end of file
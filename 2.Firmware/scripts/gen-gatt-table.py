@@ -0,0 +1,255 @@
+# GATT 表生成器：data/ble_config.json → src/drivers/BLE/GattTable.generated.h
+#
+# - 作为 PlatformIO 预构建脚本运行（platformio.ini: extra_scripts = pre:scripts/gen-gatt-table.py），
+#   也可以单独运行：python scripts/gen-gatt-table.py
+# - 先按 data/ble_config.schema.json 校验配置（只实现了 schema 中用到的 draft-07 关键字），
+#   再做 UUID 格式、重复 UUID、初始值范围等语义检查，任何错误都会中止构建
+# - 初始值在构建时就转换成字节：bytes → 原样，string → UTF-8，json → 紧凑序列化，int → 1 字节
+# - 特征的 notify 字段（mode / min_interval_ms / pack）生成通知策略，由 NotifyQueue 在发送任务中执行
+# - 服务的 boot 字段为 "deferred" 时，该服务在开始广播之后才由后台任务创建（快速启动，见 BLEServerWrapper::beginDeferred）
+# - 内容没有变化时不重写文件，避免触发无谓的重新编译
+
+import json
+import os
+import re
+import sys
+
+HEADER_NAME = "GattTable.generated.h"
+UUID_RE = re.compile(r"^([0-9a-fA-F]{4}|[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{12})$")
+PROPERTY_FLAGS = {
+    "READ": "GATT_PROP_READ",
+    "WRITE": "GATT_PROP_WRITE",
+    "NOTIFY": "GATT_PROP_NOTIFY",
+    "WRITE_NO_RESPONSE": "GATT_PROP_WRITE_NR",
+}
+NOTIFY_MODES = {
+    "event": "GATT_NOTIFY_EVENT",
+    "state": "GATT_NOTIFY_STATE",
+}
+DEFAULT_DEVICE_NAME = "CLO"             # 与 BLEServerWrapper 的 JSON 加载路径默认值一致
+
+
+class ConfigError(Exception):
+    pass
+
+
+# ---------- 最小 JSON Schema 校验（type / required / properties / items / enum / oneOf） ----------
+
+def _type_ok(value, expected):
+    if expected == "object":
+        return isinstance(value, dict)
+    if expected == "array":
+        return isinstance(value, list)
+    if expected == "string":
+        return isinstance(value, str)
+    if expected == "number":
+        return isinstance(value, (int, float)) and not isinstance(value, bool)
+    if expected == "integer":
+        return isinstance(value, int) and not isinstance(value, bool)
+    if expected == "boolean":
+        return isinstance(value, bool)
+    return True
+
+
+def validate(value, schema, where, errors):
+    if "type" in schema and not _type_ok(value, schema["type"]):
+        errors.append("%s: 应为 %s" % (where, schema["type"]))
+        return
+    if "enum" in schema and value not in schema["enum"]:
+        errors.append("%s: %r 不在 %s 中" % (where, value, schema["enum"]))
+    if "oneOf" in schema:
+        matched = 0
+        for sub in schema["oneOf"]:
+            sub_errors = []
+            validate(value, sub, where, sub_errors)
+            matched += not sub_errors
+        if matched != 1:
+            errors.append("%s: 需要恰好匹配 oneOf 中的一种类型（匹配 %d 种）" % (where, matched))
+    if isinstance(value, dict):
+        for key in schema.get("required", []):
+            if key not in value:
+                errors.append("%s: 缺少必填字段 %s" % (where, key))
+        for key, sub in schema.get("properties", {}).items():
+            if key in value:
+                validate(value[key], sub, "%s.%s" % (where, key), errors)
+    if isinstance(value, list) and "items" in schema:
+        for i, item in enumerate(value):
+            validate(item, schema["items"], "%s[%d]" % (where, i), errors)
+
+
+# ---------- 语义检查与初始值转换 ----------
+
+def encode_value(ch, where):
+    if "value" not in ch:
+        return b""
+    value = ch["value"]
+    fmt = ch.get("value_format", ch.get("format", "bytes"))
+    if fmt == "bytes":
+        if not isinstance(value, list):
+            raise ConfigError("%s: value_format 为 bytes 时 value 必须是数组" % where)
+        for v in value:
+            if not isinstance(v, int) or not 0 <= v <= 255:
+                raise ConfigError("%s: 字节值 %r 超出 0~255" % (where, v))
+        return bytes(value)
+    if fmt == "string":
+        if not isinstance(value, str):
+            raise ConfigError("%s: value_format 为 string 时 value 必须是字符串" % where)
+        return value.encode("utf-8")
+    if fmt == "json":
+        return json.dumps(value, separators=(",", ":"), ensure_ascii=False).encode("utf-8")
+    if fmt == "int":
+        if not isinstance(value, int) or not 0 <= value <= 255:
+            raise ConfigError("%s: int 初始值 %r 超出 0~255（按 1 字节写入）" % (where, value))
+        return bytes([value])
+    raise ConfigError("%s: 未知的 value_format %r" % (where, fmt))
+
+
+def notify_policy(ch, where):
+    policy = ch.get("notify", {})
+    if policy and "NOTIFY" not in ch["type"]:
+        raise ConfigError("%s: 只有 type 含 NOTIFY 的特征才能配置 notify" % where)
+    interval = policy.get("min_interval_ms", 0)
+    if not 0 <= interval <= 65535:
+        raise ConfigError("%s: min_interval_ms %r 超出 0~65535" % (where, interval))
+    mode = policy.get("mode", "event")
+    if policy.get("pack", False) and mode != "event":
+        raise ConfigError("%s: pack 只适用于 event 模式（state 模式只保留最新值）" % where)
+    return {"mode": NOTIFY_MODES[mode], "pack": bool(policy.get("pack", False)), "min_interval_ms": interval}
+
+
+def load_config(config_path, schema_path):
+    with open(config_path, encoding="utf-8") as f:
+        config = json.load(f)
+    with open(schema_path, encoding="utf-8") as f:
+        schema = json.load(f)
+
+    errors = []
+    validate(config, schema, "ble_config", errors)
+    if errors:
+        raise ConfigError("ble_config.json 未通过 schema 校验:\n  " + "\n  ".join(errors))
+
+    seen = set()
+    services = []
+    for si, service in enumerate(config.get("services", [])):
+        where = "services[%d](%s)" % (si, service["name"])
+        if not UUID_RE.match(service["uuid"]):
+            raise ConfigError("%s: 服务 UUID 必须是 4 位或 36 位格式: %s" % (where, service["uuid"]))
+        characteristics = []
+        for ci, ch in enumerate(service["characteristics"]):
+            cwhere = "%s.characteristics[%d](%s)" % (where, ci, ch["name"])
+            uuid = ch["uuid"]
+            if not UUID_RE.match(uuid):
+                raise ConfigError("%s: 特征 UUID 必须是 4 位或 36 位格式: %s" % (cwhere, uuid))
+            if uuid.lower() in seen:
+                raise ConfigError("%s: 特征 UUID 重复: %s" % (cwhere, uuid))
+            seen.add(uuid.lower())
+            if not ch["type"]:
+                raise ConfigError("%s: type 不能为空" % cwhere)
+            characteristics.append({
+                "uuid": uuid,
+                "name": ch["name"],
+                "description": ch.get("description", ""),
+                "properties": [PROPERTY_FLAGS[t] for t in ch["type"]],
+                "value": encode_value(ch, cwhere),
+                "notify": notify_policy(ch, cwhere),
+            })
+        services.append({
+            "uuid": service["uuid"],
+            "name": service["name"],
+            "deferred": service.get("boot", "early") == "deferred",
+            "characteristics": characteristics,
+        })
+
+    return {
+        "device_name": config.get("ble_device_name", DEFAULT_DEVICE_NAME),
+        "services": services,
+    }
+
+
+# ---------- 代码生成 ----------
+
+def c_string(s):
+    out = []
+    for c in s:                                 # 中文等非 ASCII 字符保持 UTF-8 原样（与其他源文件一致）
+        if c in '"\\':
+            out.append("\\" + c)
+        elif ord(c) < 0x20:
+            out.append("\\%03o" % ord(c))          # 八进制转义，避免与后续十六进制字符粘连
+        else:
+            out.append(c)
+    return '"' + "".join(out) + '"'
+
+
+def render(table, source_name):
+    lines = [
+        "// ⚠️ 自动生成的文件，请勿手动修改",
+        "// 来源: %s（经 data/ble_config.schema.json 校验），生成脚本: scripts/gen-gatt-table.py" % source_name,
+        "#pragma once",
+        "#include \"GattTable.h\"",
+        "",
+    ]
+    service_lines = []
+    char_count = 0
+    for si, service in enumerate(table["services"]):
+        entries = []
+        for ci, ch in enumerate(service["characteristics"]):
+            value_ref = "nullptr"
+            if ch["value"]:
+                value_ref = "GATT_VALUE_%d_%d" % (si, ci)
+                lines.append("static constexpr uint8_t %s[] = {%s};" % (value_ref, ", ".join(str(b) for b in ch["value"])))
+            notify = ch["notify"]
+            entries.append("    {%s, %s, %s, %s, %s, %d, {%s, %s, %d}}," % (
+                c_string(ch["uuid"]), c_string(ch["name"]), c_string(ch["description"]),
+                " | ".join(ch["properties"]), value_ref, len(ch["value"]),
+                notify["mode"], "true" if notify["pack"] else "false", notify["min_interval_ms"]))
+        lines.append("static constexpr GattCharacteristicDef GATT_CHARACTERISTICS_%d[] = {" % si)
+        lines.extend(entries)
+        lines.append("};")
+        lines.append("")
+        service_lines.append("    {%s, %s, GATT_CHARACTERISTICS_%d, %d, %s}," % (
+            c_string(service["uuid"]), c_string(service["name"]), si, len(service["characteristics"]),
+            "true" if service["deferred"] else "false"))
+        char_count += len(service["characteristics"])
+
+    lines.append("static constexpr GattServiceDef GATT_SERVICES[] = {")
+    lines.extend(service_lines)
+    lines.append("};")
+    lines.append("")
+    lines.append("static constexpr GattTableDef GATT_TABLE = {%s, GATT_SERVICES, %d, %d};" % (
+        c_string(table["device_name"]), len(table["services"]), char_count))
+    lines.append("")
+    return "\n".join(lines)
+
+
+def generate(project_dir):
+    config_path = os.path.join(project_dir, "data", "ble_config.json")
+    schema_path = os.path.join(project_dir, "data", "ble_config.schema.json")
+    out_path = os.path.join(project_dir, "src", "drivers", "BLE", HEADER_NAME)
+
+    table = load_config(config_path, schema_path)
+    content = render(table, "data/ble_config.json")
+    old = None
+    if os.path.exists(out_path):
+        with open(out_path, encoding="utf-8") as f:
+            old = f.read()
+    if old != content:
+        with open(out_path, "w", encoding="utf-8", newline="\n") as f:
+            f.write(content)
+        print("🧩 已生成 GATT 表: %d 个服务，%d 个特征 → %s" % (
+            len(table["services"]), sum(len(s["characteristics"]) for s in table["services"]), out_path))
+
+
+def _run(project_dir):
+    try:
+        generate(project_dir)
+    except (ConfigError, ValueError, KeyError) as e:
+        print("❌ GATT 表生成失败: %s" % e)
+        sys.exit(1)
+
+
+try:
+    Import("env")                               # noqa: F821  由 PlatformIO 注入
+    _run(env.subst("$PROJECT_DIR"))             # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        _run(os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")))
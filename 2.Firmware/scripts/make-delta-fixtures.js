@@ -0,0 +1,58 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const zlib = require('zlib');
+const delta = require('./make-delta');
+const { execSync } = require('child_process');
+
+// 用两次相邻提交的真实固件生成差分基准镜像（test_ota 的 bench_ota_patch_firmware 使用）
+// 用法：node scripts/make-delta-fixtures.js [基准提交，默认 HEAD~1]
+// 基准提交在临时 git worktree 中构建，当前工作区构建出新固件，输出到 .pio/delta-fixtures/：
+//   base.bin / target.bin                 两次 esp32dev 构建的 firmware.bin
+//   base-to-target.patch(.deflate)       make-delta 生成的补丁（已做往返校验）
+// 固件体积较大且随每次提交变化，不提交到仓库；没有这个目录时测试退回到 test/native/test_ota/fixtures 的合成镜像
+
+const projectDir = path.join(__dirname, '..');
+const outDir = path.join(projectDir, '.pio/delta-fixtures');
+const baseRef = process.argv[2] || 'HEAD~1';
+
+function run(command, cwd) {
+    execSync(command, { cwd, stdio: 'inherit' });
+}
+
+function buildFirmware(dir) {
+    run('pio run -e esp32dev', dir);
+    return fs.readFileSync(path.join(dir, '.pio/build/esp32dev/firmware.bin'));
+}
+
+const gitRoot = execSync('git rev-parse --show-toplevel', { cwd: projectDir }).toString().trim();
+const prefix = execSync('git rev-parse --show-prefix', { cwd: projectDir }).toString().trim();
+const worktree = fs.mkdtempSync(path.join(os.tmpdir(), 'delta-base-'));
+
+let base;
+try {
+    console.log(`🔨 构建基准固件（${baseRef}）...`);
+    run(`git worktree add --detach "${worktree}" ${baseRef}`, gitRoot);
+    base = buildFirmware(path.join(worktree, prefix));
+} finally {
+    execSync(`git worktree remove --force "${worktree}"`, { cwd: gitRoot });
+}
+
+console.log('🔨 构建当前固件...');
+const target = buildFirmware(projectDir);
+
+fs.mkdirSync(outDir, { recursive: true });
+fs.writeFileSync(path.join(outDir, 'base.bin'), base);
+fs.writeFileSync(path.join(outDir, 'target.bin'), target);
+
+const patch = delta.serialize(delta.generate(base, target), base, target);
+const compressed = zlib.deflateRawSync(patch, { level: 9, windowBits: 12, memLevel: 9 });
+if (!delta.apply(base, zlib.inflateRawSync(compressed)).equals(target)) {
+    throw new Error('差分补丁往返校验失败');
+}
+fs.writeFileSync(path.join(outDir, 'base-to-target.patch'), patch);
+fs.writeFileSync(path.join(outDir, 'base-to-target.patch.deflate'), compressed);
+
+console.log(`✅ 差分基准镜像已生成: ${outDir}`);
+console.log(`📦 基准 ${base.length} 字节，新固件 ${target.length} 字节，压缩补丁 ${compressed.length} 字节` +
+            `（${(compressed.length / target.length * 100).toFixed(1)}%）`);
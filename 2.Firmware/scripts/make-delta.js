@@ -0,0 +1,267 @@
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
+
+// 差分 OTA 补丁生成器
+// 用法：node scripts/make-delta.js <旧固件.bin> <新固件.bin> [-o 输出前缀] [--verify]
+// 旧固件必须与设备当前运行的固件完全一致（设备会校验 CRC32，不一致直接拒绝）
+// 输出：
+//   <前缀>.patch          原始补丁（格式见 src/controllers/OTAController/OTAPatchApplier.h）
+//   <前缀>.patch.deflate  raw deflate 压缩补丁（窗口 4KB），APP 以 START [0x00, 0x01, 0x03] 发送
+//
+// 匹配策略（与 bsdiff 思路相同，简化为单遍贪心）：
+// - 对旧镜像每个偏移的 16 字节块建哈希表，新镜像逐字节查找精确匹配的种子
+// - 优先沿用上一段匹配的平移量，覆盖"代码整体平移、地址常量小幅变化"的常见情况
+// - 种子向前扩展时允许少量不同字节（按 2×相同 - 长度 计分），不同处用 DIFF 记录差值，
+//   差值绝大多数为 0，压缩后几乎不占体积；完全相同的长段直接用 COPY
+
+const MAGIC = 0x3150444F;       // "ODP1"
+const OP_COPY = 0x01;
+const OP_ADD = 0x02;
+const OP_DIFF = 0x03;
+
+const BLOCK = 16;               // 种子块长度
+const MIN_MATCH = 32;           // 短于此长度的匹配不如直接当作字面数据
+const MIN_COPY_RUN = 64;        // 匹配段内完全相同的连续字节达到此长度才单独拆成 COPY
+const SCORE_SLACK = 32;         // 向前扩展时允许分数从最高点回落的幅度
+const HASH_BITS = 22;
+
+const crcTable = (() => {
+    const table = new Uint32Array(256);
+    for (let n = 0; n < 256; n++) {
+        let c = n;
+        for (let k = 0; k < 8; k++) c = (c & 1) ? (0xEDB88320 ^ (c >>> 1)) : (c >>> 1);
+        table[n] = c >>> 0;
+    }
+    return table;
+})();
+
+function crc32(buf) {
+    let crc = 0xFFFFFFFF;
+    for (let i = 0; i < buf.length; i++) crc = crcTable[(crc ^ buf[i]) & 0xFF] ^ (crc >>> 8);
+    return (crc ^ 0xFFFFFFFF) >>> 0;
+}
+
+function blockHash(buf, pos) {
+    let h = 0x811C9DC5;
+    for (let i = 0; i < BLOCK; i++) h = Math.imul(h ^ buf[pos + i], 0x01000193);
+    return (h >>> (32 - HASH_BITS)) >>> 0;
+}
+
+function blocksEqual(a, ap, b, bp) {
+    for (let i = 0; i < BLOCK; i++) if (a[ap + i] !== b[bp + i]) return false;
+    return true;
+}
+
+function buildIndex(oldBuf) {
+    const table = new Int32Array(1 << HASH_BITS).fill(-1);
+    for (let i = 0; i + BLOCK <= oldBuf.length; i++) {
+        const h = blockHash(oldBuf, i);
+        if (table[h] < 0) table[h] = i;
+    }
+    return table;
+}
+
+// 从 (oldPos, newPos) 开始向前扩展，返回得分最高的长度
+function extendForward(oldBuf, oldPos, newBuf, newPos) {
+    let same = 0;
+    let bestScore = 0;
+    let bestLen = 0;
+    for (let k = 0; oldPos + k < oldBuf.length && newPos + k < newBuf.length; k++) {
+        if (oldBuf[oldPos + k] === newBuf[newPos + k]) same++;
+        const score = same * 2 - (k + 1);
+        if (score > bestScore) {
+            bestScore = score;
+            bestLen = k + 1;
+        } else if (bestScore - score > SCORE_SLACK) {
+            break;
+        }
+    }
+    return bestLen;
+}
+
+function generate(oldBuf, newBuf) {
+    const index = buildIndex(oldBuf);
+    const ops = [];
+    let litStart = 0;
+    let lastDelta = null;
+    let j = 0;
+
+    while (j + BLOCK <= newBuf.length) {
+        let oldPos = -1;
+        // 1. 沿用上一段的平移量
+        if (lastDelta !== null) {
+            const p = j + lastDelta;
+            if (p >= 0 && p + BLOCK <= oldBuf.length) {
+                let same = 0;
+                for (let i = 0; i < BLOCK; i++) if (oldBuf[p + i] === newBuf[j + i]) same++;
+                if (same >= BLOCK - 4) oldPos = p;
+            }
+        }
+        // 2. 哈希查找精确种子
+        if (oldPos < 0) {
+            const p = index[blockHash(newBuf, j)];
+            if (p >= 0 && blocksEqual(oldBuf, p, newBuf, j)) oldPos = p;
+        }
+
+        let len = oldPos >= 0 ? extendForward(oldBuf, oldPos, newBuf, j) : 0;
+        if (len < MIN_MATCH) {
+            j++;
+            continue;
+        }
+
+        // 向后吃掉字面数据末尾与旧镜像相同的字节
+        while (j > litStart && oldPos > 0 && oldBuf[oldPos - 1] === newBuf[j - 1]) {
+            j--;
+            oldPos--;
+            len++;
+        }
+
+        if (j > litStart) ops.push({ op: OP_ADD, data: newBuf.subarray(litStart, j) });
+        pushMatch(ops, oldBuf, oldPos, newBuf, j, len);
+        lastDelta = oldPos - j;
+        j += len;
+        litStart = j;
+    }
+    if (litStart < newBuf.length) ops.push({ op: OP_ADD, data: newBuf.subarray(litStart) });
+    return ops;
+}
+
+// 匹配段内：长的完全相同段用 COPY，其余用 DIFF
+function pushMatch(ops, oldBuf, oldPos, newBuf, newPos, len) {
+    let diffStart = 0;
+    let k = 0;
+    while (k < len) {
+        if (oldBuf[oldPos + k] !== newBuf[newPos + k]) {
+            k++;
+            continue;
+        }
+        let run = 0;
+        while (k + run < len && oldBuf[oldPos + k + run] === newBuf[newPos + k + run]) run++;
+        if (run >= MIN_COPY_RUN) {
+            if (k > diffStart) ops.push(diffOp(oldBuf, oldPos + diffStart, newBuf, newPos + diffStart, k - diffStart));
+            ops.push({ op: OP_COPY, offset: oldPos + k, len: run });
+            diffStart = k + run;
+        }
+        k += run;
+    }
+    if (len > diffStart) ops.push(diffOp(oldBuf, oldPos + diffStart, newBuf, newPos + diffStart, len - diffStart));
+}
+
+function diffOp(oldBuf, oldPos, newBuf, newPos, len) {
+    const data = Buffer.alloc(len);
+    for (let i = 0; i < len; i++) data[i] = (newBuf[newPos + i] - oldBuf[oldPos + i]) & 0xFF;
+    return { op: OP_DIFF, offset: oldPos, len, data };
+}
+
+function serialize(ops, oldBuf, newBuf) {
+    const parts = [];
+    const header = Buffer.alloc(16);
+    header.writeUInt32LE(MAGIC, 0);
+    header.writeUInt32LE(oldBuf.length, 4);
+    header.writeUInt32LE(crc32(oldBuf), 8);
+    header.writeUInt32LE(newBuf.length, 12);
+    parts.push(header);
+    for (const o of ops) {
+        if (o.op === OP_ADD) {
+            const h = Buffer.alloc(5);
+            h[0] = OP_ADD;
+            h.writeUInt32LE(o.data.length, 1);
+            parts.push(h, o.data);
+        } else {
+            const h = Buffer.alloc(9);
+            h[0] = o.op;
+            h.writeUInt32LE(o.offset, 1);
+            h.writeUInt32LE(o.len, 5);
+            parts.push(h);
+            if (o.op === OP_DIFF) parts.push(o.data);
+        }
+    }
+    return Buffer.concat(parts);
+}
+
+// 与设备端 OTAPatchApplier 语义一致的参考实现，用于往返校验
+function apply(oldBuf, patch) {
+    if (patch.readUInt32LE(0) !== MAGIC) throw new Error('补丁魔数错误');
+    const oldSize = patch.readUInt32LE(4);
+    if (oldSize !== oldBuf.length || patch.readUInt32LE(8) !== crc32(oldBuf)) throw new Error('基准固件不一致');
+    const out = Buffer.alloc(patch.readUInt32LE(12));
+    let pos = 16;
+    let produced = 0;
+    while (produced < out.length) {
+        const op = patch[pos++];
+        if (op === OP_ADD) {
+            const len = patch.readUInt32LE(pos);
+            pos += 4;
+            patch.copy(out, produced, pos, pos + len);
+            pos += len;
+            produced += len;
+        } else if (op === OP_COPY || op === OP_DIFF) {
+            const offset = patch.readUInt32LE(pos);
+            const len = patch.readUInt32LE(pos + 4);
+            pos += 8;
+            if (offset + len > oldSize) throw new Error('引用越界');
+            for (let i = 0; i < len; i++) {
+                out[produced + i] = op === OP_COPY ? oldBuf[offset + i] : (oldBuf[offset + i] + patch[pos + i]) & 0xFF;
+            }
+            if (op === OP_DIFF) pos += len;
+            produced += len;
+        } else {
+            throw new Error(`未知操作码 0x${op.toString(16)}`);
+        }
+    }
+    if (pos !== patch.length) throw new Error('补丁末尾有多余数据');
+    return out;
+}
+
+function main() {
+    const args = process.argv.slice(2);
+    const verify = args.includes('--verify');
+    const outIdx = args.indexOf('-o');
+    const files = args.filter((a, i) => !a.startsWith('--') && a !== '-o' && (outIdx < 0 || i !== outIdx + 1));
+    if (files.length !== 2) {
+        console.log('用法: node scripts/make-delta.js <旧固件.bin> <新固件.bin> [-o 输出前缀] [--verify]');
+        process.exit(1);
+    }
+    const [oldPath, newPath] = files;
+    const outPrefix = outIdx >= 0 ? args[outIdx + 1]
+        : path.join(path.dirname(newPath), `${path.basename(oldPath, '.bin')}-to-${path.basename(newPath, '.bin')}`);
+
+    const oldBuf = fs.readFileSync(oldPath);
+    const newBuf = fs.readFileSync(newPath);
+
+    console.log('🩹 生成差分补丁...');
+    let t0 = process.hrtime.bigint();
+    const ops = generate(oldBuf, newBuf);
+    const patch = serialize(ops, oldBuf, newBuf);
+    const compressed = zlib.deflateRawSync(patch, { level: 9, windowBits: 12, memLevel: 9 });
+    const genMs = Number(process.hrtime.bigint() - t0) / 1e6;
+
+    fs.writeFileSync(`${outPrefix}.patch`, patch);
+    fs.writeFileSync(`${outPrefix}.patch.deflate`, compressed);
+
+    const fullCompressed = zlib.deflateRawSync(newBuf, { level: 9, windowBits: 12, memLevel: 9 }).length;
+    const count = (op) => ops.filter((o) => o.op === op).length;
+    const pct = (n) => (n / newBuf.length * 100).toFixed(1);
+    console.log(`📦 新固件: ${newBuf.length} 字节（整包压缩后 ${fullCompressed} 字节，${pct(fullCompressed)}%）`);
+    console.log(`📦 补丁:   ${patch.length} 字节，压缩后 ${compressed.length} 字节（${pct(compressed.length)}%）`);
+    console.log(`📊 操作数: COPY ${count(OP_COPY)}，DIFF ${count(OP_DIFF)}，ADD ${count(OP_ADD)}；生成耗时 ${genMs.toFixed(0)} ms`);
+
+    if (verify) {
+        t0 = process.hrtime.bigint();
+        const rebuilt = apply(oldBuf, zlib.inflateRawSync(compressed));
+        const applyMs = Number(process.hrtime.bigint() - t0) / 1e6;
+        if (!rebuilt.equals(newBuf)) {
+            console.error('❌ 往返校验失败：应用补丁后与新固件不一致');
+            process.exit(1);
+        }
+        console.log(`✅ 往返校验通过（主机解压 + 应用耗时 ${applyMs.toFixed(0)} ms）`);
+    }
+    console.log(`📄 输出: ${outPrefix}.patch(.deflate)`);
+}
+
+if (require.main === module) {
+    main();
+}
+
+module.exports = { generate, serialize, apply, crc32 };
@@ -33,3 +33,15 @@ void runLoop() {
   loop_main();
 #endif
 }
+
+// 串口命令（main.cpp 未处理的命令转给当前入口模块）
+bool runCommand(const char* cmd) {
+#ifdef ENTRY_TEST_PWM
+  return command_PWMServo(cmd);
+#elif defined(ENTRY_APP_MAIN)
+  return command_main(cmd);
+#else
+  (void)cmd;
+  return false;
+#endif
+}
@@ -2,4 +2,5 @@
 #include "config.h"
 
 void runSetup();
-void runLoop();
\ No newline at end of file
+void runLoop();
+bool runCommand(const char* cmd);    // 串口命令交给当前入口模块处理，未处理返回 false
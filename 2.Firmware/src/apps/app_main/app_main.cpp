@@ -3,64 +3,107 @@
 
 #include "app_main.h"
 #include "serial_color_debug.h"
+#include "utils/FastLog.h"
+#include "utils/BootTimeline.h"
+#include "utils/Metrics.h"
+#include "utils/SerialConsole.h"
+#include <atomic>
+#include <stdlib.h>
 #include "drivers/BLE/BLEServerWrapper.h"
 #include "drivers/BLE/MessageDispatcher.h"
 #include "controllers/OTAController/OTAController.h"
-#include <unordered_map>
+#include "controllers/AnimationController/ClipPlayer.h"
+#include "controllers/MotorController/MotorController.h"
+#include "controllers/DiagnosticsController/DiagnosticsController.h"
+#include "controllers/PWMServoController/ServoCalibrator.h"
 
 BLEServerWrapper bleServer;
 MessageDispatcher dispatcher;
 TaskHandle_t bleTaskHandle = nullptr;
 OTAController otaController;  // 添加OTA控制器实例
+std::atomic<bool> appReady{false};      // 后台初始化任务全部完成（各模块已订阅特征）后置位
+PWMServoController headServo(18, 6);    // 头部舵机（与舵机测试相同：GPIO18，LEDC 通道 6）
+MotionController motion;                // 舵机轨迹插值（定时器）
+ClipPlayer clipPlayer(motion);          // 动作片段播放：APP 按编号触发表情动作
+MotorController motorController(motion);   // MotorWrite / MotorClock：APP 实时下发的批量多轴设定点与时钟同步
+DiagnosticsController diagnostics;      // Diagnostics：运行指标快照（串口 stats 命令打印同一组指标）
+ServoCalibrator headCalibrator(headServo);  // 串口 cal 命令：逐点标定头部舵机，结果写入 NVS
 
-std::unordered_map<std::string, MessageConsumer*> uuidHandlerMap = {      // 注册 UUID 与处理函数的映射
-    { "ef040001-1000-8000-0080-5f9b34fb0000", &otaController },    // OTAControl
-    { "ef040002-1000-8000-0080-5f9b34fb0000", &otaController },    // OTAData
-};
-
-// BLE 处理任务句柄
+// BLE 处理任务：由 dispatcher 入队时的任务通知唤醒，醒来后一次性处理完整批消息
 void bleWriteTask(void* pvParameters) {
+    BLEWriteMessage msg;                    // 复用同一个消息对象，负载句柄从队列槽位直接移交，不拷贝数据
+    dispatcher.setConsumerTask(xTaskGetCurrentTaskHandle());
     while (true) {
-        while (dispatcher.hasMessage()) {
-            BLEWriteMessage msg = dispatcher.pop();
+        while (dispatcher.tryPop(msg)) {
+            const char* uuid = dispatcher.characteristics().uuidOf(msg.handle);
             if (msg.data.size() == 0) {
-                DEBUG_ERRORF("❌ 处理 BLE 消息失败，数据为空，UUID: %s", msg.uuid.c_str());
+                FLOG_ERROR("❌ 处理 BLE 消息失败，数据为空，UUID: %s", uuid);
                 continue;
             }
 
-            // 打印接收到的消息详情
-            DEBUG_INFOF("📥 收到BLE消息 - UUID: %s, 数据长度: %d", msg.uuid.c_str(), msg.data.size());
-            String hex;
-            for (uint8_t b : msg.data) {
-                char buf[4];
-                sprintf(buf, "%02X ", b);
-                hex += buf;
-            }
-            DEBUG_INFOF("📥 消息数据(hex): %s", hex.c_str());
-
-            // 根据 UUID 进行消息分发处理
-            if (uuidHandlerMap.count(msg.uuid)) {
-                DEBUG_INFOF("✅ 开始处理 UUID: %s", msg.uuid.c_str());
-                uuidHandlerMap[msg.uuid]->handleMessage(msg);
-                DEBUG_INFOF("✅ 完成处理 UUID: %s", msg.uuid.c_str());
-            } else {
-                DEBUG_WARNF("⚠️ 未注册的UUID: %s", msg.uuid.c_str());
-            }
+            // 每条消息都会经过这里：只记一条 DEBUG 级别的二进制日志（发布构建中整体删除）
+            FLOG_DEBUG("📥 收到BLE消息 - UUID: %s, 数据长度: %u", uuid, (unsigned)msg.data.size());
 
-            vTaskDelay(pdMS_TO_TICKS(1));  // 非常重要！
+            // 根据特征句柄进行消息分发处理（路由表按句柄直接索引）
+            if (!dispatcher.dispatch(msg)) {
+                FLOG_WARN("⚠️ 未注册的UUID: %s", uuid);
+            }
+            dispatcher.markHandled(msg);
         }
-        vTaskDelay(pdMS_TO_TICKS(10));
+        dispatcher.waitForMessage();        // 队列已排空，阻塞等待下一次入队通知
     }
 }
 
-void printHex(const std::vector<uint8_t>& data) {
-    String hex;
-    for (uint8_t b : data) {
-        char buf[4];
-        sprintf(buf, "%02X ", b);
-        hex += buf;
+// 定期打印入队→处理延迟分布，用于在设备上确认唤醒延迟；force 时立即打印（串口 trace 命令）
+void printDispatchLatency(bool force = false) {
+    static uint32_t lastPrintMs = 0;
+    static uint32_t lastCount = 0;
+    LatencyHistogram& h = dispatcher.latency();
+    uint32_t now = millis();
+    if (!force) {
+        if (now - lastPrintMs < 10000 || h.count() == lastCount) return;
+        lastPrintMs = now;
+        lastCount = h.count();
+    }
+    DEBUG_INFOF("⏱️ BLE 入队→处理延迟: 样本=%u 平均=%uus p50=%uus p99=%uus 最大=%uus 丢弃=%u 拒绝=%u",
+                h.count(), h.mean(), h.percentile(50), h.percentile(99), h.max(),
+                dispatcher.droppedCount(), dispatcher.rejectedCount());
+}
+
+// 每 10 秒打印一次流式运动的缓冲与时钟同步状态（有新帧时才打印）
+void printMotorStats(bool force = false) {
+    static uint32_t lastPrintMs = 0;
+    static uint32_t lastFrames = 0;
+    uint32_t now = millis();
+    if (!force) {
+        if (now - lastPrintMs < 10000 || motorController.frameCount() == lastFrames) return;
+        lastPrintMs = now;
+        lastFrames = motorController.frameCount();
+    }
+    MotorStreamStats s = motorController.streamStats();
+    DEBUG_INFOF("🦾 电机流: 帧=%u 丢帧=%u 缓冲=%u 个/%ums 播放延迟=%ums 抖动=%uus 迟到=%u 帧/%u 样本",
+                motorController.frameCount(), motorController.lostFrames(), s.bufferedSetpoints, s.bufferedMs,
+                s.playoutDelayMs, s.jitterUs, s.lateFrames, s.lateSamples);
+    DEBUG_INFOF("🕒 时钟同步: 往返=%u 次 偏移=%lldus rtt=%uus 漂移=%.1fppm",
+                s.syncExchanges, (long long)s.offsetUs, s.rttUs, s.driftPpm);
+}
+
+// 链路参数有变化（档位请求、协商结果、连接/断开）时打印一次，OTA 期间也打印，便于把吞吐与链路参数对应起来
+void printLinkStats(bool force = false) {
+    static uint32_t lastChanges = 0;
+    LinkStatus s = bleServer.linkStatus();
+    if (!force) {
+        if (s.changes == lastChanges) return;
+        lastChanges = s.changes;
+    }
+    if (!s.connected) {
+        DEBUG_INFOF("🔗 链路: 未连接（累计请求=%u 拒绝=%u）", s.requests, s.rejected);
+        return;
     }
-    DEBUG_INFOF("✅ 📤 发送状态数据 (hex): %s", hex.c_str());
+    DEBUG_INFOF("🔗 链路: 档位=%s 间隔=%u.%02ums 从机延迟=%u 超时=%ums MTU=%u 数据长度=%u/%u PHY=%u/%u%s 请求=%u 拒绝=%u",
+                LinkPolicy::workloadName(s.workload), s.interval * 125u / 100u, s.interval * 125u % 100u, s.latency,
+                s.timeout * 10u, s.mtu, s.txOctets, s.rxOctets, s.txPhy, s.rxPhy, s.phySupported ? "" : "（不支持2M）",
+                s.requests, s.rejected);
 }
 
 // 触摸状态变化回调函数
@@ -83,29 +126,119 @@ void onTouchStateChanged(bool isTouched) {
     }
 }
 
-void setup_main() {
-    Serial.begin(115200);
+// 串口命令：在命令台任务中执行，只调用线程安全的接口，不阻塞 loop_main()
+void registerAppCommands() {
+    // jog <度> 或 jog <轴> <度>：在当前位置上相对转动（按轴的速度 / 加速度上限）
+    SerialConsole::add("jog", "舵机相对转动：jog [轴] <度>", [](const char* args, void*) {
+        char* end;
+        float first = strtof(args, &end);
+        if (end == args) {
+            DEBUG_WARN("⚠️ 用法: jog [轴] <度>");
+            return;
+        }
+        const char* rest = end;
+        float second = strtof(rest, &end);
+        uint8_t axis = end == rest ? 0 : (uint8_t)first;
+        float delta = end == rest ? first : second;
+        if (axis >= motion.axisCount()) {
+            DEBUG_WARNF("⚠️ 轴 %u 不存在（已初始化 %u 个轴）", axis, motion.axisCount());
+            return;
+        }
+        float target = motion.position(axis) + delta;
+        motion.moveTo(axis, target);
+        DEBUG_INFOF("🎯 轴 %u → %.1f°", axis, target);
+    });
+    // trace：不等 10 秒周期，立即打印延迟分布、电机流与链路状态
+    SerialConsole::add("trace", "立即打印消息延迟、电机流与链路状态", [](const char*, void*) {
+        printDispatchLatency(true);
+        printMotorStats(true);
+        printLinkStats(true);
+    });
+    // cal [角度...]：标定头部舵机，之后的 +N / -N / =N / ok / abort 由 command_main 转给标定流程
+    // 标定期间由标定流程直接输出脉宽，APP 下发的动作会覆盖它，因此只在未连接时允许
+    SerialConsole::add("cal", "标定头部舵机：cal [角度...]，随后 +N/-N 微调、ok 确认、abort 放弃", [](const char* args, void*) {
+        if (!appReady.load()) {
+            DEBUG_WARN("⚠️ 舵机尚未初始化完成，稍后再试");
+            return;
+        }
+        if (bleServer.isConnected()) {
+            DEBUG_WARN("⚠️ APP 已连接，标定期间的动作会被覆盖，请先断开再标定");
+            return;
+        }
+        motion.stop(0);                     // 轴 0 即头部舵机，停止插值输出
+        char line[CONSOLE_LINE_MAX];
+        snprintf(line, sizeof(line), "cal %s", args);
+        headCalibrator.handleCommand(line);
+    });
+    // cal-reload：只重新加载头部舵机的标定表；GATT / 设备配置在启动时建好服务后不能在运行中替换，改配置需要重启
+    SerialConsole::add("cal-reload", "从 NVS 重新加载头部舵机标定表（不含 GATT 配置）", [](const char*, void*) {
+        if (headServo.loadCalibration()) {
+            DEBUG_INFO("✅ 已重新加载舵机标定表");
+        } else {
+            DEBUG_WARN("⚠️ NVS 中没有舵机标定表，保持当前表");
+        }
+    });
+}
 
-    DEBUG_INFO("启动完成");
-    DEBUG_INFOF("当前开发板: %s", BOARD_NAME);
+// 命令表中没有的命令（标定过程中的 +N / -N / =N / ok / abort / show / clear）交给舵机标定流程
+bool command_main(const char* cmd) {
+    return appReady.load() && headCalibrator.handleCommand(cmd);
+}
 
+// 后台初始化任务：开始广播之后再做非关键的初始化，完成后自行删除
+// 延后的 GATT 服务最先创建，APP 连上后马上能发现全部服务；耗时的模块初始化（OTA 分区探测与 NVS 断点、
+// 挂载 SPIFFS、指标采样）放在后面，各模块全部就绪后才订阅对应特征，在此之前的写入在 BLE 回调中直接拒绝
+void deferredInitTask(void* pvParameters) {
+    bleServer.beginDeferred();
 
-    // 初始化 BLE 和运动控制器
-    bleServer.begin(&dispatcher);
-    
-    // 初始化OTA控制器
+    uint8_t stage = BootTimeline::begin("ota_init");
     DEBUG_INFO("正在初始化 OTA 控制器...");
-    otaController.begin();
-    if (!otaController.initOTA()) {
+    otaController.setTransport(&bleServer);
+    otaController.begin();                  // begin() 内部完成分区探测（initOTA），不再重复调用
+    if (otaController.getStatus() == OTAStatus::FAILED) {
         DEBUG_ERROR("❌ OTA控制器初始化失败");
         // 继续运行，但 OTA 功能将不可用
     }
-    otaController.setBLEServer(&bleServer);
     bleServer.setOTAController(&otaController);
-    
+    otaController.registerMetrics();
+    BootTimeline::end(stage);
 
+    stage = BootTimeline::begin("motion_init");
+    headServo.setLimits(500, 2500, 0, 180);
+    headServo.begin();                      // 有标定表时自动从 NVS 加载
+    motion.addAxis(&headServo, 360, 2400);  // 轴 0：表情动作比较快，上限放宽到 360°/s、2400°/s²
+    motion.begin();
+    clipPlayer.setTransport(&bleServer);
+    clipPlayer.begin();                     // 挂载 SPIFFS，动作片段在 /clips/<id>.clip
+    motorController.begin();
+    BootTimeline::end(stage);
+
+    Metrics::begin();                       // 所有模块都已登记指标，启动采样（堆、任务栈水位、速率）
+    diagnostics.setTransport(&bleServer);
+    diagnostics.begin();
+
+    // 注册特征订阅（按 ble_config.json 中的特征名），订阅之后 APP 的写入才会送到对应模块
+    dispatcher.subscribe("OTAControl", &otaController);
+    dispatcher.subscribe("OTAData", &otaController);
+    dispatcher.subscribe("ClipControl", &clipPlayer);
+    dispatcher.subscribe("Diagnostics", &diagnostics);
+    appReady.store(true);
+    BootTimeline::mark("boot_complete");
+    DEBUG_INFO("系统初始化完成");
+    BootTimeline::print();
+    vTaskDelete(nullptr);
+}
+
+// 快速启动：广播之前只做连接必需的初始化（BLE 协议栈、启动必需的 GATT 服务、消息处理任务），
+// 其余初始化放到后台任务中；各阶段耗时记录在 BootTimeline 中，串口输入 boot 可随时查看
+void setup_main() {
+    BootTimeline::mark("setup");
+    FastLog::begin();                       // 热路径日志的后台输出任务（FLOG_* 宏）
+
+    DEBUG_INFO("启动完成");
+    DEBUG_INFOF("当前开发板: %s", BOARD_NAME);
 
-    // 创建 BLE 写入处理任务
+    // 先创建 BLE 写入处理任务，连接后的第一条写入就能被处理
     xTaskCreatePinnedToCore(
         bleWriteTask,
         "BLEWriteTask",
@@ -116,20 +249,43 @@ void setup_main() {
         1
     );
 
-
-
+    // 断线时升级中的 OTA 会话挂起等待续传（见 OTAController README「断线续传」），不再直接丢弃进度
     bleServer.setDisconnectCallback([]() {
-        otaController.reset();
+        if (appReady.load()) {
+            otaController.onDisconnect();
+        }
     });
 
-    DEBUG_INFO("系统初始化完成");
+    // 初始化 BLE 并开始广播（延后的服务此时还未创建，但所有特征的句柄已登记）
+    bleServer.begin(&dispatcher);
+
+    // 电机特征在这里订阅（未订阅的特征写入会在 BLE 回调中直接拒绝）；OTA、动作片段与诊断在后台初始化完成后订阅
+    dispatcher.subscribe("MotorWrite", &motorController);
+    dispatcher.subscribe("MotorClock", &motorController);
+    motorController.setTransport(&bleServer);   // 句柄在 begin 时已登记；运动轴在后台初始化中添加，之前收到的帧不执行
+
+    // 运行指标：各模块持有自己的计数器 / 直方图，这里只登记（见 utils/Metrics.h）
+    dispatcher.registerMetrics();
+    bleServer.registerMetrics();
+    FastLog::registerMetrics();
+    Metrics::watchTask("stack.ble_write", bleTaskHandle);
+    Metrics::watchTask("stack.loop", xTaskGetCurrentTaskHandle());     // setup/loop 运行在 Arduino 的 loopTask 中
+    registerAppCommands();
+
+    xTaskCreatePinnedToCore(deferredInitTask, "DeferredInit", 6144, nullptr, 1, nullptr, 1);
 }
 
 void loop_main() {
+    if (!appReady.load()) {                 // 后台初始化完成之前只让出 CPU
+        vTaskDelay(pdMS_TO_TICKS(10));
+        return;
+    }
+
     // OTA期间暂停高频任务
     if (otaController.getStatus() == OTAStatus::UPDATING) {
         // 只处理OTA相关逻辑，跳过其它高频任务
         otaController.update();
+        printLinkStats();
         vTaskDelay(pdMS_TO_TICKS(10));
         return;
     }
@@ -147,6 +303,9 @@ void loop_main() {
 
     // 更新OTA控制器状态
     otaController.update();
+    printDispatchLatency();
+    printMotorStats();
+    printLinkStats();
 
     vTaskDelay(pdMS_TO_TICKS(10));  // 10ms 延时
 }
@@ -2,4 +2,5 @@
 
 void setup_main();
 void loop_main();
+bool command_main(const char* cmd);           // 串口命令台 fallback：舵机标定流程的交互命令
 
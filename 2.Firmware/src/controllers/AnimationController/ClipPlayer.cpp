@@ -0,0 +1,293 @@
+#include "ClipPlayer.h"
+#include <SPIFFS.h>
+#include <stdio.h>
+#include "serial_color_debug.h"
+#include "utils/FastLog.h"
+#include "drivers/Transport/MessageTransport.h"
+
+static const char* CLIP_CONTROL_UUID = "ef050001-1000-8000-0080-5f9b34fb0000";
+static const char* CLIP_STATUS_UUID = "ef050002-1000-8000-0080-5f9b34fb0000";
+
+static ProfileShape shapeOf(uint8_t easing) {
+    switch (easing) {
+        case CLIP_EASE_LINEAR: return ProfileShape::LINEAR;
+        case CLIP_EASE_TRAPEZOID: return ProfileShape::TRAPEZOID;
+        default: return ProfileShape::S_CURVE;
+    }
+}
+
+ClipPlayer::ClipPlayer(MotionController& motion) : _motion(motion) {}
+
+void ClipPlayer::begin() {
+    if (_task) return;
+    if (!SPIFFS.begin(true)) {
+        DEBUG_ERROR("❌ SPIFFS 挂载失败，动作片段不可用");
+        return;
+    }
+    _commands = xQueueCreate(CLIP_QUEUE_DEPTH * 2, sizeof(Command));
+    if (!_commands ||
+        xTaskCreatePinnedToCore(taskEntry, "ClipPlayer", 4096, this, CLIP_TASK_PRIORITY, &_task, CLIP_TASK_CORE) != pdPASS) {
+        DEBUG_ERROR("❌ 创建动作片段播放任务失败");
+        _task = nullptr;
+        return;
+    }
+    DEBUG_INFO("✅ 动作片段播放器启动");
+}
+
+void ClipPlayer::setTransport(MessageTransport* transport) {
+    _transport = transport;
+    _controlHandle = transport->handleOf(CLIP_CONTROL_UUID);
+    _statusHandle = transport->handleOf(CLIP_STATUS_UUID);
+}
+
+// BLE 写入（在 bleWriteTask 中调用）：只解析命令并转交给播放任务，不碰文件和播放状态
+void ClipPlayer::handleMessage(const BLEWriteMessage& msg) {
+    if (msg.handle != _controlHandle) {
+        FLOG_WARN("⚠️ 未知的动作片段特征句柄: %d", msg.handle);
+        return;
+    }
+    const uint8_t* data = msg.data.data();
+    size_t len = msg.data.size();
+    if (len == 0) {                                 // 空写入：负载块是复用的，data[0] 是上一条消息残留的字节
+        FLOG_WARN("⚠️ 空的动作片段命令已忽略");
+        return;
+    }
+    switch (data[0]) {
+        case OP_PLAY: {
+            if (len < 3) {
+                FLOG_WARN("⚠️ 播放命令长度不足: %u", (unsigned)len);
+                return;
+            }
+            uint16_t clipId = data[1] | (data[2] << 8);
+            uint8_t mode = len > 3 ? data[3] : (uint8_t)ClipPlayMode::REPLACE;
+            uint16_t blendMs = len > 5 ? (uint16_t)(data[4] | (data[5] << 8)) : CLIP_DEFAULT_BLEND_MS;
+            if (mode > (uint8_t)ClipPlayMode::LAYER) {
+                FLOG_WARN("⚠️ 未知的播放方式: %u", mode);
+                return;
+            }
+            play(clipId, (ClipPlayMode)mode, blendMs);
+            break;
+        }
+        case OP_STOP:
+            stop();
+            break;
+        case OP_CLEAR:
+            clearQueue();
+            break;
+        default:
+            FLOG_WARN("⚠️ 未知的动作片段命令: 0x%02X", data[0]);
+            break;
+    }
+}
+
+bool ClipPlayer::play(uint16_t clipId, ClipPlayMode mode, uint16_t blendMs) {
+    Command cmd = {OP_PLAY, (uint8_t)mode, clipId, blendMs};
+    return send(cmd);
+}
+
+void ClipPlayer::stop() {
+    Command cmd = {OP_STOP, 0, 0, 0};
+    send(cmd);
+}
+
+void ClipPlayer::clearQueue() {
+    Command cmd = {OP_CLEAR, 0, 0, 0};
+    send(cmd);
+}
+
+bool ClipPlayer::send(const Command& cmd) {
+    if (!_commands) {
+        FLOG_WARN("⚠️ 动作片段播放器未启动，命令 %u 已忽略", cmd.op);
+        return false;
+    }
+    if (xQueueSend(_commands, &cmd, 0) != pdTRUE) {
+        FLOG_WARN("⚠️ 动作片段命令队列已满，命令 %u 已丢弃", cmd.op);
+        return false;
+    }
+    return true;
+}
+
+void ClipPlayer::taskEntry(void* arg) {
+    static_cast<ClipPlayer*>(arg)->run();
+}
+
+// 播放任务：下发所有到期的关键帧，然后阻塞在命令队列上，超时时间取最近一条关键帧的到期时刻
+void ClipPlayer::run() {
+    Command cmd;
+    for (;;) {
+        uint32_t now = millis();
+        uint32_t waitMs = NO_DEADLINE;
+        for (uint8_t i = 0; i < 2; ++i) {
+            uint32_t wait = service(i, now);
+            if (wait < waitMs) waitMs = wait;
+        }
+        TickType_t ticks = waitMs == NO_DEADLINE ? portMAX_DELAY : pdMS_TO_TICKS(waitMs);
+        if (xQueueReceive(_commands, &cmd, ticks) == pdTRUE) {
+            handle(cmd, millis());
+        }
+    }
+}
+
+void ClipPlayer::handle(const Command& cmd, uint32_t now) {
+    switch (cmd.op) {
+        case OP_PLAY:
+            if (cmd.mode == (uint8_t)ClipPlayMode::LAYER) {
+                start(OVERLAY, cmd.clipId, cmd.blendMs, now);
+            } else if (cmd.mode == (uint8_t)ClipPlayMode::QUEUE && _layers[BASE].active) {
+                if (_pendingCount >= CLIP_QUEUE_DEPTH) {
+                    DEBUG_WARNF("⚠️ 动作片段队列已满，片段 %u 未排上", cmd.clipId);
+                    notifyStatus(CLIP_DROPPED, BASE, cmd.clipId);
+                    return;
+                }
+                _pending[(_pendingHead + _pendingCount) % CLIP_QUEUE_DEPTH] = cmd;
+                _pendingCount++;
+            } else {
+                if (cmd.mode == (uint8_t)ClipPlayMode::REPLACE) {
+                    _pendingCount = 0;
+                    finish(OVERLAY, CLIP_STOPPED);
+                }
+                start(BASE, cmd.clipId, cmd.blendMs, now);
+            }
+            break;
+        case OP_STOP:
+            _pendingCount = 0;
+            for (uint8_t i = 0; i < 2; ++i) {
+                if (!_layers[i].active) continue;
+                uint8_t mask = _layers[i].reader.header().axisMask;
+                for (uint8_t axis = 0; axis < _motion.axisCount(); ++axis) {
+                    if (mask & (1u << axis)) _motion.stop(axis);
+                }
+                finish(i, CLIP_STOPPED);
+            }
+            break;
+        case OP_CLEAR:
+            _pendingCount = 0;
+            break;
+    }
+}
+
+bool ClipPlayer::start(uint8_t index, uint16_t clipId, uint16_t blendMs, uint32_t now) {
+    Layer& layer = _layers[index];
+    finish(index, CLIP_STOPPED);
+
+    char path[24];
+    snprintf(path, sizeof(path), "/clips/%u.clip", clipId);
+    layer.source.file = SPIFFS.open(path, "r");
+    if (!layer.source.file) {
+        DEBUG_WARNF("⚠️ 动作片段不存在: %s", path);
+        notifyStatus(CLIP_FAILED, index, clipId);
+        return false;
+    }
+    if (!layer.reader.open(&layer.source)) {
+        DEBUG_ERRORF("❌ 动作片段格式错误: %s（%s）", path, layer.reader.error());
+        layer.source.file.close();
+        notifyStatus(CLIP_FAILED, index, clipId);
+        return false;
+    }
+
+    // 过渡到起始姿态：底层片段不动叠加层正在接管的轴
+    const MotionClipHeader& header = layer.reader.header();
+    uint8_t blocked = (index == BASE && _layers[OVERLAY].active) ? _layers[OVERLAY].reader.header().axisMask : 0;
+    for (uint8_t axis = 0; axis < _motion.axisCount(); ++axis) {
+        if (!(header.axisMask & (1u << axis)) || (blocked & (1u << axis))) continue;
+        float pose = header.startPose[axis] / 100.0f;
+        if (blendMs > 0) {
+            _motion.moveToIn(axis, pose, blendMs, ProfileShape::S_CURVE);
+        } else {
+            _motion.moveTo(axis, pose);
+        }
+    }
+
+    layer.clipId = clipId;
+    layer.startMs = now + blendMs;
+    layer.active = true;
+    advance(layer);
+    if (index == BASE) {
+        _currentClip.store(clipId, std::memory_order_relaxed);
+        _playing.store(true, std::memory_order_relaxed);
+    }
+    DEBUG_INFOF("🎬 播放动作片段 %u（%s，%u 条关键帧，%u ms）", clipId, index == BASE ? "底层" : "叠加",
+                header.keyframeCount, (unsigned)header.durationMs);
+    notifyStatus(CLIP_STARTED, index, clipId);
+    return true;
+}
+
+void ClipPlayer::finish(uint8_t index, ClipEvent event) {
+    Layer& layer = _layers[index];
+    if (!layer.active) return;
+    layer.active = false;
+    layer.hasNext = false;
+    layer.reader.close();
+    layer.source.file.close();
+    if (index == BASE) _playing.store(false, std::memory_order_relaxed);
+    notifyStatus(event, index, layer.clipId);
+}
+
+bool ClipPlayer::advance(Layer& layer) {
+    layer.hasNext = layer.reader.next(layer.next, layer.nextStartMs);
+    return layer.hasNext;
+}
+
+uint32_t ClipPlayer::service(uint8_t index, uint32_t now) {
+    Layer& layer = _layers[index];
+    if (!layer.active) return NO_DEADLINE;
+
+    while (layer.hasNext) {
+        uint32_t due = layer.startMs + layer.nextStartMs;
+        if ((int32_t)(now - due) < 0) return due - now;
+        apply(index, layer.next, now - due);
+        advance(layer);
+    }
+    if (layer.reader.error()) {
+        DEBUG_ERRORF("❌ 读取动作片段 %u 失败（%s）", layer.clipId, layer.reader.error());
+        finish(index, CLIP_FAILED);
+        if (index == BASE) startQueued(now);
+        return 0;
+    }
+
+    // 关键帧已全部下发，等最后一段补间结束
+    uint32_t end = layer.startMs + layer.reader.header().durationMs;
+    if ((int32_t)(now - end) < 0) return end - now;
+
+    // 循环片段在有排队片段时播完本轮就结束
+    if (layer.reader.loops() && !(index == BASE && _pendingCount > 0) && layer.reader.rewind()) {
+        layer.startMs = end;
+        advance(layer);
+        return 0;
+    }
+    finish(index, CLIP_FINISHED);
+    if (index == BASE) startQueued(now);
+    return 0;
+}
+
+// 下发一段补间；任务被延迟时从补间时长中扣掉迟到的时间，保持片段整体节奏
+void ClipPlayer::apply(uint8_t index, const MotionKeyframe& keyframe, uint32_t lateMs) {
+    if (keyframe.axis >= _motion.axisCount()) return;
+    if (index == BASE && _layers[OVERLAY].active &&
+        (_layers[OVERLAY].reader.header().axisMask & (1u << keyframe.axis))) {
+        return;                                     // 该轴正被叠加层接管
+    }
+    float target = keyframe.centiDegrees / 100.0f;
+    if (keyframe.durationMs == 0 || lateMs >= keyframe.durationMs) {
+        _motion.moveTo(keyframe.axis, target);
+    } else {
+        _motion.moveToIn(keyframe.axis, target, keyframe.durationMs - lateMs, shapeOf(keyframe.easing));
+    }
+    FLOG_DEBUG("🎞️ 轴 %u → %d (%u ms，迟到 %u ms)", keyframe.axis, keyframe.centiDegrees, keyframe.durationMs,
+               (unsigned)lateMs);
+}
+
+void ClipPlayer::startQueued(uint32_t now) {
+    while (_pendingCount > 0) {
+        Command cmd = _pending[_pendingHead];
+        _pendingHead = (_pendingHead + 1) % CLIP_QUEUE_DEPTH;
+        _pendingCount--;
+        if (start(BASE, cmd.clipId, cmd.blendMs, now)) return;
+    }
+}
+
+void ClipPlayer::notifyStatus(ClipEvent event, uint8_t index, uint16_t clipId) {
+    if (!_transport || _statusHandle == INVALID_CHAR_HANDLE) return;
+    uint8_t frame[4] = {event, index, (uint8_t)(clipId & 0xFF), (uint8_t)(clipId >> 8)};
+    _transport->notify(_statusHandle, frame, sizeof(frame));
+}
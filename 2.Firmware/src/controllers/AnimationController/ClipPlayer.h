@@ -0,0 +1,132 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "MessageConsumer.h"
+#include "MotionClip.h"
+#include "MotionController.h"
+
+class MessageTransport;
+
+#ifndef CLIP_QUEUE_DEPTH
+#define CLIP_QUEUE_DEPTH 4                          // 排队等待播放的片段数
+#endif
+
+#ifndef CLIP_TASK_PRIORITY
+#define CLIP_TASK_PRIORITY 2                        // 高于 bleWriteTask，关键帧按时下发
+#endif
+
+#ifndef CLIP_TASK_CORE
+#define CLIP_TASK_CORE 1                            // 读 Flash 的任务不放在 BLE 协议栈所在的 core 0
+#endif
+
+#ifndef CLIP_DEFAULT_BLEND_MS
+#define CLIP_DEFAULT_BLEND_MS 200                   // 未指定时，片段开始前过渡到起始姿态的时间
+#endif
+
+// 播放方式
+enum class ClipPlayMode : uint8_t {
+    REPLACE = 0,                                    // 打断正在播放的片段（含叠加层），清空队列后立即播放
+    QUEUE = 1,                                      // 排在当前片段之后播放（空闲时立即播放）
+    LAYER = 2,                                      // 叠加播放：只接管片段用到的轴，其它轴继续播放底层片段
+};
+
+// 动作片段播放器：APP 只需写入几个字节的片段编号，表情对应的肢体动作由设备端从 SPIFFS 读取并播放，
+// 不再需要通过 BLE 逐步下发舵机角度
+//
+//   BLE ClipControl ──▶ bleWriteTask ──handleMessage──▶ _commands ──▶ 播放任务 ──读取关键帧──▶ MotionController
+//                                                                       ▲ SPIFFS /clips/<id>.clip     （定时器插值）
+//
+// - 播放任务按关键帧的起始时刻把补间下发给 MotionController，插值由其定时器完成；Flash 读取只发生在播放任务中
+// - 过渡（blend）：每个片段开始前，各轴用 blendMs 以 S 曲线从当前位置移动到片段的起始姿态；
+//   补间总是从当前插值位置出发，所以打断、排队、叠加切换时位置都是连续的
+// - 叠加层结束后，被接管的轴停在最后的姿态，直到底层片段的下一条关键帧
+// - 所有播放状态只在播放任务中修改，play / stop 可以在任意任务中调用
+//
+// ClipControl 写入格式（小端）：
+//   01 id_lo id_hi [mode] [blend_lo blend_hi]   播放片段（mode 缺省为 REPLACE，blend 缺省为 CLIP_DEFAULT_BLEND_MS）
+//   02                                          停止全部片段并清空队列，各轴停在当前位置
+//   03                                          清空队列（正在播放的片段不受影响）
+// ClipStatus 通知（event 模式）：[事件][层 0 底层 / 1 叠加][id_lo][id_hi]，事件见 ClipEvent
+class ClipPlayer : public MessageConsumer {
+public:
+    enum ClipEvent : uint8_t {
+        CLIP_STARTED = 1,
+        CLIP_FINISHED = 2,
+        CLIP_STOPPED = 3,                           // 被打断或停止
+        CLIP_FAILED = 4,                            // 文件不存在或格式错误
+        CLIP_DROPPED = 5,                           // 队列已满，没有排上
+    };
+
+    explicit ClipPlayer(MotionController& motion);
+
+    void begin() override;                          // 挂载 SPIFFS，创建命令队列与播放任务（MotionController 需已启动）
+    void handleMessage(const BLEWriteMessage& msg) override;
+    void setTransport(MessageTransport* transport);    // 解析 ClipControl / ClipStatus 句柄
+
+    bool play(uint16_t clipId, ClipPlayMode mode = ClipPlayMode::REPLACE, uint16_t blendMs = CLIP_DEFAULT_BLEND_MS);
+    void stop();
+    void clearQueue();
+
+    bool isPlaying() const { return _playing.load(std::memory_order_relaxed); }
+    uint16_t currentClip() const { return _currentClip.load(std::memory_order_relaxed); }
+
+private:
+    enum Op : uint8_t { OP_PLAY = 1, OP_STOP = 2, OP_CLEAR = 3 };
+
+    struct Command {
+        uint8_t op;
+        uint8_t mode;
+        uint16_t clipId;
+        uint16_t blendMs;
+    };
+
+    // SPIFFS 文件作为片段的字节来源（File 内部有缓冲）
+    class FileSource : public ClipSource {
+    public:
+        File file;
+        size_t read(uint8_t* dst, size_t len) override { return file.read(dst, len); }
+        bool seek(uint32_t offset) override { return file.seek(offset); }
+    };
+    // 一个播放层：打开的文件 + 流式读取器 + 下一条待下发的关键帧
+    struct Layer {
+        FileSource source;
+        MotionClipReader reader;
+        uint16_t clipId = 0;
+        uint32_t startMs = 0;                       // 片段时间轴零点（过渡结束的时刻，millis）
+        MotionKeyframe next = {};
+        uint32_t nextStartMs = 0;
+        bool hasNext = false;
+        bool active = false;
+    };
+    static const uint8_t BASE = 0;
+    static const uint8_t OVERLAY = 1;
+    static const uint32_t NO_DEADLINE = 0xFFFFFFFF;
+
+    static void taskEntry(void* arg);
+    void run();
+    void handle(const Command& cmd, uint32_t now);
+    bool send(const Command& cmd);
+    bool start(uint8_t layer, uint16_t clipId, uint16_t blendMs, uint32_t now);
+    void finish(uint8_t layer, ClipEvent event);
+    uint32_t service(uint8_t layer, uint32_t now);  // 下发到期的关键帧，返回距下一个到期时刻的毫秒数
+    void apply(uint8_t layer, const MotionKeyframe& keyframe, uint32_t lateMs);
+    bool advance(Layer& layer);
+    void startQueued(uint32_t now);
+    void notifyStatus(ClipEvent event, uint8_t layer, uint16_t clipId);
+
+    MotionController& _motion;
+    Layer _layers[2];
+    Command _pending[CLIP_QUEUE_DEPTH];             // 排队的片段（只在播放任务中访问）
+    uint8_t _pendingHead = 0;
+    uint8_t _pendingCount = 0;
+    QueueHandle_t _commands = nullptr;
+    TaskHandle_t _task = nullptr;
+    std::atomic<bool> _playing{false};
+    std::atomic<uint16_t> _currentClip{0};
+    MessageTransport* _transport = nullptr;
+    CharHandle _controlHandle = INVALID_CHAR_HANDLE;
+    CharHandle _statusHandle = INVALID_CHAR_HANDLE;
+};
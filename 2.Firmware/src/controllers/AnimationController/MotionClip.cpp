@@ -0,0 +1,60 @@
+#include "MotionClip.h"
+#include <string.h>
+
+bool MotionClipReader::fail(const char* error) {
+    _error = error;
+    _source = nullptr;
+    return false;
+}
+
+bool MotionClipReader::open(ClipSource* source) {
+    _source = source;
+    _error = nullptr;
+    if (!source || !source->seek(0)) return fail("NoSource");
+
+    uint8_t raw[sizeof(MotionClipHeader)];
+    if (source->read(raw, sizeof(raw)) != sizeof(raw)) return fail("ShortHeader");
+    memcpy(&_header, raw, sizeof(_header));         // ESP32 与文件格式同为小端
+
+    if (_header.magic != MOTION_CLIP_MAGIC) return fail("BadMagic");
+    if (_header.version != MOTION_CLIP_VERSION) return fail("BadVersion");
+    if (_header.axisMask == 0 || (_header.axisMask >> MOTION_CLIP_MAX_AXES) != 0) return fail("BadAxisMask");
+    if (loops() && _header.durationMs == 0) return fail("BadDuration");
+    return rewind();
+}
+
+bool MotionClipReader::rewind() {
+    if (!_source) return false;
+    if (!_source->seek(sizeof(MotionClipHeader))) return fail("SeekFailed");
+    _remaining = _header.keyframeCount;
+    _batchCount = 0;
+    _batchIndex = 0;
+    _timeMs = 0;
+    return true;
+}
+
+bool MotionClipReader::fill() {
+    uint8_t count = _remaining < CLIP_READ_BATCH ? (uint8_t)_remaining : CLIP_READ_BATCH;
+    size_t bytes = count * sizeof(MotionKeyframe);
+    if (_source->read(reinterpret_cast<uint8_t*>(_batch), bytes) != bytes) return fail("Truncated");
+    _remaining -= count;
+    _batchCount = count;
+    _batchIndex = 0;
+    return true;
+}
+
+bool MotionClipReader::next(MotionKeyframe& keyframe, uint32_t& startMs) {
+    if (!_source) return false;
+    if (_batchIndex >= _batchCount) {
+        if (_remaining == 0) return false;          // 正常结束
+        if (!fill()) return false;
+    }
+    keyframe = _batch[_batchIndex++];
+
+    if (keyframe.axis >= MOTION_CLIP_MAX_AXES || !(_header.axisMask & (1u << keyframe.axis))) return fail("BadAxis");
+    if (keyframe.easing >= CLIP_EASE_COUNT) return fail("BadEasing");
+    _timeMs += keyframe.startDeltaMs;
+    if (_timeMs + keyframe.durationMs > _header.durationMs) return fail("BadTiming");
+    startMs = _timeMs;
+    return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// 动作片段（.clip）二进制格式，小端，由 scripts/build-clips.py 从 clips/*.json 生成，存放在 SPIFFS 的 /clips/<id>.clip
+//
+//   [MotionClipHeader 24B][MotionKeyframe 8B] × keyframeCount
+//
+// 每条关键帧是一段补间：从 start 时刻起，某个轴用 durationMs 毫秒、按 easing 缓动到目标角度。
+// 关键帧按 start 升序存放，start 以相对上一条的增量编码，播放时顺序读取即可，不需要随机访问或整段载入内存
+// 片段开始前，各轴先在过渡时间（blend）内平滑移动到 startPose，再开始计时
+//
+// ⚠️ 结构体按原样从文件读出，字段变化时修改 MOTION_CLIP_VERSION 并同步 build-clips.py
+
+#ifndef MOTION_CLIP_MAX_AXES
+#define MOTION_CLIP_MAX_AXES 4                      // 与 MotionController::MAX_AXES 一致
+#endif
+
+static const uint32_t MOTION_CLIP_MAGIC = 0x314C434D;   // "MCL1"
+static const uint8_t MOTION_CLIP_VERSION = 1;
+static const uint8_t MOTION_CLIP_FLAG_LOOP = 0x01;      // 循环播放，直到被替换或停止
+
+// 关键帧缓动，对应 MotionController 的轨迹曲线
+enum ClipEasing : uint8_t {
+    CLIP_EASE_LINEAR = 0,                           // 匀速
+    CLIP_EASE_IN_OUT = 1,                           // S 曲线（smoothstep），起停柔和
+    CLIP_EASE_TRAPEZOID = 2,                        // 梯形加减速
+    CLIP_EASE_COUNT
+};
+
+struct MotionClipHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t axisMask;                               // bit i 表示片段驱动轴 i
+    uint8_t flags;                                  // MOTION_CLIP_FLAG_*
+    uint8_t reserved;
+    uint16_t keyframeCount;
+    uint16_t reserved2;
+    uint32_t durationMs;                            // 片段总时长（最后一段补间结束的时刻）
+    int16_t startPose[MOTION_CLIP_MAX_AXES];        // 起始姿态（0.01°），未使用的轴为 0
+};
+
+struct MotionKeyframe {
+    uint16_t startDeltaMs;                          // 相对上一条关键帧 start 的增量
+    uint16_t durationMs;                            // 补间时长，0 表示按轴的速度/加速度上限尽快到达
+    uint8_t axis;
+    uint8_t easing;                                 // ClipEasing
+    int16_t centiDegrees;                           // 目标角度（0.01°）
+};
+
+static_assert(sizeof(MotionClipHeader) == 24, "MotionClipHeader 必须与 build-clips.py 的布局一致");
+static_assert(sizeof(MotionKeyframe) == 8, "MotionKeyframe 必须与 build-clips.py 的布局一致");
+
+// 片段的字节来源（SPIFFS 文件、主机测试中的内存缓冲等）
+class ClipSource {
+public:
+    virtual ~ClipSource() = default;
+    virtual size_t read(uint8_t* dst, size_t len) = 0;     // 返回实际读取的字节数
+    virtual bool seek(uint32_t offset) = 0;
+};
+
+// 流式读取片段：只缓存 CLIP_READ_BATCH 条关键帧，内存占用与片段长度无关
+class MotionClipReader {
+public:
+    static const uint8_t CLIP_READ_BATCH = 16;
+
+    bool open(ClipSource* source);                  // 读取并校验文件头，失败时 error() 给出原因
+    void close() { _source = nullptr; }
+    bool rewind();                                  // 回到第一条关键帧（循环播放）
+
+    // 读取下一条关键帧；startMs 为其在片段时间轴上的绝对起始时刻。读完或出错时返回 false
+    bool next(MotionKeyframe& keyframe, uint32_t& startMs);
+
+    const MotionClipHeader& header() const { return _header; }
+    bool isOpen() const { return _source != nullptr; }
+    bool loops() const { return (_header.flags & MOTION_CLIP_FLAG_LOOP) != 0; }
+    const char* error() const { return _error; }
+
+private:
+    bool fill();
+    bool fail(const char* error);
+
+    ClipSource* _source = nullptr;
+    MotionClipHeader _header = {};
+    MotionKeyframe _batch[CLIP_READ_BATCH];
+    uint8_t _batchCount = 0;
+    uint8_t _batchIndex = 0;
+    uint16_t _remaining = 0;                        // 还没有读进缓冲的关键帧数
+    uint32_t _timeMs = 0;                           // 上一条关键帧的起始时刻
+    const char* _error = nullptr;
+};
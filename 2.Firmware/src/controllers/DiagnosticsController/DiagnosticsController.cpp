@@ -0,0 +1,64 @@
+#include "DiagnosticsController.h"
+#include "drivers/Transport/MessageTransport.h"
+#include "serial_color_debug.h"
+#include "utils/FastLog.h"
+
+const char* DiagnosticsController::DIAGNOSTICS_UUID = "ef060001-1000-8000-0080-5f9b34fb0000";
+
+void DiagnosticsController::begin() {
+    DEBUG_INFOF("✅ 诊断特征就绪：%u 项指标", (unsigned)Metrics::count());
+}
+
+void DiagnosticsController::setTransport(MessageTransport* transport) {
+    _transport = transport;
+    _handle = transport->handleOf(DIAGNOSTICS_UUID);
+}
+
+void DiagnosticsController::handleMessage(const BLEWriteMessage& msg) {
+    if (msg.handle != _handle) {
+        FLOG_WARN("⚠️ 未知的诊断特征句柄: %d", msg.handle);
+        return;
+    }
+    if (msg.data.size() == 0) {                     // 空写入：负载块是复用的，首字节是上一条消息残留的
+        FLOG_WARN("⚠️ 空的诊断命令已忽略");
+        return;
+    }
+    switch (msg.data.data()[0]) {
+        case OP_SNAPSHOT:
+            sendFrame(OP_SNAPSHOT, _frame, Metrics::snapshot(_frame, sizeof(_frame)));
+            break;
+        case OP_RESET:
+            Metrics::reset();
+            sendFrame(OP_RESET, nullptr, 0);
+            break;
+        case OP_DESCRIBE:
+            sendFrame(OP_DESCRIBE, _frame, Metrics::describe(_frame, sizeof(_frame)));
+            break;
+        default:
+            FLOG_WARN("⚠️ 未知的诊断命令: 0x%02x", msg.data.data()[0]);
+            break;
+    }
+}
+
+// 按当前连接的通知上限分片：大分片由传输层在本任务中同步发出，只有最后一片可能较小而进入通知队列，顺序不变
+// 未协商 MTU（23）时分片很多，名称表可能超过通知队列深度，APP 应先协商 MTU 再读取
+void DiagnosticsController::sendFrame(uint8_t op, const uint8_t* frame, size_t len) {
+    if (!_transport || _handle == INVALID_CHAR_HANDLE || !_transport->isConnected()) return;
+    size_t limit = _transport->notifyPayloadLimit();
+    if (limit > sizeof(_chunk)) limit = sizeof(_chunk);
+    size_t perChunk = limit - CHUNK_HEADER;
+    size_t total = len == 0 ? 1 : (len + perChunk - 1) / perChunk;
+    if (total > 0xFF) {
+        FLOG_WARN("⚠️ 诊断帧过大（%u 字节），无法分片", (unsigned)len);
+        return;
+    }
+    for (size_t i = 0; i < total; ++i) {
+        size_t offset = i * perChunk;
+        size_t n = len - offset < perChunk ? len - offset : perChunk;
+        _chunk[0] = (uint8_t)(op | 0x80);
+        _chunk[1] = (uint8_t)i;
+        _chunk[2] = (uint8_t)total;
+        if (n) memcpy(&_chunk[CHUNK_HEADER], frame + offset, n);
+        _transport->notify(_handle, _chunk, CHUNK_HEADER + n);
+    }
+}
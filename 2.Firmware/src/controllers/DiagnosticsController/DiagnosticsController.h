@@ -0,0 +1,43 @@
+#pragma once
+#include <Arduino.h>
+#include "MessageConsumer.h"
+#include "utils/Metrics.h"
+
+class MessageTransport;
+
+#ifndef DIAG_FRAME_BYTES
+#define DIAG_FRAME_BYTES 1024                       // 快照 / 名称表的编码缓冲（METRICS_MAX 条直方图也放得下）
+#endif
+
+// 诊断特征：APP 写命令，设备把 Metrics 注册表编码成紧凑的二进制帧，经同一个特征的通知分片发回
+//
+// Diagnostics 写入格式：
+//   01    读取快照（计数器 / 量规 / 直方图摘要，格式见 utils/Metrics.h）
+//   02    清零直方图与峰值量规（开始一段新的测量）
+//   03    读取名称表（编号 → 名称、类型、单位；编号在一次启动内不变，APP 每次连接读一次即可）
+// 通知格式：[命令 | 0x80][分片序号][分片总数][帧数据...]，每片不超过协商的 MTU - 3，APP 按序号拼接
+// 02 的回应是一片空数据（只有 3 字节头）
+class DiagnosticsController : public MessageConsumer {
+public:
+    static const char* DIAGNOSTICS_UUID;
+
+    enum Op : uint8_t {
+        OP_SNAPSHOT = 0x01,
+        OP_RESET = 0x02,
+        OP_DESCRIBE = 0x03,
+    };
+
+    static const size_t CHUNK_HEADER = 3;
+
+    void begin() override;
+    void handleMessage(const BLEWriteMessage& msg) override;   // 在 bleWriteTask 中调用
+    void setTransport(MessageTransport* transport);
+
+private:
+    void sendFrame(uint8_t op, const uint8_t* frame, size_t len);
+
+    MessageTransport* _transport = nullptr;
+    CharHandle _handle = INVALID_CHAR_HANDLE;
+    uint8_t _frame[DIAG_FRAME_BYTES];
+    uint8_t _chunk[512];                            // 一片通知（不超过 BLEDevice::setMTU(512)）
+};
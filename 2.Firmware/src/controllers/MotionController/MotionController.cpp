@@ -0,0 +1,204 @@
+#include "MotionController.h"
+#include "serial_color_debug.h"
+
+MotionController::~MotionController() {
+    end();
+}
+
+uint8_t MotionController::addAxis(PWMServoController* servo, float maxVelocity, float maxAcceleration,
+                                  ProfileShape shape) {
+    if (!servo || _axisCount >= MAX_AXES) {
+        DEBUG_ERRORF("❌ 添加运动轴失败（已有 %u 个轴，上限 %u）", _axisCount, MAX_AXES);
+        return INVALID_AXIS;
+    }
+    Axis& axis = _axes[_axisCount];
+    axis.servo = servo;
+    axis.maxVelocity = maxVelocity;
+    axis.maxAcceleration = maxAcceleration;
+    axis.shape = shape;
+    axis.position = (float)servo->getCurrentAngle();
+    axis.profile.hold(axis.position);
+    return _axisCount++;
+}
+
+bool MotionController::begin(uint32_t tickHz) {
+    if (_timer) return true;
+    if (tickHz == 0) tickHz = MOTION_TICK_HZ;
+
+    esp_timer_create_args_t args = {};
+    args.callback = &MotionController::onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;          // 在 esp_timer 任务中执行（ledcWrite 不能在中断里调用）
+    args.name = "motion";
+    if (esp_timer_create(&args, &_timer) != ESP_OK) {
+        DEBUG_ERROR("❌ 创建运动插值定时器失败");
+        _timer = nullptr;
+        return false;
+    }
+    esp_timer_start_periodic(_timer, 1000000ULL / tickHz);
+    DEBUG_INFOF("✅ 运动控制器启动：%u 个轴，插值频率 %u Hz", _axisCount, (unsigned)tickHz);
+    return true;
+}
+
+void MotionController::end() {
+    if (!_timer) return;
+    esp_timer_stop(_timer);
+    esp_timer_delete(_timer);
+    _timer = nullptr;
+}
+
+bool MotionController::moveTo(uint8_t axis, float target, float maxVelocity, float maxAcceleration) {
+    return plan(axis, target, maxVelocity, maxAcceleration, 0.0f);
+}
+
+bool MotionController::moveToIn(uint8_t axis, float target, uint32_t durationMs) {
+    return plan(axis, target, 0.0f, 0.0f, durationMs / 1000.0f);
+}
+
+bool MotionController::moveToIn(uint8_t axis, float target, uint32_t durationMs, ProfileShape shape) {
+    return plan(axis, target, 0.0f, 0.0f, durationMs / 1000.0f, &shape);
+}
+
+// 新轨迹在临界区外算好，只在替换时短暂进入临界区；起点取当前插值位置，因此运动途中改目标不会跳变
+bool MotionController::plan(uint8_t index, float target, float maxVelocity, float maxAcceleration, float durationS,
+                            const ProfileShape* shapeOverride) {
+    if (index >= _axisCount) return false;
+    Axis& axis = _axes[index];
+    if (maxVelocity <= 0.0f) maxVelocity = axis.maxVelocity;
+    if (maxAcceleration <= 0.0f) maxAcceleration = axis.maxAcceleration;
+
+    portENTER_CRITICAL(&_lock);
+    float from = axis.position;
+    ProfileShape shape = shapeOverride ? *shapeOverride : axis.shape;
+    portEXIT_CRITICAL(&_lock);
+
+    TrajectoryProfile profile;
+    profile.plan(from, target, maxVelocity, maxAcceleration, shape, durationS);
+
+    portENTER_CRITICAL(&_lock);
+    axis.profile = profile;
+    axis.startUs = esp_timer_get_time();
+    axis.moving = true;
+    portEXIT_CRITICAL(&_lock);
+    return true;
+}
+
+void MotionController::stop(uint8_t index) {
+    if (index >= _axisCount) return;
+    Axis& axis = _axes[index];
+    portENTER_CRITICAL(&_lock);
+    axis.profile.hold(axis.position);
+    axis.moving = false;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void MotionController::setShape(uint8_t index, ProfileShape shape) {
+    if (index >= _axisCount) return;
+    portENTER_CRITICAL(&_lock);
+    _axes[index].shape = shape;
+    portEXIT_CRITICAL(&_lock);
+}
+
+bool MotionController::queueSetpoint(const Setpoint& setpoint) {
+    Setpoint* slot = _setpoints.beginWrite();
+    if (!slot) return false;
+    *slot = setpoint;
+    slot->epoch = _epoch.load(std::memory_order_relaxed);
+    _setpoints.commitWrite();
+    return true;
+}
+
+void MotionController::flushSetpoints() {
+    _epoch.store(_epoch.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void MotionController::onTimer(void* arg) {
+    static_cast<MotionController*>(arg)->tick();
+}
+
+// 定时器回调：对运动中的轴按经过时间插值并写占空比，到达终点后停止写入
+void MotionController::tick() {
+    int64_t now = esp_timer_get_time();
+    applySetpoints(now);
+    for (uint8_t i = 0; i < _axisCount; ++i) {
+        Axis& axis = _axes[i];
+        portENTER_CRITICAL(&_lock);
+        if (!axis.moving) {
+            portEXIT_CRITICAL(&_lock);
+            continue;
+        }
+        float t = (now - axis.startUs) / 1000000.0f;
+        float position = axis.profile.position(t);
+        bool done = t >= axis.profile.duration();
+        axis.position = position;
+        if (done) axis.moving = false;
+        portEXIT_CRITICAL(&_lock);
+
+        axis.servo->writeAngle(position);           // 写占空比放在临界区外
+    }
+    _ticks = _ticks + 1;
+}
+
+// 在定时器中装入到期的设定点：先在临界区外规划所有轴（轴位置只由定时器写入，这里读取不需要加锁），
+// 再一次性替换；写占空比在之后的插值循环中完成，所以同一设定点的各轴总在同一个周期生效
+void MotionController::applySetpoints(int64_t now) {
+    uint8_t epoch = _epoch.load(std::memory_order_acquire);
+    Setpoint* setpoint;
+    while ((setpoint = _setpoints.front()) != nullptr) {
+        if (setpoint->epoch != epoch) {             // flushSetpoints 之前入队的
+            _setpoints.popFront();
+            continue;
+        }
+        if (setpoint->atUs > now) break;
+
+        TrajectoryProfile profiles[MAX_AXES];
+        uint8_t mask = setpoint->mask;
+        for (uint8_t i = 0; i < _axisCount; ++i) {
+            if (!(mask & (1u << i))) continue;
+            const Axis& axis = _axes[i];
+            ProfileShape shape = setpoint->rampMs ? ProfileShape::LINEAR : axis.shape;
+            profiles[i].plan(axis.position, setpoint->centiDegrees[i] / 100.0f, axis.maxVelocity,
+                             axis.maxAcceleration, shape, setpoint->rampMs / 1000.0f);
+        }
+        portENTER_CRITICAL(&_lock);
+        for (uint8_t i = 0; i < _axisCount; ++i) {
+            if (!(mask & (1u << i))) continue;
+            _axes[i].profile = profiles[i];
+            _axes[i].startUs = setpoint->atUs;
+            _axes[i].moving = true;
+        }
+        portEXIT_CRITICAL(&_lock);
+        _setpoints.popFront();
+    }
+}
+
+bool MotionController::isMoving(uint8_t index) const {
+    if (index >= _axisCount) return false;
+    portENTER_CRITICAL(&_lock);
+    bool moving = _axes[index].moving;
+    portEXIT_CRITICAL(&_lock);
+    return moving;
+}
+
+bool MotionController::isIdle() const {
+    for (uint8_t i = 0; i < _axisCount; ++i) {
+        if (isMoving(i)) return false;
+    }
+    return true;
+}
+
+float MotionController::position(uint8_t index) const {
+    if (index >= _axisCount) return 0.0f;
+    portENTER_CRITICAL(&_lock);
+    float position = _axes[index].position;
+    portEXIT_CRITICAL(&_lock);
+    return position;
+}
+
+float MotionController::target(uint8_t index) const {
+    if (index >= _axisCount) return 0.0f;
+    portENTER_CRITICAL(&_lock);
+    float target = _axes[index].profile.target();
+    portEXIT_CRITICAL(&_lock);
+    return target;
+}
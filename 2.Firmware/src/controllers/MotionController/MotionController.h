@@ -0,0 +1,100 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include "TrajectoryProfile.h"
+#include "utils/SPSCRing.h"
+#include "PWMServoController.h"
+
+#ifndef MOTION_TICK_HZ
+#define MOTION_TICK_HZ 100                          // 插值频率（舵机 PWM 为 50Hz，100Hz 保证每个 PWM 周期都拿到新脉宽）
+#endif
+
+#ifndef MOTION_SETPOINT_SLOTS
+#define MOTION_SETPOINT_SLOTS 64                    // 定时设定点队列槽位（2 的幂）
+#endif
+
+// 舵机运动引擎：每个轴接收目标角度 + 速度/加速度上限（或指定时长），生成梯形或 S 曲线轨迹，
+// 由固定频率的 esp_timer 定时器插值并写占空比，运动平滑、节拍确定，调用方不再需要在 loop 中 delay 逐步逼近
+//
+//   MotionController motion;
+//   uint8_t head = motion.addAxis(&servo, 180, 720);       // 上限：180°/s、720°/s²
+//   motion.begin();
+//   motion.moveTo(head, 30);                               // 按上限以最短时间运动到 30°
+//   motion.moveToIn(head, 150, 2000);                      // 用时 2 秒运动到 150°
+//
+// - moveTo 可以在运动途中调用：新轨迹从当前插值位置出发（速度从 0 开始）
+// - 线程安全：任意任务都可以下发目标，轨迹在临界区内整体替换
+class MotionController {
+public:
+    static const uint8_t MAX_AXES = 4;
+    static const uint8_t INVALID_AXIS = 0xFF;
+
+    // 定时设定点：定时器在 atUs（esp_timer_get_time）之后的第一个插值周期，一次性装入 mask 中所有轴的新轨迹，
+    // 同一个设定点的各轴在同一个 PWM 周期开始运动；轨迹从 atUs 起计时，定时器晚到时不会累积延迟
+    struct Setpoint {
+        int64_t atUs = 0;
+        uint16_t rampMs = 0;                        // 匀速用时 rampMs 到达；0 表示按轴的默认曲线与上限尽快到达
+        uint8_t mask = 0;                           // bit i 表示轴 i
+        uint8_t epoch = 0;                          // 由 queueSetpoint 填写，flushSetpoints 之后旧的设定点被丢弃
+        int16_t centiDegrees[MAX_AXES] = {};        // 目标角度（0.01°）
+    };
+
+    ~MotionController();
+
+    // 添加一个轴（begin 之前调用），返回轴编号，满了返回 INVALID_AXIS
+    // 起始位置取舵机当前角度
+    uint8_t addAxis(PWMServoController* servo, float maxVelocity = 180.0f, float maxAcceleration = 720.0f,
+                    ProfileShape shape = ProfileShape::S_CURVE);
+
+    bool begin(uint32_t tickHz = MOTION_TICK_HZ);   // 启动插值定时器
+    void end();
+
+    // 按速度/加速度上限运动（0 表示使用轴的默认上限）
+    bool moveTo(uint8_t axis, float target, float maxVelocity = 0.0f, float maxAcceleration = 0.0f);
+    // 指定用时运动（仍受轴的速度/加速度上限约束：上限内做不到时按最短时间完成）
+    bool moveToIn(uint8_t axis, float target, uint32_t durationMs);
+    // 同上，本次运动使用指定曲线（动作片段的关键帧缓动），不改变轴的默认曲线
+    bool moveToIn(uint8_t axis, float target, uint32_t durationMs, ProfileShape shape);
+    void stop(uint8_t axis);                        // 停在当前插值位置
+    void setShape(uint8_t axis, ProfileShape shape);
+
+    // 定时设定点队列（单生产者：只能由一个任务调用 queueSetpoint / flushSetpoints，例如 bleWriteTask）
+    // 设定点按入队顺序生效，atUs 必须单调不减；队列满时返回 false
+    bool queueSetpoint(const Setpoint& setpoint);
+    void flushSetpoints();                          // 丢弃所有尚未生效的设定点
+    size_t pendingSetpoints() const { return _setpoints.size(); }
+
+    bool isMoving(uint8_t axis) const;
+    bool isIdle() const;                            // 所有轴都已到位
+    float position(uint8_t axis) const;             // 最近一次插值输出的角度
+    float target(uint8_t axis) const;
+    uint8_t axisCount() const { return _axisCount; }
+    uint32_t tickCount() const { return _ticks; }
+
+private:
+    struct Axis {
+        PWMServoController* servo = nullptr;
+        float maxVelocity = 0.0f;
+        float maxAcceleration = 0.0f;
+        ProfileShape shape = ProfileShape::S_CURVE;
+        TrajectoryProfile profile;
+        int64_t startUs = 0;                        // 轨迹开始时间（esp_timer_get_time）
+        float position = 0.0f;
+        bool moving = false;
+    };
+
+    static void onTimer(void* arg);
+    void tick();
+    void applySetpoints(int64_t now);
+    bool plan(uint8_t axis, float target, float maxVelocity, float maxAcceleration, float durationS,
+              const ProfileShape* shape = nullptr);
+
+    Axis _axes[MAX_AXES];
+    uint8_t _axisCount = 0;
+    esp_timer_handle_t _timer = nullptr;
+    volatile uint32_t _ticks = 0;
+    mutable portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;     // 保护轨迹替换与插值读取
+    SPSCRing<Setpoint, MOTION_SETPOINT_SLOTS> _setpoints;          // 生产者：queueSetpoint 的调用方；消费者：定时器
+    std::atomic<uint8_t> _epoch{0};
+};
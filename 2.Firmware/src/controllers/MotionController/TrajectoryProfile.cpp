@@ -0,0 +1,118 @@
+#include "TrajectoryProfile.h"
+#include <math.h>
+
+float TrajectoryProfile::plan(float start, float target, float maxVelocity, float maxAcceleration,
+                              ProfileShape shape, float durationS) {
+    _start = start;
+    _shape = shape;
+    _distance = fabsf(target - start);
+    _direction = target >= start ? 1.0f : -1.0f;
+    if (_distance <= 0.0f || maxVelocity <= 0.0f || maxAcceleration <= 0.0f) {
+        hold(target);
+        return 0.0f;
+    }
+
+    if (shape == ProfileShape::LINEAR) {            // 匀速：没有加减速段
+        _peakVelocity = maxVelocity;
+        _accelTime = 0.0f;
+        _cruiseTime = _distance / maxVelocity;
+    } else {
+        // S 曲线的峰值加速度是平均值的 1.5 倍
+        float accel = shape == ProfileShape::S_CURVE ? maxAcceleration / 1.5f : maxAcceleration;
+
+        // 最短时间：先按梯形/三角形求加速段和匀速段
+        float velocity = maxVelocity;
+        if (_distance < velocity * velocity / accel) {  // 加速到上限之前就得开始减速：三角形
+            velocity = sqrtf(_distance * accel);
+        }
+        _peakVelocity = velocity;
+        _accelTime = velocity / accel;
+        _cruiseTime = _distance / velocity - _accelTime;
+        if (_cruiseTime < 0.0f) _cruiseTime = 0.0f;
+    }
+
+    // 指定时长：整体时间缩放 k 倍（速度 ÷k，加速度 ÷k²），曲线形状不变
+    float minimum = duration();
+    if (durationS > minimum) {
+        float k = durationS / minimum;
+        _accelTime *= k;
+        _cruiseTime *= k;
+        _peakVelocity /= k;
+    }
+    return duration();
+}
+
+void TrajectoryProfile::hold(float position) {
+    _start = position;
+    _distance = 0.0f;
+    _direction = 1.0f;
+    _peakVelocity = 0.0f;
+    _accelTime = 0.0f;
+    _cruiseTime = 0.0f;
+}
+
+float TrajectoryProfile::rampDistance(float tau) const {
+    float u = tau / _accelTime;
+    if (_shape == ProfileShape::S_CURVE) {
+        return _peakVelocity * _accelTime * (u * u * u - 0.5f * u * u * u * u);   // ∫(3u² - 2u³)
+    }
+    return 0.5f * _peakVelocity * _accelTime * u * u;
+}
+
+float TrajectoryProfile::rampVelocity(float tau) const {
+    float u = tau / _accelTime;
+    if (_shape == ProfileShape::S_CURVE) {
+        return _peakVelocity * u * u * (3.0f - 2.0f * u);
+    }
+    return _peakVelocity * u;
+}
+
+float TrajectoryProfile::rampAcceleration(float tau) const {
+    float u = tau / _accelTime;
+    if (_shape == ProfileShape::S_CURVE) {
+        return _peakVelocity / _accelTime * 6.0f * u * (1.0f - u);
+    }
+    return _peakVelocity / _accelTime;
+}
+
+float TrajectoryProfile::position(float t) const {
+    if (_distance <= 0.0f || t <= 0.0f) return _start;
+    float total = duration();
+    if (t >= total) return target();
+
+    float d;
+    if (t < _accelTime) {
+        d = rampDistance(t);
+    } else if (t < _accelTime + _cruiseTime) {
+        d = 0.5f * _peakVelocity * _accelTime + _peakVelocity * (t - _accelTime);   // 两种曲线加速段的位移都是 vt/2
+    } else {
+        d = _distance - rampDistance(total - t);    // 减速段与加速段关于中点对称
+    }
+    return _start + _direction * d;
+}
+
+float TrajectoryProfile::velocity(float t) const {
+    if (_distance <= 0.0f || t <= 0.0f) return 0.0f;
+    float total = duration();
+    if (t >= total) return 0.0f;
+
+    float v;
+    if (t < _accelTime) {
+        v = rampVelocity(t);
+    } else if (t < _accelTime + _cruiseTime) {
+        v = _peakVelocity;
+    } else {
+        v = rampVelocity(total - t);
+    }
+    return _direction * v;
+}
+
+float TrajectoryProfile::acceleration(float t) const {
+    if (_distance <= 0.0f || t <= 0.0f) return 0.0f;
+    float total = duration();
+    if (t >= total) return 0.0f;
+
+    if (t < _accelTime) return _direction * rampAcceleration(t);
+    if (t < _accelTime + _cruiseTime) return 0.0f;
+    return -_direction * rampAcceleration(total - t);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+
+// 单轴点到点运动曲线（纯计算，不依赖 Arduino，可在 Linux 主机上对照参考曲线测试）
+// 单位由调用方决定（舵机用 度 / 度每秒 / 度每平方秒），时间单位为秒
+//
+// - TRAPEZOID：加速度恒定的梯形速度曲线（距离不够时退化为三角形），加速度在段间突变
+// - S_CURVE：加减速段的速度按 smoothstep（3u² - 2u³）变化，加速度连续、加加速度有界，起停时没有冲击
+//   smoothstep 段的平均加速度与梯形相同、峰值为其 1.5 倍，规划时按 maxAcceleration / 1.5 计算，保证峰值不超限
+//   两种曲线的段时长结构相同：加速 ta → 匀速 tc → 减速 ta
+// - LINEAR：全程匀速（ta = 0），起停时速度突变，只用于动作片段中的关键帧缓动（不受加速度上限约束）
+enum class ProfileShape : uint8_t {
+    TRAPEZOID = 0,
+    S_CURVE = 1,
+    LINEAR = 2,
+};
+
+class TrajectoryProfile {
+public:
+    TrajectoryProfile() = default;
+
+    // 按速度/加速度上限规划最短时间的运动；durationS 大于最短时间时整体放慢到恰好用时 durationS
+    // maxVelocity / maxAcceleration 必须为正；返回规划后的总时长（秒）
+    float plan(float start, float target, float maxVelocity, float maxAcceleration,
+               ProfileShape shape = ProfileShape::S_CURVE, float durationS = 0.0f);
+
+    // 保持在某个位置不动（总时长为 0）
+    void hold(float position);
+
+    float position(float t) const;                  // t 为从运动开始经过的秒数，超出范围时钳在起点/终点
+    float velocity(float t) const;
+    float acceleration(float t) const;
+
+    float duration() const { return _accelTime * 2.0f + _cruiseTime; }
+    float start() const { return _start; }
+    float target() const { return _start + _direction * _distance; }
+    float peakVelocity() const { return _peakVelocity; }
+    ProfileShape shape() const { return _shape; }
+
+private:
+    float rampDistance(float tau) const;            // 加速段开始后 tau 秒走过的距离（tau ≤ _accelTime）
+    float rampVelocity(float tau) const;
+    float rampAcceleration(float tau) const;
+
+    float _start = 0.0f;
+    float _distance = 0.0f;                         // 总位移的绝对值
+    float _direction = 1.0f;                        // +1 / -1
+    float _peakVelocity = 0.0f;                     // 匀速段速度（绝对值）
+    float _accelTime = 0.0f;                        // 单个加速（减速）段时长
+    float _cruiseTime = 0.0f;
+    ProfileShape _shape = ProfileShape::S_CURVE;
+};
@@ -0,0 +1,77 @@
+#include "ClockSync.h"
+
+static const float MAX_DRIFT_PPM = 500.0f;          // 超出时视为测量异常（晶振误差一般在 ±50ppm 以内）
+static const int64_t MIN_DRIFT_SPAN_US = 20000000;  // 基线不足 20 秒时不估计漂移
+
+void ClockSync::reset() {
+    _count = 0;
+    _next = 0;
+    _best = 0;
+    _driftPpm = 0.0f;
+    _hasAnchor = false;
+    _exchanges = 0;                                 // 窗口边界按 _exchanges 判断，必须与 _count 一起清零
+    _hasOneWay = false;
+    _hasSender = false;
+}
+
+int64_t ClockSync::unwrapSender(uint32_t senderUs) {
+    if (!_hasSender) {
+        _hasSender = true;
+        _lastSender = senderUs;
+    } else {
+        _lastSender += (int32_t)(senderUs - (uint32_t)_lastSender);     // 前后相差不超过约 35 分钟
+    }
+    return _lastSender;
+}
+
+void ClockSync::addExchange(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+    int64_t rtt = (t4 - t1) - (t3 - t2);
+    if (rtt < 0 || t3 < t2) return;                 // 时间戳乱序（例如手机时钟回拨），丢弃
+    Sample& sample = _samples[_next];
+    sample.localUs = t2 + (t3 - t2) / 2;
+    sample.offset = ((t2 - t1) + (t3 - t4)) / 2;
+    sample.rtt = rtt > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)rtt;
+    _next = (_next + 1) % CLOCK_SYNC_WINDOW;
+    if (_count < CLOCK_SYNC_WINDOW) _count++;
+    _exchanges++;
+    update();
+}
+
+void ClockSync::update() {
+    _best = 0;
+    for (uint8_t i = 1; i < _count; ++i) {
+        if (_samples[i].rtt < _samples[_best].rtt) _best = i;
+    }
+    if (_exchanges % CLOCK_SYNC_WINDOW != 0) return;
+
+    // 每凑满一个窗口取一次最优测量；第一个窗口的最优测量作为锚点，之后用两者的偏移差 / 时间差估计漂移
+    // （单次测量有毫秒级的不对称误差，只有拉长基线才能把斜率误差压到几十 ppm 以内）
+    const Sample& best = _samples[_best];
+    if (!_hasAnchor) {
+        _anchor = best;
+        _hasAnchor = true;
+        return;
+    }
+    int64_t span = best.localUs - _anchor.localUs;
+    if (span < MIN_DRIFT_SPAN_US) return;           // 保留上一次的漂移估计
+    float drift = (float)((double)(best.offset - _anchor.offset) / (double)span * 1e6);
+    if (drift > -MAX_DRIFT_PPM && drift < MAX_DRIFT_PPM) _driftPpm = drift;
+}
+
+void ClockSync::observeOneWay(int64_t senderUs, int64_t localUs) {
+    int64_t offset = localUs - senderUs;
+    if (!_hasOneWay || offset < _oneWayOffset) {
+        _oneWayOffset = offset;
+        _hasOneWay = true;
+    }
+}
+
+int64_t ClockSync::offsetUs(int64_t nowUs) const {
+    if (_count == 0) return _hasOneWay ? _oneWayOffset : 0;
+    const Sample& best = _samples[_best];
+    return best.offset + (int64_t)((double)(nowUs - best.localUs) * _driftPpm / 1e6);
+}
+
+int64_t ClockSync::toLocal(int64_t senderUs, int64_t nowUs) const {
+    return senderUs + offsetUs(nowUs);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+
+#ifndef CLOCK_SYNC_WINDOW
+#define CLOCK_SYNC_WINDOW 8                         // 保留最近几次往返用于估计偏移与漂移
+#endif
+
+// 手机 → 设备时钟换算（纯计算，不依赖 Arduino，可在主机上测试）
+//
+// 往返测量（NTP 方式，时间单位 μs）：t1 手机发出，t2 设备收到，t3 设备回复，t4 手机收到
+//   偏移 offset = ((t2 - t1) + (t3 - t4)) / 2      （设备时间 - 手机时间）
+//   往返 rtt    = (t4 - t1) - (t3 - t2)
+// - 窗口内 rtt 最小的一次测量最可信（排队最少），以它的偏移为基准
+// - 漂移：每凑满一个窗口取最优测量，与第一个窗口的最优测量（锚点）比较，偏移差 / 时间差即两个时钟的频率差（ppm）
+// - 还没有往返测量时，退化为单向估计：偏移取“设备到达时间 - 手机时间戳”的最小值（包含最小传输延迟）
+class ClockSync {
+public:
+    void reset();
+
+    // 32 位手机时间戳（μs，约 71 分钟回绕一次）展开为 64 位
+    int64_t unwrapSender(uint32_t senderUs);
+
+    void addExchange(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+    void observeOneWay(int64_t senderUs, int64_t localUs);  // 每个带时间戳的帧调用一次
+
+    int64_t toLocal(int64_t senderUs, int64_t nowUs) const;  // 手机时间 → 设备时间（按 nowUs 时的偏移估计）
+
+    bool synced() const { return _count > 0; }      // 至少完成过一次往返测量
+    bool hasEstimate() const { return _count > 0 || _hasOneWay; }
+    int64_t offsetUs(int64_t nowUs) const;
+    uint32_t rttUs() const { return _count ? _samples[_best].rtt : 0; }
+    float driftPpm() const { return _driftPpm; }
+    uint32_t exchangeCount() const { return _exchanges; }     // reset() 以来完成的往返测量次数
+
+private:
+    struct Sample {
+        int64_t localUs;                            // 测量时刻（设备时间，t2 与 t3 的中点）
+        int64_t offset;
+        uint32_t rtt;
+    };
+    void update();
+
+    Sample _samples[CLOCK_SYNC_WINDOW];
+    uint8_t _count = 0;
+    uint8_t _next = 0;
+    uint8_t _best = 0;
+    float _driftPpm = 0.0f;
+    Sample _anchor;
+    bool _hasAnchor = false;
+    uint32_t _exchanges = 0;
+    bool _hasOneWay = false;
+    int64_t _oneWayOffset = 0;
+    bool _hasSender = false;
+    int64_t _lastSender = 0;
+};
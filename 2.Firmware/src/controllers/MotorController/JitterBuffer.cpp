@@ -0,0 +1,42 @@
+#include "JitterBuffer.h"
+
+void JitterBuffer::reset() {
+    _count = 0;
+    _next = 0;
+    _lastTransit = 0;
+    _jitterUs = 0;
+    _delayUs = JITTER_MIN_DELAY_MS * 1000;
+}
+
+uint32_t JitterBuffer::onFrame(int64_t sentLocalUs, int64_t arrivalUs) {
+    int64_t transit64 = arrivalUs - sentLocalUs;
+    if (transit64 > INT32_MAX) transit64 = INT32_MAX;
+    if (transit64 < INT32_MIN) transit64 = INT32_MIN;
+    int32_t transit = (int32_t)transit64;
+
+    if (_count > 0) {
+        int32_t d = transit - _lastTransit;
+        uint32_t magnitude = d < 0 ? (uint32_t)-(int64_t)d : (uint32_t)d;
+        _jitterUs = _jitterUs + (int32_t)(magnitude - _jitterUs) / 16;
+    }
+    _lastTransit = transit;
+    _transit[_next] = transit;
+    _next = (_next + 1) % JITTER_WINDOW;
+    if (_count < JITTER_WINDOW) _count++;
+
+    int32_t worst = _transit[0];
+    for (uint8_t i = 1; i < _count; ++i) {
+        if (_transit[i] > worst) worst = _transit[i];
+    }
+    int64_t target = (int64_t)worst + MARGIN_US;
+    if (target < (int64_t)JITTER_MIN_DELAY_MS * 1000) target = (int64_t)JITTER_MIN_DELAY_MS * 1000;
+    if (target > (int64_t)JITTER_MAX_DELAY_MS * 1000) target = (int64_t)JITTER_MAX_DELAY_MS * 1000;
+
+    if (target >= _delayUs) {
+        _delayUs = (uint32_t)target;
+    } else {
+        uint32_t shrink = _delayUs - (uint32_t)target;
+        _delayUs -= shrink < JITTER_SHRINK_US ? shrink : JITTER_SHRINK_US;
+    }
+    return _delayUs;
+}
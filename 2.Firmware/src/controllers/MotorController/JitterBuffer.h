@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+
+#ifndef JITTER_MIN_DELAY_MS
+#define JITTER_MIN_DELAY_MS 20                      // 播放延迟下限（约一个连接间隔）
+#endif
+
+#ifndef JITTER_MAX_DELAY_MS
+#define JITTER_MAX_DELAY_MS 300                     // 播放延迟上限，超过后宁可迟到也不再加深缓冲
+#endif
+
+#ifndef JITTER_WINDOW
+#define JITTER_WINDOW 32                            // 统计最近多少帧的传输时间
+#endif
+
+// 自适应抖动缓冲的延迟估计（纯计算，不依赖 Arduino，可在主机上测试）
+//
+// 每帧的传输时间 transit = 设备到达时刻 - 发送时间戳换算到设备时钟的时刻。样本按“发送时刻 + 播放延迟”播放，
+// 播放延迟取最近 JITTER_WINDOW 帧传输时间的最大值 + 余量，限制在 [JITTER_MIN_DELAY_MS, JITTER_MAX_DELAY_MS]：
+// - 变大时立即跟上（出现迟到说明缓冲不够深，宁可多停顿一下）
+// - 变小时每帧最多缩短 JITTER_SHRINK_US，播放节奏的变化小到看不出来
+// 缓冲本身就是 MotionController 的设定点队列，固定频率的运动定时器负责按时播放并在样本之间插值
+class JitterBuffer {
+public:
+    static const uint32_t MARGIN_US = 5000;         // 最大传输时间之外再留的余量
+    static const uint32_t JITTER_SHRINK_US = 500;
+
+    void reset();
+    uint32_t onFrame(int64_t sentLocalUs, int64_t arrivalUs);      // 记录一帧的传输时间，返回更新后的播放延迟（μs）
+
+    uint32_t delayUs() const { return _delayUs; }
+    uint32_t jitterUs() const { return _jitterUs; } // 传输时间的平均变化（RFC 3550 的到达间隔抖动）
+
+private:
+    int32_t _transit[JITTER_WINDOW] = {};
+    uint8_t _count = 0;
+    uint8_t _next = 0;
+    int32_t _lastTransit = 0;
+    uint32_t _jitterUs = 0;
+    uint32_t _delayUs = JITTER_MIN_DELAY_MS * 1000;
+};
@@ -0,0 +1,238 @@
+#include "MotorController.h"
+#include <esp_timer.h>
+#include <math.h>
+#include "serial_color_debug.h"
+#include "utils/FastLog.h"
+#include "drivers/Transport/MessageTransport.h"
+
+static const char* MOTOR_WRITE_UUID = "ef010001-1000-8000-0080-5f9b34fb0000";
+static const char* MOTOR_READ_UUID = "ef010002-1000-8000-0080-5f9b34fb0000";
+static const char* MOTOR_CLOCK_UUID = "ef010003-1000-8000-0080-5f9b34fb0000";
+
+static uint32_t readU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void writeU32(uint8_t* p, uint32_t v) {
+    for (uint8_t i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+MotorController::MotorController(MotionController& motion) : _motion(motion) {}
+
+void MotorController::begin() {
+    DEBUG_INFOF("✅ 电机控制器就绪：%u 个轴，设定点队列 %u 槽", _motion.axisCount(), (unsigned)MOTION_SETPOINT_SLOTS);
+}
+
+void MotorController::setTransport(MessageTransport* transport) {
+    _transport = transport;
+    _writeHandle = transport->handleOf(MOTOR_WRITE_UUID);
+    _readHandle = transport->handleOf(MOTOR_READ_UUID);
+    _clockHandle = transport->handleOf(MOTOR_CLOCK_UUID);
+}
+
+void MotorController::handleMessage(const BLEWriteMessage& msg) {
+    // 入队时间戳是 32 位的 micros()，换算到 64 位的 esp_timer 时间轴上：现在 - 在队列中等待的时间
+    int64_t arrivalUs = esp_timer_get_time() - (uint32_t)(micros() - msg.enqueueMicros);
+    if (msg.handle == _writeHandle) {
+        handleFrame(msg.data.data(), msg.data.size(), arrivalUs);
+    } else if (msg.handle == _clockHandle) {
+        handleClock(msg.data.data(), msg.data.size(), arrivalUs);
+    } else {
+        FLOG_WARN("⚠️ 未知的电机特征句柄: %d", msg.handle);
+    }
+}
+
+void MotorController::handleFrame(const uint8_t* data, size_t len, int64_t arrivalUs) {
+    MotorFrameDecoder decoder;
+    if (!decoder.begin(data, len)) {
+        _errors++;
+        FLOG_WARN("⚠️ 电机帧格式错误（%s），长度 %u", decoder.error(), (unsigned)len);
+        return;
+    }
+    _frames++;
+    trackSequence(decoder.seq());
+
+    if (decoder.op() == MOTOR_OP_STOP) {
+        _motion.flushSetpoints();
+        for (uint8_t axis = 0; axis < _motion.axisCount(); ++axis) {
+            _motion.stop(axis);
+        }
+        resetStream();
+        publishState(decoder.seq());
+        return;
+    }
+    if (_transport) _transport->hintWorkload(LinkWorkload::STREAMING);      // 运动流进行中：请求低延迟链路参数
+
+    uint8_t axisMask = decoder.axisMask() & (uint8_t)((1u << _motion.axisCount()) - 1);   // 没有添加的轴忽略
+    if (decoder.timed()) {
+        uint8_t queued = queueTimedSamples(decoder, axisMask, arrivalUs);
+        if (!decoder.done()) {
+            _errors++;
+            FLOG_WARN("⚠️ 电机帧解码中止（%s），已排队 %u 个样本", decoder.error(), queued);
+        }
+        _setpoints += queued;
+        publishState(decoder.seq());
+        return;
+    }
+
+    // 帧时间轴：从收到的时刻开始；上一帧的样本还没播完时接在最后一个样本之后
+    int64_t startUs = arrivalUs > _timelineEndUs ? arrivalUs : _timelineEndUs;
+
+    MotorSample sample;
+    MotionController::Setpoint setpoint;
+    uint32_t previousMs = 0;
+    uint8_t queued = 0;
+    while (decoder.next(sample)) {
+        // 样本在 timeMs 时刻到达：从上一个样本的时刻出发，用 dt 匀速过去
+        setpoint.atUs = startUs + (int64_t)previousMs * 1000;
+        setpoint.rampMs = sample.dtMs;
+        setpoint.mask = axisMask;
+        for (uint8_t axis = 0; axis < MOTOR_MAX_AXES; ++axis) {
+            setpoint.centiDegrees[axis] = sample.centiDegrees[axis];
+        }
+        previousMs = sample.timeMs;
+        if (!axisMask) continue;
+        if (!_motion.queueSetpoint(setpoint)) {
+            _overflows++;
+            continue;
+        }
+        queued++;
+    }
+    if (!decoder.done()) {
+        _errors++;
+        FLOG_WARN("⚠️ 电机帧解码中止（%s），已执行 %u 个样本", decoder.error(), queued);
+    }
+    _setpoints += queued;
+    _timelineEndUs = startUs + (int64_t)previousMs * 1000;
+    FLOG_DEBUG("🦾 电机帧 seq=%u：%u 个样本，%u 个轴", decoder.seq(), queued, axisMask);
+    publishState(decoder.seq());
+}
+
+// 带时间戳的样本：播放时刻 = 发送时间换算到设备时钟 + 播放延迟；从上一个样本的播放时刻出发匀速插值到本样本
+uint8_t MotorController::queueTimedSamples(MotorFrameDecoder& decoder, uint8_t axisMask, int64_t arrivalUs) {
+    int64_t sender = _clock.unwrapSender(decoder.senderTimeUs());
+    _clock.observeOneWay(sender, arrivalUs);
+    int64_t sentLocalUs = _clock.toLocal(sender, arrivalUs);
+    uint32_t delayUs = _jitter.onFrame(sentLocalUs, arrivalUs);
+    int64_t now = esp_timer_get_time();
+
+    MotorSample sample;
+    MotionController::Setpoint setpoint;
+    setpoint.mask = axisMask;
+    uint8_t queued = 0;
+    bool late = false;
+    while (decoder.next(sample)) {
+        int64_t playUs = sentLocalUs + (int64_t)sample.timeMs * 1000 + delayUs;
+        if (_hasPlayout && playUs <= _lastPlayoutUs) {     // 早于已排队的样本：重复帧或严重迟到，丢弃
+            _lateSamples++;
+            late = true;
+            continue;
+        }
+        if (playUs < now) {
+            _lateSamples++;
+            late = true;
+        }
+        int64_t gapUs = _hasPlayout ? playUs - _lastPlayoutUs : INT64_MAX;
+        if (gapUs <= (int64_t)MOTOR_MAX_INTERP_GAP_MS * 1000) {
+            setpoint.atUs = _lastPlayoutUs;
+            setpoint.rampMs = (uint16_t)(gapUs / 1000);
+        } else {                                    // 新的一段流：到时间后按上限尽快到达
+            setpoint.atUs = playUs;
+            setpoint.rampMs = 0;
+        }
+        for (uint8_t axis = 0; axis < MOTOR_MAX_AXES; ++axis) {
+            setpoint.centiDegrees[axis] = sample.centiDegrees[axis];
+        }
+        _lastPlayoutUs = playUs;
+        _hasPlayout = true;
+        if (!axisMask) continue;
+        if (!_motion.queueSetpoint(setpoint)) {
+            _overflows++;
+            continue;
+        }
+        queued++;
+    }
+    if (late) _lateFrames++;
+    return queued;
+}
+
+// 时钟同步往返：PING 记下 t1/t2 并立即回复 t3；手机收到后回传 t4，凑齐一次测量
+void MotorController::handleClock(const uint8_t* data, size_t len, int64_t arrivalUs) {
+    if (len == 6 && data[0] == CLOCK_PING) {
+        _ping.seq = data[1];
+        _ping.t1 = _clock.unwrapSender(readU32(data + 2));
+        _ping.t2 = arrivalUs;
+        _ping.t3 = esp_timer_get_time();
+        _ping.valid = true;
+
+        uint8_t reply[16];
+        uint32_t delayMs = _jitter.delayUs() / 1000;
+        reply[0] = CLOCK_PONG;
+        reply[1] = _ping.seq;
+        writeU32(reply + 2, (uint32_t)_ping.t1);
+        writeU32(reply + 6, (uint32_t)_ping.t2);
+        writeU32(reply + 10, (uint32_t)_ping.t3);
+        reply[14] = (uint8_t)(delayMs & 0xFF);
+        reply[15] = (uint8_t)(delayMs >> 8);
+        if (_transport && _clockHandle != INVALID_CHAR_HANDLE) {
+            _transport->notify(_clockHandle, reply, sizeof(reply));
+        }
+    } else if (len == 6 && data[0] == CLOCK_RESULT) {
+        if (!_ping.valid || data[1] != _ping.seq) return;  // 不是最近一次 PING 的回传
+        _ping.valid = false;
+        int64_t t4 = _clock.unwrapSender(readU32(data + 2));
+        _clock.addExchange(_ping.t1, _ping.t2, _ping.t3, t4);
+        FLOG_DEBUG("🕒 时钟同步：偏移 %d ms，往返 %u us", (int32_t)(_clock.offsetUs(_ping.t3) / 1000), (unsigned)_clock.rttUs());
+    } else {
+        FLOG_WARN("⚠️ 时钟同步消息格式错误，长度 %u", (unsigned)len);
+    }
+}
+
+void MotorController::resetStream() {
+    _timelineEndUs = 0;
+    _hasPlayout = false;
+    _jitter.reset();
+}
+
+MotorStreamStats MotorController::streamStats() const {
+    MotorStreamStats stats;
+    int64_t now = esp_timer_get_time();
+    stats.bufferedSetpoints = _motion.pendingSetpoints();
+    stats.bufferedMs = _hasPlayout && _lastPlayoutUs > now ? (uint32_t)((_lastPlayoutUs - now) / 1000) : 0;
+    stats.playoutDelayMs = _jitter.delayUs() / 1000;
+    stats.jitterUs = _jitter.jitterUs();
+    stats.lateFrames = _lateFrames;
+    stats.lateSamples = _lateSamples;
+    stats.offsetUs = _clock.offsetUs(now);
+    stats.rttUs = _clock.rttUs();
+    stats.driftPpm = _clock.driftPpm();
+    stats.syncExchanges = _clock.exchangeCount();
+    return stats;
+}
+
+void MotorController::trackSequence(uint8_t seq) {
+    if (_hasSeq) {
+        uint8_t gap = (uint8_t)(seq - _lastSeq - 1);
+        if (gap != 0 && gap < 128) _lost += gap;    // 重复/回退（APP 重连后从 0 开始）不计入丢帧
+    }
+    _hasSeq = true;
+    _lastSeq = seq;
+}
+
+// 回报执行进度与当前位置（state 模式：只发最新值并按 min_interval_ms 限速）
+void MotorController::publishState(uint8_t seq) {
+    if (!_transport || _readHandle == INVALID_CHAR_HANDLE) return;
+    uint8_t frame[3 + MOTOR_MAX_AXES * 2];
+    uint8_t count = _motion.axisCount() < MOTOR_MAX_AXES ? _motion.axisCount() : MOTOR_MAX_AXES;
+    size_t pending = _motion.pendingSetpoints();
+    frame[0] = seq;
+    frame[1] = pending > 0xFF ? 0xFF : (uint8_t)pending;
+    frame[2] = (uint8_t)((1u << count) - 1);
+    size_t len = 3;
+    for (uint8_t axis = 0; axis < count; ++axis) {
+        int16_t cd = (int16_t)lroundf(_motion.position(axis) * 100.0f);
+        frame[len++] = (uint8_t)(cd & 0xFF);
+        frame[len++] = (uint8_t)((uint16_t)cd >> 8);
+    }
+    _transport->notify(_readHandle, frame, len);
+}
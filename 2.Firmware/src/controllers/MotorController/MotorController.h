@@ -0,0 +1,98 @@
+#pragma once
+#include <Arduino.h>
+#include "MessageConsumer.h"
+#include "MotorProtocol.h"
+#include "ClockSync.h"
+#include "JitterBuffer.h"
+#include "MotionController.h"
+
+class MessageTransport;
+
+#ifndef MOTOR_MAX_INTERP_GAP_MS
+#define MOTOR_MAX_INTERP_GAP_MS 250                 // 相邻样本间隔超过这个值时不再插值（视为新的一段流）
+#endif
+
+// 流式播放统计（在其它任务中读取时为近似值）
+struct MotorStreamStats {
+    uint32_t bufferedSetpoints;                     // 设定点队列中尚未生效的样本数
+    uint32_t bufferedMs;                            // 已排队样本覆盖到未来多少毫秒
+    uint32_t playoutDelayMs;                        // 抖动缓冲当前的播放延迟
+    uint32_t jitterUs;                              // 到达间隔抖动
+    uint32_t lateFrames;                            // 含有迟到样本的帧
+    uint32_t lateSamples;                           // 播放时刻已过（或早于已排队样本）的样本
+    int64_t offsetUs;                               // 设备时钟 - 手机时钟
+    uint32_t rttUs;                                 // 最优一次时钟同步的往返时间
+    float driftPpm;                                 // 时钟频率差
+    uint32_t syncExchanges;                         // 完成的时钟同步往返次数
+};
+
+// MotorWrite 的消费者：解码批量设定点帧（格式见 MotorProtocol.h），换算成 MotionController 的定时设定点
+//
+//   BLE 回调 ──enqueue──▶ bleWriteTask ──handleMessage──▶ 解码 ──queueSetpoint──▶ [设定点队列] ──▶ 运动定时器
+//
+// - 一个样本的所有轴作为一个设定点入队，由定时器在同一个插值周期装入，各轴在同一个 PWM 周期开始运动
+// - 帧的时间轴从收到写入的时刻（BLE 回调入队时间）开始；上一帧的样本还没播完时接在其后，批量发送的样本无缝衔接
+// - 每处理完一帧，在 MotorRead（state 模式限速通知）回报 [seq][待执行设定点数][axisMask][各轴当前角度 int16...]
+//
+// 带时间戳的流（TIMED 帧，口型同步 / 实时操控）：
+//   MotorClock 时钟同步：手机写 01 seq t1(u32) → 设备通知 81 seq t1 t2 t3(u32) 播放延迟(u16 ms) → 手机写 02 seq t4(u32)
+//   （t1/t4 手机 μs，t2/t3 设备 μs），设备据此估计偏移与漂移（ClockSync）。手机每秒左右做一次即可
+//   样本的播放时刻 = 发送时间戳换算到设备时钟 + 抖动缓冲的播放延迟（JitterBuffer 自适应），
+//   手机把音频推迟同样的延迟播放即可与动作对齐；样本之间由运动定时器以固定频率匀速插值
+// - 只在 bleWriteTask 中调用（MotionController 设定点队列的唯一生产者）
+class MotorController : public MessageConsumer {
+public:
+    explicit MotorController(MotionController& motion);
+
+    void begin() override;
+    void handleMessage(const BLEWriteMessage& msg) override;
+    void setTransport(MessageTransport* transport);    // 解析 MotorWrite / MotorRead / MotorClock 句柄
+
+    uint32_t frameCount() const { return _frames; }
+    uint32_t setpointCount() const { return _setpoints; }
+    uint32_t errorCount() const { return _errors; }     // 格式错误的帧
+    uint32_t overflowCount() const { return _overflows; }   // 设定点队列满被丢弃的样本
+    uint32_t lostFrames() const { return _lost; }       // 按 seq 推算的丢帧数
+    MotorStreamStats streamStats() const;
+
+private:
+    static const uint8_t CLOCK_PING = 0x01;
+    static const uint8_t CLOCK_RESULT = 0x02;
+    static const uint8_t CLOCK_PONG = 0x81;
+
+    void handleFrame(const uint8_t* data, size_t len, int64_t arrivalUs);
+    uint8_t queueTimedSamples(MotorFrameDecoder& decoder, uint8_t axisMask, int64_t arrivalUs);
+    void handleClock(const uint8_t* data, size_t len, int64_t arrivalUs);
+    void resetStream();
+    void trackSequence(uint8_t seq);
+    void publishState(uint8_t seq);
+
+    MotionController& _motion;
+    MessageTransport* _transport = nullptr;
+    CharHandle _writeHandle = INVALID_CHAR_HANDLE;
+    CharHandle _readHandle = INVALID_CHAR_HANDLE;
+    CharHandle _clockHandle = INVALID_CHAR_HANDLE;
+    int64_t _timelineEndUs = 0;                     // 已入队样本的最后时刻
+
+    // 带时间戳的流
+    ClockSync _clock;
+    JitterBuffer _jitter;
+    struct PendingPing {
+        bool valid = false;
+        uint8_t seq = 0;
+        int64_t t1 = 0;
+        int64_t t2 = 0;
+        int64_t t3 = 0;
+    } _ping;                                        // 等待手机回传 t4 的一次往返
+    bool _hasPlayout = false;
+    int64_t _lastPlayoutUs = 0;                     // 最后一个已排队样本的播放时刻
+    uint32_t _lateFrames = 0;
+    uint32_t _lateSamples = 0;
+    bool _hasSeq = false;
+    uint8_t _lastSeq = 0;
+    uint32_t _frames = 0;
+    uint32_t _setpoints = 0;
+    uint32_t _errors = 0;
+    uint32_t _overflows = 0;
+    uint32_t _lost = 0;
+};
@@ -0,0 +1,141 @@
+#include "MotorProtocol.h"
+
+static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// ---------- 解码 ----------
+
+bool MotorFrameDecoder::fail(const char* error) {
+    _error = error;
+    _count = 0;
+    return false;
+}
+
+bool MotorFrameDecoder::begin(const uint8_t* data, size_t len) {
+    _data = data;
+    _len = len;
+    _error = nullptr;
+    _index = 0;
+    _count = 0;
+    _mask = 0;
+    _timeMs = 0;
+    _senderUs = 0;
+    if (len < 2) return fail("Short");
+    _op = data[0];
+    _seq = data[1];
+    if (_op == MOTOR_OP_STOP) {
+        return len == 2 ? true : fail("TrailingBytes");
+    }
+    if (_op != MOTOR_OP_SETPOINTS && _op != MOTOR_OP_TIMED_SETPOINTS) return fail("BadOp");
+    size_t header = timed() ? MOTOR_TIMED_FRAME_HEADER : MOTOR_FRAME_HEADER;
+    if (len < header) return fail("Short");
+    _mask = data[2];
+    _count = data[3];
+    if (_mask == 0 || (_mask >> MOTOR_MAX_AXES) != 0) return fail("BadAxisMask");
+    if (_count == 0) return fail("Empty");
+    if (timed()) {
+        _senderUs = (uint32_t)data[4] | ((uint32_t)data[5] << 8) | ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+    }
+    _pos = header;
+    return true;
+}
+
+bool MotorFrameDecoder::readVarint(uint32_t& value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 21; shift += 7) {           // 最多 3 字节（21 位），足够表示 16 位的 zigzag 值
+        if (_pos >= _len) return fail("Truncated");
+        uint8_t b = _data[_pos++];
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return fail("VarintTooLong");
+}
+
+bool MotorFrameDecoder::next(MotorSample& sample) {
+    if (_error || _index >= _count) return false;
+
+    uint32_t dt;
+    if (!readVarint(dt)) return false;
+    if (dt > 0xFFFF) return fail("BadDelta");
+    _timeMs += dt;
+    sample.dtMs = (uint16_t)dt;
+    sample.timeMs = _timeMs;
+
+    for (uint8_t axis = 0; axis < MOTOR_MAX_AXES; ++axis) {
+        if (!(_mask & (1u << axis))) continue;
+        uint32_t raw;
+        if (!readVarint(raw)) return false;
+        int32_t value = unzigzag(raw);
+        if (_index > 0) value += _last[axis];                   // 第一个样本是绝对值
+        if (value < INT16_MIN || value > INT16_MAX) return fail("OutOfRange");
+        _last[axis] = (int16_t)value;
+        sample.centiDegrees[axis] = (int16_t)value;
+    }
+    if (++_index == _count && _pos != _len) return fail("TrailingBytes");
+    return true;
+}
+
+// ---------- 编码 ----------
+
+bool MotorFrameEncoder::begin(uint8_t seq, uint8_t axisMask) {
+    _len = 0;
+    _count = 0;
+    _mask = axisMask;
+    if (_capacity < MOTOR_FRAME_HEADER || axisMask == 0 || (axisMask >> MOTOR_MAX_AXES) != 0) return false;
+    _buffer[0] = MOTOR_OP_SETPOINTS;
+    _buffer[1] = seq;
+    _buffer[2] = axisMask;
+    _buffer[3] = 0;
+    _len = MOTOR_FRAME_HEADER;
+    return true;
+}
+
+bool MotorFrameEncoder::beginTimed(uint8_t seq, uint8_t axisMask, uint32_t senderUs) {
+    if (_capacity < MOTOR_TIMED_FRAME_HEADER || !begin(seq, axisMask)) return false;
+    _buffer[0] = MOTOR_OP_TIMED_SETPOINTS;
+    for (uint8_t i = 0; i < 4; ++i) {
+        _buffer[4 + i] = (uint8_t)(senderUs >> (8 * i));
+    }
+    _len = MOTOR_TIMED_FRAME_HEADER;
+    return true;
+}
+
+bool MotorFrameEncoder::writeVarint(uint32_t value, size_t& pos) {
+    do {
+        if (pos >= _capacity) return false;
+        uint8_t b = value & 0x7F;
+        value >>= 7;
+        _buffer[pos++] = b | (value ? 0x80 : 0);
+    } while (value);
+    return true;
+}
+
+bool MotorFrameEncoder::add(uint16_t dtMs, const int16_t* centiDegrees) {
+    if (_len == 0 || _count >= MOTOR_MAX_SAMPLES) return false;
+    size_t pos = _len;
+    if (!writeVarint(dtMs, pos)) return false;
+    for (uint8_t axis = 0; axis < MOTOR_MAX_AXES; ++axis) {
+        if (!(_mask & (1u << axis))) continue;
+        int32_t value = _count == 0 ? centiDegrees[axis] : (int32_t)centiDegrees[axis] - _last[axis];
+        if (!writeVarint(zigzag(value), pos)) return false;     // 放不下：_len 不变，本样本作废
+    }
+    for (uint8_t axis = 0; axis < MOTOR_MAX_AXES; ++axis) {
+        if (_mask & (1u << axis)) _last[axis] = centiDegrees[axis];
+    }
+    _len = pos;
+    _count++;
+    return true;
+}
+
+size_t MotorFrameEncoder::finish() {
+    if (_count == 0) return 0;
+    _buffer[3] = _count;
+    return _len;
+}
+
+size_t MotorFrameEncoder::encodeStop(uint8_t* buffer, size_t capacity, uint8_t seq) {
+    if (capacity < 2) return 0;
+    buffer[0] = MOTOR_OP_STOP;
+    buffer[1] = seq;
+    return 2;
+}
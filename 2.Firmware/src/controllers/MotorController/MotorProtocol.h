@@ -0,0 +1,90 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// MotorWrite（ef010001）二进制协议：一次写入携带多个轴、多个带时间戳的设定点，差分 + 变长编码，尽量塞满一个 MTU
+//
+//   [op][seq][axisMask][count]([senderTime u32]) [样本 0] [样本 1] ... [样本 count-1]
+//   样本 = [dt varint][每个轴（按 axisMask 位序）的 zigzag varint]
+//
+// - op：MOTOR_OP_SETPOINTS / MOTOR_OP_TIMED_SETPOINTS / MOTOR_OP_STOP（STOP 帧只有 op 和 seq 两个字节）
+// - senderTime：只有 TIMED 帧携带，手机单调时钟的 μs（低 32 位），表示样本时间轴的零点；
+//   设备按时钟同步的结果换算到本地时钟，经抖动缓冲后按时播放（见 MotorController.h）
+// - seq：帧序号（0 ~ 255 循环），接收端据此统计丢帧
+// - dt：距上一个样本的毫秒数（第一个样本相对帧的起始时刻），样本的角度在该时刻到达，样本之间匀速插值；
+//   第一个样本的 dt 为 0 时表示“立即出发，按轴的上限尽快到达”
+// - 角度单位 0.01°：第一个样本是绝对值，之后是相对上一个样本同一轴的差值；zigzag 后按 LEB128 编码
+//   （差值在 ±63 以内只占 1 字节，4 轴小幅运动每个样本 5 字节；首个样本是绝对角度，90° 附近每轴 3 字节，共 13 字节，
+//   一个 244 字节的负载扣除 4 字节帧头后可以放 1 + 45 = 46 个样本）
+// - 纯计算、不依赖 Arduino，主机测试和 APP 端可以共用同一份编码实现
+
+static const uint8_t MOTOR_OP_SETPOINTS = 0x10;
+static const uint8_t MOTOR_OP_STOP = 0x11;
+static const uint8_t MOTOR_OP_TIMED_SETPOINTS = 0x12;
+static const uint8_t MOTOR_MAX_AXES = 4;            // 与 MotionController::MAX_AXES 一致
+static const size_t MOTOR_FRAME_HEADER = 4;
+static const size_t MOTOR_TIMED_FRAME_HEADER = 8;
+static const uint8_t MOTOR_MAX_SAMPLES = 255;
+
+struct MotorSample {
+    uint32_t timeMs = 0;                            // 距帧起始时刻的累计毫秒数
+    uint16_t dtMs = 0;                              // 距上一个样本的毫秒数
+    int16_t centiDegrees[MOTOR_MAX_AXES] = {};      // 绝对角度（已还原差分），只有 axisMask 中的轴有效
+};
+
+// 解码器：直接在接收缓冲上逐个样本解码，不拷贝、不分配
+class MotorFrameDecoder {
+public:
+    bool begin(const uint8_t* data, size_t len);    // 校验帧头，失败时 error() 给出原因
+    bool next(MotorSample& sample);                 // 解码下一个样本；读完或出错时返回 false
+
+    uint8_t op() const { return _op; }
+    uint8_t seq() const { return _seq; }
+    uint8_t axisMask() const { return _mask; }
+    uint8_t sampleCount() const { return _count; }
+    bool timed() const { return _op == MOTOR_OP_TIMED_SETPOINTS; }
+    uint32_t senderTimeUs() const { return _senderUs; }     // 只有 TIMED 帧有效
+    bool done() const { return _index >= _count && !_error; }      // 样本全部读完且没有多余字节
+    const char* error() const { return _error; }
+
+private:
+    bool readVarint(uint32_t& value);
+    bool fail(const char* error);
+
+    const uint8_t* _data = nullptr;
+    size_t _len = 0;
+    size_t _pos = 0;
+    uint8_t _op = 0;
+    uint8_t _seq = 0;
+    uint8_t _mask = 0;
+    uint8_t _count = 0;
+    uint8_t _index = 0;
+    uint32_t _timeMs = 0;
+    uint32_t _senderUs = 0;
+    int16_t _last[MOTOR_MAX_AXES] = {};
+    const char* _error = nullptr;
+};
+
+// 编码器：往调用方的缓冲里追加样本，放不下时 add 返回 false 且缓冲保持不变（调用方发出本帧后另起一帧）
+class MotorFrameEncoder {
+public:
+    MotorFrameEncoder(uint8_t* buffer, size_t capacity) : _buffer(buffer), _capacity(capacity) {}
+
+    bool begin(uint8_t seq, uint8_t axisMask);
+    bool beginTimed(uint8_t seq, uint8_t axisMask, uint32_t senderUs);  // 带发送时间戳的帧
+    bool add(uint16_t dtMs, const int16_t* centiDegrees);     // centiDegrees 按轴编号索引（长度 MOTOR_MAX_AXES）
+    size_t finish();                                // 写入样本数，返回帧长度（没有样本时为 0）
+    uint8_t sampleCount() const { return _count; }
+
+    static size_t encodeStop(uint8_t* buffer, size_t capacity, uint8_t seq);
+
+private:
+    bool writeVarint(uint32_t value, size_t& pos);
+
+    uint8_t* _buffer;
+    size_t _capacity;
+    size_t _len = 0;
+    uint8_t _mask = 0;
+    uint8_t _count = 0;
+    int16_t _last[MOTOR_MAX_AXES] = {};
+};
@@ -0,0 +1,58 @@
+#include "OTACheckpoint.h"
+#include <Preferences.h>
+#include "serial_color_debug.h"
+
+static const char* OTA_NVS_NAMESPACE = "ota";
+static const char* OTA_NVS_KEY = "ckpt";
+
+bool OTACheckpointStore::load(OTACheckpoint& checkpoint) {
+    lock();
+    Preferences prefs;
+    bool ok = false;
+    if (prefs.begin(OTA_NVS_NAMESPACE, true)) {
+        ok = prefs.getBytesLength(OTA_NVS_KEY) == sizeof(checkpoint) &&
+             prefs.getBytes(OTA_NVS_KEY, &checkpoint, sizeof(checkpoint)) == sizeof(checkpoint) &&
+             checkpoint.valid();
+        prefs.end();
+    }
+    unlock();
+    return ok;
+}
+
+bool OTACheckpointStore::save(const OTACheckpoint& checkpoint) {
+    lock();
+    Preferences prefs;
+    bool ok = false;
+    if (prefs.begin(OTA_NVS_NAMESPACE, false)) {
+        ok = prefs.putBytes(OTA_NVS_KEY, &checkpoint, sizeof(checkpoint)) == sizeof(checkpoint);
+        prefs.end();
+    }
+    unlock();
+    if (!ok) {
+        DEBUG_ERROR("❌ OTA断点写入 NVS 失败");
+    }
+    return ok;
+}
+
+void OTACheckpointStore::clear() {
+    lock();
+    Preferences prefs;
+    if (prefs.begin(OTA_NVS_NAMESPACE, false)) {
+        if (prefs.isKey(OTA_NVS_KEY)) {
+            prefs.remove(OTA_NVS_KEY);
+        }
+        prefs.end();
+    }
+    unlock();
+}
+
+void OTACheckpointStore::lock() {
+    if (!_lock) {
+        _lock = xSemaphoreCreateMutex();            // 首次使用在 setup 阶段（OTAController::begin），不存在并发创建
+    }
+    xSemaphoreTake(_lock, portMAX_DELAY);
+}
+
+void OTACheckpointStore::unlock() {
+    xSemaphoreGive(_lock);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// OTA 断点记录：保存在 NVS 中，设备重启或会话被放弃后仍可从 offset 处续传
+// 只有原始数据流（未压缩、非差分）的会话会写断点：数据流偏移与镜像偏移一一对应，
+// 压缩/差分会话的解压器状态无法持久化，只支持同一次上电内的断线续传
+struct OTACheckpoint {
+    uint32_t magic = 0;
+    uint32_t sessionId = 0;                         // START 时由设备生成
+    uint32_t partitionAddress = 0;                  // 写入的目标分区，重启后必须仍是下一个更新分区
+    uint32_t imageSize = 0;                         // START 声明的镜像大小
+    uint8_t sha256[32] = {};                        // START 声明的镜像 SHA-256
+    uint8_t hasDigest = 0;
+    uint8_t protocol = 0;                           // START 协议版本
+    uint8_t reserved[2] = {};
+    uint32_t offset = 0;                            // 已落盘的字节数（续传起点）
+    uint32_t crc32 = 0;                             // 分区前 offset 字节的 CRC32，续传前回读校验
+
+    static const uint32_t MAGIC = 0x4F544131;       // "OTA1"，结构变化时修改
+    bool valid() const { return magic == MAGIC && sessionId != 0; }
+};
+
+// NVS 中的断点存储（命名空间 "ota"），写入任务与控制器都会访问，内部加锁
+// 写入频率由 OTA_CHECKPOINT_BYTES 控制，一次 1.25MB 的升级默认只写 20 次左右
+class OTACheckpointStore {
+public:
+    bool load(OTACheckpoint& checkpoint);
+    bool save(const OTACheckpoint& checkpoint);
+    void clear();
+
+private:
+    void lock();
+    void unlock();
+
+    SemaphoreHandle_t _lock = nullptr;
+};
@@ -1,8 +1,31 @@
 #include "OTAController.h"
 #include "serial_color_debug.h"
+#include "utils/FastLog.h"
 #include <esp_heap_caps.h>
 
+#ifdef OTA_WITH_SEQUENTIAL_WRITES
+static const size_t OTA_BEGIN_SIZE = OTA_WITH_SEQUENTIAL_WRITES;   // 边写边擦，esp_ota_begin 立即返回
+static const bool OTA_SAVED_RESUME = true;
+#else
+static const size_t OTA_BEGIN_SIZE = OTA_SIZE_UNKNOWN;             // 旧版 IDF：begin 时擦除整个分区
+// 从 NVS 断点续传需要在新的 OTA 句柄中重放分区里已写的前缀，而 begin 会先把它擦掉：只保留同一次上电内的断线续传
+static const bool OTA_SAVED_RESUME = false;
+#endif
+
+static const uint8_t OTA_ACK_FRAME = 0xA1;      // OTAStatus 特征上的 ACK 帧类型
+static const uint8_t OTA_SESSION_FRAME = 0xA2;  // OTAStatus 特征上的会话/续传点帧类型
+
+// 会话帧中的状态
+static const uint8_t OTA_SESSION_NONE = 0;      // 没有可续传的会话，需要重新 START
+static const uint8_t OTA_SESSION_SUSPENDED = 1; // 会话挂起在内存中，可以 RESUME
+static const uint8_t OTA_SESSION_SAVED = 2;     // 只有 NVS 断点（重启或挂起超时后），RESUME 后先恢复前缀
+static const uint8_t OTA_SESSION_CONTINUE = 3;  // 从帧中的 offset / seq 继续发送
+// START 标志位与写入器的数据流类型一一对应
+static const uint8_t OTA_STREAM_FLAGS = OTAFlashWriter::STREAM_DEFLATE | OTAFlashWriter::STREAM_PATCH;
+
 const char* OTAController::OTA_STATUS_UUID = "ef040003-1000-8000-0080-5f9b34fb0000";
+const char* OTAController::OTA_CONTROL_UUID = "ef040001-1000-8000-0080-5f9b34fb0000";
+const char* OTAController::OTA_DATA_UUID = "ef040002-1000-8000-0080-5f9b34fb0000";
 
 OTAController::OTAController()
     : _status(OTAStatus::IDLE),
@@ -11,11 +34,23 @@ OTAController::OTAController()
       _updateStarted(false),
       _updatePartition(nullptr),
       _updateHandle(0) {
-    _buffer.reserve(BUFFER_SIZE);
 }
 
 void OTAController::begin() {
     DEBUG_INFO("🔄 开始初始化 OTA 控制器...");
+    if (!_windowLock) {
+        _windowLock = xSemaphoreCreateMutex();
+    }
+    if (OTA_SAVED_RESUME) {
+        _writer.setCheckpointStore(&_checkpointStore, OTA_CHECKPOINT_BYTES);
+    } else {
+        DEBUG_WARN("⚠️ 当前 IDF 没有 OTA_WITH_SEQUENTIAL_WRITES（esp_ota_begin 会擦除整个分区），重启后的断点续传已禁用");
+    }
+    if (!_writer.begin()) {
+        DEBUG_ERROR("❌ OTA 写入任务启动失败");
+        updateStatus(OTAStatus::FAILED);
+        return;
+    }
     if (!initOTA()) {
         DEBUG_ERROR("❌ OTA 初始化失败");
         updateStatus(OTAStatus::FAILED);
@@ -76,6 +111,14 @@ bool OTAController::initOTA() {
     }
 
     reset();
+
+    OTACheckpoint checkpoint;
+    if (!OTA_SAVED_RESUME) {
+        _checkpointStore.clear();               // 旧固件留下的断点在这里无法使用
+    } else if (_checkpointStore.load(checkpoint)) {
+        DEBUG_INFOF("💾 发现未完成的OTA断点: 会话 %08x，已写入 %u / %u 字节，可通过 RESUME 续传",
+                    checkpoint.sessionId, checkpoint.offset, checkpoint.imageSize);
+    }
     DEBUG_INFO("✅ OTA控制器初始化完成");
     return true;
 }
@@ -86,64 +129,126 @@ void OTAController::handleMessage(const BLEWriteMessage& msg) {
         return;
     }
 
-    DEBUG_INFOF("📥 OTA控制器收到消息 - UUID: %s, 数据长度: %d", msg.uuid.c_str(), msg.data.size());
-    String hex;
-    for (uint8_t b : msg.data) {
-        char buf[4];
-        sprintf(buf, "%02X ", b);
-        hex += buf;
-    }
-    DEBUG_INFOF("📥 OTA消息数据(hex): %s", hex.c_str());
+    FLOG_DEBUG("📥 OTA控制器收到消息 - 句柄: %d, 数据长度: %u", msg.handle, (unsigned)msg.data.size());
 
-    // 根据UUID处理不同的消息
-    if (msg.uuid == "ef040001-1000-8000-0080-5f9b34fb0000") {
+    // 根据特征句柄处理不同的消息
+    if (msg.handle == _controlHandle) {
         // OTA控制命令
-        DEBUG_INFO("📥 处理OTA控制命令");
-        processControlCommand(msg.data);
-    } else if (msg.uuid == "ef040002-1000-8000-0080-5f9b34fb0000") {
+        processControlCommand(msg.data.data(), msg.data.size());
+    } else if (msg.handle == _dataHandle) {
         // OTA数据包
-        DEBUG_INFO("📥 处理OTA数据包");
-        processDataPacket(msg.data);
+        processDataPacket(msg.data.data(), msg.data.size());
     } else {
-        DEBUG_WARNF("⚠️ 未知的OTA UUID: %s", msg.uuid.c_str());
+        FLOG_WARN("⚠️ 未知的OTA特征句柄: %d", msg.handle);
     }
 }
 
-void OTAController::processControlCommand(const std::vector<uint8_t>& data) {
-    if (data.empty()) {
+bool OTAController::handleData(const uint8_t* data, size_t len) {
+    if (len == 0) {
+        FLOG_ERROR("❌ 收到空的OTA数据包");
+        return true;
+    }
+    // 旧协议没有重传，缓冲满时只能等：交给 bleWriteTask 处理，BLE 回调里不等
+    OTAStatus status = _status.load(std::memory_order_acquire);
+    if ((status == OTAStatus::READY || status == OTAStatus::UPDATING) && _protocol != OTA_PACKET_VERSION) {
+        return false;
+    }
+    processDataPacket(data, len);
+    return true;
+}
+
+void OTAController::processControlCommand(const uint8_t* data, size_t len) {
+    if (len == 0) {
         DEBUG_ERROR("❌ 收到空的OTA控制命令");
         return;
     }
 
     DEBUG_INFOF("📥 收到OTA控制命令: %d", data[0]);
     OTAControlCommand cmd = static_cast<OTAControlCommand>(data[0]);
+    OTAStatus status = _status.load(std::memory_order_acquire);
     
     switch (cmd) {
         case OTAControlCommand::START:
-            if (_status == OTAStatus::IDLE) {
+            if (status == OTAStatus::IDLE) {
                 DEBUG_INFO("📥 开始OTA升级流程");
                 // 确保系统处于干净状态
                 reset();
-                updateStatus(OTAStatus::READY);
             } else {
-                DEBUG_WARNF("⚠️ 收到START命令但状态不是IDLE，当前状态: %d", _status);
+                DEBUG_WARNF("⚠️ 收到START命令但状态不是IDLE，当前状态: %d", (int)status);
                 // 如果不是 IDLE，强制重置
                 reset();
-                updateStatus(OTAStatus::READY);
             }
+            // 新会话：旧断点作废
+            _checkpointStore.clear();
+            do {
+                _sessionId = esp_random();
+            } while (_sessionId == 0);
+            // START 第 2 个字节为协议版本：1 = 带顺序号/偏移的包头 + 滑动窗口 + ACK
+            _protocol = (len >= 2) ? data[1] : 0;
+            // 第 3 个字节为标志位：bit0 = raw deflate 压缩（窗口 4KB），bit1 = 差分补丁（基于当前运行分区）
+            _streamFlags = (len >= 3) ? (data[2] & OTA_STREAM_FLAGS) : 0;
+            if (_streamFlags & OTAFlashWriter::STREAM_DEFLATE) {
+                DEBUG_INFO("📦 数据流为压缩数据，写入时解压");
+            }
+            if (_streamFlags & OTAFlashWriter::STREAM_PATCH) {
+                DEBUG_INFO("🩹 数据流为差分补丁，基于当前运行分区重建镜像");
+            }
+            // [3-6] 镜像大小，[7-38] 镜像 SHA-256（均指最终写入 Flash 的镜像，与压缩/差分无关）
+            _image = OTAImageInfo();
+            if (len >= 7) {
+                memcpy(&_image.size, &data[3], sizeof(_image.size));
+                _totalSize = _image.size;
+                const esp_partition_t* next = esp_ota_get_next_update_partition(NULL);
+                if (next && _image.size > next->size) {
+                    DEBUG_ERRORF("❌ 声明的镜像大小 %u 超出更新分区（%u 字节）", _image.size, next->size);
+                    updateStatus(OTAStatus::FAILED);
+                    break;
+                }
+            }
+            if (len >= 7 + sizeof(_image.sha256)) {
+                memcpy(_image.sha256, &data[7], sizeof(_image.sha256));
+                _image.hasDigest = true;
+            }
+            if (_image.size > 0) {
+                DEBUG_INFOF("📥 镜像大小 %u 字节%s", _image.size, _image.hasDigest ? "，写入时校验 SHA-256" : "");
+            }
+            if (_protocol == OTA_PACKET_VERSION) {
+                if (!setupWindow(0, 0)) {
+                    updateStatus(OTAStatus::FAILED);
+                    break;
+                }
+                DEBUG_INFOF("📥 使用 v%d 分包协议，接收窗口 %d 字节", _protocol, OTA_WINDOW_BYTES);
+            } else if (_protocol != 0) {
+                DEBUG_ERRORF("❌ 不支持的OTA协议版本: %d", _protocol);
+                updateStatus(OTAStatus::FAILED);
+                break;
+            }
+            updateStatus(OTAStatus::READY);
+            sendSessionInfo(OTA_SESSION_CONTINUE, _sessionId, 0, 0);     // 告知 APP 会话 ID，断线后凭它续传
             break;
             
         case OTAControlCommand::CANCEL:
             DEBUG_INFO("❌ 取消OTA升级");
             reset();
+            _checkpointStore.clear();
+            break;
+
+        case OTAControlCommand::RESUME:
+            processResume(data, len);
             break;
             
         case OTAControlCommand::CONFIRM:
-            if (_status == OTAStatus::UPDATING || _status == OTAStatus::READY) {
+            if (status == OTAStatus::UPDATING || status == OTAStatus::READY) {
                 DEBUG_INFO("✅ 收到CONFIRM命令，准备结束OTA升级");
-                if (endUpdate()) {
+                bool ok = endUpdate();
+                _checkpointStore.clear();           // 成功或镜像无效，断点都不再有用
+                if (ok) {
                     updateStatus(OTAStatus::COMPLETE);
-                    DEBUG_INFO("✅ OTA更新成功完成");
+                    // 吞吐量与日志开销对照（FAST_LOG_LEVEL 不同的两次构建各升级一次，比较这一行）
+                    DEBUG_INFOF("✅ OTA更新成功完成: %u 字节，平均 %u KB/s，Flash 忙碌 %u ms，日志 %u 条（丢弃 %u 条，级别 %d）",
+                                _writer.bytesWritten(), _writer.throughputKBps(), _writer.flashBusyMicros() / 1000,
+                                FastLog::recordCount(), FastLog::droppedCount(), FAST_LOG_LEVEL);
+                    FastLog::flush();
                     delay(1000);
                     esp_restart();
                 } else {
@@ -151,7 +256,7 @@ void OTAController::processControlCommand(const std::vector<uint8_t>& data) {
                     DEBUG_ERROR("❌ OTA更新结束失败");
                 }
             } else {
-                DEBUG_WARNF("⚠️ 收到CONFIRM命令但状态不是UPDATING/READY，当前状态: %d", _status);
+                DEBUG_WARNF("⚠️ 收到CONFIRM命令但状态不是UPDATING/READY，当前状态: %d", (int)status);
             }
             break;
             
@@ -161,9 +266,10 @@ void OTAController::processControlCommand(const std::vector<uint8_t>& data) {
     }
 }
 
-void OTAController::processDataPacket(const std::vector<uint8_t>& data) {
-    if (_status != OTAStatus::UPDATING && _status != OTAStatus::READY) {
-        DEBUG_ERRORF("❌ 收到数据包但OTA未就绪, 当前状态: %d", _status);
+void OTAController::processDataPacket(const uint8_t* data, size_t len) {
+    OTAStatus status = _status.load(std::memory_order_acquire);
+    if (status != OTAStatus::UPDATING && status != OTAStatus::READY) {
+        FLOG_ERROR("❌ 收到数据包但OTA未就绪, 当前状态: %d", (int)status);
         return;
     }
 
@@ -171,47 +277,192 @@ void OTAController::processDataPacket(const std::vector<uint8_t>& data) {
         DEBUG_INFO("📥 收到第一个数据包，准备开始OTA更新");
         if (!startUpdate()) {
             DEBUG_ERROR("❌ OTA更新初始化失败，状态将设置为FAILED");
-            updateStatus(OTAStatus::FAILED);
+            transitionStatus(OTAStatus::READY, OTAStatus::FAILED);
             return;
         }
     }
 
-    // 写入数据
-    esp_err_t err = esp_ota_write(_updateHandle, data.data(), data.size());
-    if (err != ESP_OK) {
-        DEBUG_ERRORF("❌ OTA写入失败: %s (错误码: %d)", esp_err_to_name(err), err);
-        updateStatus(OTAStatus::FAILED);
+    if (_protocol == OTA_PACKET_VERSION) {
+        processSequencedPacket(data, len);
         return;
     }
 
-    _currentSize += data.size();
-    DEBUG_INFOF("📥 已累计接收: %d 字节，剩余堆内存: %u 字节", _currentSize, ESP.getFreeHeap());
+    // 旧协议在 bleWriteTask 中处理（见 handleData）：写入暂存缓冲，两个缓冲都在写 Flash 时在这里等，不影响 BLE 回调
+    uint32_t waitStart = millis();
+    while (!_writer.write(data, len)) {
+        if (_writer.failed()) {
+            FLOG_ERROR("❌ OTA写入失败: %s (错误码: %d)", esp_err_to_name(_writer.lastError()), _writer.lastError());
+            transitionStatus(OTAStatus::UPDATING, OTAStatus::FAILED);
+            return;
+        }
+        if (millis() - waitStart >= OTA_LEGACY_WAIT_MS) {
+            FLOG_ERROR("❌ OTA暂存缓冲等待超时，Flash 写入跟不上");
+            transitionStatus(OTAStatus::UPDATING, OTAStatus::FAILED);
+            return;
+        }
+        vTaskDelay(1);
+    }
+
+    _currentSize += len;
     // 不在这里结束OTA，由CONFIRM命令触发endUpdate
 }
 
+void OTAController::processSequencedPacket(const uint8_t* data, size_t len) {
+    OTAPacketHeader header;
+    if (!OTAReceiveWindow::parseHeader(data, len, header)) {
+        FLOG_ERROR("❌ OTA数据包头无效（长度 %u）", (unsigned)len);
+        ++_rejectedPackets;
+        return;
+    }
+
+    xSemaphoreTake(_windowLock, portMAX_DELAY);
+    OTAReceiveWindow::Result result = _window.accept(header, data + OTA_PACKET_HEADER_SIZE,
+                                                     len - OTA_PACKET_HEADER_SIZE, _writer);
+    _currentSize = _window.nextOffset();
+    bool gap = _window.hasGap();
+    xSemaphoreGive(_windowLock);
+
+    switch (result) {
+        case OTAReceiveWindow::Result::ACCEPTED:
+            if (gap) _ackPending = true;            // 有空缺：尽快让 APP 知道该重传哪些包
+            break;
+        case OTAReceiveWindow::Result::DUPLICATE:
+        case OTAReceiveWindow::Result::OUT_OF_WINDOW:
+            _ackPending = true;
+            break;
+        case OTAReceiveWindow::Result::BUSY:        // Flash 写入跟不上：丢包等重传，不阻塞 BLE 回调
+            FLOG_DEBUG("⏳ OTA暂存缓冲已满，丢弃 seq=%u 等待重传", header.seq);
+            _ackPending = true;
+            break;
+        case OTAReceiveWindow::Result::INVALID:
+            FLOG_ERROR("❌ OTA数据包与已接收数据矛盾: seq=%u offset=%u", header.seq, header.offset);
+            ++_rejectedPackets;
+            _ackPending = true;
+            break;
+        case OTAReceiveWindow::Result::SINK_ERROR:
+            FLOG_ERROR("❌ OTA写入失败: %s (错误码: %d)", esp_err_to_name(_writer.lastError()), _writer.lastError());
+            transitionStatus(OTAStatus::UPDATING, OTAStatus::FAILED);
+            break;
+    }
+}
+
+// ACK 通知帧（OTAStatus 特征，小端）：
+//   [0]    0xA1（与状态帧区分，状态值只用 0~4）
+//   [1-2]  nextSeq：期望的下一个序号（累计确认）
+//   [3-6]  nextOffset：之前的数据已全部收到
+//   [7-14] sack：第 i 位 = seq (nextSeq + 1 + i) 已收到（64 位，覆盖整个接收窗口）
+void OTAController::sendAck() {
+    if (!_transport || !_windowLock) return;
+    xSemaphoreTake(_windowLock, portMAX_DELAY);
+    OTAAckState ack = _window.ackState();
+    xSemaphoreGive(_windowLock);
+
+    uint8_t frame[15];
+    frame[0] = OTA_ACK_FRAME;
+    memcpy(&frame[1], &ack.nextSeq, sizeof(ack.nextSeq));
+    memcpy(&frame[3], &ack.nextOffset, sizeof(ack.nextOffset));
+    memcpy(&frame[7], &ack.sack, sizeof(ack.sack));
+    if (_transport->isConnected()) {
+        _transport->notify(_statusHandle, frame, sizeof(frame));
+    }
+    _ackPending = false;
+    _lastAckMs = millis();
+}
+
 void OTAController::updateStatus(OTAStatus newStatus) {
-    _status = newStatus;
-    DEBUG_INFOF("[OTA] 状态变更为: %d，当前剩余堆内存: %u 字节", (int)newStatus, ESP.getFreeHeap());
+    _status.store(newStatus, std::memory_order_release);
+    announceStatus(newStatus);
+}
+
+// 只有当前状态仍是 from 时才切换到 to；状态已被其它任务改掉时返回 false，不覆盖
+bool OTAController::transitionStatus(OTAStatus from, OTAStatus to) {
+    if (!_status.compare_exchange_strong(from, to, std::memory_order_acq_rel)) {
+        FLOG_WARN("⚠️ OTA状态已变为 %d，放弃切换到 %d", (int)from, (int)to);
+        return false;
+    }
+    announceStatus(to);
+    return true;
+}
+
+void OTAController::announceStatus(OTAStatus status) {
+    hintLink();                                 // START 之后立即切到批量传输参数，不等下一次 update()
+    DEBUG_INFOF("[OTA] 状态变更为: %d，当前剩余堆内存: %u 字节", (int)status, ESP.getFreeHeap());
     notifyStatus();
 }
 
+// 状态通知帧（小端）：
+//   [0]   状态（OTAStatus），只读第 1 个字节的旧版 APP 不受影响
+//   [1-4] 已接收字节数
+//   [5-6] 持续写入速率（KB/s）
+//   [7]   进度百分比（按 START 声明的镜像大小，未声明时为 0xFF）
 void OTAController::notifyStatus() {
-    if (!_bleServer) {
-        DEBUG_ERROR("❌ BLE服务器未设置，无法发送OTA状态通知");
+    if (!_transport) {
+        DEBUG_ERROR("❌ 传输层未设置，无法发送OTA状态通知");
         return;
     }
 
-    uint8_t status = static_cast<uint8_t>(_status);
-    DEBUG_INFOF("📤 准备发送OTA状态通知: %d", status);
-    if (_bleServer->isConnected()) {
-        _bleServer->notify(OTA_STATUS_UUID, &status, sizeof(status));
+    uint8_t frame[8];
+    uint32_t received = _currentSize;
+    uint16_t kbps = _updateStarted ? (uint16_t)_writer.throughputKBps() : 0;
+    frame[0] = static_cast<uint8_t>(_status.load(std::memory_order_acquire));
+    memcpy(&frame[1], &received, sizeof(received));
+    memcpy(&frame[5], &kbps, sizeof(kbps));
+    frame[7] = _updateStarted ? _writer.progressPercent() : (_image.size > 0 ? 0 : 0xFF);
+    if (_transport->isConnected()) {
+        _transport->notify(_statusHandle, frame, sizeof(frame));
     }
-    
-    DEBUG_INFOF("✅ OTA状态通知已发送: %d", status);
+    FLOG_DEBUG("📤 OTA状态通知已发送: %d", frame[0]);
+}
+
+// 会话进行中（含断点恢复）持续提示批量传输档位；挂起或结束后停止提示，链路在保持期后自动回落
+void OTAController::hintLink() {
+    if (!_transport) return;
+    OTAStatus status = _status.load(std::memory_order_acquire);
+    if (status == OTAStatus::READY || status == OTAStatus::UPDATING || status == OTAStatus::RESUMING) {
+        _transport->hintWorkload(LinkWorkload::BULK);
+    }
+}
+
+void OTAController::notifyProgress() {
+    uint32_t now = millis();
+    if (now - _lastProgressMs < PROGRESS_INTERVAL_MS) return;
+    _lastProgressMs = now;
+    FLOG_INFO("📊 OTA进度: 已接收 %u 字节，已写入 %u / %u 字节，速率 %u KB/s，Flash 忙碌 %u ms",
+              (unsigned)_currentSize, _writer.bytesWritten(), (unsigned)_totalSize, _writer.throughputKBps(),
+              _writer.flashBusyMicros() / 1000);
+    notifyStatus();
 }
 
 bool OTAController::startUpdate() {
     DEBUG_INFO("🔄 开始OTA更新流程...");
+    if (!beginPartition()) {
+        return false;
+    }
+
+    // 原始数据流会话由写入任务周期性保存断点，断线/重启后可以从断点续传
+    OTACheckpoint checkpoint;
+    checkpoint.magic = OTACheckpoint::MAGIC;
+    checkpoint.sessionId = _sessionId;
+    checkpoint.partitionAddress = _updatePartition->address;
+    checkpoint.imageSize = _image.size;
+    checkpoint.hasDigest = _image.hasDigest;
+    memcpy(checkpoint.sha256, _image.sha256, sizeof(checkpoint.sha256));
+    checkpoint.protocol = _protocol;
+
+    if (!_writer.start(_updateHandle, _streamFlags, _image, &checkpoint)) {
+        DEBUG_ERROR("❌ OTA写入流水线启动失败");
+        esp_ota_abort(_updateHandle);
+        _updateHandle = 0;
+        return false;
+    }
+
+    DEBUG_INFO("✅ OTA更新初始化成功");
+    _updateStarted = true;
+    transitionStatus(OTAStatus::READY, OTAStatus::UPDATING);   // 期间被 CANCEL / 断开改掉的状态不覆盖
+    return true;
+}
+
+bool OTAController::beginPartition() {
     
     // 确保之前的更新已经清理
     if (_updateStarted || _updateHandle != 0) {
@@ -246,8 +497,8 @@ bool OTAController::startUpdate() {
         return false;
     }
 
-    // 尝试开始 OTA
-    esp_err_t err = esp_ota_begin(_updatePartition, OTA_SIZE_UNKNOWN, &_updateHandle);
+    // 尝试开始 OTA：顺序写入模式下由写入任务按扇区边写边擦，不在这里一次性擦除整个分区
+    esp_err_t err = esp_ota_begin(_updatePartition, OTA_BEGIN_SIZE, &_updateHandle);
     if (err != ESP_OK) {
         DEBUG_ERRORF("❌ OTA开始失败: %s (错误码: %d)", esp_err_to_name(err), err);
         
@@ -271,7 +522,7 @@ bool OTAController::startUpdate() {
             }
             
             // 4. 重试 OTA 开始
-            err = esp_ota_begin(_updatePartition, OTA_SIZE_UNKNOWN, &_updateHandle);
+            err = esp_ota_begin(_updatePartition, OTA_BEGIN_SIZE, &_updateHandle);
             if (err != ESP_OK) {
                 DEBUG_ERRORF("❌ 修复后OTA开始仍然失败: %s (错误码: %d)", esp_err_to_name(err), err);
                 return false;
@@ -282,9 +533,6 @@ bool OTAController::startUpdate() {
         }
     }
     
-    DEBUG_INFO("✅ OTA更新初始化成功");
-    _updateStarted = true;
-    updateStatus(OTAStatus::UPDATING);
     return true;
 }
 
@@ -293,6 +541,11 @@ bool OTAController::endUpdate() {
         return false;
     }
 
+    // 先把暂存缓冲中剩余的数据写完
+    if (!_writer.finish()) {
+        return false;
+    }
+
     esp_err_t err = esp_ota_end(_updateHandle);
     if (err != ESP_OK) {
         DEBUG_ERRORF("❌ OTA结束失败: %d", err);
@@ -313,25 +566,237 @@ void OTAController::reset() {
     
     if (_updateStarted) {
         DEBUG_INFO("⚠️ 中止未完成的 OTA 更新");
+        _writer.abort();                    // 等写入任务放下旧句柄后再 abort
         esp_ota_abort(_updateHandle);
     }
     
-    _status = OTAStatus::IDLE;
+    _status.store(OTAStatus::IDLE, std::memory_order_release);
     _totalSize = 0;
     _currentSize = 0;
     _updateStarted = false;
     _updatePartition = nullptr;
     _updateHandle = 0;
-    _buffer.clear();
+    _protocol = 0;
+    _streamFlags = 0;
+    _image = OTAImageInfo();
+    _sessionId = 0;
+    _ackPending = false;
+    _rejectedPackets = 0;
     
     notifyStatus();
 }
 
-void OTAController::setBLEServer(BLEServerWrapper* server) {
-    _bleServer = server;
-    DEBUG_INFO("✅ OTA控制器BLE服务器设置完成");
+void OTAController::setTransport(MessageTransport* transport) {
+    _transport = transport;
+    _controlHandle = transport->handleOf(OTA_CONTROL_UUID);    // 配置加载后驻留的句柄，消息分发时只比较整数
+    _dataHandle = transport->handleOf(OTA_DATA_UUID);
+    _statusHandle = transport->handleOf(OTA_STATUS_UUID);
+    DEBUG_INFOF("✅ OTA控制器传输层设置完成: %s", transport->transportName());
+}
+
+void OTAController::onDisconnect() {
+    // 与 update() 中的 RESUMING → UPDATING、写入失败等迁移并发：比较交换失败时按新状态重新判断
+    OTAStatus status = _status.load(std::memory_order_acquire);
+    do {
+        bool active = status == OTAStatus::READY || status == OTAStatus::UPDATING || status == OTAStatus::RESUMING;
+        if (!active || _sessionId == 0) {
+            reset();
+            return;
+        }
+        _suspendedAtMs = millis();              // 先于状态发布，update() 看到 SUSPENDED 时超时起点已就绪
+    } while (!_status.compare_exchange_weak(status, OTAStatus::SUSPENDED, std::memory_order_acq_rel));
+    // 保留会话（OTA 句柄、写入流水线、接收窗口）等待 APP 重连后 RESUME，并立即落一次断点
+    DEBUG_WARNF("⚠️ OTA升级中断线，会话 %08x 挂起（已接收 %u 字节），等待续传", _sessionId, (unsigned)_currentSize);
+    if (_updateStarted) {
+        _writer.checkpointNow();
+    }
 }
 
 void OTAController::update() {
-    // 定期检查状态并更新
-} 
\ No newline at end of file
+    hintLink();
+    OTAStatus status = _status.load(std::memory_order_acquire);
+    if (status == OTAStatus::RESUMING && !_writer.replaying()) {
+        if (_writer.failed()) {
+            DEBUG_ERROR("❌ OTA断点恢复失败，需要重新开始升级");
+            _checkpointStore.clear();
+            transitionStatus(OTAStatus::RESUMING, OTAStatus::FAILED);
+            return;
+        }
+        if (!transitionStatus(OTAStatus::RESUMING, OTAStatus::UPDATING)) return;   // 恢复期间断线或被取消
+        sendResumePoint(OTA_SESSION_CONTINUE);
+        status = OTAStatus::UPDATING;
+    }
+    if (status == OTAStatus::SUSPENDED && millis() - _suspendedAtMs >= OTA_SUSPEND_TIMEOUT_MS) {
+        // 释放内存中的会话；NVS 断点保留，APP 之后仍可 RESUME（从分区前缀恢复）
+        // 先把 SUSPENDED 换成 IDLE，与同时到达的 RESUME 只有一方能拿到这个会话
+        if (!_status.compare_exchange_strong(status, OTAStatus::IDLE, std::memory_order_acq_rel)) return;
+        DEBUG_WARN("⚠️ OTA会话挂起超时，释放会话");
+        reset();
+        return;
+    }
+
+    // 升级中定期推送进度（含持续写入速率）
+    if (status == OTAStatus::UPDATING) {
+        if (_writer.failed()) {
+            DEBUG_ERRORF("❌ OTA写入任务报告失败: %s", esp_err_to_name(_writer.lastError()));
+            transitionStatus(OTAStatus::UPDATING, OTAStatus::FAILED);
+            return;
+        }
+        if (_protocol == OTA_PACKET_VERSION) {
+            uint32_t now = millis();
+            uint32_t sinceAck = now - _lastAckMs;
+            if (sinceAck >= ACK_INTERVAL_MS || (_ackPending && sinceAck >= ACK_MIN_GAP_MS)) {
+                sendAck();
+            }
+        }
+        notifyProgress();
+    }
+} 
+// RESUME 命令：[0x03][sessionId u32]
+//   sessionId = 0（或省略）：只查询，回复会话帧描述当前可续传的会话
+//   sessionId ≠ 0：恢复该会话，回复会话帧（CONTINUE）给出续传点；从 NVS 断点恢复时先进入 RESUMING，
+//                 前缀校验完成后再回复
+void OTAController::processResume(const uint8_t* data, size_t len) {
+    uint32_t id = 0;
+    if (len >= 1 + sizeof(id)) {
+        memcpy(&id, &data[1], sizeof(id));
+    }
+
+    OTAStatus status = _status.load(std::memory_order_acquire);
+    bool live = _sessionId != 0 &&
+                (status == OTAStatus::READY || status == OTAStatus::UPDATING ||
+                 status == OTAStatus::SUSPENDED || status == OTAStatus::RESUMING);
+    if (live && (id == 0 || id == _sessionId)) {
+        if (id == 0) {
+            sendResumePoint(status == OTAStatus::SUSPENDED ? OTA_SESSION_SUSPENDED : OTA_SESSION_CONTINUE);
+            return;
+        }
+        if (status == OTAStatus::SUSPENDED) {
+            DEBUG_INFOF("🔄 恢复挂起的OTA会话 %08x（已接收 %u 字节）", _sessionId, (unsigned)_currentSize);
+            // 前缀还在恢复时先进入 RESUMING，完成后由 update() 回复续传点
+            status = _writer.replaying() ? OTAStatus::RESUMING
+                                         : (_updateStarted ? OTAStatus::UPDATING : OTAStatus::READY);
+            if (!transitionStatus(OTAStatus::SUSPENDED, status)) {
+                // 挂起超时，会话刚被 update() 释放：按没有内存会话处理，APP 重新查询后从 NVS 断点续传
+                sendSessionInfo(OTA_SESSION_NONE, 0, 0, 0);
+                return;
+            }
+        }
+        if (status != OTAStatus::RESUMING) {
+            sendResumePoint(OTA_SESSION_CONTINUE);
+        }
+        return;
+    }
+
+    OTACheckpoint checkpoint;
+    bool saved = _checkpointStore.load(checkpoint);
+    if (id == 0) {
+        if (saved) {
+            sendSessionInfo(OTA_SESSION_SAVED, checkpoint.sessionId, checkpoint.offset, 0);
+        } else {
+            sendSessionInfo(OTA_SESSION_NONE, 0, 0, 0);
+        }
+        return;
+    }
+    if (!saved || checkpoint.sessionId != id) {
+        DEBUG_WARNF("⚠️ 找不到可续传的OTA会话 %08x", id);
+        sendSessionInfo(OTA_SESSION_NONE, 0, 0, 0);
+        return;
+    }
+    if (!resumeFromCheckpoint(checkpoint)) {
+        _checkpointStore.clear();
+        updateStatus(OTAStatus::FAILED);
+        sendSessionInfo(OTA_SESSION_NONE, 0, 0, 0);
+    }
+}
+
+bool OTAController::resumeFromCheckpoint(const OTACheckpoint& checkpoint) {
+    reset();
+    if (!OTA_SAVED_RESUME) {
+        DEBUG_WARN("⚠️ esp_ota_begin 会擦除整个分区，无法从 NVS 断点续传，需要重新 START");
+        return false;
+    }
+
+    const esp_partition_t* next = esp_ota_get_next_update_partition(NULL);
+    if (!next || next->address != checkpoint.partitionAddress || checkpoint.offset > next->size) {
+        DEBUG_ERROR("❌ OTA断点对应的更新分区已变化，无法续传");
+        return false;
+    }
+
+    _sessionId = checkpoint.sessionId;
+    _protocol = checkpoint.protocol;
+    _streamFlags = 0;
+    _image.size = checkpoint.imageSize;
+    _image.hasDigest = checkpoint.hasDigest != 0;
+    memcpy(_image.sha256, checkpoint.sha256, sizeof(_image.sha256));
+    _totalSize = _image.size;
+    // 断点之后 seq 从 0 重新编号，偏移沿用数据流偏移
+    if (_protocol == OTA_PACKET_VERSION && !setupWindow(checkpoint.offset, 0)) {
+        return false;
+    }
+    // 前缀必须在 esp_ota_begin 之前校验：之后写入任务从分区回读前缀重放，begin 不能动这些扇区
+    if (!OTAFlashWriter::verifyPrefix(next, checkpoint.offset, checkpoint.crc32)) {
+        return false;
+    }
+    if (!beginPartition()) {
+        return false;
+    }
+    if (!_writer.resume(_updateHandle, _updatePartition, _image, checkpoint)) {
+        DEBUG_ERROR("❌ OTA写入流水线启动失败");
+        esp_ota_abort(_updateHandle);
+        _updateHandle = 0;
+        return false;
+    }
+
+    DEBUG_INFOF("🔄 从NVS断点恢复OTA会话 %08x: 偏移 %u / %u 字节", _sessionId, checkpoint.offset, checkpoint.imageSize);
+    _updateStarted = true;
+    _currentSize = checkpoint.offset;
+    updateStatus(OTAStatus::RESUMING);
+    return true;
+}
+
+// 会话帧（OTAStatus 特征，小端）：
+//   [0]    0xA2
+//   [1]    状态：0 无会话 / 1 挂起 / 2 仅有 NVS 断点 / 3 从 offset、seq 继续发送
+//   [2-5]  sessionId
+//   [6-9]  续传偏移（数据流偏移）
+//   [10-11] 续传 seq（v1 协议）
+void OTAController::sendSessionInfo(uint8_t state, uint32_t sessionId, uint32_t offset, uint16_t seq) {
+    if (!_transport) return;
+    uint8_t frame[12];
+    frame[0] = OTA_SESSION_FRAME;
+    frame[1] = state;
+    memcpy(&frame[2], &sessionId, sizeof(sessionId));
+    memcpy(&frame[6], &offset, sizeof(offset));
+    memcpy(&frame[10], &seq, sizeof(seq));
+    DEBUG_INFOF("📤 OTA会话帧: 状态 %u，会话 %08x，偏移 %u，seq %u", state, sessionId, offset, seq);
+    if (_transport->isConnected()) {
+        _transport->notify(_statusHandle, frame, sizeof(frame));
+    }
+}
+
+void OTAController::sendResumePoint(uint8_t state) {
+    uint32_t offset = _currentSize;
+    uint16_t seq = 0;
+    if (_protocol == OTA_PACKET_VERSION) {
+        xSemaphoreTake(_windowLock, portMAX_DELAY);
+        OTAAckState ack = _window.ackState();
+        xSemaphoreGive(_windowLock);
+        offset = ack.nextOffset;
+        seq = ack.nextSeq;
+        _ackPending = true;                         // 紧接着补发一次 ACK，带上 sack 位图
+    }
+    sendSessionInfo(state, _sessionId, offset, seq);
+}
+
+bool OTAController::setupWindow(uint32_t startOffset, uint16_t startSeq) {
+    if (!_windowBuffer) {
+        _windowBuffer = (uint8_t*)malloc(OTA_WINDOW_BYTES);
+    }
+    if (!_windowBuffer || !_windowLock) {
+        DEBUG_ERROR("❌ OTA接收窗口分配失败");
+        return false;
+    }
+    _window.reset(_windowBuffer, OTA_WINDOW_BYTES, startOffset, startSeq);
+    return true;
+}
@@ -5,10 +5,31 @@
 #include <esp_ota_ops.h>
 #include <esp_partition.h>
 #include <esp_system.h>
+#include <atomic>
 #include <vector>
 #include <string>
 #include "MessageConsumer.h"
-#include "drivers/BLE/BLEServerWrapper.h"
+#include "drivers/Transport/MessageTransport.h"
+#include "OTAFlashWriter.h"
+#include "OTAReceiveWindow.h"
+#include "OTACheckpoint.h"
+#include <freertos/semphr.h>
+
+#ifndef OTA_WINDOW_BYTES
+#define OTA_WINDOW_BYTES (8 * 1024)         // v1 协议的重排缓冲（接收窗口）大小
+#endif
+
+#ifndef OTA_CHECKPOINT_BYTES
+#define OTA_CHECKPOINT_BYTES (64 * 1024)    // 每写入这么多字节保存一次 NVS 断点（越小续传越省流量，NVS 写入越多）
+#endif
+
+#ifndef OTA_LEGACY_WAIT_MS
+#define OTA_LEGACY_WAIT_MS 500              // 旧协议在 bleWriteTask 中等暂存缓冲的上限，超时判定 Flash 写入跟不上
+#endif
+
+#ifndef OTA_SUSPEND_TIMEOUT_MS
+#define OTA_SUSPEND_TIMEOUT_MS (5 * 60 * 1000)  // 断线后会话在内存中保留的时间，超时后只保留 NVS 断点
+#endif
 
 // OTA状态枚举
 enum class OTAStatus {
@@ -16,14 +37,17 @@ enum class OTAStatus {
     READY = 1,          // 准备升级
     UPDATING = 2,       // 升级中
     COMPLETE = 3,       // 升级完成
-    FAILED = 4          // 升级失败
+    FAILED = 4,         // 升级失败
+    SUSPENDED = 5,      // 升级中断线，会话保留，等待 RESUME
+    RESUMING = 6        // 正在从 NVS 断点恢复（回读校验分区前缀）
 };
 
 // OTA控制命令枚举
 enum class OTAControlCommand {
     START = 0,          // 开始升级
     CANCEL = 1,         // 取消升级
-    CONFIRM = 2         // 确认升级
+    CONFIRM = 2,        // 确认升级
+    RESUME = 3          // 查询/恢复会话（断线续传）
 };
 
 class OTAController : public MessageConsumer {
@@ -32,27 +56,70 @@ public:
     void begin() override;  // 实现基类的虚函数
     bool initOTA();        // 新增：实际的初始化函数
     void handleMessage(const BLEWriteMessage& msg) override;
+    // OTAData 写入回调直通入口（不经过负载池和队列，不阻塞）；返回 false 表示旧协议数据，调用方改为入队
+    bool handleData(const uint8_t* data, size_t len);
     void update();
-    void setBLEServer(BLEServerWrapper* server);
+    void setTransport(MessageTransport* transport);
     void reset();
-    OTAStatus getStatus() const { return _status; }
+    void onDisconnect();    // BLE 断开：升级中的会话挂起等待续传，否则重置
+    OTAStatus getStatus() const { return _status.load(std::memory_order_acquire); }
+    void registerMetrics() { _writer.registerMetrics(); }   // 登记到 Metrics：写入速率、Flash 写入耗时
 
 private:
-    void processControlCommand(const std::vector<uint8_t>& data);
-    void processDataPacket(const std::vector<uint8_t>& data);
+    void processControlCommand(const uint8_t* data, size_t len);
+    void processDataPacket(const uint8_t* data, size_t len);
+    void processSequencedPacket(const uint8_t* data, size_t len);
     void updateStatus(OTAStatus newStatus);
+    bool transitionStatus(OTAStatus from, OTAStatus to);
+    void announceStatus(OTAStatus status);
     void notifyStatus();
+    void notifyProgress();
+    void hintLink();                    // 会话进行中提示传输层切到批量传输链路参数
+    void sendAck();
+    void processResume(const uint8_t* data, size_t len);
+    bool resumeFromCheckpoint(const OTACheckpoint& checkpoint);
+    void sendSessionInfo(uint8_t state, uint32_t sessionId, uint32_t offset, uint16_t seq);
+    void sendResumePoint(uint8_t state);
+    bool setupWindow(uint32_t startOffset, uint16_t startSeq);
+    bool beginPartition();
     bool startUpdate();
     bool endUpdate();
 
-    OTAStatus _status;
+    // 状态由三个任务修改：BLE 回调（数据包、断开）、bleWriteTask（控制命令）、loop 任务（update）
+    // 控制命令是用户的明确意图，用 updateStatus 直接覆盖；其余迁移用 transitionStatus 比较交换，
+    // 状态已被其它任务改掉时放弃（例如 CANCEL 之后迟到的写入失败不会把 IDLE 改回 FAILED）
+    std::atomic<OTAStatus> _status;
     size_t _totalSize;
     size_t _currentSize;
     bool _updateStarted;
     const esp_partition_t* _updatePartition;
     esp_ota_handle_t _updateHandle;
-    std::vector<uint8_t> _buffer;
-    static const size_t BUFFER_SIZE = 1024;  // 1KB缓冲区
-    BLEServerWrapper* _bleServer = nullptr;
+    OTAFlashWriter _writer;                  // 扇区对齐的双缓冲写入流水线（独立任务写 Flash）
+    uint32_t _lastProgressMs = 0;
+    static const uint32_t PROGRESS_INTERVAL_MS = 500;  // 升级中进度通知间隔
+
+    // v1 顺序号/窗口协议（START 命令第 2 个字节为 1 时启用，否则按旧协议直接追加）
+    uint8_t _protocol = 0;
+    uint8_t _streamFlags = 0;                           // START 标志位：压缩 / 差分（OTAFlashWriter::STREAM_*）
+    OTAImageInfo _image;                                // START 声明的镜像大小与 SHA-256
+
+    // 断线续传
+    OTACheckpointStore _checkpointStore;
+    uint32_t _sessionId = 0;                            // START 时生成，RESUME 时用来匹配会话
+    uint32_t _suspendedAtMs = 0;
+    OTAReceiveWindow _window;
+    uint8_t* _windowBuffer = nullptr;                   // 重排缓冲，首次使用 v1 协议时分配
+    SemaphoreHandle_t _windowLock = nullptr;            // 保护窗口状态（BLE 回调写入 / loop 任务读取 ACK）
+    volatile bool _ackPending = false;                  // 出现乱序/重复/越界时尽快补发一次 ACK
+    uint32_t _lastAckMs = 0;
+    uint32_t _rejectedPackets = 0;
+    static const uint32_t ACK_INTERVAL_MS = 100;        // 周期 ACK 间隔
+    static const uint32_t ACK_MIN_GAP_MS = 20;          // 两次 ACK 的最小间隔
+    MessageTransport* _transport = nullptr;
+    CharHandle _controlHandle = INVALID_CHAR_HANDLE;    // OTAControl 特征句柄
+    CharHandle _dataHandle = INVALID_CHAR_HANDLE;       // OTAData 特征句柄
+    CharHandle _statusHandle = INVALID_CHAR_HANDLE;     // OTAStatus 特征句柄（通知直接按句柄投递）
     static const char* OTA_STATUS_UUID;
+    static const char* OTA_CONTROL_UUID;
+    static const char* OTA_DATA_UUID;
 }; 
\ No newline at end of file
@@ -0,0 +1,508 @@
+#include "OTAFlashWriter.h"
+#include "serial_color_debug.h"
+#include "utils/FastLog.h"
+#include "utils/Metrics.h"
+#include <freertos/task.h>
+#include <esp_rom_crc.h>
+
+#ifndef OTA_WRITER_CORE
+#define OTA_WRITER_CORE 1           // Bluedroid 固定运行在 core 0，写入任务放到 core 1
+#endif
+
+bool OTAFlashWriter::begin() {
+    if (_task) return true;
+
+    _freeQueue = xQueueCreate(STAGING_SECTORS, sizeof(uint8_t));
+    _fullQueue = xQueueCreate(STAGING_SECTORS + 1, sizeof(Job));    // 数据任务 + 一个控制任务
+    _producerLock = xSemaphoreCreateMutex();
+    _drained = xSemaphoreCreateBinary();
+    if (!_freeQueue || !_fullQueue || !_producerLock || !_drained) {
+        DEBUG_ERROR("❌ OTA写入器队列创建失败");
+        return false;
+    }
+
+    BaseType_t ok = xTaskCreatePinnedToCore(taskEntry, "OTAFlashWriter", 4096, this, 2, &_task, OTA_WRITER_CORE);
+    if (ok != pdPASS) {
+        DEBUG_ERROR("❌ OTA写入任务创建失败");
+        _task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void OTAFlashWriter::setCheckpointStore(OTACheckpointStore* store, uint32_t intervalBytes) {
+    _checkpointStore = store;
+    _checkpointInterval = intervalBytes;
+}
+
+bool OTAFlashWriter::start(esp_ota_handle_t handle, uint8_t streamFlags, const OTAImageInfo& image,
+                           const OTACheckpoint* checkpoint) {
+    if (!_task && !begin()) return false;
+
+    xSemaphoreTake(_producerLock, portMAX_DELAY);
+    // 暂存缓冲在第一次 OTA 时才分配，之后常驻，避免写入任务仍在使用时被释放
+    for (size_t i = 0; i < STAGING_SECTORS; ++i) {
+        if (!_buffers[i]) {
+            _buffers[i] = (uint8_t*)malloc(SECTOR_SIZE);
+            if (!_buffers[i]) {
+                DEBUG_ERRORF("❌ OTA暂存缓冲分配失败（%u 字节）", (unsigned)SECTOR_SIZE);
+                xSemaphoreGive(_producerLock);
+                return false;
+            }
+        }
+    }
+
+    _session.fetch_add(1);              // 旧会话残留的任务会被写入任务丢弃
+    submitControl(CMD_RESET);           // 由写入任务释放上一个会话的资源
+    waitDrained(portMAX_DELAY);         // 旧任务会被立即丢弃，只需等正在写的一个扇区
+
+    xQueueReset(_freeQueue);
+    xQueueReset(_fullQueue);
+    for (uint8_t i = 0; i < STAGING_SECTORS; ++i) {
+        xQueueSend(_freeQueue, &i, 0);
+    }
+    // 写入任务此时空闲，可以在这里初始化它使用的解压器/补丁应用器
+    if ((streamFlags & STREAM_DEFLATE) && !_inflater.begin()) {
+        xSemaphoreGive(_producerLock);
+        return false;
+    }
+    if (streamFlags & STREAM_PATCH) {
+        _patchSource.begin(esp_ota_get_running_partition());
+        if (!_patcher.begin(_patchSource, _flashSink)) {
+            DEBUG_ERRORF("❌ 差分输出缓冲分配失败（%u 字节）", (unsigned)OTAPatchApplier::OUTPUT_SIZE);
+            _inflater.end();
+            xSemaphoreGive(_producerLock);
+            return false;
+        }
+    }
+    _handle = handle;
+    _streamFlags = streamFlags;
+    _image = image;
+    // 断点只对原始数据流有意义：压缩/差分会话的中间状态无法从 Flash 恢复
+    _checkpointing = checkpoint && _checkpointStore && _checkpointInterval > 0 && streamFlags == 0;
+    if (_checkpointing) {
+        _checkpoint = *checkpoint;
+    }
+    _crc = 0;
+    _replaying.store(false);
+    _fillIndex = -1;
+    _fillLength = 0;
+    _streamBytes = 0;
+    _failed.store(false);
+    _complete.store(false);
+    _lastError = ESP_OK;
+    _bytesWritten.store(0);
+    _bytesConsumed.store(0);
+    _flashMicros.store(0);
+    _startMicros = micros();
+    xSemaphoreGive(_producerLock);
+    return true;
+}
+
+bool OTAFlashWriter::resume(esp_ota_handle_t handle, const esp_partition_t* partition, const OTAImageInfo& image,
+                            const OTACheckpoint& checkpoint) {
+    if (!start(handle, 0, image, &checkpoint)) return false;
+
+    xSemaphoreTake(_producerLock, portMAX_DELAY);
+    _replayPartition = partition;
+    _replayBytes = checkpoint.offset;
+    _streamBytes = checkpoint.offset;
+    _replaying.store(true);
+    // 之后追加的数据排在 REPLAY 之后，写入任务会按顺序处理，不会与前缀交错
+    submitControl(CMD_REPLAY);
+    xSemaphoreGive(_producerLock);
+    return true;
+}
+
+// 在断线回调中调用：锁或队列一时拿不到就放弃，写入任务每 OTA_CHECKPOINT_BYTES 字节保存的断点仍然有效
+void OTAFlashWriter::checkpointNow() {
+    if (!_task || !_checkpointing) return;
+    if (xSemaphoreTake(_producerLock, pdMS_TO_TICKS(CHECKPOINT_WAIT_MS)) != pdTRUE) {
+        FLOG_WARN("⚠️ OTA断点请求超时，沿用上一次保存的断点");
+        return;
+    }
+    if (!submitControl(CMD_CHECKPOINT, pdMS_TO_TICKS(CHECKPOINT_WAIT_MS))) {
+        FLOG_WARN("⚠️ OTA写入队列已满，沿用上一次保存的断点");
+    }
+    xSemaphoreGive(_producerLock);
+}
+
+bool OTAFlashWriter::canAccept(size_t len) {
+    if (_failed.load()) return true;                // 交给 write() 报告失败
+    xSemaphoreTake(_producerLock, portMAX_DELAY);
+    bool ok = room() >= len;
+    xSemaphoreGive(_producerLock);
+    return ok;
+}
+
+bool OTAFlashWriter::write(const uint8_t* data, size_t len) {
+    if (_failed.load()) return false;
+
+    xSemaphoreTake(_producerLock, portMAX_DELAY);
+    // 原始数据流与镜像一一对应：超出声明大小在收到的那一刻就能判定，不必等写入任务
+    if (_streamFlags == 0 && _image.size > 0 && _streamBytes + len > _image.size) {
+        FLOG_ERROR("❌ OTA数据超出声明的镜像大小（%u 字节）", _image.size);
+        fail(ESP_ERR_INVALID_SIZE);
+        xSemaphoreGive(_producerLock);
+        return false;
+    }
+    // 两个缓冲都在写入任务手里：不等 Flash，整包拒收
+    if (room() < len) {
+        xSemaphoreGive(_producerLock);
+        return false;
+    }
+    _streamBytes += len;
+
+    bool ok = true;
+    while (len > 0) {
+        if (_fillIndex < 0 && !acquireFill()) {     // room() 已确认放得下，只有并发 abort 时才会走到这里
+            ok = false;
+            break;
+        }
+        size_t n = SECTOR_SIZE - _fillLength;
+        if (n > len) n = len;
+        memcpy(_buffers[_fillIndex] + _fillLength, data, n);
+        _fillLength += n;
+        data += n;
+        len -= n;
+        if (_fillLength == SECTOR_SIZE && !submitFill()) {
+            ok = false;
+            break;
+        }
+    }
+    xSemaphoreGive(_producerLock);
+    return ok && !_failed.load();
+}
+
+bool OTAFlashWriter::finish(uint32_t timeoutMs) {
+    xSemaphoreTake(_producerLock, portMAX_DELAY);
+    if (_fillIndex >= 0 && _fillLength > 0) {
+        submitFill();
+    }
+    submitControl(CMD_FINISH);
+    xSemaphoreGive(_producerLock);                  // 等待落盘期间不挡住 BLE 回调与断线回调
+    waitDrained(pdMS_TO_TICKS(timeoutMs));
+    bool ok = _pending.load() == 0 && _complete.load() && !_failed.load();
+    if (!ok) {
+        DEBUG_ERRORF("❌ OTA写入收尾失败: %s", esp_err_to_name(_lastError));
+    }
+    return ok;
+}
+
+void OTAFlashWriter::abort() {
+    if (!_task) return;
+    xSemaphoreTake(_producerLock, portMAX_DELAY);
+    _session.fetch_add(1);
+    if (_fillIndex >= 0) {
+        uint8_t index = (uint8_t)_fillIndex;
+        xQueueSend(_freeQueue, &index, 0);
+        _fillIndex = -1;
+        _fillLength = 0;
+    }
+    // RESET 排在所有在途任务之后：等它执行完，写入任务就不会再使用旧的 OTA 句柄，调用方可以安全地 esp_ota_abort
+    submitControl(CMD_RESET);
+    waitDrained(portMAX_DELAY);
+    xSemaphoreGive(_producerLock);
+}
+
+uint8_t OTAFlashWriter::progressPercent() const {
+    if (_image.size == 0) return 0xFF;
+    uint32_t pct = (uint32_t)((uint64_t)_bytesWritten.load() * 100 / _image.size);
+    return pct > 100 ? 100 : (uint8_t)pct;
+}
+
+void OTAFlashWriter::registerMetrics() {
+    Metrics::addCounter("ota.bytes_written", "B", _bytesWritten);
+    Metrics::addRate("ota.write_rate", "B/s", _bytesWritten);
+    Metrics::addHistogram("ota.flash_write", "us", _flashWriteTime);
+    // 写入任务在第一次会话时才创建，采样时再取句柄
+    Metrics::addProbe("stack.ota_writer", "B", [](void* writer) {
+        TaskHandle_t task = static_cast<OTAFlashWriter*>(writer)->_task;
+        return task ? (int32_t)uxTaskGetStackHighWaterMark(task) : 0;
+    }, this);
+}
+
+uint32_t OTAFlashWriter::throughputKBps() const {
+    uint32_t elapsed = micros() - _startMicros;
+    if (elapsed == 0) return 0;
+    return (uint32_t)((uint64_t)_bytesWritten.load() * 1000000ULL / elapsed / 1024);
+}
+
+bool OTAFlashWriter::submitFill() {
+    Job job{CMD_DATA, (uint8_t)_fillIndex, (uint16_t)_fillLength, _session.load()};
+    _pending.fetch_add(1);
+    _fillIndex = -1;
+    _fillLength = 0;
+    // 队列长度大于缓冲数量，不可能满；这里只是兜底
+    if (xQueueSend(_fullQueue, &job, portMAX_DELAY) != pdTRUE) {
+        _pending.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+bool OTAFlashWriter::submitControl(Command command, TickType_t timeout) {
+    Job job{command, NO_BUFFER, 0, _session.load()};
+    _pending.fetch_add(1);
+    if (xQueueSend(_fullQueue, &job, timeout) != pdTRUE) {
+        _pending.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+bool OTAFlashWriter::acquireFill() {
+    uint8_t index;
+    if (xQueueReceive(_freeQueue, &index, 0) != pdTRUE) return false;
+    _fillIndex = index;
+    _fillLength = 0;
+    return true;
+}
+
+// 空闲缓冲只由持锁的生产者取走，写入任务只会归还：持锁期间算出的容量不会变小
+size_t OTAFlashWriter::room() const {
+    size_t free = _fillIndex >= 0 ? SECTOR_SIZE - _fillLength : 0;
+    return free + (size_t)uxQueueMessagesWaiting(_freeQueue) * SECTOR_SIZE;
+}
+
+// finish() 不持锁等待，可能与 abort() 同时等：分段等待，另一方先拿走信号量时也能及时看到计数清零
+void OTAFlashWriter::waitDrained(TickType_t timeout) {
+    const TickType_t slice = pdMS_TO_TICKS(10) > 0 ? pdMS_TO_TICKS(10) : 1;
+    TickType_t start = xTaskGetTickCount();
+    while (_pending.load() > 0) {
+        TickType_t waited = xTaskGetTickCount() - start;
+        if (waited >= timeout) break;
+        TickType_t left = timeout - waited;
+        xSemaphoreTake(_drained, left < slice ? left : slice);
+    }
+}
+
+void OTAFlashWriter::fail(esp_err_t err) {
+    if (_failed.load()) return;
+    _lastError = err;
+    _failed.store(true);
+}
+
+bool OTAFlashWriter::flashWrite(const uint8_t* data, size_t len) {
+    // 解压/差分输出超过声明大小：镜像必然不对，立即失败，不再继续写 Flash
+    if (_image.size > 0 && _bytesWritten.load() + len > _image.size) {
+        DEBUG_ERRORF("❌ OTA镜像超出声明大小（%u 字节）", _image.size);
+        fail(ESP_ERR_INVALID_SIZE);
+        return false;
+    }
+
+    uint32_t t0 = micros();
+    esp_err_t err = esp_ota_write(_handle, data, len);
+    uint32_t elapsed = micros() - t0;
+    _flashMicros.fetch_add(elapsed);
+    _flashWriteTime.record(elapsed);
+    if (err != ESP_OK) {
+        fail(err);
+        DEBUG_ERRORF("❌ OTA写入失败: %s (错误码: %d)", esp_err_to_name(err), err);
+        return false;
+    }
+
+    if (_checkpointing) {
+        _crc = esp_rom_crc32_le(_crc, (const uint8_t*)data, len);
+    }
+    // 在写入路径上增量计算摘要，收尾时不必再把整个分区读一遍
+    if (_image.hasDigest) {
+        if (!_hashing) {
+            mbedtls_sha256_init(&_sha);
+            mbedtls_sha256_starts_ret(&_sha, 0);
+            _hashing = true;
+        }
+        mbedtls_sha256_update_ret(&_sha, data, len);
+    }
+    _bytesWritten.fetch_add(len);
+    return true;
+}
+
+bool OTAFlashWriter::PartitionSource::read(uint32_t offset, uint8_t* dst, size_t len) {
+    return _partition && esp_partition_read(_partition, offset, dst, len) == ESP_OK;
+}
+
+uint32_t OTAFlashWriter::PartitionSource::crc32(uint32_t len) {
+    uint8_t chunk[256];
+    uint32_t crc = 0;
+    for (uint32_t offset = 0; offset < len; offset += sizeof(chunk)) {
+        uint32_t n = len - offset < sizeof(chunk) ? len - offset : sizeof(chunk);
+        if (!read(offset, chunk, n)) return ~crc;   // 读取失败：返回取反的部分结果，与补丁头 CRC 相符的概率可忽略
+        crc = esp_rom_crc32_le(crc, chunk, n);
+    }
+    return crc;
+}
+
+void OTAFlashWriter::taskEntry(void* arg) {
+    static_cast<OTAFlashWriter*>(arg)->run();
+}
+
+void OTAFlashWriter::run() {
+    Job job;
+    while (true) {
+        if (xQueueReceive(_fullQueue, &job, portMAX_DELAY) != pdTRUE) continue;
+
+        switch (job.command) {
+            case CMD_DATA:
+                if (job.session == _session.load() && !_failed.load()) {
+                    processData(job);
+                    saveCheckpoint(false);
+                }
+                xQueueSend(_freeQueue, &job.index, 0);
+                break;
+            case CMD_FINISH:
+                if (job.session == _session.load() && !_failed.load()) {
+                    finalizeSession();
+                }
+                break;
+            case CMD_RESET:
+                releaseSession();
+                break;
+            case CMD_REPLAY:
+                if (job.session == _session.load()) {
+                    replayPrefix();
+                }
+                _replaying.store(false);
+                break;
+            case CMD_CHECKPOINT:
+                if (job.session == _session.load()) {
+                    saveCheckpoint(true);
+                }
+                break;
+        }
+
+        if (_pending.fetch_sub(1) == 1) {
+            xSemaphoreGive(_drained);
+        }
+    }
+}
+
+void OTAFlashWriter::processData(const Job& job) {
+    OTAStreamSink& image = imageSink();
+    bool ok = _inflater.active() ? _inflater.feed(_buffers[job.index], job.length, image)
+                                 : image.write(_buffers[job.index], job.length);
+    _bytesConsumed.fetch_add(job.length);
+    if (ok || _failed.load()) return;               // Flash / 大小错误已在 flashWrite 中记录
+
+    // 解压或补丁失败
+    if (_patcher.active() && _patcher.error() != OTAPatchApplier::Error::NONE) {
+        DEBUG_ERRORF("❌ 差分补丁应用失败: %s", OTAPatchApplier::errorName(_patcher.error()));
+        fail(_patcher.error() == OTAPatchApplier::Error::BASE_MISMATCH ? ESP_ERR_INVALID_CRC : ESP_ERR_INVALID_ARG);
+    } else {
+        fail(ESP_ERR_INVALID_ARG);
+    }
+}
+
+void OTAFlashWriter::finalizeSession() {
+    bool ok = true;
+    if (_inflater.active()) {
+        ok = _inflater.finish(imageSink());         // 确认压缩流完整，并写出最后一段解压数据
+    }
+    if (ok && _patcher.active()) {
+        ok = _patcher.finish();
+        if (ok) {
+            DEBUG_INFOF("🩹 差分升级完成: 补丁 %u 字节 → 镜像 %u 字节（复用 %u，新增 %u），用时 %u ms",
+                        _bytesConsumed.load(), _patcher.produced(), _patcher.copiedBytes(),
+                        _patcher.literalBytes(), (unsigned)((micros() - _startMicros) / 1000));
+        } else {
+            DEBUG_ERRORF("❌ 差分补丁不完整: %s", OTAPatchApplier::errorName(_patcher.error()));
+        }
+    }
+    if (!ok) {
+        fail(ESP_ERR_INVALID_ARG);
+    } else if (_image.size > 0 && _bytesWritten.load() != _image.size) {
+        DEBUG_ERRORF("❌ OTA镜像不完整: 声明 %u 字节，实际写入 %u 字节", _image.size, _bytesWritten.load());
+        fail(ESP_ERR_INVALID_SIZE);
+        ok = false;
+    } else if (_image.hasDigest) {
+        uint8_t digest[32];
+        if (!_hashing) {                            // 空镜像
+            mbedtls_sha256_init(&_sha);
+            mbedtls_sha256_starts_ret(&_sha, 0);
+            _hashing = true;
+        }
+        mbedtls_sha256_finish_ret(&_sha, digest);
+        if (memcmp(digest, _image.sha256, sizeof(digest)) != 0) {
+            char actual[65];
+            char expected[65];
+            for (size_t i = 0; i < sizeof(digest); ++i) {
+                sprintf(actual + i * 2, "%02x", digest[i]);
+                sprintf(expected + i * 2, "%02x", _image.sha256[i]);
+            }
+            DEBUG_ERRORF("❌ OTA镜像 SHA-256 不匹配\n   期望: %s\n   实际: %s", expected, actual);
+            fail(ESP_ERR_INVALID_CRC);
+            ok = false;
+        } else {
+            DEBUG_INFO("✅ OTA镜像 SHA-256 校验通过");
+        }
+    }
+    releaseSession();
+    _complete.store(ok);
+}
+
+void OTAFlashWriter::releaseSession() {
+    _inflater.end();
+    _patcher.end();
+    if (_hashing) {
+        mbedtls_sha256_free(&_sha);                 // 释放 SHA 硬件引擎（必须在使用它的任务中调用）
+        _hashing = false;
+    }
+}
+
+bool OTAFlashWriter::verifyPrefix(const esp_partition_t* partition, uint32_t bytes, uint32_t crc) {
+    uint8_t* buf = (uint8_t*)malloc(SECTOR_SIZE);
+    if (!buf) {
+        DEBUG_ERROR("❌ 断点校验缓冲分配失败");
+        return false;
+    }
+    uint32_t actual = 0;
+    bool ok = true;
+    for (uint32_t offset = 0; offset < bytes; offset += SECTOR_SIZE) {
+        uint32_t n = bytes - offset < SECTOR_SIZE ? bytes - offset : SECTOR_SIZE;
+        if (esp_partition_read(partition, offset, buf, n) != ESP_OK) {
+            ok = false;
+            break;
+        }
+        actual = esp_rom_crc32_le(actual, buf, n);
+    }
+    free(buf);
+    if (!ok || actual != crc) {
+        DEBUG_ERRORF("❌ OTA断点校验失败（%u 字节，CRC %08x / %08x）", bytes, actual, crc);
+        return false;
+    }
+    return true;
+}
+
+// 把已校验的前缀重新写入新的 OTA 句柄，恢复句柄的写入位置和 SHA-256 状态
+// 顺序写入模式下 esp_ota_write 在进入新扇区时才擦除该扇区，而这个扇区的内容已经先读进了缓冲
+void OTAFlashWriter::replayPrefix() {
+    uint32_t t0 = millis();
+    uint8_t* buf = (uint8_t*)malloc(SECTOR_SIZE);
+    if (!buf) {
+        DEBUG_ERROR("❌ 断点恢复缓冲分配失败");
+        fail(ESP_ERR_NO_MEM);
+        return;
+    }
+    for (uint32_t offset = 0; offset < _replayBytes; offset += SECTOR_SIZE) {
+        uint32_t n = _replayBytes - offset < SECTOR_SIZE ? _replayBytes - offset : SECTOR_SIZE;
+        if (esp_partition_read(_replayPartition, offset, buf, n) != ESP_OK) {
+            fail(ESP_ERR_INVALID_CRC);
+            break;
+        }
+        if (!flashWrite(buf, n)) break;
+    }
+    free(buf);
+    if (!_failed.load()) {
+        DEBUG_INFOF("✅ OTA断点恢复完成: %u 字节，用时 %u ms", _replayBytes, (unsigned)(millis() - t0));
+    }
+}
+
+void OTAFlashWriter::saveCheckpoint(bool force) {
+    if (!_checkpointing || _failed.load()) return;
+    uint32_t written = _bytesWritten.load();
+    if (written == _checkpoint.offset) return;
+    if (!force && written - _checkpoint.offset < _checkpointInterval) return;
+    _checkpoint.offset = written;
+    _checkpoint.crc32 = _crc;
+    _checkpointStore->save(_checkpoint);
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_ota_ops.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <mbedtls/sha256.h>
+#include <atomic>
+#include "OTAReceiveWindow.h"
+#include "OTAInflater.h"
+#include "OTAPatchApplier.h"
+#include "OTACheckpoint.h"
+#include "utils/LatencyHistogram.h"
+
+// 声明的目标镜像（START 命令携带）：写入 Flash 的字节数与 SHA-256
+struct OTAImageInfo {
+    uint32_t size = 0;                              // 0 表示未声明
+    bool hasDigest = false;
+    uint8_t sha256[32] = {};
+};
+
+// OTA 流水线写入器
+// BLE 回调只负责把数据拷进按扇区（4KB）对齐的暂存缓冲区，写满一个扇区就交给另一个核上的写入任务
+// 执行 esp_ota_write（含擦除），这样 BLE 接收和 Flash 编程可以重叠进行，不再阻塞 Bluedroid 协议栈
+//
+//   BLE 回调 ──write()──▶ [扇区缓冲 A] ──满──▶ _fullQueue ──▶ 写入任务 ──esp_ota_write──▶ Flash
+//                         [扇区缓冲 B] ◀──────── _freeQueue ◀──────── 写完归还
+//
+// 两个缓冲全部在途时 write() 不等待，整包拒收（不改动任何状态）：v1 协议由接收窗口丢包、APP 按 SACK 重传，
+// 背压体现为重传而不是阻塞 Bluedroid 协议栈；生产者锁只在拷贝与入队期间持有，等待落盘时不持有
+// 压缩会话中，写入任务先用 OTAInflater 解压，再按扇区写 Flash（解压同样不占用 BLE 回调的时间）
+// 差分会话中，数据流是补丁：OTAPatchApplier 从当前运行分区读取旧数据重建新镜像后再写 Flash
+//
+//   写入任务：数据流 ──▶ [OTAInflater] ──▶ [OTAPatchApplier ◀── 运行分区] ──▶ 大小检查 / SHA-256 ──▶ esp_ota_write
+//
+// 收尾和放弃也作为控制任务排进同一个队列由写入任务执行，SHA-256 硬件引擎的占用与释放始终在同一个任务内
+// 原始数据流会话每写入 OTA_CHECKPOINT_BYTES 字节由写入任务保存一次断点（偏移 + 前缀 CRC32），见 OTACheckpoint.h
+class OTAFlashWriter : public OTAStreamSink {
+public:
+    static const size_t SECTOR_SIZE = 4096;         // Flash 扇区大小，每次写入一个完整扇区
+    static const size_t STAGING_SECTORS = 2;        // 暂存扇区数量（双缓冲）
+    static const uint8_t STREAM_DEFLATE = 0x01;     // 数据流为 raw deflate 压缩
+    static const uint8_t STREAM_PATCH = 0x02;       // 数据流为差分补丁（可与压缩同时使用，先解压再应用）
+
+    bool begin();                                   // 创建写入任务与队列（只需调用一次）
+    void setCheckpointStore(OTACheckpointStore* store, uint32_t intervalBytes);
+    // 开始新的写入会话；image 声明了大小/摘要时，写入任务边写边校验；checkpoint 非空时周期性保存断点
+    bool start(esp_ota_handle_t handle, uint8_t streamFlags = 0, const OTAImageInfo& image = OTAImageInfo(),
+               const OTACheckpoint* checkpoint = nullptr);
+    // 只读校验分区前缀的 CRC32 是否与断点一致；必须在 esp_ota_begin 之前调用（非顺序写模式下 begin 会擦除整个分区）
+    static bool verifyPrefix(const esp_partition_t* partition, uint32_t bytes, uint32_t crc);
+    // 从 NVS 断点恢复会话（调用方已用 verifyPrefix 校验前缀）：写入任务把前缀重新写入新的 OTA 句柄，恢复摘要与写入位置
+    // 期间 replaying() 为 true，完成后数据从 checkpoint.offset 继续追加
+    bool resume(esp_ota_handle_t handle, const esp_partition_t* partition, const OTAImageInfo& image,
+                const OTACheckpoint& checkpoint);
+    void checkpointNow();                           // 请求写入任务保存一次断点（断线时调用，最多等 CHECKPOINT_WAIT_MS）
+    // 生产者：追加数据，不阻塞；暂存缓冲放不下时整包拒收并返回 false（此时 failed() 仍为 false）
+    bool write(const uint8_t* data, size_t len) override;
+    bool canAccept(size_t len) override;            // 暂存缓冲现在能否放下 len 字节
+    bool finish(uint32_t timeoutMs = 5000);         // 提交剩余数据并等待全部落盘，校验大小与 SHA-256
+    void abort();                                   // 放弃当前会话；返回时写入任务已不再使用旧的 OTA 句柄
+
+    bool failed() const { return _failed.load(); }
+    esp_err_t lastError() const { return _lastError; }
+    uint32_t bytesWritten() const { return _bytesWritten.load(); }      // 已写入 Flash 的镜像字节数（解压后）
+    uint32_t bytesConsumed() const { return _bytesConsumed.load(); }    // 已处理的数据流字节数（压缩/差分时为传输的数据）
+    uint8_t progressPercent() const;                // 按声明大小计算的进度，未声明时为 0xFF
+    bool replaying() const { return _replaying.load(); }
+    uint32_t throughputKBps() const;                // 会话开始以来的持续写入速率（KB/s）
+    uint32_t flashBusyMicros() const { return _flashMicros.load(); }   // 累计花在 esp_ota_write 上的时间
+    void registerMetrics();                         // 登记到 Metrics：写入字节数与速率、单次 esp_ota_write 耗时、写入任务栈水位
+
+private:
+    enum Command : uint8_t {
+        CMD_DATA,                                   // 写入一个暂存扇区
+        CMD_FINISH,                                 // 收尾：冲刷解压/补丁输出，校验大小与摘要
+        CMD_RESET,                                  // 释放会话资源（解压器、补丁应用器、SHA 引擎）
+        CMD_REPLAY,                                 // 断点续传：校验并重写分区前缀
+        CMD_CHECKPOINT                              // 立即保存断点
+    };
+    static const uint8_t NO_BUFFER = 0xFF;
+    static const uint32_t CHECKPOINT_WAIT_MS = 50;  // 断线回调里请求断点时最多等这么久，拿不到锁就沿用上一个周期断点
+
+    struct Job {
+        uint8_t command;
+        uint8_t index;                              // 扇区缓冲编号（控制任务为 NO_BUFFER）
+        uint16_t length;                            // 有效字节数
+        uint32_t session;                           // 所属会话，旧会话的数据任务直接丢弃
+    };
+
+    // 写入任务内部的 Flash 出口：原始数据和解压输出都从这里写入
+    class FlashSink : public OTAStreamSink {
+    public:
+        explicit FlashSink(OTAFlashWriter* owner) : _owner(owner) {}
+        bool write(const uint8_t* data, size_t len) override { return _owner->flashWrite(data, len); }
+    private:
+        OTAFlashWriter* _owner;
+    };
+
+    // 差分补丁的旧镜像来源：当前运行分区
+    class PartitionSource : public OTAPatchSource {
+    public:
+        void begin(const esp_partition_t* partition) { _partition = partition; }
+        bool read(uint32_t offset, uint8_t* dst, size_t len) override;
+        uint32_t crc32(uint32_t len) override;
+        uint32_t size() const override { return _partition ? _partition->size : 0; }
+    private:
+        const esp_partition_t* _partition = nullptr;
+    };
+
+    static void taskEntry(void* arg);
+    void run();
+    void processData(const Job& job);
+    void finalizeSession();
+    void releaseSession();
+    void replayPrefix();
+    void saveCheckpoint(bool force);
+    void fail(esp_err_t err);
+    bool flashWrite(const uint8_t* data, size_t len);
+    // 解压输出（或原始数据）的去向：差分会话交给补丁应用器，否则直接写 Flash
+    OTAStreamSink& imageSink() { return _patcher.active() ? static_cast<OTAStreamSink&>(_patcher) : _flashSink; }
+
+    bool submitFill();                              // 把当前填充中的缓冲交给写入任务
+    bool submitControl(Command command, TickType_t timeout = portMAX_DELAY);   // 把控制任务排进写入队列
+    bool acquireFill();                             // 取一个空闲缓冲作为新的填充缓冲（不等待）
+    size_t room() const;                            // 暂存缓冲剩余容量（调用方持有 _producerLock）
+    void waitDrained(TickType_t timeout);
+
+    uint8_t* _buffers[STAGING_SECTORS] = {};
+    QueueHandle_t _freeQueue = nullptr;             // 空闲缓冲编号
+    QueueHandle_t _fullQueue = nullptr;             // 待处理的 Job
+    SemaphoreHandle_t _producerLock = nullptr;      // 保护生产者侧状态（BLE 回调 / bleWriteTask / 断开回调）
+    SemaphoreHandle_t _drained = nullptr;           // 在途任务清零时由写入任务释放
+    TaskHandle_t _task = nullptr;
+
+    esp_ota_handle_t _handle = 0;
+    uint8_t _streamFlags = 0;
+    OTAImageInfo _image;
+    int _fillIndex = -1;                            // 当前填充中的缓冲编号，-1 表示没有
+    size_t _fillLength = 0;
+    uint32_t _streamBytes = 0;                      // 生产者已接受的数据流字节数
+    std::atomic<uint32_t> _session{0};
+    std::atomic<uint32_t> _pending{0};              // 已提交但尚未处理完的任务数
+    std::atomic<bool> _failed{false};
+    std::atomic<bool> _complete{false};             // 收尾校验通过
+    esp_err_t _lastError = ESP_OK;
+    std::atomic<uint32_t> _bytesWritten{0};
+    std::atomic<uint32_t> _bytesConsumed{0};
+    std::atomic<uint32_t> _flashMicros{0};
+    LatencyHistogram _flashWriteTime;               // 单次 esp_ota_write 耗时（含进入新扇区时的擦除）
+    uint32_t _startMicros = 0;
+    std::atomic<bool> _replaying{false};
+
+    // 以下由写入任务使用（start() 在写入任务空闲时完成初始化）
+    FlashSink _flashSink{this};
+    OTAInflater _inflater;                          // 仅压缩会话期间分配
+    PartitionSource _patchSource;
+    OTAPatchApplier _patcher;                       // 仅差分会话期间分配
+    mbedtls_sha256_context _sha;
+    bool _hashing = false;                          // _sha 已初始化（首次写入时才开始）
+    OTACheckpointStore* _checkpointStore = nullptr;
+    uint32_t _checkpointInterval = 0;
+    bool _checkpointing = false;                    // 本会话是否保存断点
+    OTACheckpoint _checkpoint;                      // 最近一次保存的断点
+    uint32_t _crc = 0;                              // 已写入镜像的 CRC32
+    const esp_partition_t* _replayPartition = nullptr;
+    uint32_t _replayBytes = 0;
+};
@@ -0,0 +1,79 @@
+#include "OTAInflater.h"
+#include <stdlib.h>
+#include "rom/miniz.h"
+#include "serial_color_debug.h"
+
+bool OTAInflater::begin() {
+    end();
+    _decomp = malloc(sizeof(tinfl_decompressor));
+    _window = (uint8_t*)malloc(WINDOW_SIZE);
+    if (!_decomp || !_window) {
+        DEBUG_ERRORF("❌ 解压缓冲分配失败（需要 %u 字节）", (unsigned)(sizeof(tinfl_decompressor) + WINDOW_SIZE));
+        end();
+        return false;
+    }
+    tinfl_init((tinfl_decompressor*)_decomp);
+    _outPos = 0;
+    _done = false;
+    _totalIn = 0;
+    _totalOut = 0;
+    return true;
+}
+
+void OTAInflater::end() {
+    free(_decomp);
+    free(_window);
+    _decomp = nullptr;
+    _window = nullptr;
+}
+
+bool OTAInflater::feed(const uint8_t* data, size_t len, OTAStreamSink& sink) {
+    if (!_decomp) return false;
+    _totalIn += len;
+    while (true) {
+        if (_done) {
+            return len == 0;                        // 压缩流已结束却还有数据：镜像与声明不符
+        }
+        size_t inBytes = len;
+        size_t outBytes = WINDOW_SIZE - _outPos;
+        // 不带 NON_WRAPPING 标志：_window 作为 4KB 循环字典使用，回溯距离不会超过压缩端窗口
+        tinfl_status status = tinfl_decompress((tinfl_decompressor*)_decomp, data, &inBytes,
+                                               _window, _window + _outPos, &outBytes,
+                                               TINFL_FLAG_HAS_MORE_INPUT);
+        data += inBytes;
+        len -= inBytes;
+        _outPos += outBytes;
+        _totalOut += outBytes;
+
+        if (_outPos == WINDOW_SIZE) {               // 凑满一个扇区，交给 Flash 写入后从头复用字典
+            if (!sink.write(_window, WINDOW_SIZE)) return false;
+            _outPos = 0;
+        }
+
+        if (status == TINFL_STATUS_DONE) {
+            _done = true;
+            continue;
+        }
+        if (status < TINFL_STATUS_DONE) {
+            DEBUG_ERRORF("❌ 压缩数据损坏（tinfl 状态 %d）", (int)status);
+            return false;
+        }
+        if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) {
+            return true;
+        }
+        // TINFL_STATUS_HAS_MORE_OUTPUT：输出缓冲已写出，继续解压
+    }
+}
+
+bool OTAInflater::finish(OTAStreamSink& sink) {
+    if (!_decomp) return false;
+    if (!_done) {
+        DEBUG_ERRORF("❌ 压缩流不完整（已输入 %u 字节，已输出 %u 字节）", _totalIn, _totalOut);
+        return false;
+    }
+    if (_outPos > 0) {
+        if (!sink.write(_window, _outPos)) return false;
+        _outPos = 0;
+    }
+    return true;
+}
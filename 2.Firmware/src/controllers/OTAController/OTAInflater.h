@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "OTAReceiveWindow.h"
+
+// 流式 Deflate 解压器（使用 ESP32 ROM 内置的 miniz tinfl，不额外占用 Flash）
+// - 压缩端必须使用 raw deflate、窗口 4KB（zlib windowBits = 12），见 scripts/build-firmware.js
+// - 解压字典同时作为输出缓冲：每凑满一个 4KB 扇区就交给 sink 写入，正好对齐 Flash 扇区
+// - 内存占用约 11KB 解压状态 + 4KB 字典，只在压缩升级会话期间分配
+class OTAInflater {
+public:
+    static const size_t WINDOW_SIZE = 4096;         // 必须与压缩端窗口一致，且为 2 的幂
+
+    bool begin();                                   // 分配解压状态并初始化
+    void end();                                     // 释放内存
+    bool active() const { return _decomp != nullptr; }
+
+    // 送入一段压缩数据，解压输出按扇区交给 sink；数据损坏或 sink 失败返回 false
+    bool feed(const uint8_t* data, size_t len, OTAStreamSink& sink);
+    // 数据流结束：确认压缩流完整，并把最后不满一个扇区的输出交给 sink
+    bool finish(OTAStreamSink& sink);
+
+    bool done() const { return _done; }
+    uint32_t totalIn() const { return _totalIn; }
+    uint32_t totalOut() const { return _totalOut; }
+
+private:
+    void* _decomp = nullptr;                        // tinfl_decompressor
+    uint8_t* _window = nullptr;                     // 循环字典 / 输出扇区缓冲
+    size_t _outPos = 0;
+    bool _done = false;
+    uint32_t _totalIn = 0;
+    uint32_t _totalOut = 0;
+};
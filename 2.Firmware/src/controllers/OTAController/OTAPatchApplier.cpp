@@ -0,0 +1,211 @@
+#include "OTAPatchApplier.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool OTAPatchApplier::begin(OTAPatchSource& source, OTAStreamSink& output) {
+    end();
+    _out = (uint8_t*)malloc(OUTPUT_SIZE);
+    if (!_out) {
+        _error = Error::NO_MEMORY;
+        return false;
+    }
+    _source = &source;
+    _output = &output;
+    _outLen = 0;
+    _state = State::HEADER;
+    _argsLen = 0;
+    _argsNeed = OTA_PATCH_HEADER_SIZE;
+    _oldSize = 0;
+    _newSize = 0;
+    _produced = 0;
+    _copiedBytes = 0;
+    _literalBytes = 0;
+    _error = Error::NONE;
+    return true;
+}
+
+void OTAPatchApplier::end() {
+    free(_out);
+    _out = nullptr;
+    _source = nullptr;
+    _output = nullptr;
+}
+
+bool OTAPatchApplier::write(const uint8_t* data, size_t len) {
+    if (!_out || _error != Error::NONE) return false;
+
+    while (len > 0) {
+        switch (_state) {
+            case State::HEADER:
+            case State::ARGS: {
+                size_t n = _argsNeed - _argsLen;
+                if (n > len) n = len;
+                memcpy(_args + _argsLen, data, n);
+                _argsLen += n;
+                data += n;
+                len -= n;
+                if (_argsLen < _argsNeed) break;
+                if (!(_state == State::HEADER ? parseHeader() : startOp())) return false;
+                break;
+            }
+
+            case State::OPCODE:
+                _op = *data++;
+                --len;
+                _argsLen = 0;
+                if (_op == OP_COPY || _op == OP_DIFF) {
+                    _argsNeed = 8;
+                } else if (_op == OP_ADD) {
+                    _argsNeed = 4;
+                } else {
+                    return fail(Error::BAD_OP);
+                }
+                _state = State::ARGS;
+                break;
+
+            case State::ADD_DATA: {
+                size_t n = _opRemaining < len ? _opRemaining : len;
+                if (!emit(data, n)) return false;
+                _literalBytes += n;
+                _opRemaining -= n;
+                data += n;
+                len -= n;
+                if (_opRemaining == 0) {
+                    _state = (_produced == _newSize) ? State::DONE : State::OPCODE;
+                }
+                break;
+            }
+
+            case State::DIFF_DATA: {
+                size_t n = _opRemaining < len ? _opRemaining : len;
+                if (!copyFromSource(_opOffset, n, data)) return false;
+                _opOffset += n;
+                _opRemaining -= n;
+                data += n;
+                len -= n;
+                if (_opRemaining == 0) {
+                    _state = (_produced == _newSize) ? State::DONE : State::OPCODE;
+                }
+                break;
+            }
+
+            case State::DONE:
+                return fail(Error::SIZE_MISMATCH);  // 镜像已完整，多余数据说明补丁与声明不符
+        }
+    }
+    return true;
+}
+
+bool OTAPatchApplier::finish() {
+    if (!_out) return false;
+    if (_error != Error::NONE) return false;
+    if (_state != State::DONE) return fail(Error::INCOMPLETE);
+    return flushOutput();
+}
+
+const char* OTAPatchApplier::errorName(Error error) {
+    switch (error) {
+        case Error::NONE:           return "NONE";
+        case Error::NO_MEMORY:      return "NO_MEMORY";
+        case Error::BAD_HEADER:     return "BAD_HEADER";
+        case Error::BASE_MISMATCH:  return "BASE_MISMATCH";
+        case Error::BAD_OP:         return "BAD_OP";
+        case Error::SIZE_MISMATCH:  return "SIZE_MISMATCH";
+        case Error::SOURCE_ERROR:   return "SOURCE_ERROR";
+        case Error::SINK_ERROR:     return "SINK_ERROR";
+        case Error::INCOMPLETE:     return "INCOMPLETE";
+    }
+    return "?";
+}
+
+bool OTAPatchApplier::fail(Error error) {
+    if (_error == Error::NONE) _error = error;
+    return false;
+}
+
+bool OTAPatchApplier::parseHeader() {
+    if (readU32(_args) != OTA_PATCH_MAGIC) return fail(Error::BAD_HEADER);
+    _oldSize = readU32(_args + 4);
+    uint32_t oldCrc = readU32(_args + 8);
+    _newSize = readU32(_args + 12);
+    if (_oldSize > _source->size()) return fail(Error::BAD_HEADER);
+    // 基准镜像不一致时，COPY/DIFF 会拼出错误的固件，必须在写入任何数据前拒绝
+    if (_source->crc32(_oldSize) != oldCrc) return fail(Error::BASE_MISMATCH);
+    _state = (_newSize == 0) ? State::DONE : State::OPCODE;
+    return true;
+}
+
+bool OTAPatchApplier::startOp() {
+    if (_op == OP_ADD) {
+        _opRemaining = readU32(_args);
+        if (_opRemaining == 0) return fail(Error::BAD_OP);
+        if (_opRemaining > _newSize - _produced) return fail(Error::SIZE_MISMATCH);
+        _state = State::ADD_DATA;
+        return true;
+    }
+
+    uint32_t offset = readU32(_args);
+    uint32_t len = readU32(_args + 4);
+    if (len == 0 || !checkRange(offset, len)) return fail(Error::BAD_OP);
+    if (len > _newSize - _produced) return fail(Error::SIZE_MISMATCH);
+
+    if (_op == OP_COPY) {
+        if (!copyFromSource(offset, len, nullptr)) return false;
+        _state = (_produced == _newSize) ? State::DONE : State::OPCODE;
+    } else {
+        _opOffset = offset;
+        _opRemaining = len;
+        _state = State::DIFF_DATA;
+    }
+    return true;
+}
+
+bool OTAPatchApplier::copyFromSource(uint32_t offset, uint32_t len, const uint8_t* diff) {
+    // 旧数据直接读进输出缓冲的空闲部分，DIFF 时原地叠加差值，不需要额外缓冲
+    while (len > 0) {
+        size_t n = OUTPUT_SIZE - _outLen;
+        if (n > len) n = len;
+        uint8_t* dst = _out + _outLen;
+        if (!_source->read(offset, dst, n)) return fail(Error::SOURCE_ERROR);
+        if (diff) {
+            for (size_t i = 0; i < n; ++i) dst[i] = (uint8_t)(dst[i] + diff[i]);
+            diff += n;
+        }
+        _outLen += n;
+        _produced += n;
+        _copiedBytes += n;
+        offset += n;
+        len -= n;
+        if (_outLen == OUTPUT_SIZE && !flushOutput()) return false;
+    }
+    return true;
+}
+
+bool OTAPatchApplier::emit(const uint8_t* data, size_t len) {
+    while (len > 0) {
+        size_t n = OUTPUT_SIZE - _outLen;
+        if (n > len) n = len;
+        memcpy(_out + _outLen, data, n);
+        _outLen += n;
+        _produced += n;
+        data += n;
+        len -= n;
+        if (_outLen == OUTPUT_SIZE && !flushOutput()) return false;
+    }
+    return true;
+}
+
+bool OTAPatchApplier::flushOutput() {
+    if (_outLen == 0) return true;
+    if (!_output->write(_out, _outLen)) return fail(Error::SINK_ERROR);
+    _outLen = 0;
+    return true;
+}
+
+bool OTAPatchApplier::checkRange(uint32_t offset, uint32_t len) const {
+    return offset <= _oldSize && len <= _oldSize - offset;
+}
+
+uint32_t OTAPatchApplier::readU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
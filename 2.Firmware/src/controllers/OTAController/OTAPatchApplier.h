@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "OTAReceiveWindow.h"
+
+// 差分补丁的旧镜像来源（设备上为当前运行分区，见 OTAFlashWriter）
+class OTAPatchSource {
+public:
+    virtual bool read(uint32_t offset, uint8_t* dst, size_t len) = 0;
+    virtual uint32_t crc32(uint32_t len) = 0;       // 前 len 字节的 CRC32（与 zlib crc32 一致）
+    virtual uint32_t size() const = 0;              // 可读取的最大字节数
+    virtual ~OTAPatchSource() = default;
+};
+
+// 差分补丁格式（小端），由 scripts/make-delta.js 生成
+//   头部 16 字节：  "ODP1" | oldSize u32 | oldCrc32 u32 | newSize u32
+//   之后为操作序列：
+//     0x01 COPY  oldOffset u32 | len u32              新 = 旧[oldOffset, +len)
+//     0x02 ADD   len u32 | len 字节                    新 = 字面数据
+//     0x03 DIFF  oldOffset u32 | len u32 | len 字节    新[i] = 旧[oldOffset + i] + diff[i]（按字节模 256）
+// DIFF 对应代码段整体平移后地址常量的小幅变化，diff 中绝大多数是 0，配合压缩（START 标志 bit0）体积很小
+// 输出累计满 newSize 字节即结束，之后再出现数据视为错误
+static const uint32_t OTA_PATCH_MAGIC = 0x3150444F;    // "ODP1"
+static const size_t OTA_PATCH_HEADER_SIZE = 16;
+
+// 流式补丁应用器：作为 OTAStreamSink 接收补丁流（可接在 OTAInflater 之后），重建的新镜像按扇区交给下游 sink
+// 纯逻辑实现，不依赖 FreeRTOS / Arduino，可在主机上对照生成器做往返验证
+class OTAPatchApplier : public OTAStreamSink {
+public:
+    static const size_t OUTPUT_SIZE = 4096;         // 输出缓冲，与 Flash 扇区对齐
+
+    enum class Error {
+        NONE,
+        NO_MEMORY,
+        BAD_HEADER,         // 魔数错误或旧镜像大小超出运行分区
+        BASE_MISMATCH,      // 运行分区内容与补丁的基准镜像不一致
+        BAD_OP,             // 未知操作码或引用越界
+        SIZE_MISMATCH,      // 输出将超过 newSize，或镜像完整后仍有数据
+        SOURCE_ERROR,       // 读取旧镜像失败
+        SINK_ERROR,         // 下游写入失败
+        INCOMPLETE          // 结束时输出不足 newSize
+    };
+
+    bool begin(OTAPatchSource& source, OTAStreamSink& output);
+    void end();
+    bool active() const { return _out != nullptr; }
+
+    bool write(const uint8_t* data, size_t len) override;  // 送入补丁数据
+    bool finish();                                  // 补丁流结束：校验完整性并写出最后一段输出
+
+    Error error() const { return _error; }
+    static const char* errorName(Error error);
+    uint32_t newSize() const { return _newSize; }
+    uint32_t produced() const { return _produced; }
+    uint32_t copiedBytes() const { return _copiedBytes; }  // 来自旧镜像（COPY + DIFF）的字节数
+    uint32_t literalBytes() const { return _literalBytes; }
+
+private:
+    enum class State { HEADER, OPCODE, ARGS, ADD_DATA, DIFF_DATA, DONE };
+    enum Op : uint8_t { OP_COPY = 0x01, OP_ADD = 0x02, OP_DIFF = 0x03 };
+
+    bool fail(Error error);
+    bool parseHeader();
+    bool startOp();
+    bool copyFromSource(uint32_t offset, uint32_t len, const uint8_t* diff);
+    bool emit(const uint8_t* data, size_t len);
+    bool flushOutput();
+    bool checkRange(uint32_t offset, uint32_t len) const;
+    static uint32_t readU32(const uint8_t* p);
+
+    OTAPatchSource* _source = nullptr;
+    OTAStreamSink* _output = nullptr;
+    uint8_t* _out = nullptr;
+    size_t _outLen = 0;
+
+    State _state = State::HEADER;
+    uint8_t _op = 0;
+    uint8_t _args[OTA_PATCH_HEADER_SIZE];           // 头部 / 操作参数累积缓冲
+    size_t _argsLen = 0;
+    size_t _argsNeed = 0;
+    uint32_t _opOffset = 0;                         // DIFF 当前对应的旧镜像偏移
+    uint32_t _opRemaining = 0;
+
+    uint32_t _oldSize = 0;
+    uint32_t _newSize = 0;
+    uint32_t _produced = 0;
+    uint32_t _copiedBytes = 0;
+    uint32_t _literalBytes = 0;
+    Error _error = Error::NONE;
+};
@@ -0,0 +1,122 @@
+#include "OTAReceiveWindow.h"
+#include <string.h>
+
+void OTAReceiveWindow::reset(uint8_t* reorderBuffer, size_t reorderBytes, uint32_t startOffset, uint16_t startSeq) {
+    _buffer = reorderBuffer;
+    _bufferSize = reorderBytes;
+    _nextSeq = startSeq;
+    _nextOffset = startOffset;
+    _received = 0;
+    _duplicates = 0;
+    _outOfWindow = 0;
+    _reordered = 0;
+    _busy = 0;
+}
+
+bool OTAReceiveWindow::parseHeader(const uint8_t* data, size_t len, OTAPacketHeader& header) {
+    if (len <= OTA_PACKET_HEADER_SIZE || data[0] != OTA_PACKET_VERSION) return false;
+    header.version = data[0];
+    header.flags = data[1];
+    header.seq = (uint16_t)(data[2] | (data[3] << 8));
+    header.offset = (uint32_t)data[4] | ((uint32_t)data[5] << 8) | ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+    return true;
+}
+
+OTAReceiveWindow::Result OTAReceiveWindow::accept(const OTAPacketHeader& header, const uint8_t* payload, size_t len,
+                                                  OTAStreamSink& sink) {
+    // 先交付上次因 sink 忙而留在重排缓冲中的连续包
+    Result drained = drain(sink);
+    if (drained == Result::INVALID || drained == Result::SINK_ERROR) return drained;
+
+    uint16_t distance = (uint16_t)(header.seq - _nextSeq);
+    if (distance >= 0x8000) {                       // seq 落在确认点之前：重传导致的重复包
+        ++_duplicates;
+        return Result::DUPLICATE;
+    }
+    if (distance >= MAX_PACKETS) {
+        ++_outOfWindow;
+        return Result::OUT_OF_WINDOW;
+    }
+    if (len == 0 || header.offset < _nextOffset) return Result::INVALID;
+
+    if (distance == 0) {
+        if (_received & 1) {                        // 已在重排缓冲中，只是 sink 还没空出来
+            ++_duplicates;
+            return Result::DUPLICATE;
+        }
+        // 快速路径：正好是下一个期望的包，直接交付，不经过重排缓冲
+        if (header.offset != _nextOffset) return Result::INVALID;
+        if (!sink.canAccept(len)) {
+            ++_busy;
+            return Result::BUSY;
+        }
+        if (!sink.write(payload, len)) return Result::SINK_ERROR;
+        _nextOffset += len;
+        ++_nextSeq;
+        _received >>= 1;
+
+        // 空缺补齐后，把重排缓冲里已经连续的包依次交付
+        drained = drain(sink);
+        return drained == Result::BUSY ? Result::ACCEPTED : drained;
+    }
+
+    uint64_t bit = 1ULL << distance;
+    if (_received & bit) {
+        ++_duplicates;
+        return Result::DUPLICATE;
+    }
+    if (header.offset - _nextOffset + len > _bufferSize) {
+        ++_outOfWindow;
+        return Result::OUT_OF_WINDOW;
+    }
+
+    copyIn(header.offset, payload, len);
+    size_t slot = header.seq % MAX_PACKETS;
+    _offsets[slot] = header.offset;
+    _lengths[slot] = (uint16_t)len;
+    _received |= bit;
+    ++_reordered;
+    return Result::ACCEPTED;
+}
+
+// 依次交付重排缓冲中与确认点连续的包；sink 忙时停下（返回 BUSY），包留在缓冲中
+OTAReceiveWindow::Result OTAReceiveWindow::drain(OTAStreamSink& sink) {
+    while (_received & 1) {
+        size_t slot = _nextSeq % MAX_PACKETS;
+        if (_offsets[slot] != _nextOffset) return Result::INVALID;
+        if (!sink.canAccept(_lengths[slot])) {
+            ++_busy;
+            return Result::BUSY;
+        }
+        if (!deliverBuffered(sink, _offsets[slot], _lengths[slot])) return Result::SINK_ERROR;
+        _nextOffset += _lengths[slot];
+        ++_nextSeq;
+        _received >>= 1;
+    }
+    return Result::ACCEPTED;
+}
+
+OTAAckState OTAReceiveWindow::ackState() const {
+    OTAAckState state;
+    state.nextSeq = _nextSeq;
+    state.nextOffset = _nextOffset;
+    state.sack = _received >> 1;
+    return state;
+}
+
+void OTAReceiveWindow::copyIn(uint32_t offset, const uint8_t* src, size_t len) {
+    size_t pos = offset % _bufferSize;
+    size_t first = _bufferSize - pos;
+    if (first > len) first = len;
+    memcpy(_buffer + pos, src, first);
+    if (len > first) memcpy(_buffer, src + first, len - first);
+}
+
+bool OTAReceiveWindow::deliverBuffered(OTAStreamSink& sink, uint32_t offset, size_t len) {
+    size_t pos = offset % _bufferSize;
+    size_t first = _bufferSize - pos;
+    if (first > len) first = len;
+    if (!sink.write(_buffer + pos, first)) return false;
+    if (len > first && !sink.write(_buffer, len - first)) return false;
+    return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// OTA 数据流的写入目标（OTAFlashWriter 实现），接收窗口按流偏移顺序交付数据
+class OTAStreamSink {
+public:
+    virtual bool write(const uint8_t* data, size_t len) = 0;
+    // 不阻塞地判断现在能否接收 len 字节；返回 false 时接收窗口不交付这个包，等 APP 重传
+    virtual bool canAccept(size_t len) { (void)len; return true; }
+    virtual ~OTAStreamSink() = default;
+};
+
+// OTA v1 数据包头（OTAData 特征，小端）
+//   [0]   版本号（OTA_PACKET_VERSION）
+//   [1]   保留标志位
+//   [2-3] 序号 seq（每包 +1，65535 后回绕）
+//   [4-7] 该包负载在数据流中的偏移
+//   [8..] 负载
+struct OTAPacketHeader {
+    uint8_t version;
+    uint8_t flags;
+    uint16_t seq;
+    uint32_t offset;
+};
+static const uint8_t OTA_PACKET_VERSION = 1;
+static const size_t OTA_PACKET_HEADER_SIZE = 8;
+
+// ACK 快照：nextSeq/nextOffset 为累计确认点（之前的数据全部收到），
+// sack 的第 i 位表示 seq = nextSeq + 1 + i 的包已收到（选择性确认），APP 只需重传空缺的包
+// 位图覆盖整个接收窗口（MAX_PACKETS - 1 个包），窗口内缓冲的包都能被确认
+struct OTAAckState {
+    uint16_t nextSeq;
+    uint32_t nextOffset;
+    uint64_t sack;
+};
+
+// 滑动接收窗口：
+// - 只接受 seq 落在 [nextSeq, nextSeq + MAX_PACKETS) 且数据落在 [nextOffset, nextOffset + 窗口字节) 的包
+// - 乱序到达的包先存进重排缓冲，累计确认点前移时按顺序交给 sink
+// - 重复包、窗口外的包直接丢弃（但仍会触发一次 ACK，让 APP 尽快得知真实进度）
+// - sink 暂时接收不了（Flash 写入跟不上）时不等待：下一个期望的包直接丢弃，不记入确认，由 APP 按 SACK 重传；
+//   已在重排缓冲中的连续包留到下一个包到达时再交付
+// 纯逻辑实现，不依赖 FreeRTOS / Arduino，可在主机上仿真丢包与乱序
+class OTAReceiveWindow {
+public:
+    static const size_t MAX_PACKETS = 64;           // 窗口内最多跟踪的包数（位图宽度）
+
+    enum class Result {
+        ACCEPTED,       // 已接收（可能已交付，也可能在重排缓冲中等待）
+        DUPLICATE,      // 已收到过
+        OUT_OF_WINDOW,  // 超出接收窗口
+        INVALID,        // 包头或偏移与已知数据矛盾
+        BUSY,           // sink 暂时接收不了，包未记录，等待重传
+        SINK_ERROR      // 交付给 sink 失败
+    };
+
+    // reorderBuffer 由调用方提供，大小必须 ≥ 单包最大负载，决定窗口字节数
+    void reset(uint8_t* reorderBuffer, size_t reorderBytes, uint32_t startOffset = 0, uint16_t startSeq = 0);
+
+    static bool parseHeader(const uint8_t* data, size_t len, OTAPacketHeader& header);
+    Result accept(const OTAPacketHeader& header, const uint8_t* payload, size_t len, OTAStreamSink& sink);
+
+    OTAAckState ackState() const;
+    uint32_t nextOffset() const { return _nextOffset; }
+    uint32_t duplicates() const { return _duplicates; }
+    uint32_t outOfWindow() const { return _outOfWindow; }
+    uint32_t reordered() const { return _reordered; }
+    uint32_t busy() const { return _busy; }
+    bool hasGap() const { return _received != 0; } // 有包在等待空缺补齐（或等待 sink 空出）
+
+private:
+    Result drain(OTAStreamSink& sink);
+    void copyIn(uint32_t offset, const uint8_t* src, size_t len);
+    bool deliverBuffered(OTAStreamSink& sink, uint32_t offset, size_t len);
+
+    uint8_t* _buffer = nullptr;
+    size_t _bufferSize = 0;
+    uint16_t _nextSeq = 0;
+    uint32_t _nextOffset = 0;
+    uint64_t _received = 0;                         // 第 i 位：seq = _nextSeq + i 已在重排缓冲中（第 0 位只在 sink 忙时为 1）
+    uint32_t _offsets[MAX_PACKETS] = {};            // 按 seq % MAX_PACKETS 记录缓冲包的偏移和长度
+    uint16_t _lengths[MAX_PACKETS] = {};
+    uint32_t _duplicates = 0;
+    uint32_t _outOfWindow = 0;
+    uint32_t _reordered = 0;
+    uint32_t _busy = 0;
+};
@@ -1,4 +1,6 @@
 #include "PWMServoController.h"
+#include <math.h>
+#include "serial_color_debug.h"
 
 // 构造函数：保存引脚和通道
 PWMServoController::PWMServoController(uint8_t pin, uint8_t channel)
@@ -8,6 +10,9 @@ PWMServoController::PWMServoController(uint8_t pin, uint8_t channel)
 void PWMServoController::begin() {
     ledcSetup(channel, frequency, resolution);
     ledcAttachPin(pin, channel);
+    if (loadCalibration()) {
+        DEBUG_INFOF("✅ 舵机（通道 %u）已加载标定表: %u 个标定点", channel, calibration.count);
+    }
     setAngle(currentAngle);  // 设置初始角度
 }
 
@@ -15,16 +20,42 @@ void PWMServoController::begin() {
 bool PWMServoController::setAngle(int angle) {
     if (angle < minAngle) angle = minAngle;
     if (angle > maxAngle) angle = maxAngle;
+    writeCentiDegrees((int32_t)angle * 100);
+    return true;
+}
+
+// 按小数角度输出：MotionController 的定时器每个周期调用，避免整数角度带来的台阶
+void PWMServoController::writeAngle(float angle) {
+    writeCentiDegrees((int32_t)lroundf(angle * 100.0f));
+}
+
+// 按 0.01° 输出：标定表整数插值得到 1/16 μs 脉宽，再换算成占空比
+// 16 位分辨率下一个占空比单位约 0.3μs（≈0.03°），原来整数角度 + map() 只用到了其中约 1/30 的精度
+void PWMServoController::writeCentiDegrees(int32_t centiDegrees) {
+    int32_t minCd = (int32_t)minAngle * 100;
+    int32_t maxCd = (int32_t)maxAngle * 100;
+    if (centiDegrees < minCd) centiDegrees = minCd;
+    if (centiDegrees > maxCd) centiDegrees = maxCd;
 
-    // 角度映射为脉冲宽度（单位 μs）
-    int us = map(angle, minAngle, maxAngle, minPulseWidth, maxPulseWidth);
+    writePulse(calibration.pulseAt(centiDegrees));
+    currentCentiDegrees = centiDegrees;
+    currentAngle = (centiDegrees + 50) / 100;
+}
 
-    // 将 us 映射为占空比（基于 20ms 周期 = 50Hz）
-    uint32_t duty = (us * (1 << resolution)) / 20000;
+void PWMServoController::writeMicroseconds(uint16_t us) {
+    uint16_t low = minPulseWidth < maxPulseWidth ? minPulseWidth : maxPulseWidth;
+    uint16_t high = minPulseWidth < maxPulseWidth ? maxPulseWidth : minPulseWidth;
+    if (us < low) us = low;
+    if (us > high) us = high;
+    writePulse((uint32_t)us << ServoCalibration::PULSE_SHIFT);
+}
 
+// 占空比 = 脉宽 / 周期 × 2^resolution，全程 32 位整数：
+// 脉宽 ≤ 4096μs（Q4 ≤ 65535）时 pulseQ4 << 16 不超过 2^32
+void PWMServoController::writePulse(uint32_t pulseQ4) {
+    uint32_t periodQ4 = (1000000u / frequency) << ServoCalibration::PULSE_SHIFT;
+    uint32_t duty = ((pulseQ4 << resolution) + periodQ4 / 2) / periodQ4;
     ledcWrite(channel, duty);
-    currentAngle = angle;
-    return true;
 }
 
 // 获取当前设置的角度
@@ -37,10 +68,43 @@ void PWMServoController::stop() {
     ledcWrite(channel, 0); // 设置占空比为 0，相当于断 PWM
 }
 
-// 设置脉冲宽度 + 角度范围（更灵活）
+// 设置脉冲宽度 + 角度范围（更灵活）；未标定时同时重建线性表
 void PWMServoController::setLimits(int minPulse, int maxPulse, int minAng, int maxAng) {
     minPulseWidth = minPulse;
     maxPulseWidth = maxPulse;
     minAngle = minAng;
     maxAngle = maxAng;
+    if (!calibrated) {
+        calibration = ServoCalibration::linear(minAng * 100, maxAng * 100, minPulse, maxPulse);
+    }
+}
+
+bool PWMServoController::setCalibration(const ServoCalibration& table) {
+    if (!table.valid()) {
+        DEBUG_ERRORF("❌ 舵机（通道 %u）标定表无效，忽略", channel);
+        return false;
+    }
+    calibration = table;
+    calibrated = true;
+    return true;
+}
+
+bool PWMServoController::loadCalibration() {
+    ServoCalibration stored;
+    if (!ServoCalibrationStore::load(channel, stored)) return false;
+    return setCalibration(stored);
+}
+
+bool PWMServoController::saveCalibration() {
+    return ServoCalibrationStore::save(channel, calibration);
+}
+
+void PWMServoController::clearCalibration() {
+    ServoCalibrationStore::clear(channel);
+    calibrated = false;
+    calibration = ServoCalibration::linear(minAngle * 100, maxAngle * 100, minPulseWidth, maxPulseWidth);
+}
+
+uint16_t PWMServoController::pulseForCentiDegrees(int32_t centiDegrees) const {
+    return (uint16_t)((calibration.pulseAt(centiDegrees) + (1u << (ServoCalibration::PULSE_SHIFT - 1))) >> ServoCalibration::PULSE_SHIFT);
 }
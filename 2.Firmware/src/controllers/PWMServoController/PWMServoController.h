@@ -2,30 +2,52 @@
 #define SERVO_CONTROLLER_H
 
 #include <Arduino.h>
+#include "ServoCalibration.h"
 
 class PWMServoController {
 private:
     uint8_t pin;                 // 舵机信号线引脚
     uint8_t channel;             // PWM通道
     int currentAngle = 90;          // 初始角度设为90度
+    int32_t currentCentiDegrees = 9000; // 当前角度（0.01°）
     int frequency = 50;         // 50Hz
-    int resolution = 16;        // 16位分辨率
+    int resolution = 16;        // 16位分辨率（≤ 16，占空比换算用 32 位整数）
     int minPulseWidth = 500;    // 最小脉冲宽度 (μs)
     int maxPulseWidth = 2500;   // 最大脉冲宽度 (μs)
     int minAngle = 0;           // 最小角度
     int maxAngle = 180;         // 最大角度 
+    ServoCalibration calibration = ServoCalibration::linear(0, 18000, 500, 2500);  // 角度 → 脉宽查找表
+    bool calibrated = false;    // 是否使用了标定表（否则为 setLimits 生成的线性表）
+
+    void writePulse(uint32_t pulseQ4);                              // 按 1/16 μs 脉宽写占空比
 
 public:
     PWMServoController(uint8_t pin, uint8_t channel = 0);           // 构造函数
-    void begin();                                                   // 初始化函数
+    void begin();                                                   // 初始化函数（会尝试从 NVS 加载标定表）
     bool setAngle(int angle);                                       // 设置舵机角度
+    void writeAngle(float angle);                                   // 按小数角度输出（轨迹插值用，限幅后不取整）
+    void writeCentiDegrees(int32_t centiDegrees);                   // 按 0.01° 输出，经标定表整数插值（热路径）
+    void writeMicroseconds(uint16_t us);                            // 直接输出脉宽（限制在 minPulse ~ maxPulse，不经标定表）
     int getCurrentAngle() const;                                    // 获取当前角度
+    int32_t getCurrentCentiDegrees() const { return currentCentiDegrees; }
     void stop();                                                    // 停止舵机
     void setLimits(                                                 // 设置舵机角度限制
         int minPulse,                                              // 脉冲宽度限制
         int maxPulse,                                             // 脉冲宽度限制
         int minAng,                                               // 角度限制
         int maxAng);                                              // 角度限制
+
+    // 标定表：每个舵机（按 LEDC 通道区分）单独保存在 NVS，由 ServoCalibrator 生成
+    bool setCalibration(const ServoCalibration& table);             // 立即生效（不写 NVS）
+    bool loadCalibration();                                         // 从 NVS 加载，没有时保持线性表
+    bool saveCalibration();                                         // 当前标定表写入 NVS
+    void clearCalibration();                                        // 删除 NVS 中的标定表，回到线性表
+    const ServoCalibration& getCalibration() const { return calibration; }
+    bool isCalibrated() const { return calibrated; }
+    uint8_t getChannel() const { return channel; }
+    int getMinAngle() const { return minAngle; }                    // setLimits 的角度范围（度）
+    int getMaxAngle() const { return maxAngle; }
+    uint16_t pulseForCentiDegrees(int32_t centiDegrees) const;      // 某个角度当前对应的脉宽（μs，标定时用）
 };
 
 #endif
@@ -0,0 +1,96 @@
+#include "ServoCalibration.h"
+#include <Preferences.h>
+#include <stdio.h>
+#include "serial_color_debug.h"
+
+static const char* SERVO_NVS_NAMESPACE = "servo";
+
+bool ServoCalibration::valid() const {
+    if (magic != MAGIC || count < 2 || count > MAX_POINTS) return false;
+    for (uint8_t i = 1; i < count; ++i) {
+        int32_t span = (int32_t)centiDegrees[i] - centiDegrees[i - 1];
+        int32_t rise = (int32_t)pulseQ4[i] - pulseQ4[i - 1];
+        if (span <= 0) return false;
+        if ((int64_t)(rise < 0 ? -rise : rise) * span > INT32_MAX / 2) return false;   // 保证 pulseAt 的乘积（含舍入）不溢出 int32
+    }
+    return true;
+}
+
+ServoCalibration ServoCalibration::linear(int16_t minCentiDegrees, int16_t maxCentiDegrees,
+                                          uint16_t minPulseUs, uint16_t maxPulseUs) {
+    ServoCalibration calibration;
+    calibration.magic = MAGIC;
+    calibration.count = 2;
+    calibration.centiDegrees[0] = minCentiDegrees;
+    calibration.centiDegrees[1] = maxCentiDegrees;
+    calibration.pulseQ4[0] = (uint16_t)(minPulseUs << PULSE_SHIFT);
+    calibration.pulseQ4[1] = (uint16_t)(maxPulseUs << PULSE_SHIFT);
+    return calibration;
+}
+
+// 热路径：每个插值周期调用一次，只有整数比较和一次乘除
+// valid() 保证乘积在 int32 范围内（0~180° 对应 500~2500μs 时只用到约 1/4）
+uint32_t ServoCalibration::pulseAt(int32_t cd) const {
+    if (cd <= centiDegrees[0]) return pulseQ4[0];
+    if (cd >= centiDegrees[count - 1]) return pulseQ4[count - 1];
+    uint8_t i = 1;
+    while (cd > centiDegrees[i]) ++i;               // 最多 MAX_POINTS 次比较
+    int32_t x0 = centiDegrees[i - 1];
+    int32_t x1 = centiDegrees[i];
+    int32_t y0 = pulseQ4[i - 1];
+    int32_t y1 = pulseQ4[i];
+    int32_t span = x1 - x0;
+    int32_t delta = (y1 - y0) * (cd - x0);
+    return (uint32_t)(y0 + (delta + (delta >= 0 ? span / 2 : -span / 2)) / span);    // 四舍五入
+}
+
+static void keyOf(uint8_t channel, char* key, size_t size) {
+    snprintf(key, size, "cal%u", channel);
+}
+
+bool ServoCalibrationStore::load(uint8_t channel, ServoCalibration& calibration) {
+    char key[8];
+    keyOf(channel, key, sizeof(key));
+    Preferences prefs;
+    bool ok = false;
+    if (prefs.begin(SERVO_NVS_NAMESPACE, true)) {
+        ServoCalibration stored;
+        ok = prefs.getBytesLength(key) == sizeof(stored) &&
+             prefs.getBytes(key, &stored, sizeof(stored)) == sizeof(stored) &&
+             stored.valid();
+        if (ok) calibration = stored;
+        prefs.end();
+    }
+    return ok;
+}
+
+bool ServoCalibrationStore::save(uint8_t channel, const ServoCalibration& calibration) {
+    if (!calibration.valid()) {
+        DEBUG_ERRORF("❌ 舵机标定表无效（通道 %u），不写入 NVS", channel);
+        return false;
+    }
+    char key[8];
+    keyOf(channel, key, sizeof(key));
+    Preferences prefs;
+    bool ok = false;
+    if (prefs.begin(SERVO_NVS_NAMESPACE, false)) {
+        ok = prefs.putBytes(key, &calibration, sizeof(calibration)) == sizeof(calibration);
+        prefs.end();
+    }
+    if (!ok) {
+        DEBUG_ERRORF("❌ 舵机标定表写入 NVS 失败（通道 %u）", channel);
+    }
+    return ok;
+}
+
+void ServoCalibrationStore::clear(uint8_t channel) {
+    char key[8];
+    keyOf(channel, key, sizeof(key));
+    Preferences prefs;
+    if (prefs.begin(SERVO_NVS_NAMESPACE, false)) {
+        if (prefs.isKey(key)) {
+            prefs.remove(key);
+        }
+        prefs.end();
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+
+// 舵机标定表：若干个（角度 → 脉宽）标定点，点之间线性插值，补偿舵机的非线性和个体差异
+// - 角度单位为 0.01°（centi-degree），脉宽单位为 1/16 μs（Q4），插值全程整数运算，不使用浮点
+// - 未标定时由 setLimits 的两个端点生成线性表，与原来的 map() 行为一致
+// - 结构体按原样写入 NVS，字段变化时修改 MAGIC
+struct ServoCalibration {
+    static const uint8_t MAX_POINTS = 9;
+    static const uint32_t MAGIC = 0x53434131;       // "SCA1"
+    static const uint8_t PULSE_SHIFT = 4;           // 脉宽定点小数位数（1/16 μs）
+
+    uint32_t magic = 0;
+    uint8_t count = 0;                              // 有效标定点数（2 ~ MAX_POINTS）
+    uint8_t reserved[3] = {};
+    int16_t centiDegrees[MAX_POINTS] = {};          // 严格递增
+    uint16_t pulseQ4[MAX_POINTS] = {};              // 对应脉宽（1/16 μs），可以递减（舵机反装）
+
+    bool valid() const;
+
+    // 两点线性表（minAngle → minPulse，maxAngle → maxPulse）
+    static ServoCalibration linear(int16_t minCentiDegrees, int16_t maxCentiDegrees, uint16_t minPulseUs, uint16_t maxPulseUs);
+
+    // 查表插值：角度超出标定范围时钳在两端
+    uint32_t pulseAt(int32_t centiDegrees) const;
+};
+
+// NVS 中的标定存储（命名空间 "servo"，每个舵机一个键，例如 LEDC 通道 6 → "cal6"）
+class ServoCalibrationStore {
+public:
+    static bool load(uint8_t channel, ServoCalibration& calibration);
+    static bool save(uint8_t channel, const ServoCalibration& calibration);
+    static void clear(uint8_t channel);
+};
@@ -0,0 +1,148 @@
+#include "ServoCalibrator.h"
+#include <stdlib.h>
+#include <string.h>
+#include "serial_color_debug.h"
+
+static const int16_t DEFAULT_POINTS[] = {0, 4500, 9000, 13500, 18000};
+
+bool ServoCalibrator::start(const int16_t* centiDegrees, uint8_t count) {
+    int16_t clipped[sizeof(DEFAULT_POINTS) / sizeof(DEFAULT_POINTS[0])];
+    if (!centiDegrees || count == 0) {
+        // 默认标定点裁剪到舵机的角度范围（setLimits）内，裁剪后重合的点只保留一个
+        int16_t lo = (int16_t)(servo.getMinAngle() * 100);
+        int16_t hi = (int16_t)(servo.getMaxAngle() * 100);
+        count = 0;
+        for (int16_t p : DEFAULT_POINTS) {
+            int16_t c = p < lo ? lo : (p > hi ? hi : p);
+            if (count == 0 || c > clipped[count - 1]) clipped[count++] = c;
+        }
+        centiDegrees = clipped;
+    }
+    if (count < 2 || count > ServoCalibration::MAX_POINTS) {
+        DEBUG_ERRORF("❌ 标定点数量必须在 2 ~ %u 之间", ServoCalibration::MAX_POINTS);
+        return false;
+    }
+
+    table = ServoCalibration();
+    table.magic = ServoCalibration::MAGIC;
+    table.count = count;
+    for (uint8_t i = 0; i < count; ++i) {
+        table.centiDegrees[i] = centiDegrees[i];
+        table.pulseQ4[i] = (uint16_t)(servo.pulseForCentiDegrees(centiDegrees[i]) << ServoCalibration::PULSE_SHIFT);
+        if (i > 0 && centiDegrees[i] <= centiDegrees[i - 1]) {
+            DEBUG_ERROR("❌ 标定角度必须严格递增");
+            return false;
+        }
+    }
+
+    point = 0;
+    running = true;
+    DEBUG_INFOF("🎯 开始标定舵机（通道 %u），共 %u 个标定点：+N/-N 微调，ok 确认，abort 放弃", servo.getChannel(), count);
+    moveToPoint();
+    return true;
+}
+
+// 每个点的初始脉宽取当前标定表（或线性表）的估计值，操作者只需要小幅微调
+void ServoCalibrator::moveToPoint() {
+    pulseUs = servo.pulseForCentiDegrees(table.centiDegrees[point]);
+    servo.writeMicroseconds(pulseUs);
+    DEBUG_INFOF("📐 标定点 %u/%u：%d.%02d°，当前脉宽 %u μs", point + 1, table.count,
+                table.centiDegrees[point] / 100, abs(table.centiDegrees[point] % 100), pulseUs);
+}
+
+void ServoCalibrator::nudge(int16_t deltaUs) {
+    int32_t us = (int32_t)pulseUs + deltaUs;
+    setPulse(us < 0 ? 0 : (uint16_t)us);
+}
+
+void ServoCalibrator::setPulse(uint16_t us) {
+    if (!running) return;
+    pulseUs = us;
+    servo.writeMicroseconds(pulseUs);
+    DEBUG_INFOF("   脉宽 %u μs", pulseUs);
+}
+
+bool ServoCalibrator::accept() {
+    if (!running) return false;
+    table.pulseQ4[point] = (uint16_t)(pulseUs << ServoCalibration::PULSE_SHIFT);
+    if (++point < table.count) {
+        moveToPoint();
+        return false;
+    }
+    return finish();
+}
+
+bool ServoCalibrator::finish() {
+    running = false;
+    if (!servo.setCalibration(table)) {
+        abort();
+        return false;
+    }
+    bool saved = servo.saveCalibration();
+    DEBUG_INFOF("✅ 舵机（通道 %u）标定完成%s", servo.getChannel(), saved ? "，已写入 NVS" : "（写入 NVS 失败，仅本次上电有效）");
+    show();
+    servo.writeCentiDegrees(table.centiDegrees[table.count / 2]);   // 停在中间的标定点
+    return saved;
+}
+
+void ServoCalibrator::abort() {
+    running = false;
+    servo.writeCentiDegrees(servo.getCurrentCentiDegrees());     // 回到标定前的角度
+    DEBUG_WARN("⚠️ 已放弃标定，标定表保持不变");
+}
+
+void ServoCalibrator::show() const {
+    const ServoCalibration& current = servo.getCalibration();
+    DEBUG_INFOF("📋 舵机（通道 %u）标定表（%s）:", servo.getChannel(), servo.isCalibrated() ? "NVS" : "线性");
+    for (uint8_t i = 0; i < current.count; ++i) {
+        DEBUG_INFOF("   %3d.%02d° → %4u.%04u μs", current.centiDegrees[i] / 100, abs(current.centiDegrees[i] % 100),
+                    current.pulseQ4[i] >> ServoCalibration::PULSE_SHIFT,
+                    (current.pulseQ4[i] & 0x0F) * 625);      // 1/16 μs = 0.0625 μs
+    }
+}
+
+bool ServoCalibrator::handleCommand(const char* line) {
+    if (strncmp(line, "cal", 3) == 0 && (line[3] == '\0' || line[3] == ' ')) {
+        int16_t points[ServoCalibration::MAX_POINTS];
+        uint8_t count = 0;
+        const char* p = line + 3;
+        char* end;
+        while (count < ServoCalibration::MAX_POINTS) {
+            long degrees = strtol(p, &end, 10);
+            if (end == p) break;
+            points[count++] = (int16_t)(degrees * 100);
+            p = end;
+        }
+        start(count ? points : nullptr, count);
+        return true;
+    }
+    if (strcmp(line, "show") == 0) {
+        show();
+        return true;
+    }
+    if (strcmp(line, "clear") == 0) {
+        servo.clearCalibration();
+        DEBUG_INFOF("🧹 已删除舵机（通道 %u）的标定表", servo.getChannel());
+        return true;
+    }
+    if (!running) return false;
+
+    if (line[0] == '+' || line[0] == '-') {
+        long step = line[1] ? strtol(line + 1, nullptr, 10) : 1;
+        nudge((int16_t)(line[0] == '+' ? step : -step));
+        return true;
+    }
+    if (line[0] == '=') {
+        setPulse((uint16_t)strtol(line + 1, nullptr, 10));
+        return true;
+    }
+    if (strcmp(line, "ok") == 0) {
+        accept();
+        return true;
+    }
+    if (strcmp(line, "abort") == 0) {
+        abort();
+        return true;
+    }
+    return false;
+}
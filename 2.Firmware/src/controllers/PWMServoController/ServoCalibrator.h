@@ -0,0 +1,39 @@
+#pragma once
+#include <Arduino.h>
+#include "PWMServoController.h"
+
+// 舵机标定流程：依次把舵机转到若干个标定角度，操作者对照标定治具（量角器/刻线）微调脉宽直到舵盘对准，
+// 逐点确认后生成标定表，写入该舵机的 NVS 键。每台机器人的每个舵机标定一次，之后注视/手势动作的角度可复现
+//
+// 串口命令（handleCommand，一行一条）：
+//   cal [角度...]   开始标定，默认标定点 0 45 90 135 180（度，自动裁剪到舵机角度范围内）
+//   +N / -N        当前点脉宽增减 N μs（省略 N 为 1）
+//   =N             当前点脉宽直接设为 N μs
+//   ok             确认当前点，进入下一点；最后一点确认后生效并写入 NVS
+//   abort          放弃本次标定，原标定表保持不变
+//   show           打印当前生效的标定表
+//   clear          删除 NVS 中的标定表，回到线性表
+class ServoCalibrator {
+public:
+    explicit ServoCalibrator(PWMServoController& servo) : servo(servo) {}
+
+    bool start(const int16_t* centiDegrees = nullptr, uint8_t count = 0);
+    void nudge(int16_t deltaUs);
+    void setPulse(uint16_t us);
+    bool accept();                                  // 确认当前点；全部完成时返回 true（已生效并保存）
+    void abort();
+    void show() const;
+
+    bool active() const { return running; }
+    bool handleCommand(const char* line);           // 不是标定命令时返回 false
+
+private:
+    void moveToPoint();
+    bool finish();
+
+    PWMServoController& servo;
+    ServoCalibration table;                         // 正在采集的标定表（全部确认后才替换舵机的标定表）
+    uint8_t point = 0;                              // 当前标定点序号
+    uint16_t pulseUs = 0;                           // 当前点的输出脉宽
+    bool running = false;
+};
@@ -1,30 +1,31 @@
 // BLEServer.cpp
 #include "BLEServerWrapper.h"
+#include <esp_gap_ble_api.h>
+#include "GattTable.generated.h"    // 构建时由 scripts/gen-gatt-table.py 生成
+#ifdef BLE_CONFIG_RUNTIME_OVERRIDE
 #include <ArduinoJson.h>
+#include "GattConfigReader.h"
 #include <FS.h>         // 包含文件系统库，用于文件操作
 #include <SPIFFS.h>     // 包含 SPIFFS 库，用于文件系统操作
+#endif
 #include "serial_color_debug.h"
-#include "controllers/OTAController/OTAController.h"
+#include "utils/BootTimeline.h"
+#include "utils/Metrics.h"
+
+static BLEServerWrapper* s_gapOwner = nullptr;          // GAP 回调是全局函数，转交给创建设备的实例
 
 class WriteCallbackHandler : public BLECharacteristicCallbacks {
     public:
-    WriteCallbackHandler(const std::string& uuid, MessageDispatcher* dispatcher, BLEServerWrapper* server)
-    : uuid(uuid),  dispatcher(dispatcher), server(server) {}
+    WriteCallbackHandler(CharHandle handle, BLEServerWrapper* server)
+    : handle(handle), server(server) {}
 
     void onWrite(BLECharacteristic* characteristic) override {
-        std::string value = characteristic->getValue();
-        // OTA数据包直通处理
-        if (uuid == "ef040002-1000-8000-0080-5f9b34fb0000" && server && server->otaController) {
-            BLEWriteMessage msg{uuid, std::vector<uint8_t>(value.begin(), value.end())};
-            server->otaController->handleMessage(msg);
-        } else {
-            dispatcher->enqueue({ uuid, std::vector<uint8_t>(value.begin(), value.end()) });
-        }
+        // 直接读取协议栈内部的值缓冲区，OTAData 直通 OTAController，其余写入只在放入负载池时拷贝一次
+        server->deliver(handle, characteristic->getData(), characteristic->getLength());
     }
 
     private:
-        std::string uuid;                                                           // 特征 UUID
-        MessageDispatcher* dispatcher;                                             // 写入分发器指针
+        CharHandle handle;                                                          // 特征句柄
         BLEServerWrapper* server;                                                  // BLEServerWrapper指针
 };
 
@@ -32,13 +33,19 @@ class ServerCallbacks : public BLEServerCallbacks {
     public:
         ServerCallbacks(BLEServerWrapper* wrapper) : wrapper(wrapper) {}
     
-        void onConnect(BLEServer* pServer) override {
+        void onConnect(BLEServer* /*pServer*/) override {
             wrapper->deviceConnected = true;
             DEBUG_INFO("🔗 BLE device connected");
         }
+
+        void onConnect(BLEServer* /*pServer*/, esp_ble_gatts_cb_param_t* param) override {
+            memcpy(wrapper->peerAddress, param->connect.remote_bda, sizeof(esp_bd_addr_t));
+            wrapper->linkPolicy.onConnect(millis());
+        }
     
         void onDisconnect(BLEServer* pServer) override {
             wrapper->deviceConnected = false;
+            wrapper->linkPolicy.onDisconnect();
             DEBUG_WARN("❌ BLE device disconnected");
             // Optionally restart advertising
             pServer->getAdvertising()->start();
@@ -54,179 +61,391 @@ class ServerCallbacks : public BLEServerCallbacks {
     };
 
 void BLEServerWrapper::begin(MessageDispatcher* dispatcherPtr) {
-    dispatcher = dispatcherPtr;                         // 初始化写入分发器指针
+    _dispatcher = dispatcherPtr;                        // 初始化写入分发器指针
+    uint32_t beginMs = millis();
+    uint32_t heapBefore = ESP.getFreeHeap();
+    notifyQueue.begin([this](CharHandle handle, const uint8_t* data, size_t len) { return sendNotification(handle, data, len); },
+                      [this]() { return notifyPayloadLimit(); });
+    LinkPolicy::Backend link;
+    link.updateParams = [this](const LinkProfile& profile) { return requestLinkParams(profile); };
+    link.setDataLength = [this](uint16_t octets) { return requestDataLength(octets); };
+    link.setPhy = [this](LinkPhy phy) { return requestPhy(phy); };
+    linkPolicy.setBackend(link);
+    linkPolicy.begin();
 
-    SPIFFS.begin(true);                                 // 初始化 SPIFFS 文件系统       
-    File file = SPIFFS.open("/ble_config.json");        // 打开配置文件
-    if (!file) {                                        // 检查文件是否成功打开
-        // Serial.println("❌ Failed to open ble_config.json");
-        DEBUG_ERROR("❌ Failed to open ble_config.json");
-        return;
+    const char* source = "编译期 GATT 表";
+#ifdef BLE_CONFIG_RUNTIME_OVERRIDE
+    uint8_t stage = BootTimeline::begin("ble_json");
+    bool fromJson = beginFromJson();                    // SPIFFS 中的配置优先，缺失或解析失败时回落到编译期表
+    BootTimeline::end(stage);
+    if (fromJson) {
+        source = "SPIFFS /ble_config.json";
+    } else
+#endif
+    {
+        beginFromTable(GATT_TABLE);                     // 只创建启动必需的服务，其余由 beginDeferred() 在广播之后创建
     }
 
-    // Step 1️⃣：尝试从 JSON 配置中读取 ble_json_buffer_size
-    size_t estimatedSize = file.size();  // 获取文件大小
-    size_t jsonBufferSize = 4096;        // 默认 buffer 大小
-    String deviceName = "CLO";  // 默认值
-    {           // 括号作用域，作用是为了在这里创建一个临时的 JSON 文档，避免影响后面的代码
-        DynamicJsonDocument docHead(512);  // 临时文档
-        DeserializationError headErr = deserializeJson(docHead, file);
-        // Serial.println(headErr.c_str());  // 打印错误信息
-        // Serial.println(docHead.containsKey("ble_json_buffer_size"));  // 检查是否包含 "ble_json_buffer_size" 键
-        if (headErr.c_str() == "NoMemory" && docHead.containsKey("ble_json_buffer_size")) {              // 如果包含 "ble_json_buffer_size" 键（内存肯定不足，前面我们设置了一个小内存），就使用配置的大小
-            jsonBufferSize = docHead["ble_json_buffer_size"].as<size_t>();
-            DEBUG_INFOF("📦 使用配置指定 JSON 缓冲区大小: %d 字节", jsonBufferSize);
-        } else {
-            // 如果没有指定大小，使用默认大小
-            DEBUG_INFOF("📦 使用默认 JSON 缓冲区大小: %d 字节（文件大小约 %d 字节）", jsonBufferSize, estimatedSize);
-        }
-        if (docHead.containsKey("ble_device_name")) {
-            deviceName = docHead["ble_device_name"].as<const char*>();
-            DEBUG_INFOF("🔧 使用配置的 BLE 名称: %s", deviceName.c_str());
+    BLEDevice::getAdvertising()->start();               // 启动广播
+    BootTimeline::mark("advertising");
+    // 启动到广播的耗时与峰值堆占用（两种配置来源对比用；BLE 协议栈本身的分配两条路径相同）
+    DEBUG_INFOF("📶 BLE Advertising started: 启动后 %u ms（BLE 初始化 %u ms），配置来源: %s，峰值堆占用 %u 字节，常驻 %u 字节",
+                (unsigned)millis(), (unsigned)(millis() - beginMs), source,
+                (unsigned)(heapBefore - ESP.getMinFreeHeap()), (unsigned)(heapBefore - ESP.getFreeHeap()));
+}
+
+// 遍历构建时生成的 GATT 表：字符串与初始值都在 Flash 中，无需挂载 SPIFFS 或解析 JSON
+// 快速启动：广播前只创建 boot 为 early 的服务；所有特征的句柄和所有服务的广播 UUID 在这里一次登记完，
+// 因此广播数据与之前一致，订阅（MessageDispatcher::subscribe）也可以在延后的服务创建之前完成
+void BLEServerWrapper::beginFromTable(const GattTableDef& table) {
+    uint8_t stage = BootTimeline::begin("ble_init");
+    initDevice(table.deviceName);
+    BootTimeline::end(stage);
+
+    stage = BootTimeline::begin("gatt_core");
+    BLEAdvertising* advertising = BLEDevice::getAdvertising();
+    for (uint8_t s = 0; s < table.serviceCount; ++s) {
+        const GattServiceDef& service = table.services[s];
+        advertising->addServiceUUID(service.uuid);
+        for (uint8_t c = 0; c < service.characteristicCount; ++c) {
+            _dispatcher->characteristics().intern(service.characteristics[c].uuid, service.characteristics[c].name);
         }
-        // 重新 seek 到文件开头（⚠️ 关键点）
-        file.seek(0);  // 重置读指针，无需关闭重开  
     }
-    // Step 2️⃣：尝试加载整个 JSON 配置
-    // 关于DynamicJsonDocument详细可见博客：https://better-town-aff.notion.site/ESP32-DynamicJsonDocument-1ea63f1a31c380369decfee9585f0fc5?pvs=4
-    DynamicJsonDocument doc(jsonBufferSize);
-    DeserializationError err = deserializeJson(doc, file);      // 反序列化 JSON 数据
-    
-    // Step 3️⃣：若失败，则 fallback 使用估算内存重试
-    if (err) {
-        DEBUG_WARNF("JSON 解析失败，尝试使用估算缓冲区（%.0f 字节）", estimatedSize * 1.3);
-    
-        file.seek(0);
-        size_t fallbackSize = static_cast<size_t>(estimatedSize * 1.3);
-        DynamicJsonDocument fallbackDoc(fallbackSize);
-        DeserializationError fallbackErr = deserializeJson(fallbackDoc, file);
-    
-        if (fallbackErr) {
-            DEBUG_ERRORF("fallback 解析也失败（大小: %d 字节）: %s", fallbackSize, fallbackErr.c_str());
-            return;
+    createServices(table, false);
+    BootTimeline::end(stage);
+    deferredTable = &table;
+}
+
+// 创建延后的服务（OTA、设备信息等），在开始广播之后由后台任务调用一次
+// Bluedroid 允许广播/连接期间新增服务：已连接且开启了 Service Changed 的客户端会收到指示并重新发现服务
+void BLEServerWrapper::beginDeferred() {
+    if (!deferredTable) return;                         // 运行期 JSON 配置：begin() 已创建全部服务
+    uint8_t stage = BootTimeline::begin("gatt_deferred");
+    createServices(*deferredTable, true);
+    deferredTable = nullptr;
+    BootTimeline::end(stage);
+}
+
+void BLEServerWrapper::createServices(const GattTableDef& table, bool deferred) {
+    for (uint8_t s = 0; s < table.serviceCount; ++s) {
+        const GattServiceDef& service = table.services[s];
+        if (service.deferred != deferred) continue;
+        BLEService* bleService = addService(service.uuid, service.name);
+        if (!bleService) continue;
+        for (uint8_t c = 0; c < service.characteristicCount; ++c) {
+            const GattCharacteristicDef& ch = service.characteristics[c];
+            addCharacteristic(bleService, ch.uuid, ch.name, ch.description, ch.properties, ch.value, ch.valueLength,
+                              ch.notify);
         }
-    
-        DEBUG_INFOF("fallback 解析成功，实际使用大小: %d 字节", fallbackSize);
-        doc = std::move(fallbackDoc);       // 使用 std::move 转移所有权
+        bleService->start();
     }
+}
 
-    BLEDevice::init(deviceName.c_str());                     // 初始化 BLE 设备，设置设备名称    
-    DEBUG_INFOF("🔧 BLE设备初始化完成，设备名称: %s", deviceName.c_str());  // 添加调试信息
-    BLEDevice::setMTU(512);                             // 设置 MTU 上限，客户端需支持
-    server = BLEDevice::createServer();                 // 用成员变量存储
-    server->setCallbacks(new ServerCallbacks(this));    // ✅ 设置连接回调
-
+#ifdef BLE_CONFIG_RUNTIME_OVERRIDE
+namespace {
+// SPIFFS 文件作为 GattConfigReader 的字节来源（File 内部有缓冲，逐字节读取开销很小）
+class FileConfigSource : public GattConfigSource {
+public:
+    explicit FileConfigSource(File& file) : file(file) {}
+    int read() override { return file.read(); }
+private:
+    File& file;
+};
+}  // namespace
 
-    BLEAdvertising* advertising = BLEDevice::getAdvertising();  // 获取 BLE 广播对象
+// 运行期覆盖：从 SPIFFS 的 ble_config.json 加载（便于不重新编译固件就调整特征）
+// 流式读取：一次只反序列化一个服务，峰值内存与文件大小无关（见 GattConfigReader.h）
+bool BLEServerWrapper::beginFromJson() {
+    SPIFFS.begin(true);                                 // 初始化 SPIFFS 文件系统
+    File file = SPIFFS.open("/ble_config.json");        // 打开配置文件
+    if (!file) {                                        // 检查文件是否成功打开
+        DEBUG_WARN("⚠️ SPIFFS 中没有 ble_config.json，使用编译期 GATT 表");
+        return false;
+    }
 
-    for (JsonObject service : doc["services"].as<JsonArray>()) {        // 遍历服务数组
-        const char* serviceUUID = service["uuid"];                      // 获取服务 UUID
-        const char* serviceName = service["name"];                      // 获取服务名称(但是上位机不会显示，所以这里也不需要使用)
-        
-        // ✅ 校验 serviceUUID 是否合法（4 或 36 个字符）
-        if (!serviceUUID || (strlen(serviceUUID) != 4 && strlen(serviceUUID) != 36)) {
-            // Serial.printf("❌ Invalid Service UUID for %s: %s\n", serviceName, serviceUUID ? serviceUUID : "null"); // 打印错误信息
-            DEBUG_ERRORF("❌ Invalid Service UUID for %s: %s", serviceName, serviceUUID? serviceUUID : "null");
-            continue;  // 跳过这个服务
+    bool initialized = false;
+    auto onDeviceName = [&](const char* name) {
+        if (initialized) {
+            DEBUG_WARNF("⚠️ ble_device_name 写在 services 之后，已忽略: %s", name);
+            return;
         }
+        DEBUG_INFOF("🔧 使用配置的 BLE 名称: %s", name);
+        initDevice(name);
+        initialized = true;
+    };
 
-        BLEService* bleService = server->createService(serviceUUID);    // 创建服务对象
-        advertising->addServiceUUID(serviceUUID);                       // 添加服务 UUID 到广播中   
+    auto onService = [&](JsonObjectConst service) {
+        if (!initialized) {                             // 第一个服务之前没有出现设备名：使用默认名称
+            initDevice("CLO");
+            initialized = true;
+        }
+        BLEService* bleService = addService(service["uuid"], service["name"]);
+        if (!bleService) return true;                   // 跳过这个服务，继续读下一个
+        BLEDevice::getAdvertising()->addServiceUUID(service["uuid"].as<const char*>());   // 添加服务 UUID 到广播中
 
-        for (JsonObject ch : service["characteristics"].as<JsonArray>()) {      // 遍历特征数组
-            const char* uuid = ch["uuid"];                              // 获取特征 UUID
-            const char* name = ch["name"];                              // 获取特征名称
-            const char* desc = ch["description"] | "";                  // 获取特征描述，如果没有则默认为空字符串
+        for (JsonObjectConst ch : service["characteristics"].as<JsonArrayConst>()) {      // 遍历特征数组
             const char* format = ch["value_format"] | "bytes";                // 获取特征格式，默认为 "bytes"
 
-            JsonArray typeArray = ch["type"];                           // 获取特征类型数组
-
-            // ✅ 校验 characteristic UUID 是否合法
-            if (!uuid || (strlen(uuid) != 4 && strlen(uuid) != 36)) {
-                // Serial.printf("❌ Invalid Characteristic UUID for %s: %s\n", name, uuid ? uuid : "null"); // 打印错误信息
-                DEBUG_ERRORF("❌ Invalid Characteristic UUID for %s: %s", name, uuid ? uuid : "null");
-                continue;  // 跳过这个特征
+            uint8_t props = 0;
+            for (JsonVariantConst t : ch["type"].as<JsonArrayConst>()) {        // 遍历特征类型数组
+                const char* type = t | "";
+                if (strcmp(type, "READ") == 0)      props |= GATT_PROP_READ;
+                if (strcmp(type, "WRITE") == 0)     props |= GATT_PROP_WRITE;
+                if (strcmp(type, "NOTIFY") == 0)    props |= GATT_PROP_NOTIFY;
+                if (strcmp(type, "WRITE_NO_RESPONSE") == 0)  props |= GATT_PROP_WRITE_NR;
             }
 
-            uint32_t props = 0;                                         // 初始化特征属性为 0  
-            for (const char* t : typeArray) {                           // 遍历特征类型数组
-                if (strcmp(t, "READ") == 0)      props |= BLECharacteristic::PROPERTY_READ;                 // 读取属性
-                if (strcmp(t, "WRITE") == 0)     props |= BLECharacteristic::PROPERTY_WRITE;                // 写入属性
-                if (strcmp(t, "NOTIFY") == 0)    props |= BLECharacteristic::PROPERTY_NOTIFY;               // 通知属性
-                if (strcmp(t, "WRITE_NO_RESPONSE") == 0)  props |= BLECharacteristic::PROPERTY_WRITE_NR;    // 无响应写入属性
+            // 初始值按 value_format 转换成字节（与 scripts/gen-gatt-table.py 的转换规则一致）
+            std::vector<uint8_t> value;
+            if (ch.containsKey("value")) {
+                if (strcmp(format, "bytes") == 0) {
+                    for (JsonVariantConst v : ch["value"].as<JsonArrayConst>()) value.push_back(v.as<uint8_t>());
+                } else if (strcmp(format, "string") == 0) {
+                    const char* str = ch["value"] | "";
+                    value.assign(str, str + strlen(str));
+                } else if (strcmp(format, "json") == 0) {
+                    String jsonStr;
+                    serializeJson(ch["value"], jsonStr);
+                    value.assign(jsonStr.c_str(), jsonStr.c_str() + jsonStr.length());
+                } else if (strcmp(format, "int") == 0) {
+                    value.push_back(ch["value"].as<uint8_t>());
+                }
             }
 
-            BLECharacteristic* characteristic = bleService->createCharacteristic(uuid, props);      // 创建特征对象
+            GattNotifyPolicy notifyPolicy;
+            notifyPolicy.mode = strcmp(ch["notify"]["mode"] | "event", "state") == 0 ? GATT_NOTIFY_STATE : GATT_NOTIFY_EVENT;
+            notifyPolicy.pack = ch["notify"]["pack"] | false;
+            notifyPolicy.minIntervalMs = ch["notify"]["min_interval_ms"] | 0;
 
-            // 添加 CCCD 描述符
-            if (props & BLECharacteristic::PROPERTY_NOTIFY || props & BLECharacteristic::PROPERTY_INDICATE) {
-                BLEDescriptor* cccd = new BLEDescriptor(BLEUUID((uint16_t)0x2902));
-                characteristic->addDescriptor(cccd);
-            }
+            addCharacteristic(bleService, ch["uuid"], ch["name"], ch["description"] | "", props,
+                              value.data(), value.size(), notifyPolicy);
+        }
 
-            if (ch.containsKey("value")) {  // 如果特征对象包含 "value" 键
-                if (strcmp(format, "bytes") == 0) {  // 如果格式为字节数组
-                    JsonArray arr = ch["value"];  // 获取字节数组
-                    
-                    // DEBUG_INFOF("字节数组长度: %d", arr.size());  // 打印字节数组长度
-                    if (arr.size() > 0) {  // 如果字节数组非空
-                        std::vector<uint8_t> val;  // 创建字节数组
-                        for (auto v : arr) val.push_back(v.as<uint8_t>());  // 遍历字节数组并添加到字节数组中
-                        characteristic->setValue(val.data(), val.size());  // 设置字节数组值
-                        // DEBUG_INFOF("设置字节值，共 %d 字节", val.size());
-                        // DEBUG_INFOF("设置字节数组值: %s", val.data());  // 打印设置的字节数组值
-                    } else {
-                        // DEBUG_INFOF("字节数组为空, 无需设置值");
-                    }
-                } else if (strcmp(format, "string") == 0) {  // 如果格式为字符串
-                    characteristic->setValue(ch["value"].as<const char*>());  // 设置字符串值
-                    // DEBUG_INFOF("设置字符串值: %s", ch["value"].as<const char*>());
-                } else if (strcmp(format, "json") == 0) {  // 如果格式为 JSON
-                    String jsonStr;  // 创建字符串对象
-                    serializeJson(ch["value"], jsonStr);  // 序列化 JSON 对象为字符串
-                    characteristic->setValue(jsonStr.c_str());  // 设置 JSON 值
-                } else if (strcmp(format, "int") == 0) {  // 如果格式为整数
-                    uint8_t val = ch["value"].as<uint8_t>();  // 获取整数值
-                    characteristic->setValue(&val, 1);  // 设置整数值
-                }
-            }
-            
+        bleService->start();            // 启动服务对象（运行期配置不分阶段，全部在广播前创建）
+        return true;
+    };
 
-            if (props & BLECharacteristic::PROPERTY_WRITE || props & BLECharacteristic::PROPERTY_WRITE_NR) {                        // 如果特征对象包含写入属性，则设置回调函数
-                characteristic->setCallbacks(new WriteCallbackHandler(uuid, dispatcher, this)); // 设置写入回调函数
-            }
-            if (props & BLECharacteristic::PROPERTY_NOTIFY || props & BLECharacteristic::PROPERTY_INDICATE) {   // 如果特征对象包含通知或指示属性，则设置通知回调函数
-                notifyCharacteristics[uuid] = characteristic;                           // 将特征对象添加到通知特征对象映射中
-            }
+    GattConfigReader reader;
+    FileConfigSource source(file);
+    bool ok = reader.read(source, onDeviceName, onService);
+    file.close();
 
-            // Optional BLE descriptor (0x2901)
-            if (strlen(desc) > 0) {                                                     // 如果描述字符串长度大于 0，则创建描述对象并添加到特征对象中
-                BLEDescriptor* userDesc = new BLEDescriptor(BLEUUID((uint16_t)0x2901)); // 创建描述对象
-                userDesc->setValue(desc);                                               // 设置描述值
-                characteristic->addDescriptor(userDesc);                                // 添加描述对象到特征对象中
-            }
+    if (!ok) {
+        if (!initialized) {                             // 还没有创建任何服务：整体回落到编译期表
+            DEBUG_ERRORF("❌ ble_config.json 解析失败: %s，使用编译期 GATT 表", reader.error());
+            return false;
+        }
+        // 协议栈已经按前面的服务初始化，无法再回落；保留已创建的服务继续启动
+        DEBUG_ERRORF("❌ ble_config.json 在第 %u 个服务处解析失败: %s，其后的服务未创建",
+                     (unsigned)reader.serviceCount() + 1, reader.error());
+    }
+    if (!initialized) initDevice("CLO");                // 配置中没有服务
+    DEBUG_INFOF("📦 流式加载 %u 个服务，单个服务文档峰值 %u / %u 字节",
+                (unsigned)reader.serviceCount(), (unsigned)reader.peakDocumentBytes(),
+                (unsigned)GattConfigReader::capacity());
+    return true;
+}
+#endif
 
-            // Serial.printf("✅ Registered %s (%s): %s\n", name, uuid, desc);              // 打印注册的特征对象信息
-            DEBUG_INFOF("✅ Registered %s (%s): %s", name, uuid, desc);                     // 打印注册的特征对象信息
+void BLEServerWrapper::initDevice(const char* deviceName) {
+    BLEDevice::init(deviceName);                        // 初始化 BLE 设备，设置设备名称    
+    DEBUG_INFOF("🔧 BLE设备初始化完成，设备名称: %s", deviceName);  // 添加调试信息
+    BLEDevice::setMTU(512);                             // 设置 MTU 上限，客户端需支持
+    server = BLEDevice::createServer();                 // 用成员变量存储
+    server->setCallbacks(new ServerCallbacks(this));    // ✅ 设置连接回调
+    s_gapOwner = this;
+    BLEDevice::setCustomGapHandler(&BLEServerWrapper::handleGapEvent);     // 连接参数 / 数据长度 / PHY 的协商结果
+}
+
+BLEService* BLEServerWrapper::addService(const char* uuid, const char* name) {
+    // ✅ 校验 serviceUUID 是否合法（4 或 36 个字符）
+    if (!uuid || (strlen(uuid) != 4 && strlen(uuid) != 36)) {
+        DEBUG_ERRORF("❌ Invalid Service UUID for %s: %s", name ? name : "null", uuid ? uuid : "null");
+        return nullptr;
+    }
+    return server->createService(uuid);                             // 创建服务对象
+}
+
+void BLEServerWrapper::addCharacteristic(BLEService* service, const char* uuid, const char* name, const char* desc,
+                                         uint8_t gattProps, const uint8_t* value, size_t valueLen,
+                                         const GattNotifyPolicy& notifyPolicy) {
+    // ✅ 校验 characteristic UUID 是否合法
+    if (!uuid || (strlen(uuid) != 4 && strlen(uuid) != 36)) {
+        DEBUG_ERRORF("❌ Invalid Characteristic UUID for %s: %s", name ? name : "null", uuid ? uuid : "null");
+        return;  // 跳过这个特征
+    }
+
+    CharHandle handle = _dispatcher->characteristics().intern(uuid, name);   // 驻留 UUID，得到特征句柄
+
+    uint32_t props = 0;
+    if (gattProps & GATT_PROP_READ)     props |= BLECharacteristic::PROPERTY_READ;          // 读取属性
+    if (gattProps & GATT_PROP_WRITE)    props |= BLECharacteristic::PROPERTY_WRITE;         // 写入属性
+    if (gattProps & GATT_PROP_NOTIFY)   props |= BLECharacteristic::PROPERTY_NOTIFY;        // 通知属性
+    if (gattProps & GATT_PROP_WRITE_NR) props |= BLECharacteristic::PROPERTY_WRITE_NR;      // 无响应写入属性
+
+    BLECharacteristic* characteristic = service->createCharacteristic(uuid, props);      // 创建特征对象
+
+    // 添加 CCCD 描述符
+    if (props & BLECharacteristic::PROPERTY_NOTIFY || props & BLECharacteristic::PROPERTY_INDICATE) {
+        BLEDescriptor* cccd = new BLEDescriptor(BLEUUID((uint16_t)0x2902));
+        characteristic->addDescriptor(cccd);
+    }
+
+    if (valueLen > 0) {
+        characteristic->setValue(const_cast<uint8_t*>(value), valueLen);   // 设置初始值
+    }
+
+    if (props & BLECharacteristic::PROPERTY_WRITE || props & BLECharacteristic::PROPERTY_WRITE_NR) {                        // 如果特征对象包含写入属性，则设置回调函数
+        characteristic->setCallbacks(new WriteCallbackHandler(handle, this));   // 设置写入回调函数
+    }
+    if (props & BLECharacteristic::PROPERTY_NOTIFY || props & BLECharacteristic::PROPERTY_INDICATE) {   // 如果特征对象包含通知或指示属性，则设置通知回调函数
+        if (handle != INVALID_CHAR_HANDLE) {
+            notifyQueue.setPolicy(handle, notifyPolicy);                        // 先登记策略，再让发送任务看到特征
+            std::lock_guard<std::mutex> lock(notifyLock);                       // 延后创建的服务可能与发送任务并发
+            notifyCharacteristics[handle] = characteristic;                     // 按句柄登记可通知的特征对象
         }
+    }
 
-        bleService->start();            // 启动服务对象
+    // Optional BLE descriptor (0x2901)
+    if (desc && strlen(desc) > 0) {                                             // 如果描述字符串长度大于 0，则创建描述对象并添加到特征对象中
+        BLEDescriptor* userDesc = new BLEDescriptor(BLEUUID((uint16_t)0x2901)); // 创建描述对象
+        userDesc->setValue(desc);                                               // 设置描述值
+        characteristic->addDescriptor(userDesc);                                // 添加描述对象到特征对象中
     }
 
-    advertising->start();           // 启动广播
-    // Serial.println("📶 BLE Advertising started");   // 打印广播启动信息
-    DEBUG_INFO("📶 BLE Advertising started");   // 打印广播启动信息
+    DEBUG_INFOF("✅ Registered %s (%s): %s", name, uuid, desc);                     // 打印注册的特征对象信息
 }
 
 bool BLEServerWrapper::isConnected() {
     return deviceConnected;
 }
 
-// 通知函数
+// 通知函数：投递到 NotifyQueue，不在调用方任务中调用协议栈
+void BLEServerWrapper::notify(CharHandle handle, const uint8_t* data, size_t len) {
+    if (len > NotifyQueue::INLINE_BYTES) {
+        sendNotification(handle, data, len);        // 大块数据（很少见）直接同步发送，不占队列
+        return;
+    }
+    notifyQueue.post(handle, data, len);
+}
+
 void BLEServerWrapper::notify(const std::string& uuid, const uint8_t* data, size_t len) {
-    auto it = notifyCharacteristics.find(uuid);
-    if (it != notifyCharacteristics.end()) {
-        it->second->setValue(std::string((const char*)data, len));               // 设置特征值
-        it->second->notify();               // 发送通知（其中，second是指特征值的长度） 
+    notify(handleOf(uuid.c_str()), data, len);
+}
+
+bool BLEServerWrapper::sendNotification(CharHandle handle, const uint8_t* data, size_t len) {
+    if (!deviceConnected || handle >= CharacteristicRegistry::MAX_CHARACTERISTICS) return false;
+    std::lock_guard<std::mutex> lock(notifyLock);
+    BLECharacteristic* characteristic = notifyCharacteristics[handle];
+    if (!characteristic) return false;
+    characteristic->setValue(const_cast<uint8_t*>(data), len);     // 直接设置字节，不再构造临时 std::string
+    characteristic->notify();               // 发送通知
+    return true;
+}
+
+size_t BLEServerWrapper::notifyPayloadLimit() {
+    uint16_t mtu = server && deviceConnected ? server->getPeerMTU(server->getConnId()) : 23;
+    return mtu > 3 ? mtu - 3 : 20;
+}
+
+LinkStatus BLEServerWrapper::linkStatus() {
+    LinkStatus status = linkPolicy.status();
+    status.mtu = server && deviceConnected ? server->getPeerMTU(server->getConnId()) : 23;
+    return status;
+}
+
+void BLEServerWrapper::registerMetrics() {
+    notifyQueue.registerMetrics();
+    // 链路参数与吞吐放在同一个快照里，便于对照（未连接时为 0）
+    Metrics::addProbe("link.interval", "us", [](void* self) {
+        LinkStatus s = static_cast<BLEServerWrapper*>(self)->linkStatus();
+        return s.connected ? (int32_t)s.interval * 1250 : 0;
+    }, this);
+    Metrics::addProbe("link.data_length", "B", [](void* self) {
+        LinkStatus s = static_cast<BLEServerWrapper*>(self)->linkStatus();
+        return s.connected ? (int32_t)s.txOctets : 0;
+    }, this);
+    Metrics::addProbe("link.phy", "", [](void* self) {
+        LinkStatus s = static_cast<BLEServerWrapper*>(self)->linkStatus();
+        return s.connected ? (int32_t)s.txPhy : 0;
+    }, this);
+    Metrics::addProbe("link.mtu", "B", [](void* self) {
+        LinkStatus s = static_cast<BLEServerWrapper*>(self)->linkStatus();
+        return s.connected ? (int32_t)s.mtu : 0;
+    }, this);
+}
+
+bool BLEServerWrapper::requestLinkParams(const LinkProfile& profile) {
+    esp_ble_conn_update_params_t params = {};
+    memcpy(params.bda, peerAddress, sizeof(esp_bd_addr_t));
+    params.min_int = profile.minInterval;
+    params.max_int = profile.maxInterval;
+    params.latency = profile.latency;
+    params.timeout = profile.timeout;
+    esp_err_t err = esp_ble_gap_update_conn_params(&params);
+    if (err != ESP_OK) {
+        DEBUG_WARNF("⚠️ 连接参数更新请求失败: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+bool BLEServerWrapper::requestDataLength(uint16_t octets) {
+    esp_err_t err = esp_ble_gap_set_pkt_data_len(peerAddress, octets);
+    if (err != ESP_OK) {
+        DEBUG_WARNF("⚠️ 数据长度更新请求失败: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+// 2M PHY 是 BLE 5.0 特性：ESP32-C3/S3 等芯片的协议栈才有 PHY 接口，经典 ESP32（BLE 4.2）只能保持 1M
+bool BLEServerWrapper::requestPhy(LinkPhy phy) {
+#ifdef CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+    esp_ble_gap_phy_mask_t mask = phy == LinkPhy::PHY_2M ? ESP_BLE_GAP_PHY_2M_PREF_MASK : ESP_BLE_GAP_PHY_1M_PREF_MASK;
+    esp_err_t err = esp_ble_gap_set_preferred_phy(peerAddress, 0, mask, mask, ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+    if (err != ESP_OK) {
+        DEBUG_WARNF("⚠️ PHY 更新请求失败: %s", esp_err_to_name(err));
+        return false;
     }
-}
\ No newline at end of file
+    return true;
+#else
+    (void)phy;
+    return false;
+#endif
+}
+
+void BLEServerWrapper::handleGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+    BLEServerWrapper* self = s_gapOwner;
+    if (!self) return;
+    switch (event) {
+        case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT: {
+            bool ok = param->update_conn_params.status == ESP_BT_STATUS_SUCCESS;
+            self->linkPolicy.onParamsUpdated(ok, param->update_conn_params.conn_int, param->update_conn_params.latency,
+                                             param->update_conn_params.timeout);
+            DEBUG_INFOF("🔗 连接参数%s: 间隔 %u×1.25ms 从机延迟 %u 超时 %ums", ok ? "已更新" : "更新被拒绝",
+                        param->update_conn_params.conn_int, param->update_conn_params.latency,
+                        param->update_conn_params.timeout * 10u);
+            break;
+        }
+        case ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT: {
+            bool ok = param->pkt_data_lenth_cmpl.status == ESP_BT_STATUS_SUCCESS;
+            self->linkPolicy.onDataLength(ok, param->pkt_data_lenth_cmpl.params.tx_len,
+                                          param->pkt_data_lenth_cmpl.params.rx_len);
+            DEBUG_INFOF("🔗 数据长度%s: tx %u rx %u 字节", ok ? "已更新" : "更新失败",
+                        param->pkt_data_lenth_cmpl.params.tx_len, param->pkt_data_lenth_cmpl.params.rx_len);
+            break;
+        }
+#ifdef CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+        case ESP_GAP_BLE_PHY_UPDATE_COMPLETE_EVT: {
+            bool ok = param->phy_update.status == ESP_BT_STATUS_SUCCESS;
+            self->linkPolicy.onPhy(ok, param->phy_update.tx_phy, param->phy_update.rx_phy);
+            DEBUG_INFOF("🔗 PHY%s: tx %u rx %u（1=1M 2=2M 3=Coded）", ok ? "已更新" : "更新失败", param->phy_update.tx_phy,
+                        param->phy_update.rx_phy);
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+}
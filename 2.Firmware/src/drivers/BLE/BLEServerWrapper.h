@@ -6,30 +6,58 @@
 #include <BLEServer.h>
 #include <queue>
 #include <mutex>
-#include <map>
 #include <functional>
 #include <string>
 #include "MessageDispatcher.h"
+#include "GattTable.h"
+#include "NotifyQueue.h"
+#include "LinkPolicy.h"
+#include "drivers/Transport/MessageTransport.h"
 
-class OTAController; // 前置声明
-
-class BLEServerWrapper {
+// GATT 后端：Bluedroid 写入回调经 MessageTransport::deliver 进入消息管线，通知经 NotifyQueue 发出
+class BLEServerWrapper : public MessageTransport {
     friend class WriteCallbackHandler;  // 允许 WriteCallbackHandler（写入回调） 访问私有成员
     friend class ServerCallbacks;       // 允许 ServerCallbacks（服务回调，例如连接状态等） 访问私有成员
     public:
-        void begin(MessageDispatcher* dispatcher);      // 加载 ble_config.json 配置
-        void notify(const std::string& uuid, const uint8_t* data, size_t len);
-        bool isConnected();                             // ✅ 添加：查询连接状态
+        void begin(MessageDispatcher* dispatcher);      // 按编译期 GATT 表（或运行期覆盖的 ble_config.json）创建启动必需的服务并开始广播
+        void beginDeferred();                           // 广播之后创建配置中 boot 为 deferred 的服务（可在后台任务中调用）
+        // 异步通知：拷进 NotifyQueue 后立即返回，由发送任务按特征的通知策略（事件/状态、限速、打包）发出
+        // 超过 NotifyQueue::INLINE_BYTES 的数据在调用方任务中同步发送
+        void notify(CharHandle handle, const uint8_t* data, size_t len) override;
+        void notify(const std::string& uuid, const uint8_t* data, size_t len);     // 按 UUID 查句柄，热路径请缓存句柄
+        size_t notifyPayloadLimit() override;           // 当前连接协商的 MTU - 3
+        NotifyQueue& notifications() { return notifyQueue; }
+        bool isConnected() override;                    // ✅ 添加：查询连接状态
+        const char* transportName() const override { return "gatt"; }
+        void hintWorkload(LinkWorkload workload) override { linkPolicy.hint(workload); }
+        LinkStatus linkStatus();                        // 当前链路档位与协商结果（连接间隔、PHY、数据长度、MTU）
+        void registerMetrics();                         // 登记到 Metrics：通知发送 / 失败 / 速率，链路协商结果
         void setDisconnectCallback(std::function<void()> cb) { disconnectCallback = cb; }
-        void setOTAController(OTAController* ota) { otaController = ota; }
 
     private:
+        void beginFromTable(const GattTableDef& table);
+        void createServices(const GattTableDef& table, bool deferred);
+        bool beginFromJson();                           // 仅在定义 BLE_CONFIG_RUNTIME_OVERRIDE 时编译
+        void initDevice(const char* deviceName);
+        BLEService* addService(const char* uuid, const char* name);
+        void addCharacteristic(BLEService* service, const char* uuid, const char* name, const char* desc,
+                               uint8_t gattProps, const uint8_t* value, size_t valueLen,
+                               const GattNotifyPolicy& notifyPolicy);
+        bool sendNotification(CharHandle handle, const uint8_t* data, size_t len);   // 在 NotifyQueue 发送任务中调用
+        bool requestLinkParams(const LinkProfile& profile);     // LinkPolicy 的请求函数（调用 Bluedroid GAP 接口）
+        bool requestDataLength(uint16_t octets);
+        bool requestPhy(LinkPhy phy);
+        static void handleGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);   // 协商结果写回 LinkPolicy
+
         bool connected = false;  // 连接状态
-        MessageDispatcher* dispatcher;  // 写入分发器指针
-        std::map<std::string, BLECharacteristic*> notifyCharacteristics;   // 通知特征对象映射
+        BLECharacteristic* notifyCharacteristics[CharacteristicRegistry::MAX_CHARACTERISTICS] = {};   // 句柄 → 可通知的特征对象
+        std::mutex notifyLock;                                              // 保护 notifyCharacteristics 与特征值的设置/发送
+        NotifyQueue notifyQueue;
+        LinkPolicy linkPolicy;
+        esp_bd_addr_t peerAddress = {};                 // 当前连接的中心设备地址（链路参数请求用）
         bool deviceConnected = false;
         bool oldDeviceConnected = false;
         BLEServer* server = nullptr;
         std::function<void()> disconnectCallback;
-        OTAController* otaController = nullptr; // OTA控制器指针
+        const GattTableDef* deferredTable = nullptr;    // 尚未创建延后服务的 GATT 表
 };
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+
+// 特征句柄：BLEServerWrapper::begin 加载配置时，把每个特征的 UUID 驻留（intern）成一个小整数
+// 之后消息只携带句柄，热路径上不再拷贝或比较 36 字节的 UUID 字符串
+typedef uint8_t CharHandle;
+static const CharHandle INVALID_CHAR_HANDLE = 0xFF;
+
+class CharacteristicRegistry {
+public:
+    static const size_t MAX_CHARACTERISTICS = 64;
+
+    // 登记一个特征，返回其句柄；重复登记同一 UUID 返回已有句柄，表满时返回 INVALID_CHAR_HANDLE
+    CharHandle intern(const char* uuid, const char* name = nullptr) {
+        CharHandle existing = find(uuid);
+        if (existing != INVALID_CHAR_HANDLE) return existing;
+        if (_count >= MAX_CHARACTERISTICS) return INVALID_CHAR_HANDLE;
+        _entries[_count].uuid = uuid;
+        _entries[_count].name = name ? name : "";
+        return (CharHandle)_count++;
+    }
+
+    // 按 UUID 查找（启动阶段使用，热路径请直接使用句柄）
+    CharHandle find(const char* uuid) const {
+        if (!uuid) return INVALID_CHAR_HANDLE;
+        for (size_t i = 0; i < _count; ++i) {
+            if (strcasecmp(_entries[i].uuid.c_str(), uuid) == 0) return (CharHandle)i;
+        }
+        return INVALID_CHAR_HANDLE;
+    }
+
+    // 按配置中的特征名查找，例如 "OTAControl"
+    CharHandle findByName(const char* name) const {
+        if (!name) return INVALID_CHAR_HANDLE;
+        for (size_t i = 0; i < _count; ++i) {
+            if (_entries[i].name == name) return (CharHandle)i;
+        }
+        return INVALID_CHAR_HANDLE;
+    }
+
+    const char* uuidOf(CharHandle handle) const {
+        return handle < _count ? _entries[handle].uuid.c_str() : "?";
+    }
+    const char* nameOf(CharHandle handle) const {
+        return handle < _count ? _entries[handle].name.c_str() : "?";
+    }
+    size_t size() const { return _count; }
+
+private:
+    struct Entry {
+        std::string uuid;
+        std::string name;
+    };
+    Entry _entries[MAX_CHARACTERISTICS];
+    size_t _count = 0;
+};
@@ -0,0 +1,181 @@
+#include "GattConfigReader.h"
+#include <string.h>
+
+GattConfigReader::GattConfigReader() {
+    _filter["uuid"] = true;
+    _filter["name"] = true;
+    _filter["characteristics"][0]["uuid"] = true;
+    _filter["characteristics"][0]["name"] = true;
+    _filter["characteristics"][0]["description"] = true;
+    _filter["characteristics"][0]["type"] = true;
+    _filter["characteristics"][0]["value"] = true;
+    _filter["characteristics"][0]["value_format"] = true;
+    _filter["characteristics"][0]["notify"] = true;
+}
+
+int GattConfigReader::Reader::read() {
+    if (_pending != -2) {
+        int c = _pending;
+        _pending = -2;
+        return c;
+    }
+    return _source.read();
+}
+
+size_t GattConfigReader::Reader::readBytes(char* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+        int c = read();
+        if (c < 0) break;
+        buffer[n++] = (char)c;
+    }
+    return n;
+}
+
+int GattConfigReader::Reader::peek() {
+    if (_pending == -2) _pending = _source.read();
+    return _pending;
+}
+
+int GattConfigReader::Reader::skipWhitespace() {
+    int c = peek();
+    while (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+        read();
+        c = peek();
+    }
+    return c;
+}
+
+bool GattConfigReader::fail(const char* error) {
+    _error = error;
+    return false;
+}
+
+bool GattConfigReader::read(GattConfigSource& source, const DeviceNameHandler& onDeviceName,
+                            const ServiceHandler& onService) {
+    _error = nullptr;
+    _services = 0;
+    _peakBytes = 0;
+
+    Reader in(source);
+    if (in.skipWhitespace() != '{') return fail("InvalidInput");
+    in.read();
+    for (;;) {
+        int c = in.skipWhitespace();
+        if (c == '}') return true;
+        if (c == ',') {
+            in.read();
+            continue;
+        }
+        if (c != '"') return fail(c < 0 ? "IncompleteInput" : "InvalidInput");
+
+        char key[32];
+        if (!readString(in, key, sizeof(key))) return false;
+        if (in.skipWhitespace() != ':') return fail("InvalidInput");
+        in.read();
+
+        if (strcmp(key, "ble_device_name") == 0 && in.skipWhitespace() == '"') {
+            char name[32];                          // BLE 广播中的名称最长 29 字节，超长部分截断
+            if (!readString(in, name, sizeof(name))) return false;
+            if (onDeviceName) onDeviceName(name);
+        } else if (strcmp(key, "services") == 0) {
+            if (!readServices(in, onService)) return false;
+        } else if (!skipValue(in)) {                // ble_json_buffer_size 等其他字段：只扫描不解析
+            return false;
+        }
+    }
+}
+
+bool GattConfigReader::readServices(Reader& in, const ServiceHandler& onService) {
+    if (in.skipWhitespace() != '[') return fail("InvalidInput");
+    in.read();
+
+    DynamicJsonDocument doc(BLE_CONFIG_SERVICE_BYTES);      // 所有服务共用，峰值内存只取决于最大的一个服务
+    if (doc.capacity() == 0) return fail("NoMemory");
+
+    for (;;) {
+        int c = in.skipWhitespace();
+        if (c == ']') {
+            in.read();
+            return true;
+        }
+        if (c == ',') {
+            in.read();
+            continue;
+        }
+        if (c < 0) return fail("IncompleteInput");
+
+        // 从当前位置只反序列化一个服务对象（读到其右花括号为止），其余字段由过滤器丢弃
+        DeserializationError err = deserializeJson(doc, in, DeserializationOption::Filter(_filter));
+        if (err) return fail(err.c_str());
+        if (doc.memoryUsage() > _peakBytes) _peakBytes = doc.memoryUsage();
+        ++_services;
+        if (onService && !onService(doc.as<JsonObjectConst>())) return fail("Aborted");
+        doc.clear();
+    }
+}
+
+bool GattConfigReader::readString(Reader& in, char* out, size_t size) {
+    if (in.read() != '"') return fail("InvalidInput");
+    size_t n = 0;
+    for (;;) {
+        int c = in.read();
+        if (c < 0) return fail("IncompleteInput");
+        if (c == '"') break;
+        if (c == '\\') {
+            c = in.read();
+            switch (c) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u':                           // 顶层字段只用于键名和设备名，\uXXXX 以 '?' 代替
+                    for (int i = 0; i < 4; ++i) {
+                        if (in.read() < 0) return fail("IncompleteInput");
+                    }
+                    c = '?';
+                    break;
+                case -1:
+                    return fail("IncompleteInput");
+                default:                            // \" \\ \/
+                    break;
+            }
+        }
+        if (n + 1 < size) out[n++] = (char)c;
+    }
+    if (size > 0) out[n] = '\0';
+    return true;
+}
+
+bool GattConfigReader::skipValue(Reader& in) {
+    int c = in.skipWhitespace();
+    if (c == '"') {
+        char dummy[1];
+        return readString(in, dummy, sizeof(dummy));
+    }
+    if (c == '{' || c == '[') {
+        int depth = 0;
+        do {
+            c = in.peek();
+            if (c < 0) return fail("IncompleteInput");
+            if (c == '"') {
+                char dummy[1];
+                if (!readString(in, dummy, sizeof(dummy))) return false;
+                continue;
+            }
+            in.read();
+            if (c == '{' || c == '[') ++depth;
+            if (c == '}' || c == ']') --depth;
+        } while (depth > 0);
+        return true;
+    }
+    // 数字、true、false、null：读到分隔符为止（分隔符留给调用方）
+    size_t n = 0;
+    while (c >= 0 && c != ',' && c != '}' && c != ']' && c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+        in.read();
+        c = in.peek();
+        ++n;
+    }
+    return n > 0 ? true : fail(c < 0 ? "IncompleteInput" : "InvalidInput");
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <ArduinoJson.h>
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef BLE_CONFIG_SERVICE_BYTES
+#define BLE_CONFIG_SERVICE_BYTES 2048       // 单个服务的 JSON 文档容量：决定配置加载的峰值内存，与文件大小无关
+#endif
+
+// 配置文件的字节来源（SPIFFS 文件、主机测试中的内存字符串等）
+class GattConfigSource {
+public:
+    virtual ~GattConfigSource() = default;
+    virtual int read() = 0;                         // 读取一个字节，结束时返回 -1
+};
+
+// 流式读取 ble_config.json：顶层只做词法扫描，services 数组逐个元素反序列化到同一个定长文档中，
+// 处理完一个服务立即清空再读下一个。峰值内存 = 一个服务文档（BLE_CONFIG_SERVICE_BYTES）+ 过滤器，
+// 不随文件大小增长；整个文件从不完整驻留在内存中
+//
+// ⚠️ ble_device_name 必须写在 services 之前（回调 onDeviceName 先于第一个 onService），否则使用默认名称
+// ⚠️ 单个服务超过 BLE_CONFIG_SERVICE_BYTES 时返回 false（error() 为 "NoMemory"），此时应拆分服务或调大该宏
+class GattConfigReader {
+public:
+    typedef std::function<void(const char* name)> DeviceNameHandler;
+    typedef std::function<bool(JsonObjectConst service)> ServiceHandler;      // 返回 false 中止读取
+
+    GattConfigReader();
+
+    // 读取整个配置；services 之前出现的 ble_device_name 通过 onDeviceName 回调，每个服务通过 onService 回调
+    bool read(GattConfigSource& source, const DeviceNameHandler& onDeviceName, const ServiceHandler& onService);
+
+    const char* error() const { return _error; }
+    size_t serviceCount() const { return _services; }
+    size_t peakDocumentBytes() const { return _peakBytes; }        // 单个服务文档的最大实际占用
+    static constexpr size_t capacity() { return BLE_CONFIG_SERVICE_BYTES; }
+
+    // ArduinoJson 自定义读取器接口（read / readBytes），带一个字节的回退，供顶层扫描预读
+    class Reader {
+    public:
+        explicit Reader(GattConfigSource& source) : _source(source) {}
+        int read();
+        size_t readBytes(char* buffer, size_t length);
+        int peek();
+        int skipWhitespace();                      // 跳过空白，返回下一个字符（不消费）
+    private:
+        GattConfigSource& _source;
+        int _pending = -2;                          // -2 表示没有预读的字节
+    };
+
+private:
+    bool readString(Reader& in, char* out, size_t size);   // 读取一个 JSON 字符串（当前字符必须是引号），超长部分截断
+    bool skipValue(Reader& in);                     // 跳过任意一个 JSON 值
+    bool readServices(Reader& in, const ServiceHandler& onService);
+    bool fail(const char* error);
+
+    StaticJsonDocument<384> _filter;                // 只保留建 GATT 用得到的字段
+    const char* _error = nullptr;
+    size_t _services = 0;
+    size_t _peakBytes = 0;
+};
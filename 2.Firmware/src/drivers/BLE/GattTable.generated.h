@@ -0,0 +1,55 @@
+// ⚠️ 自动生成的文件，请勿手动修改
+// 来源: data/ble_config.json（经 data/ble_config.schema.json 校验），生成脚本: scripts/gen-gatt-table.py
+#pragma once
+#include "GattTable.h"
+
+static constexpr uint8_t GATT_VALUE_0_0[] = {170, 85, 3, 129};
+static constexpr uint8_t GATT_VALUE_0_1[] = {170, 85, 3, 129};
+static constexpr uint8_t GATT_VALUE_0_2[] = {0};
+static constexpr GattCharacteristicDef GATT_CHARACTERISTICS_0[] = {
+    {"ef010001-1000-8000-0080-5f9b34fb0000", "MotorWrite", "给电机发送控制指令", GATT_PROP_WRITE_NR, GATT_VALUE_0_0, 4, {GATT_NOTIFY_EVENT, false, 0}},
+    {"ef010002-1000-8000-0080-5f9b34fb0000", "MotorRead", "读取电机状态", GATT_PROP_READ | GATT_PROP_NOTIFY, GATT_VALUE_0_1, 4, {GATT_NOTIFY_STATE, false, 20}},
+    {"ef010003-1000-8000-0080-5f9b34fb0000", "MotorClock", "时钟同步(写 01 seq t1 / 02 seq t4，通知 81 seq t1 t2 t3 播放延迟ms)", GATT_PROP_WRITE_NR | GATT_PROP_NOTIFY, GATT_VALUE_0_2, 1, {GATT_NOTIFY_EVENT, false, 0}},
+};
+
+static constexpr uint8_t GATT_VALUE_1_0[] = {69, 114, 114, 111, 82, 105, 103, 104, 116, 65, 73};
+static constexpr uint8_t GATT_VALUE_1_1[] = {48, 46, 49, 46, 48};
+static constexpr uint8_t GATT_VALUE_1_2[] = {48, 46, 49, 46, 48};
+static constexpr uint8_t GATT_VALUE_1_3[] = {49, 50, 51, 52, 53, 54, 55, 56, 57, 48};
+static constexpr GattCharacteristicDef GATT_CHARACTERISTICS_1[] = {
+    {"2a29", "ManufacturerNameString", "设备制造商名称", GATT_PROP_READ, GATT_VALUE_1_0, 11, {GATT_NOTIFY_EVENT, false, 0}},
+    {"2a26", "FirmwareRevisionString", "设备固件版本", GATT_PROP_READ, GATT_VALUE_1_1, 5, {GATT_NOTIFY_EVENT, false, 0}},
+    {"2a27", "HardwareRevisionString", "设备硬件版本", GATT_PROP_READ, GATT_VALUE_1_2, 5, {GATT_NOTIFY_EVENT, false, 0}},
+    {"2a25", "SerialNumberString", "设备序列号", GATT_PROP_READ, GATT_VALUE_1_3, 10, {GATT_NOTIFY_EVENT, false, 0}},
+};
+
+static constexpr uint8_t GATT_VALUE_2_0[] = {0};
+static constexpr uint8_t GATT_VALUE_2_1[] = {0};
+static constexpr GattCharacteristicDef GATT_CHARACTERISTICS_2[] = {
+    {"ef050001-1000-8000-0080-5f9b34fb0000", "ClipControl", "动作片段命令(01 id_lo id_hi [mode] [blend_lo blend_hi]:播放, 02:停止, 03:清空队列)", GATT_PROP_WRITE_NR, GATT_VALUE_2_0, 1, {GATT_NOTIFY_EVENT, false, 0}},
+    {"ef050002-1000-8000-0080-5f9b34fb0000", "ClipStatus", "动作片段状态([事件][层][id_lo][id_hi]，事件 1:开始, 2:结束, 3:停止, 4:失败, 5:队列已满)", GATT_PROP_READ | GATT_PROP_NOTIFY, GATT_VALUE_2_1, 1, {GATT_NOTIFY_EVENT, false, 0}},
+};
+
+static constexpr uint8_t GATT_VALUE_3_0[] = {0};
+static constexpr uint8_t GATT_VALUE_3_1[] = {0};
+static constexpr uint8_t GATT_VALUE_3_2[] = {0};
+static constexpr GattCharacteristicDef GATT_CHARACTERISTICS_3[] = {
+    {"ef040001-1000-8000-0080-5f9b34fb0000", "OTAControl", "OTA控制命令(0:开始升级, 1:取消升级, 2:确认升级)", GATT_PROP_WRITE, GATT_VALUE_3_0, 1, {GATT_NOTIFY_EVENT, false, 0}},
+    {"ef040002-1000-8000-0080-5f9b34fb0000", "OTAData", "OTA固件数据包", GATT_PROP_WRITE_NR, GATT_VALUE_3_1, 1, {GATT_NOTIFY_EVENT, false, 0}},
+    {"ef040003-1000-8000-0080-5f9b34fb0000", "OTAStatus", "OTA状态(0:空闲, 1:准备升级, 2:升级中, 3:升级完成, 4:升级失败)", GATT_PROP_READ | GATT_PROP_NOTIFY, GATT_VALUE_3_2, 1, {GATT_NOTIFY_EVENT, false, 0}},
+};
+
+static constexpr uint8_t GATT_VALUE_4_0[] = {0};
+static constexpr GattCharacteristicDef GATT_CHARACTERISTICS_4[] = {
+    {"ef060001-1000-8000-0080-5f9b34fb0000", "Diagnostics", "运行指标(写 01:快照, 02:清零直方图与峰值, 03:名称表；通知 [命令|80][分片序号][分片总数][数据])", GATT_PROP_READ | GATT_PROP_WRITE | GATT_PROP_NOTIFY, GATT_VALUE_4_0, 1, {GATT_NOTIFY_EVENT, false, 0}},
+};
+
+static constexpr GattServiceDef GATT_SERVICES[] = {
+    {"ff010000-1000-8000-0080-5f9b34fb0000", "MotorService", GATT_CHARACTERISTICS_0, 3, false},
+    {"180a", "DeviceInformationService", GATT_CHARACTERISTICS_1, 4, true},
+    {"ff050000-1000-8000-0080-5f9b34fb0000", "AnimationService", GATT_CHARACTERISTICS_2, 2, true},
+    {"ff040000-1000-8000-0080-5f9b34fb0000", "OTAService", GATT_CHARACTERISTICS_3, 3, true},
+    {"ff060000-1000-8000-0080-5f9b34fb0000", "DiagnosticsService", GATT_CHARACTERISTICS_4, 1, true},
+};
+
+static constexpr GattTableDef GATT_TABLE = {"open_mibai_robot", GATT_SERVICES, 5, 13};
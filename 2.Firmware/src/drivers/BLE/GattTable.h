@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+
+// 编译期 GATT 表：构建时由 scripts/gen-gatt-table.py 把 data/ble_config.json 转换成 GattTable.generated.h
+// 启动时 BLEServerWrapper 直接遍历这张表创建服务和特征，不再挂载 SPIFFS、不再解析 JSON
+// 表中所有字符串和初始值都位于 Flash（.rodata），运行期不占用堆
+
+// 特征属性（与 ble_config.json 中 type 数组的取值一一对应）
+enum GattProperty : uint8_t {
+    GATT_PROP_READ = 0x01,
+    GATT_PROP_WRITE = 0x02,
+    GATT_PROP_NOTIFY = 0x04,
+    GATT_PROP_WRITE_NR = 0x08,                      // WRITE_NO_RESPONSE
+};
+
+// 通知策略（ble_config.json 中特征的 notify 字段，见 NotifyQueue）
+enum GattNotifyMode : uint8_t {
+    GATT_NOTIFY_EVENT = 0,                          // 事件型：按顺序逐条发送，从不合并（默认）
+    GATT_NOTIFY_STATE = 1,                          // 状态型：只保留最新值，按 minIntervalMs 限速
+};
+
+struct GattNotifyPolicy {
+    uint8_t mode;                                   // GattNotifyMode
+    bool pack;                                      // 事件型：积压的多条通知打包成一个 MTU 大小的通知（每条前加 1 字节长度）
+    uint16_t minIntervalMs;                         // 状态型：两次通知的最小间隔，0 表示不限速
+};
+
+struct GattCharacteristicDef {
+    const char* uuid;
+    const char* name;                               // 配置中的特征名，用于按名订阅
+    const char* description;                        // 非空时添加 0x2901 用户描述符
+    uint8_t properties;                             // GattProperty 位组合，含 NOTIFY 时添加 0x2902 CCCD
+    const uint8_t* value;                           // 初始值（已按 value_format 转换成字节），可为空
+    uint16_t valueLength;
+    GattNotifyPolicy notify;                        // 只对含 NOTIFY 的特征有意义
+};
+
+struct GattServiceDef {
+    const char* uuid;
+    const char* name;
+    const GattCharacteristicDef* characteristics;
+    uint8_t characteristicCount;
+    bool deferred;                                  // 配置中 boot 为 "deferred"：开始广播之后再创建
+};
+
+struct GattTableDef {
+    const char* deviceName;
+    const GattServiceDef* services;
+    uint8_t serviceCount;
+    uint8_t characteristicCount;                    // 所有服务的特征总数
+};
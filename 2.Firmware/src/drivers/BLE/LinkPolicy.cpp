@@ -0,0 +1,188 @@
+#include "LinkPolicy.h"
+#include "serial_color_debug.h"
+
+namespace {
+// 各档位请求的参数：监督超时需大于 (1 + 从机延迟) × 最大间隔 × 2
+const LinkProfile PROFILES[LINK_WORKLOAD_COUNT] = {
+    // IDLE：100–200ms，允许跳过 4 个连接事件，6s 超时；数据长度保持，PHY 回到 1M（距离更远、更稳）
+    {80, 160, 4, 600, 0, LinkPhy::PHY_1M},
+    // STREAMING：7.5–11.25ms，无从机延迟，2s 超时（尽快发现断线并停止运动）；运动帧可能超过 27 字节，开启数据长度扩展
+    {6, 9, 0, 200, 251, LinkPhy::KEEP},
+    // BULK：7.5–15ms，无从机延迟，4s 超时；2M PHY + 251 字节数据长度，一个连接事件内可以发更多、更快的包
+    {6, 12, 0, 400, 251, LinkPhy::PHY_2M},
+};
+
+const char* const WORKLOAD_NAMES[LINK_WORKLOAD_COUNT] = {"idle", "streaming", "bulk"};
+
+const uint32_t HOLD_MS[LINK_WORKLOAD_COUNT] = {0, LINK_STREAMING_HOLD_MS, LINK_BULK_HOLD_MS};
+}  // namespace
+
+const LinkProfile& LinkPolicy::profile(LinkWorkload workload) {
+    return PROFILES[(uint8_t)workload];
+}
+
+const char* LinkPolicy::workloadName(LinkWorkload workload) {
+    return (uint8_t)workload < LINK_WORKLOAD_COUNT ? WORKLOAD_NAMES[(uint8_t)workload] : "?";
+}
+
+void LinkPolicy::setBackend(const Backend& backend) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _backend = backend;
+}
+
+bool LinkPolicy::begin() {
+    if (_timer) return true;
+    esp_timer_create_args_t args = {};
+    args.callback = &LinkPolicy::onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "link_policy";
+    if (esp_timer_create(&args, &_timer) != ESP_OK) {
+        DEBUG_ERROR("❌ 创建链路策略定时器失败");
+        _timer = nullptr;
+        return false;
+    }
+    esp_timer_start_periodic(_timer, LINK_POLICY_TICK_MS * 1000ULL);
+    return true;
+}
+
+void LinkPolicy::end() {
+    if (!_timer) return;
+    esp_timer_stop(_timer);
+    esp_timer_delete(_timer);
+    _timer = nullptr;
+}
+
+void LinkPolicy::onTimer(void* arg) {
+    static_cast<LinkPolicy*>(arg)->evaluate(millis());
+}
+
+// 热路径：每个运动帧一次，只有两次原子写；比已请求的档位高时才进入 evaluate 立即升档
+void LinkPolicy::hint(LinkWorkload workload, uint32_t nowMs) {
+    uint8_t index = (uint8_t)workload;
+    if (index >= LINK_WORKLOAD_COUNT) return;
+    _lastHintMs[index].store(nowMs, std::memory_order_relaxed);
+    if (!(_hinted.load(std::memory_order_relaxed) & (1u << index))) {
+        _hinted.fetch_or((uint8_t)(1u << index), std::memory_order_relaxed);
+    }
+    if (index > _requested.load(std::memory_order_relaxed)) {
+        evaluate(nowMs);
+    }
+}
+
+LinkWorkload LinkPolicy::desired(uint32_t nowMs) const {
+    uint8_t hinted = _hinted.load(std::memory_order_relaxed);
+    for (uint8_t i = LINK_WORKLOAD_COUNT - 1; i > 0; --i) {
+        if (!(hinted & (1u << i))) continue;
+        if (nowMs - _lastHintMs[i].load(std::memory_order_relaxed) < HOLD_MS[i]) return (LinkWorkload)i;
+    }
+    return LinkWorkload::IDLE;
+}
+
+void LinkPolicy::evaluate(uint32_t nowMs) {
+    LinkWorkload target = desired(nowMs);
+    LinkProfile wanted;
+    bool sendDataLength = false;
+    bool sendPhy = false;
+    Backend backend;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_status.connected) return;
+        if (_hasRequested && target == _status.workload) return;
+        // 刚连接时保持中心设备选的参数（通常较短，服务发现更快），稳定后再放宽
+        if (!_hasRequested && target == LinkWorkload::IDLE && nowMs - _connectedAtMs < LINK_IDLE_SETTLE_MS) return;
+
+        wanted = profile(target);
+        sendDataLength = wanted.dataLength != 0 && wanted.dataLength != _requestedDataLength;
+        sendPhy = wanted.phy != LinkPhy::KEEP && wanted.phy != _requestedPhy && _status.phySupported;
+        if (sendDataLength) _requestedDataLength = wanted.dataLength;
+        if (sendPhy) _requestedPhy = wanted.phy;
+        _status.workload = target;
+        _status.requests++;
+        _hasRequested = true;
+        _requested.store((uint8_t)target, std::memory_order_relaxed);
+        backend = _backend;
+    }
+
+    // 请求函数在锁外调用：协议栈可能在同一调用链中回调 on* 方法
+    DEBUG_INFOF("🔗 链路档位 → %s：间隔 %u–%u×1.25ms 从机延迟 %u 超时 %ums",
+                workloadName(target), wanted.minInterval, wanted.maxInterval, wanted.latency, wanted.timeout * 10u);
+    uint32_t failed = 0;
+    if (backend.updateParams && !backend.updateParams(wanted)) failed++;
+    if (sendDataLength && backend.setDataLength && !backend.setDataLength(wanted.dataLength)) failed++;
+    if (sendPhy && backend.setPhy && !backend.setPhy(wanted.phy)) {
+        std::lock_guard<std::mutex> lock(_lock);
+        _status.phySupported = false;               // 不再请求；status 中保持 1M
+        DEBUG_WARN("⚠️ 当前芯片不支持切换 PHY，批量传输保持 1M PHY");
+    }
+    if (failed) {
+        std::lock_guard<std::mutex> lock(_lock);
+        _status.rejected += failed;
+    }
+}
+
+void LinkPolicy::onConnect(uint32_t nowMs) {
+    std::lock_guard<std::mutex> lock(_lock);
+    bool phySupported = _status.phySupported;
+    uint32_t requests = _status.requests;
+    uint32_t rejected = _status.rejected;
+    uint32_t changes = _status.changes;
+    _status = LinkStatus();
+    _status.connected = true;
+    _status.phySupported = phySupported;            // 芯片能力与累计计数跨连接保留
+    _status.requests = requests;
+    _status.rejected = rejected;
+    _status.changes = changes + 1;
+    _hasRequested = false;
+    _connectedAtMs = nowMs;
+    _requestedDataLength = 0;
+    _requestedPhy = LinkPhy::PHY_1M;
+    _requested.store((uint8_t)LinkWorkload::IDLE, std::memory_order_relaxed);
+}
+
+void LinkPolicy::onDisconnect() {
+    std::lock_guard<std::mutex> lock(_lock);
+    _status.connected = false;
+    _status.changes++;
+    _hasRequested = false;
+    _requested.store((uint8_t)LinkWorkload::IDLE, std::memory_order_relaxed);
+}
+
+void LinkPolicy::onParamsUpdated(bool ok, uint16_t interval, uint16_t latency, uint16_t timeout) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (!ok) {
+        _status.rejected++;
+        return;
+    }
+    _status.interval = interval;
+    _status.latency = latency;
+    _status.timeout = timeout;
+    _status.changes++;
+}
+
+void LinkPolicy::onDataLength(bool ok, uint16_t txOctets, uint16_t rxOctets) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (!ok) {
+        _status.rejected++;
+        return;
+    }
+    _status.txOctets = txOctets;
+    _status.rxOctets = rxOctets;
+    _status.changes++;
+}
+
+void LinkPolicy::onPhy(bool ok, uint8_t txPhy, uint8_t rxPhy) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (!ok) {
+        _status.rejected++;
+        return;
+    }
+    _status.txPhy = txPhy;
+    _status.rxPhy = rxPhy;
+    _status.changes++;
+}
+
+LinkStatus LinkPolicy::status() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _status;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <esp_timer.h>
+#include "drivers/Transport/MessageTransport.h"
+
+#ifndef LINK_POLICY_TICK_MS
+#define LINK_POLICY_TICK_MS 250                     // 档位回落的评估周期
+#endif
+
+#ifndef LINK_STREAMING_HOLD_MS
+#define LINK_STREAMING_HOLD_MS 2000                 // 最后一个运动帧之后保持低延迟参数的时间
+#endif
+
+#ifndef LINK_BULK_HOLD_MS
+#define LINK_BULK_HOLD_MS 3000                      // OTA 会话结束（或挂起）之后保持批量参数的时间
+#endif
+
+#ifndef LINK_IDLE_SETTLE_MS
+#define LINK_IDLE_SETTLE_MS 5000                    // 连接后等服务发现完成再请求空闲参数（过早请求会拖慢发现，iOS 也常拒绝）
+#endif
+
+static const uint8_t LINK_WORKLOAD_COUNT = 3;
+
+// 链路 PHY 偏好
+enum class LinkPhy : uint8_t {
+    KEEP = 0,           // 不请求，保持当前 PHY
+    PHY_1M = 1,
+    PHY_2M = 2
+};
+
+// 一个档位请求的链路参数（单位与 HCI 一致）
+struct LinkProfile {
+    uint16_t minInterval;   // 连接间隔下限，1.25ms
+    uint16_t maxInterval;   // 连接间隔上限，1.25ms
+    uint16_t latency;       // 从机延迟（允许跳过的连接事件数）
+    uint16_t timeout;       // 监督超时，10ms
+    uint16_t dataLength;    // LL 数据长度（27..251），0 表示不请求
+    LinkPhy phy;
+};
+
+// 当前档位与协商结果（协商值来自协议栈回调，0 表示尚未收到）
+struct LinkStatus {
+    bool connected = false;
+    LinkWorkload workload = LinkWorkload::IDLE; // 最近一次请求的档位
+    uint16_t interval = 0;                      // 协商的连接间隔，1.25ms
+    uint16_t latency = 0;
+    uint16_t timeout = 0;                       // 10ms
+    uint16_t mtu = 23;                          // 由 BLEServerWrapper::linkStatus 填写
+    uint16_t txOctets = 27;                     // LL 数据长度，未扩展时为 27
+    uint16_t rxOctets = 27;
+    uint8_t txPhy = 1;                          // 1 = 1M，2 = 2M，3 = Coded
+    uint8_t rxPhy = 1;
+    bool phySupported = true;                   // 芯片 / 协议栈不支持 PHY 切换时为 false（经典 ESP32）
+    uint32_t requests = 0;                      // 发出的参数更新请求数
+    uint32_t rejected = 0;                      // 发起失败或被中心设备拒绝的请求数
+    uint32_t changes = 0;                       // 收到的协商结果数（每次变化加一，打印统计时用来判断是否有新值）
+};
+
+// 链路策略：按当前负载档位向中心设备请求连接间隔、从机延迟、PHY 与数据长度
+// - 控制器调用 hint(档位) 刷新该档位的最后活跃时间（OTA 会话进行中 → BULK，收到运动帧 → STREAMING），
+//   取仍在保持期内的最高档位；升档在 hint 中立即请求，降档由周期定时器在保持期过后请求
+// - 同一档位只请求一次；被拒绝时不重试，直到档位变化（中心设备可能有自己的限制，例如 iOS 最短 15ms）
+// - 协商结果由协议栈回调（on* 方法）写回，status() 读取，用于把吞吐数据与链路参数对应起来
+//
+// 请求函数由 BLEServerWrapper 注入，本类不依赖 BLE 库；不调用 begin() 时可以直接调用 evaluate()（主机测试）
+class LinkPolicy {
+public:
+    struct Backend {
+        std::function<bool(const LinkProfile& profile)> updateParams;     // 发起连接参数更新，失败返回 false
+        std::function<bool(uint16_t octets)> setDataLength;               // 发起数据长度更新
+        std::function<bool(LinkPhy phy)> setPhy;                          // 发起 PHY 更新，不支持时返回 false
+    };
+
+    static const LinkProfile& profile(LinkWorkload workload);
+    static const char* workloadName(LinkWorkload workload);
+
+    void setBackend(const Backend& backend);
+    bool begin();                                   // 启动周期评估定时器
+    void end();
+
+    void hint(LinkWorkload workload) { hint(workload, millis()); }
+    void hint(LinkWorkload workload, uint32_t nowMs);
+    void evaluate(uint32_t nowMs);                  // 按保持期选出档位，与已请求的不同则发起请求
+
+    // 协议栈事件（在 Bluedroid 任务中调用）
+    void onConnect(uint32_t nowMs);
+    void onDisconnect();
+    void onParamsUpdated(bool ok, uint16_t interval, uint16_t latency, uint16_t timeout);
+    void onDataLength(bool ok, uint16_t txOctets, uint16_t rxOctets);
+    void onPhy(bool ok, uint8_t txPhy, uint8_t rxPhy);
+
+    LinkStatus status() const;
+
+private:
+    static void onTimer(void* arg);
+    LinkWorkload desired(uint32_t nowMs) const;
+
+    Backend _backend;
+    esp_timer_handle_t _timer = nullptr;
+    std::atomic<uint32_t> _lastHintMs[LINK_WORKLOAD_COUNT] = {};
+    std::atomic<uint8_t> _hinted{0};                // bit i：档位 i 提示过（从未提示过的档位不参与选择）
+    std::atomic<uint8_t> _requested{0};             // 已请求的档位（hint 无锁比较，决定是否立即升档）
+
+    mutable std::mutex _lock;                       // 保护以下状态（定时器、hint 调用方、协议栈回调三方并发）
+    LinkStatus _status;
+    bool _hasRequested = false;                     // 本次连接是否已经请求过任何档位
+    uint32_t _connectedAtMs = 0;
+    uint16_t _requestedDataLength = 0;
+    LinkPhy _requestedPhy = LinkPhy::PHY_1M;
+};
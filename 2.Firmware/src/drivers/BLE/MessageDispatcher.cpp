@@ -1,24 +1,128 @@
 #include "MessageDispatcher.h"
+#include "MessageConsumer.h"
+#include <Arduino.h>
 #include "serial_color_debug.h"
+#include "utils/FastLog.h"
 
-void MessageDispatcher::enqueue(const BLEWriteMessage& msg) {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (queue.size() >= MAX_SIZE) {
-        DEBUG_WARN("⚠️ 写入队列已满，丢弃消息");
-        return;
+MessageDispatcher::MessageDispatcher()
+    : smallPool(DISPATCHER_SMALL_PAYLOAD, SMALL_BLOCKS), pool(BLE_MAX_PAYLOAD_SIZE, POOL_BLOCKS) {
+    for (std::atomic<MessageConsumer*>& route : routes) {
+        route.store(nullptr, std::memory_order_relaxed);
     }
-    queue.push_back(msg);
 }
 
-bool MessageDispatcher::hasMessage() {
-    std::lock_guard<std::mutex> lock(mutex);
+CharHandle MessageDispatcher::subscribe(const char* nameOrUuid, MessageConsumer* consumer) {
+    CharHandle handle = registry.findByName(nameOrUuid);
+    if (handle == INVALID_CHAR_HANDLE) {
+        handle = registry.find(nameOrUuid);
+    }
+    if (handle == INVALID_CHAR_HANDLE) {
+        DEBUG_WARNF("⚠️ 订阅失败，配置中不存在的特征: %s", nameOrUuid);
+        return INVALID_CHAR_HANDLE;
+    }
+    MessageConsumer* previous = routes[handle].load(std::memory_order_relaxed);
+    if (previous && previous != consumer) {
+        DEBUG_WARNF("⚠️ 特征 %s 已有订阅者，将被覆盖", nameOrUuid);
+    }
+    routes[handle].store(consumer, std::memory_order_release);
+    DEBUG_INFOF("✅ 订阅特征 %s → 句柄 %d", registry.nameOf(handle), handle);
+    return handle;
+}
+
+bool MessageDispatcher::dispatch(const BLEWriteMessage& msg) {
+    MessageConsumer* consumer = route(msg.handle);
+    if (!consumer) return false;
+    consumer->handleMessage(msg);
+    return true;
+}
+
+PayloadRef MessageDispatcher::acquirePayload(const uint8_t* data, size_t len) {
+    if (len > BLE_MAX_PAYLOAD_SIZE) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        FLOG_WARN("⚠️ 消息长度 %u 超过上限 %u，丢弃消息", (unsigned)len, (unsigned)BLE_MAX_PAYLOAD_SIZE);
+        return PayloadRef();
+    }
+    PayloadRef ref;
+    if (len <= DISPATCHER_SMALL_PAYLOAD) ref = smallPool.acquire(data, len);
+    if (!ref) ref = pool.acquire(data, len);        // 长写入，或小块已被占满
+    if (!ref) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        FLOG_WARN("⚠️ 负载池已耗尽，丢弃消息");
+    }
+    return ref;
+}
+
+bool MessageDispatcher::enqueue(CharHandle handle, const uint8_t* data, size_t len) {
+    if (!isRouted(handle)) {                        // 无订阅者：直接拒绝，不占用负载块和队列槽位
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (queue.size() >= SLOT_COUNT) {               // 队列满时先拒绝，避免白白占用负载块
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        FLOG_WARN("⚠️ 写入队列已满，丢弃消息");
+        return false;
+    }
+    BLEWriteMessage msg;
+    msg.handle = handle;
+    msg.data = acquirePayload(data, len);
+    if (!msg.data) return false;
+    return push(std::move(msg));
+}
+
+bool MessageDispatcher::enqueue(const BLEWriteMessage& msg) {
+    BLEWriteMessage copy = msg;                     // 只拷贝句柄（引用计数 +1），不拷贝负载
+    return push(std::move(copy));
+}
+
+bool MessageDispatcher::push(BLEWriteMessage&& msg) {
+    BLEWriteMessage* slot = queue.beginWrite();
+    if (!slot) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        FLOG_WARN("⚠️ 写入队列已满，丢弃消息");
+        return false;
+    }
+    *slot = std::move(msg);
+    slot->enqueueMicros = micros();
+    queue.commitWrite();
+    depthHighWater.update((int32_t)queue.size());
+
+    TaskHandle_t task = consumerTask.load(std::memory_order_acquire);
+    if (task) {
+        xTaskNotifyGive(task);              // 发布之后再通知，消费者醒来时一定能看到这条消息
+    }
+    return true;
+}
+
+bool MessageDispatcher::tryPop(BLEWriteMessage& out) {
+    BLEWriteMessage* slot = queue.front();
+    if (!slot) return false;
+    out = std::move(*slot);                 // 移交负载句柄，槽位随之变为空句柄
+    queue.popFront();
+    return true;
+}
+
+bool MessageDispatcher::hasMessage() const {
     return !queue.empty();
 }
 
 BLEWriteMessage MessageDispatcher::pop() {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (queue.empty()) return {};
-    auto msg = queue.front();
-    queue.pop_front();
+    BLEWriteMessage msg;
+    tryPop(msg);
     return msg;
-}
\ No newline at end of file
+}
+
+bool MessageDispatcher::waitForMessage(TickType_t timeout) {
+    // pdTRUE：一次取走所有累积的通知，醒来后由调用方一次性把队列排空
+    return ulTaskNotifyTake(pdTRUE, timeout) > 0;
+}
+
+void MessageDispatcher::registerMetrics() {
+    Metrics::addGauge("dispatch.depth_peak", "msg", depthHighWater);
+    Metrics::addCounter("dispatch.dropped", "msg", dropped);
+    Metrics::addCounter("dispatch.rejected", "msg", rejected);
+    Metrics::addHistogram("dispatch.latency", "us", latencyHistogram);
+}
+
+void MessageDispatcher::markHandled(const BLEWriteMessage& msg) {
+    latencyHistogram.record(micros() - msg.enqueueMicros);
+}
@@ -1,22 +1,103 @@
 #pragma once
-#include <deque>
-#include <vector>
-#include <string>
-#include <mutex>
+#include <atomic>
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "utils/SPSCRing.h"
+#include "utils/PayloadPool.h"
+#include "utils/LatencyHistogram.h"
+#include "utils/Metrics.h"
+#include "CharacteristicRegistry.h"
+
+#ifndef DISPATCHER_QUEUE_BYTES
+#define DISPATCHER_QUEUE_BYTES (16 * 1024)              // 大负载块（MTU 上限）的内存预算（字节），可通过 build_flags 覆盖
+#endif
+
+#ifndef DISPATCHER_QUEUE_SLOTS
+#define DISPATCHER_QUEUE_SLOTS 256                      // 写入队列深度（条，2 的幂），与改造前 deque 的上限相同
+#endif
+
+#ifndef DISPATCHER_SMALL_PAYLOAD
+#define DISPATCHER_SMALL_PAYLOAD 32                     // 小负载块容量：控制命令、时钟同步等短写入用小块
+#endif
+
+#ifndef BLE_MAX_PAYLOAD_SIZE
+#define BLE_MAX_PAYLOAD_SIZE 512                        // 单条 BLE 写入的最大长度（与 MTU 上限一致）
+#endif
+
+class MessageConsumer;
 
 struct BLEWriteMessage {            // BLE 写入消息结构体
-    std::string uuid;               // 特征 UUID
-    std::vector<uint8_t> data;      // 数据
+    CharHandle handle = INVALID_CHAR_HANDLE;    // 特征句柄（由 CharacteristicRegistry 驻留 UUID 得到）
+    PayloadRef data;                // 负载：负载池中的引用计数切片，传递时不拷贝数据
+    uint32_t enqueueMicros = 0;     // 入队时间戳（micros()），用于统计入队→处理延迟
 };
 
 class MessageDispatcher {
 public:
-    void enqueue(const BLEWriteMessage& msg);       // 添加消息到队列
-    bool hasMessage();                              // 检查队列是否有消息   
-    BLEWriteMessage pop();                          // 从队列中取出消息
+    MessageDispatcher();
+
+    // 特征 UUID ⇄ 句柄表，由 BLEServerWrapper::begin 在加载配置时填充
+    CharacteristicRegistry& characteristics() { return registry; }
+    const CharacteristicRegistry& characteristics() const { return registry; }
+
+    // 路由表：消费者在启动时按特征名（如 "OTAControl"）或 UUID 订阅，订阅时解析成句柄
+    // 之后分发只是一次数组索引；没有订阅者的特征写入会在 BLE 回调里直接拒绝，不占用队列
+    // 可以在广播之后订阅（模块在后台初始化中就绪后才订阅），表项是原子指针，与 BLE 回调并发读取是安全的
+    CharHandle subscribe(const char* nameOrUuid, MessageConsumer* consumer);
+    bool isRouted(CharHandle handle) const { return route(handle) != nullptr; }
+    bool dispatch(const BLEWriteMessage& msg);      // 把消息交给订阅者处理，无订阅者时返回 false
+
+    // 从负载池取一块并拷贝数据（整个写入路径唯一的一次拷贝），池耗尽时返回空句柄
+    PayloadRef acquirePayload(const uint8_t* data, size_t len);
+
+    // 生产者（BLE 回调）调用：数据拷贝进负载池后入队，未订阅/队列满/池耗尽/数据超长时丢弃并返回 false
+    bool enqueue(CharHandle handle, const uint8_t* data, size_t len);
+    bool enqueue(const BLEWriteMessage& msg);       // 入队已持有负载的消息（只增加引用计数）
+
+    // 消费者（bleWriteTask）调用：非阻塞取出一条消息，负载句柄直接移交给调用方
+    bool tryPop(BLEWriteMessage& out);
+    bool hasMessage() const;                        // 检查队列是否有消息
+    BLEWriteMessage pop();                          // 从队列中取出消息（兼容旧接口）
+
+    size_t size() const { return queue.size(); }
+    uint32_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+    uint32_t rejectedCount() const { return rejected.load(std::memory_order_relaxed); }
+    int32_t depthPeak() const { return depthHighWater.value(); }      // 队列深度高水位（Metrics::reset 清零）
+    void registerMetrics();                         // 登记到 Metrics：深度高水位、丢弃、拒绝、入队→处理延迟
+
+    // 事件驱动唤醒：消费者任务登记自己后，每次入队都会通过任务通知直接唤醒它，不再轮询
+    void setConsumerTask(TaskHandle_t task) { consumerTask.store(task, std::memory_order_release); }
+    bool waitForMessage(TickType_t timeout = portMAX_DELAY);   // 阻塞等待入队通知，超时返回 false
+
+    // 入队→处理延迟：消费者处理完一条消息后调用 markHandled()
+    void markHandled(const BLEWriteMessage& msg);
+    LatencyHistogram& latency() { return latencyHistogram; }
+
+    // 队列深度与负载池分开设定：
+    // - 槽位数 SLOT_COUNT 独立配置；≤ DISPATCHER_SMALL_PAYLOAD 的写入用小块，小块数与槽位数相同，短消息填满队列之前不会因池耗尽丢弃
+    // - 大块按内存预算换算：块数 = 预算 / MTU，决定同时在途的长写入（OTA v0 数据、长电机帧）条数
+    // - 小块被占满（消费者还持有引用）时借用大块
+    static constexpr size_t SLOT_COUNT = DISPATCHER_QUEUE_SLOTS;
+    static constexpr size_t SMALL_BLOCKS = SLOT_COUNT;
+    static constexpr size_t POOL_BLOCKS = DISPATCHER_QUEUE_BYTES / BLE_MAX_PAYLOAD_SIZE;
+    static_assert(spscFloorPow2(SLOT_COUNT) == SLOT_COUNT, "DISPATCHER_QUEUE_SLOTS 必须是 2 的幂");
+    static_assert(SMALL_BLOCKS <= PayloadPool::MAX_BLOCKS && POOL_BLOCKS <= PayloadPool::MAX_BLOCKS, "负载块数超过 PayloadPool 上限");
 
 private:
-    std::deque<BLEWriteMessage> queue;          // 消息队列
-    std::mutex mutex;                           // 互斥锁，用于线程安全
-    const size_t MAX_SIZE = 256;                // 队列最大大小，适配高频OTA
+    bool push(BLEWriteMessage&& msg);
+    MessageConsumer* route(CharHandle handle) const {
+        return handle < CharacteristicRegistry::MAX_CHARACTERISTICS ? routes[handle].load(std::memory_order_acquire) : nullptr;
+    }
+
+    CharacteristicRegistry registry;                // 特征句柄表
+    std::atomic<MessageConsumer*> routes[CharacteristicRegistry::MAX_CHARACTERISTICS];   // 句柄 → 订阅者（构造时清零）
+    PayloadPool smallPool;                          // 预分配的小负载块（短写入）
+    PayloadPool pool;                               // 预分配的大负载块（MTU 上限）
+    SPSCRing<BLEWriteMessage, SLOT_COUNT> queue;    // 无锁消息队列（单生产者：BLE 回调；单消费者：bleWriteTask）
+    std::atomic<uint32_t> dropped{0};               // 因队列满、池耗尽或超长被丢弃的消息数
+    std::atomic<uint32_t> rejected{0};              // 写入了没有订阅者的特征而被拒绝的消息数
+    std::atomic<TaskHandle_t> consumerTask{nullptr};   // 等待消息的消费者任务
+    LatencyHistogram latencyHistogram;              // 入队→处理延迟分布
+    MetricGauge depthHighWater{MetricGauge::HIGH_WATER};   // 入队后的队列深度峰值
 };
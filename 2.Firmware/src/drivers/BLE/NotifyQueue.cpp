@@ -0,0 +1,168 @@
+#include "NotifyQueue.h"
+#include <Arduino.h>
+#include <string.h>
+#include "utils/FastLog.h"
+#include "utils/Metrics.h"
+
+NotifyQueue::NotifyQueue() {
+    for (size_t i = 0; i < CharacteristicRegistry::MAX_CHARACTERISTICS; ++i) {
+        _stateSlotOf[i].store(0xFF, std::memory_order_relaxed);
+    }
+}
+
+void NotifyQueue::begin(SendFn send, PayloadLimitFn payloadLimit) {
+    _send = send;
+    _payloadLimit = payloadLimit;
+    TaskHandle_t task = nullptr;
+    xTaskCreatePinnedToCore(taskEntry, "BLENotify", 4096, this, NOTIFY_TASK_PRIORITY, &task, NOTIFY_TASK_CORE);
+    _task.store(task, std::memory_order_release);
+    wake();                                         // begin 之前投递的通知
+}
+
+// 发送任务：被 post() 的任务通知唤醒；有限速中的状态槽位时按最近的到期时间定时醒来
+void NotifyQueue::taskEntry(void* arg) {
+    NotifyQueue* queue = static_cast<NotifyQueue*>(arg);
+    for (;;) {
+        uint32_t waitMs = queue->drain(millis());
+        ulTaskNotifyTake(pdTRUE, waitMs == NO_DEADLINE ? portMAX_DELAY : pdMS_TO_TICKS(waitMs ? waitMs : 1));
+    }
+}
+
+void NotifyQueue::registerMetrics() {
+    Metrics::addCounter("ble.notify_sent", "", _sent);
+    Metrics::addRate("ble.notify_rate", "/s", _sent);
+    Metrics::addCounter("ble.notify_failed", "", _dropped);
+    Metrics::addCounter("ble.notify_coalesced", "", _coalesced);
+    Metrics::watchTask("stack.ble_notify", _task.load(std::memory_order_acquire));
+}
+
+void NotifyQueue::setPolicy(CharHandle handle, const GattNotifyPolicy& policy) {
+    if (handle >= CharacteristicRegistry::MAX_CHARACTERISTICS) return;
+    _pack[handle] = policy.pack;
+    if (policy.mode != GATT_NOTIFY_STATE || _stateSlotOf[handle].load(std::memory_order_relaxed) != 0xFF) return;
+
+    uint8_t index = _stateCount.load(std::memory_order_relaxed);
+    if (index >= NOTIFY_STATE_SLOTS) {
+        FLOG_WARN("⚠️ 状态型通知槽位已满（%u），特征 %u 按事件型发送", (unsigned)NOTIFY_STATE_SLOTS, handle);
+        return;
+    }
+    _states[index].handle = handle;
+    _states[index].minIntervalMs = policy.minIntervalMs;
+    _stateCount.store(index + 1, std::memory_order_release);           // 先填好槽位再发布给发送任务
+    _stateSlotOf[handle].store(index, std::memory_order_release);
+}
+
+bool NotifyQueue::post(CharHandle handle, const uint8_t* data, size_t len) {
+    if (handle >= CharacteristicRegistry::MAX_CHARACTERISTICS || len > INLINE_BYTES) return false;
+
+    uint8_t index = _stateSlotOf[handle].load(std::memory_order_acquire);
+    if (index != 0xFF) {                            // 状态型：覆盖槽位中的旧值
+        StateSlot& slot = _states[index];
+        portENTER_CRITICAL(&_stateLock);
+        bool overwritten = slot.dirty.load(std::memory_order_relaxed);
+        memcpy(slot.data, data, len);
+        slot.len = (uint8_t)len;
+        slot.dirty.store(true, std::memory_order_relaxed);
+        portEXIT_CRITICAL(&_stateLock);
+        if (overwritten) _coalesced.fetch_add(1, std::memory_order_relaxed);
+        wake();
+        return true;
+    }
+
+    EventRecord record;
+    record.handle = handle;
+    record.len = (uint8_t)len;
+    memcpy(record.data, data, len);
+    if (!_events.tryPush(record)) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    wake();
+    return true;
+}
+
+void NotifyQueue::wake() {
+    TaskHandle_t task = _task.load(std::memory_order_acquire);
+    if (task) xTaskNotifyGive(task);
+}
+
+uint32_t NotifyQueue::drain(uint32_t nowMs) {
+    drainEvents();
+    return drainStates(nowMs);
+}
+
+bool NotifyQueue::takeEvent(EventRecord& out) {
+    if (_hasCarry) {
+        out = _carry;
+        _hasCarry = false;
+        return true;
+    }
+    return _events.tryPop(out);
+}
+
+void NotifyQueue::drainEvents() {
+    EventRecord record;
+    while (takeEvent(record)) {
+        if (!_pack[record.handle]) {
+            send(record.handle, record.data, record.len);
+            continue;
+        }
+
+        // 打包：[长度][数据][长度][数据]...，遇到其他特征的通知或放不下时停止（多取出的一条留到下一轮）
+        size_t limit = _payloadLimit ? _payloadLimit() : PACK_BYTES;
+        if (limit > PACK_BYTES) limit = PACK_BYTES;
+        size_t used = 0;
+        _packBuffer[used++] = record.len;
+        memcpy(&_packBuffer[used], record.data, record.len);
+        used += record.len;
+
+        EventRecord next;
+        while (takeEvent(next)) {
+            if (next.handle != record.handle || used + 1 + next.len > limit) {
+                _carry = next;
+                _hasCarry = true;
+                break;
+            }
+            _packBuffer[used++] = next.len;
+            memcpy(&_packBuffer[used], next.data, next.len);
+            used += next.len;
+            _packed.fetch_add(1, std::memory_order_relaxed);
+        }
+        send(record.handle, _packBuffer, used);
+    }
+}
+
+uint32_t NotifyQueue::drainStates(uint32_t nowMs) {
+    uint32_t nextDeadline = NO_DEADLINE;
+    uint8_t count = _stateCount.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < count; ++i) {
+        StateSlot& slot = _states[i];
+        if (!slot.dirty.load(std::memory_order_relaxed)) continue;     // 漏看的新值会由 post() 再次唤醒发送任务
+        uint32_t elapsed = nowMs - slot.lastSentMs;
+        if (slot.sentOnce && elapsed < slot.minIntervalMs) {
+            uint32_t wait = slot.minIntervalMs - elapsed;
+            if (wait < nextDeadline) nextDeadline = wait;
+            continue;
+        }
+
+        uint8_t value[NOTIFY_INLINE_BYTES];
+        portENTER_CRITICAL(&_stateLock);
+        uint8_t len = slot.len;
+        memcpy(value, slot.data, len);
+        slot.dirty.store(false, std::memory_order_relaxed);
+        portEXIT_CRITICAL(&_stateLock);
+
+        send(slot.handle, value, len);
+        slot.lastSentMs = nowMs;
+        slot.sentOnce = true;
+    }
+    return nextDeadline;
+}
+
+void NotifyQueue::send(CharHandle handle, const uint8_t* data, size_t len) {
+    if (_send && _send(handle, data, len)) {
+        _sent.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <stdint.h>
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "utils/MPSCRing.h"
+#include "CharacteristicRegistry.h"
+#include "GattTable.h"
+
+#ifndef NOTIFY_EVENT_SLOTS
+#define NOTIFY_EVENT_SLOTS 32                       // 事件型通知队列深度（2 的幂）
+#endif
+
+#ifndef NOTIFY_STATE_SLOTS
+#define NOTIFY_STATE_SLOTS 8                        // 最多几个状态型特征
+#endif
+
+#ifndef NOTIFY_INLINE_BYTES
+#define NOTIFY_INLINE_BYTES 32                      // 排队通知的最大长度，更长的由调用方同步发送
+#endif
+
+#ifndef NOTIFY_TASK_PRIORITY
+#define NOTIFY_TASK_PRIORITY 2
+#endif
+
+#ifndef NOTIFY_TASK_CORE
+#define NOTIFY_TASK_CORE 0                          // 与 BLE 协议栈同核
+#endif
+
+// 异步通知队列：生产者（OTA、触摸、控制器等任意任务）只把数据拷进队列就返回，由独立的发送任务调用协议栈
+// - 事件型特征（GATT_NOTIFY_EVENT）：无锁 MPSC 队列，严格按投递顺序发送，从不合并
+//   开启 pack 时，同一特征积压的连续多条通知打包进一个通知（每条前加 1 字节长度），不超过协商后的 MTU - 3
+// - 状态型特征（GATT_NOTIFY_STATE）：每个特征一个槽位只保留最新值，两次发送间隔不小于 minIntervalMs，
+//   限速期间的更新直接覆盖，不排队也不阻塞生产者
+// - 队列满时丢弃新通知并计数（dropped），从不阻塞
+//
+// 发送函数与 MTU 查询由 BLEServerWrapper 注入，本类不依赖 BLE 库
+class NotifyQueue {
+public:
+    typedef std::function<bool(CharHandle handle, const uint8_t* data, size_t len)> SendFn;   // 未连接等原因没有发出时返回 false
+    typedef std::function<size_t()> PayloadLimitFn;                                            // 单个通知的最大负载（MTU - 3）
+
+    static const size_t INLINE_BYTES = NOTIFY_INLINE_BYTES;
+    static const uint32_t NO_DEADLINE = 0xFFFFFFFFu;
+    static const size_t PACK_BYTES = 512;           // 打包缓冲区（与 BLEDevice::setMTU(512) 一致）
+
+    NotifyQueue();
+
+    // 创建发送任务；setPolicy/post 在此之前调用也可以（数据会在任务启动后发出）
+    void begin(SendFn send, PayloadLimitFn payloadLimit);
+
+    // 登记特征的通知策略（创建特征时调用一次，不能与另一次 setPolicy 并发），未登记的特征按事件型处理
+    void setPolicy(CharHandle handle, const GattNotifyPolicy& policy);
+
+    // 投递一条通知（任意任务，不阻塞）；超过 INLINE_BYTES、句柄无效或队列满时返回 false
+    bool post(CharHandle handle, const uint8_t* data, size_t len);
+
+    // 发送当前所有到期的通知，返回距离下一个状态槽位可以发送还有多少 ms（没有待发时返回 NO_DEADLINE）
+    // 由发送任务循环调用；不启动任务时也可以直接调用（主机测试）
+    uint32_t drain(uint32_t nowMs);
+
+    uint32_t sentCount() const { return _sent.load(std::memory_order_relaxed); }          // 实际发出的通知数
+    uint32_t coalescedCount() const { return _coalesced.load(std::memory_order_relaxed); } // 被更新值覆盖的状态数
+    uint32_t packedCount() const { return _packed.load(std::memory_order_relaxed); }       // 被打包进前一条通知的事件数
+    uint32_t droppedCount() const { return _dropped.load(std::memory_order_relaxed); }     // 队列满或发送失败丢弃的数量
+    void registerMetrics();                         // 登记到 Metrics：发送数与速率、失败（丢弃）数、发送任务栈水位
+
+private:
+    struct EventRecord {
+        CharHandle handle;
+        uint8_t len;
+        uint8_t data[NOTIFY_INLINE_BYTES];
+    };
+
+    struct StateSlot {
+        CharHandle handle = INVALID_CHAR_HANDLE;
+        uint16_t minIntervalMs = 0;
+        std::atomic<bool> dirty{false};             // 有尚未发送的新值（在锁内写入，发送任务可以先不加锁检查）
+        bool sentOnce = false;
+        uint32_t lastSentMs = 0;
+        uint8_t len = 0;
+        uint8_t data[NOTIFY_INLINE_BYTES];
+    };
+
+    static void taskEntry(void* arg);
+    bool takeEvent(EventRecord& out);
+    void drainEvents();
+    uint32_t drainStates(uint32_t nowMs);
+    void send(CharHandle handle, const uint8_t* data, size_t len);
+    void wake();
+
+    SendFn _send;
+    PayloadLimitFn _payloadLimit;
+    std::atomic<TaskHandle_t> _task{nullptr};
+
+    MPSCRing<EventRecord, NOTIFY_EVENT_SLOTS> _events;
+    EventRecord _carry;                             // 打包时多取出的一条（仅发送任务访问）
+    bool _hasCarry = false;
+    uint8_t _packBuffer[PACK_BYTES];                // 打包缓冲区（仅发送任务访问，不占任务栈）
+    bool _pack[CharacteristicRegistry::MAX_CHARACTERISTICS] = {};
+
+    StateSlot _states[NOTIFY_STATE_SLOTS];
+    std::atomic<uint8_t> _stateSlotOf[CharacteristicRegistry::MAX_CHARACTERISTICS];   // 句柄 → 状态槽位，0xFF 表示事件型
+    std::atomic<uint8_t> _stateCount{0};
+    portMUX_TYPE _stateLock = portMUX_INITIALIZER_UNLOCKED;    // 保护状态槽位的值（只在拷贝几十字节期间持有）
+
+    std::atomic<uint32_t> _sent{0};
+    std::atomic<uint32_t> _coalesced{0};
+    std::atomic<uint32_t> _packed{0};
+    std::atomic<uint32_t> _dropped{0};
+};
@@ -0,0 +1,21 @@
+#include "MessageTransport.h"
+#include "controllers/OTAController/OTAController.h"
+
+static const char* OTA_DATA_UUID = "ef040002-1000-8000-0080-5f9b34fb0000";     // OTA 数据特征，接收回调中直通 OTAController
+
+CharHandle MessageTransport::handleOf(const char* uuid) const {
+    return _dispatcher ? _dispatcher->characteristics().find(uuid) : INVALID_CHAR_HANDLE;
+}
+
+void MessageTransport::setOTAController(OTAController* ota) {
+    _otaDataHandle = handleOf(OTA_DATA_UUID);       // 先解析句柄，再让接收回调看到控制器
+    _otaController.store(ota, std::memory_order_release);
+}
+
+void MessageTransport::deliver(CharHandle handle, const uint8_t* data, size_t len) {
+    // OTA数据包直通处理：直接从接收缓冲拷进 OTA 暂存区，不占用负载池和队列
+    OTAController* ota = _otaController.load(std::memory_order_acquire);
+    // 旧协议（v0）的数据包没有重传，需要在 bleWriteTask 中等暂存缓冲，由 handleData 退回队列
+    if (ota && handle == _otaDataHandle && ota->handleData(data, len)) return;
+    _dispatcher->enqueue(handle, data, len);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+#include "drivers/BLE/MessageDispatcher.h"
+
+class OTAController;
+
+// 链路负载档位（按优先级升序）：控制器通过 hintWorkload 告诉传输层当前在做什么，由后端决定链路参数
+enum class LinkWorkload : uint8_t {
+    IDLE = 0,           // 空闲：放宽连接间隔、允许从机延迟，省电
+    STREAMING = 1,      // 实时运动流：最短连接间隔、无从机延迟，降低端到端延迟
+    BULK = 2            // 批量传输（OTA）：短连接间隔 + 2M PHY + 数据长度扩展，提高吞吐
+};
+
+// 消息传输层：中心设备“写特征 / 收通知”这条通道的抽象，控制器与 MessageDispatcher 不再关心底层是 GATT 还是套接字
+// - 写入方向：后端收到一次写入后调用 deliver()，处理与 BLE 写入回调完全相同——OTAData（v1 分包协议）直通 OTAController，
+//   其余写入拷进负载池后入队，由 bleWriteTask 消费
+// - 通知方向：控制器只调用 notify(handle, ...)，由后端决定怎么发出（GATT 通知 / 套接字帧）
+// - 特征一律按 UUID 寻址，所有后端共用 dispatcher 的 CharacteristicRegistry，句柄在后端之间通用
+// - 写入队列是单生产者：同一个 MessageDispatcher 同一时间只能接一个后端
+//
+// 后端：BLEServerWrapper（GATT，设备上）、SocketTransport（TCP / Unix 套接字，主机压测，见 README）
+class MessageTransport {
+public:
+    virtual ~MessageTransport() = default;
+
+    virtual const char* transportName() const = 0;
+    virtual bool isConnected() = 0;                                             // 至少有一个中心设备连接
+    virtual void notify(CharHandle handle, const uint8_t* data, size_t len) = 0;   // 任意任务调用，不阻塞
+    virtual size_t notifyPayloadLimit() = 0;                                    // 单个通知的最大负载（GATT：协商的 MTU - 3）
+    // 负载提示（任意任务调用，热路径上可以每条消息调用一次）：档位在最后一次提示后保持一段时间再回落
+    // GATT 后端据此请求连接参数 / PHY / 数据长度（见 drivers/BLE/LinkPolicy.h），其余后端忽略
+    virtual void hintWorkload(LinkWorkload workload) { (void)workload; }
+
+    CharHandle handleOf(const char* uuid) const;    // 按 UUID 查询特征句柄（begin 之后可用）
+    void setOTAController(OTAController* ota);      // 登记后 OTAData 写入在接收回调中直通 OTAController
+
+protected:
+    // 所有后端共用的写入入口（在后端的接收任务 / 协议栈回调中调用）
+    void deliver(CharHandle handle, const uint8_t* data, size_t len);
+
+    MessageDispatcher* _dispatcher = nullptr;
+    std::atomic<OTAController*> _otaController{nullptr};
+    CharHandle _otaDataHandle = INVALID_CHAR_HANDLE;
+};
@@ -0,0 +1,321 @@
+#ifdef TRANSPORT_SOCKET
+
+#include "SocketTransport.h"
+#include <Arduino.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "drivers/BLE/GattTable.generated.h"    // 构建时由 scripts/gen-gatt-table.py 生成
+#include "serial_color_debug.h"
+#include "utils/FastLog.h"
+
+static const int POLL_INTERVAL_MS = 20;         // end() 最长等这么久接收任务退出
+static const int SEND_TIMEOUT_MS = 100;         // 客户端不读通知时，超过这个时间关闭该连接
+
+bool SocketTransport::begin(MessageDispatcher* dispatcher, const char* endpoint) {
+    if (_running.load()) {
+        DEBUG_WARN("⚠️ 套接字传输已经启动");
+        return false;
+    }
+    _dispatcher = dispatcher;
+
+    // 句柄与通知策略与 GATT 后端一致：同一张编译期 GATT 表
+    for (uint8_t s = 0; s < GATT_TABLE.serviceCount; ++s) {
+        const GattServiceDef& service = GATT_TABLE.services[s];
+        for (uint8_t c = 0; c < service.characteristicCount; ++c) {
+            const GattCharacteristicDef& ch = service.characteristics[c];
+            CharHandle handle = _dispatcher->characteristics().intern(ch.uuid, ch.name);
+            if (!_notifyStarted && handle != INVALID_CHAR_HANDLE && (ch.properties & GATT_PROP_NOTIFY)) {
+                _notifyQueue.setPolicy(handle, ch.notify);
+            }
+        }
+    }
+    if (!_notifyStarted) {
+        _notifyQueue.begin([this](CharHandle handle, const uint8_t* data, size_t len) { return sendNotification(handle, data, len); },
+                           [this]() { return notifyPayloadLimit(); });
+        _notifyStarted = true;
+    }
+
+    _unixPath[0] = '\0';
+    _port = 0;
+    if (strncmp(endpoint, "unix:", 5) == 0) {
+        const char* path = endpoint + 5;
+        sockaddr_un addr = {};
+        if (strlen(path) >= sizeof(addr.sun_path)) {
+            DEBUG_ERRORF("❌ Unix 套接字路径过长: %s", path);
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, path);
+        unlink(path);                               // 上次运行遗留的套接字文件
+        _listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (_listenFd < 0 || bind(_listenFd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            DEBUG_ERRORF("❌ 绑定 %s 失败: %s", endpoint, strerror(errno));
+            end();
+            return false;
+        }
+        strcpy(_unixPath, path);
+    } else if (strncmp(endpoint, "tcp:", 4) == 0) {
+        char host[64];
+        const char* colon = strrchr(endpoint + 4, ':');
+        size_t hostLength = colon ? (size_t)(colon - (endpoint + 4)) : 0;
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        if (!colon || hostLength >= sizeof(host)) {
+            DEBUG_ERRORF("❌ 无效的 TCP 地址: %s（格式 tcp:<地址>:<端口>）", endpoint);
+            return false;
+        }
+        memcpy(host, endpoint + 4, hostLength);
+        host[hostLength] = '\0';
+        addr.sin_port = htons((uint16_t)atoi(colon + 1));
+        if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+            DEBUG_ERRORF("❌ 无效的 IPv4 地址: %s", host);
+            return false;
+        }
+        _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        if (_listenFd >= 0) setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (_listenFd < 0 || bind(_listenFd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            DEBUG_ERRORF("❌ 绑定 %s 失败: %s", endpoint, strerror(errno));
+            end();
+            return false;
+        }
+        socklen_t addrLength = sizeof(addr);
+        getsockname(_listenFd, (sockaddr*)&addr, &addrLength);
+        _port = ntohs(addr.sin_port);
+    } else {
+        DEBUG_ERRORF("❌ 不支持的传输地址: %s（unix:<路径> 或 tcp:<地址>:<端口>）", endpoint);
+        return false;
+    }
+
+    if (listen(_listenFd, MAX_CLIENTS) != 0) {
+        DEBUG_ERRORF("❌ 监听 %s 失败: %s", endpoint, strerror(errno));
+        end();
+        return false;
+    }
+
+    _running.store(true);
+    _taskDone.store(false);
+    xTaskCreatePinnedToCore(taskEntry, "SocketTransport", 8192, this, 2, nullptr, 0);
+    DEBUG_INFOF("🔌 套接字传输已启动: %s（TCP 端口 %u）", endpoint, (unsigned)_port);
+    return true;
+}
+
+void SocketTransport::end() {
+    if (_running.exchange(false)) {
+        while (!_taskDone.load()) vTaskDelay(pdMS_TO_TICKS(POLL_INTERVAL_MS));     // 接收任务关闭所有连接后退出
+    }
+    if (_listenFd >= 0) {
+        close(_listenFd);
+        _listenFd = -1;
+    }
+    if (_unixPath[0]) {
+        unlink(_unixPath);
+        _unixPath[0] = '\0';
+    }
+}
+
+void SocketTransport::taskEntry(void* arg) {
+    static_cast<SocketTransport*>(arg)->run();
+    vTaskDelete(nullptr);
+}
+
+// 接收任务：poll 监听套接字与所有连接，按到达顺序把完整的帧交给 deliver
+void SocketTransport::run() {
+    pollfd fds[MAX_CLIENTS + 1];
+    Client* owners[MAX_CLIENTS + 1];
+    while (_running.load(std::memory_order_relaxed)) {
+        nfds_t count = 0;
+        fds[count].fd = _listenFd;
+        fds[count].events = POLLIN;
+        owners[count++] = nullptr;
+        for (Client& client : _clients) {
+            if (client.fd < 0) continue;
+            fds[count].fd = client.fd;
+            fds[count].events = POLLIN;
+            owners[count++] = &client;
+        }
+
+        int ready = poll(fds, count, POLL_INTERVAL_MS);
+        if (ready <= 0) continue;
+        if (fds[0].revents & POLLIN) acceptClient();
+        for (nfds_t i = 1; i < count; ++i) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            if (!readClient(*owners[i])) closeClient(*owners[i]);
+        }
+    }
+    for (Client& client : _clients) {
+        if (client.fd >= 0) closeClient(client);
+    }
+    _taskDone.store(true);
+}
+
+void SocketTransport::acceptClient() {
+    int fd = accept(_listenFd, nullptr, nullptr);
+    if (fd < 0) return;
+    Client* slot = nullptr;
+    for (Client& client : _clients) {
+        if (client.fd < 0) {
+            slot = &client;
+            break;
+        }
+    }
+    if (!slot) {
+        DEBUG_WARNF("⚠️ 套接字连接已满（%u 个），拒绝新连接", (unsigned)MAX_CLIENTS);
+        close(fd);
+        return;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));      // Unix 套接字上会失败，忽略
+    timeval timeout = {0, SEND_TIMEOUT_MS * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::lock_guard<std::mutex> lock(_sendLock);
+    slot->rxLength = 0;
+    slot->lastHandle = INVALID_CHAR_HANDLE;
+    slot->lastUuidLength = 0;
+    slot->fd = fd;
+    uint32_t clients = _clientCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    DEBUG_INFOF("🔗 套接字客户端已连接（当前 %u 个）", (unsigned)clients);
+}
+
+void SocketTransport::closeClient(Client& client) {
+    std::lock_guard<std::mutex> lock(_sendLock);
+    close(client.fd);
+    client.fd = -1;
+    client.rxLength = 0;
+    uint32_t clients = _clientCount.fetch_sub(1, std::memory_order_relaxed) - 1;
+    DEBUG_INFOF("❌ 套接字客户端已断开（剩余 %u 个）", (unsigned)clients);
+}
+
+// 读一次套接字并处理其中所有完整的帧；连接关闭或帧格式错误时返回 false
+bool SocketTransport::readClient(Client& client) {
+    ssize_t n = recv(client.fd, client.rx + client.rxLength, sizeof(client.rx) - client.rxLength, 0);
+    if (n <= 0) {
+        return n < 0 && (errno == EINTR || errno == EAGAIN);
+    }
+    client.rxLength += (size_t)n;
+
+    size_t offset = 0;
+    while (offset < client.rxLength) {
+        TransportFrame frame;
+        int used = parseTransportFrame(client.rx + offset, client.rxLength - offset, frame);
+        if (used == 0) break;
+        if (used < 0 || !handleFrame(client, frame)) {
+            FLOG_WARN("⚠️ 套接字帧格式错误，关闭连接");
+            _closed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        offset += (size_t)used;
+    }
+    if (offset > 0) {
+        client.rxLength -= offset;
+        memmove(client.rx, client.rx + offset, client.rxLength);
+    }
+    return true;
+}
+
+bool SocketTransport::handleFrame(Client& client, const TransportFrame& frame) {
+    switch (frame.op) {
+        case TRANSPORT_OP_WRITE: {
+            _frames.fetch_add(1, std::memory_order_relaxed);
+            CharHandle handle = resolve(client, frame);
+            if (handle == INVALID_CHAR_HANDLE) {
+                _unknown.fetch_add(1, std::memory_order_relaxed);        // GATT 上不存在的特征，协议栈同样收不到
+                return true;
+            }
+            deliver(handle, frame.payload, frame.payloadLength);
+            return true;
+        }
+        case TRANSPORT_OP_STATS:
+            replyStats(client, frame.payloadLength ? frame.payload[0] : 0);
+            return true;
+        default:
+            return false;
+    }
+}
+
+CharHandle SocketTransport::resolve(Client& client, const TransportFrame& frame) {
+    if (frame.uuidLength == client.lastUuidLength && strncasecmp(frame.uuid, client.lastUuid, frame.uuidLength) == 0) {
+        return client.lastHandle;
+    }
+    char uuid[TRANSPORT_MAX_UUID + 1];
+    memcpy(uuid, frame.uuid, frame.uuidLength);
+    uuid[frame.uuidLength] = '\0';
+    CharHandle handle = _dispatcher->characteristics().find(uuid);
+    memcpy(client.lastUuid, frame.uuid, frame.uuidLength);
+    client.lastUuidLength = frame.uuidLength;
+    client.lastHandle = handle;
+    return handle;
+}
+
+void SocketTransport::replyStats(Client& client, uint8_t flags) {
+    LatencyHistogram& latency = _dispatcher->latency();
+    TransportStats stats;
+    stats.frames = frameCount();
+    stats.dropped = _dispatcher->droppedCount();
+    stats.rejected = _dispatcher->rejectedCount();
+    stats.handled = latency.count();
+    stats.latencyP50Us = latency.percentile(50);
+    stats.latencyP99Us = latency.percentile(99);
+    stats.latencyMaxUs = latency.max();
+    stats.queueDepth = (uint32_t)_dispatcher->size();
+    if (flags & TRANSPORT_STATS_RESET_LATENCY) latency.reset();
+
+    uint8_t payload[TRANSPORT_STATS_BYTES];
+    encodeTransportStats(stats, payload);
+    uint8_t frame[TRANSPORT_FRAME_HEADER + TRANSPORT_STATS_BYTES];
+    size_t len = encodeTransportFrame(frame, sizeof(frame), TRANSPORT_OP_STATS, nullptr, payload, sizeof(payload));
+    std::lock_guard<std::mutex> lock(_sendLock);
+    sendFrame(client.fd, frame, len);
+}
+
+// 整帧发送（调用方持有 _sendLock）；超时或出错时关闭写方向，接收任务随后看到连接断开并回收
+bool SocketTransport::sendFrame(int fd, const uint8_t* frame, size_t len) {
+    size_t sent = 0;
+    while (sent < len) {
+        ssize_t n = send(fd, frame + sent, len - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            shutdown(fd, SHUT_RDWR);
+            _closed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+void SocketTransport::notify(CharHandle handle, const uint8_t* data, size_t len) {
+    if (len > NotifyQueue::INLINE_BYTES) {
+        sendNotification(handle, data, len);        // 大块数据直接同步发送，不占队列（与 GATT 后端相同）
+        return;
+    }
+    _notifyQueue.post(handle, data, len);
+}
+
+// 在 NotifyQueue 发送任务中调用：编码一次，发给所有连接
+bool SocketTransport::sendNotification(CharHandle handle, const uint8_t* data, size_t len) {
+    if (!isConnected() || !_dispatcher || handle >= _dispatcher->characteristics().size()) return false;
+    uint8_t frame[TRANSPORT_MAX_FRAME];
+    size_t frameLength = encodeTransportFrame(frame, sizeof(frame), TRANSPORT_OP_NOTIFY,
+                                              _dispatcher->characteristics().uuidOf(handle), data, len);
+    if (!frameLength) return false;
+    bool any = false;
+    std::lock_guard<std::mutex> lock(_sendLock);
+    for (Client& client : _clients) {
+        if (client.fd >= 0 && sendFrame(client.fd, frame, frameLength)) any = true;
+    }
+    return any;
+}
+
+#endif  // TRANSPORT_SOCKET
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "MessageTransport.h"
+#include "TransportFrame.h"
+#include "drivers/BLE/NotifyQueue.h"
+
+#ifndef SOCKET_TRANSPORT_MAX_CLIENTS
+#define SOCKET_TRANSPORT_MAX_CLIENTS 16         // 同时连接的模拟中心设备数
+#endif
+
+#ifndef SOCKET_TRANSPORT_RX_BYTES
+#define SOCKET_TRANSPORT_RX_BYTES 4096          // 每个连接的接收缓冲（一次 recv 可以带回多帧）
+#endif
+
+// 套接字后端：TCP / Unix 套接字上按 TransportFrame 格式收发，与 GATT 后端走同一条消息管线
+// （MessageTransport::deliver → OTAController / MessageDispatcher，通知经 NotifyQueue 按特征策略发出）
+//
+// - 单个接收任务用 poll() 服务所有连接，是 MessageDispatcher 写入队列唯一的生产者，与 BLE 协议栈回调相同
+// - 接收任务在 deliver 中被阻塞（例如 OTA 暂存缓冲等待 Flash）时不再读取套接字，由 TCP 流控反压到客户端，
+//   对应 BLE 链路层的流控；队列满时照常丢弃并计入 dispatcher 的 droppedCount
+// - 通知发给所有连接；某个连接发送超时或出错时关闭该连接，不影响其它连接
+// - 依赖 POSIX 套接字，只在定义 TRANSPORT_SOCKET 时编译（env:native 默认开启）
+class SocketTransport : public MessageTransport {
+public:
+    static const size_t MAX_CLIENTS = SOCKET_TRANSPORT_MAX_CLIENTS;
+
+    // endpoint："unix:<路径>" 或 "tcp:<地址>:<端口>"（端口 0 由系统分配，begin 之后用 port() 查询）
+    // 与 BLEServerWrapper::beginFromTable 相同，按编译期 GATT 表驻留全部特征句柄并登记通知策略
+    bool begin(MessageDispatcher* dispatcher, const char* endpoint);
+    void end();                                     // 关闭监听与所有连接；通知任务常驻，对象不要析构
+
+    const char* transportName() const override { return "socket"; }
+    bool isConnected() override { return _clientCount.load(std::memory_order_relaxed) > 0; }
+    void notify(CharHandle handle, const uint8_t* data, size_t len) override;
+    size_t notifyPayloadLimit() override { return TRANSPORT_MAX_PAYLOAD - 3; }     // 相当于协商到 MTU 512
+
+    uint16_t port() const { return _port; }
+    uint32_t clientCount() const { return _clientCount.load(std::memory_order_relaxed); }
+    uint32_t frameCount() const { return _frames.load(std::memory_order_relaxed); }         // 收到的 WRITE 帧
+    uint32_t unknownCount() const { return _unknown.load(std::memory_order_relaxed); }      // 写入了不存在的特征
+    uint32_t closedCount() const { return _closed.load(std::memory_order_relaxed); }        // 因格式错误或发送失败被关闭的连接
+    NotifyQueue& notifications() { return _notifyQueue; }
+
+private:
+    struct Client {
+        int fd = -1;
+        size_t rxLength = 0;
+        uint8_t rx[SOCKET_TRANSPORT_RX_BYTES];
+        CharHandle lastHandle = INVALID_CHAR_HANDLE;    // 上一帧的 UUID → 句柄（同一连接通常连续写同一个特征）
+        uint8_t lastUuidLength = 0;
+        char lastUuid[TRANSPORT_MAX_UUID];
+    };
+
+    static void taskEntry(void* arg);
+    void run();
+    void acceptClient();
+    bool readClient(Client& client);
+    bool handleFrame(Client& client, const TransportFrame& frame);
+    CharHandle resolve(Client& client, const TransportFrame& frame);
+    void replyStats(Client& client, uint8_t flags);
+    bool sendFrame(int fd, const uint8_t* frame, size_t len);
+    void closeClient(Client& client);
+    bool sendNotification(CharHandle handle, const uint8_t* data, size_t len);
+
+    int _listenFd = -1;
+    uint16_t _port = 0;
+    char _unixPath[108] = {};                       // Unix 套接字路径（end 时删除）
+    Client _clients[MAX_CLIENTS];
+    std::mutex _sendLock;                           // 保护连接表与发送（接收任务 / 通知任务 / 调用方任务）
+    std::atomic<bool> _running{false};
+    std::atomic<bool> _taskDone{true};
+    bool _notifyStarted = false;
+    NotifyQueue _notifyQueue;
+
+    std::atomic<uint32_t> _clientCount{0};
+    std::atomic<uint32_t> _frames{0};
+    std::atomic<uint32_t> _unknown{0};
+    std::atomic<uint32_t> _closed{0};
+};
@@ -0,0 +1,67 @@
+#include "TransportFrame.h"
+#include <string.h>
+
+static void putU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t encodeTransportFrame(uint8_t* out, size_t capacity, uint8_t op, const char* uuid,
+                            const uint8_t* payload, size_t payloadLength) {
+    size_t uuidLength = uuid ? strlen(uuid) : 0;
+    size_t total = TRANSPORT_FRAME_HEADER + uuidLength + payloadLength;
+    if (uuidLength > TRANSPORT_MAX_UUID || payloadLength > TRANSPORT_MAX_PAYLOAD || total > capacity) return 0;
+    size_t len = total - 2;
+    out[0] = (uint8_t)len;
+    out[1] = (uint8_t)(len >> 8);
+    out[2] = op;
+    out[3] = (uint8_t)uuidLength;
+    memcpy(out + TRANSPORT_FRAME_HEADER, uuid, uuidLength);
+    if (payloadLength) memcpy(out + TRANSPORT_FRAME_HEADER + uuidLength, payload, payloadLength);
+    return total;
+}
+
+int parseTransportFrame(const uint8_t* data, size_t len, TransportFrame& frame) {
+    if (len < 2) return 0;
+    size_t body = (size_t)data[0] | ((size_t)data[1] << 8);
+    if (body < 2 || body + 2 > TRANSPORT_MAX_FRAME) return -1;
+    if (len < 2 + body) return 0;
+    uint8_t uuidLength = data[3];
+    if (uuidLength > TRANSPORT_MAX_UUID || (size_t)uuidLength + 2 > body) return -1;
+    frame.op = data[2];
+    frame.uuid = reinterpret_cast<const char*>(data + TRANSPORT_FRAME_HEADER);
+    frame.uuidLength = uuidLength;
+    frame.payload = data + TRANSPORT_FRAME_HEADER + uuidLength;
+    frame.payloadLength = body - 2 - uuidLength;
+    return (int)(body + 2);
+}
+
+void encodeTransportStats(const TransportStats& stats, uint8_t out[TRANSPORT_STATS_BYTES]) {
+    putU32(out, stats.frames);
+    putU32(out + 4, stats.dropped);
+    putU32(out + 8, stats.rejected);
+    putU32(out + 12, stats.handled);
+    putU32(out + 16, stats.latencyP50Us);
+    putU32(out + 20, stats.latencyP99Us);
+    putU32(out + 24, stats.latencyMaxUs);
+    putU32(out + 28, stats.queueDepth);
+}
+
+bool decodeTransportStats(const uint8_t* data, size_t len, TransportStats& stats) {
+    if (len < TRANSPORT_STATS_BYTES) return false;
+    stats.frames = getU32(data);
+    stats.dropped = getU32(data + 4);
+    stats.rejected = getU32(data + 8);
+    stats.handled = getU32(data + 12);
+    stats.latencyP50Us = getU32(data + 16);
+    stats.latencyP99Us = getU32(data + 20);
+    stats.latencyMaxUs = getU32(data + 24);
+    stats.queueDepth = getU32(data + 28);
+    return true;
+}
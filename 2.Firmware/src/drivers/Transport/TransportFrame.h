@@ -0,0 +1,53 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// 套接字传输的帧格式：按特征 UUID 寻址，一帧对应 GATT 上的一次写入或一次通知
+//
+//   [len u16][op u8][uuidLen u8][uuid ASCII][payload]        len = 2 + uuidLen + payload 长度（小端）
+//
+// - op：WRITE（客户端 → 设备，相当于写特征）、NOTIFY（设备 → 客户端，相当于特征通知）、
+//   STATS（客户端发出时 payload 为 [flags]，设备回复同 op 的帧，payload 为 TransportStats，见下文），STATS 帧的 uuidLen 为 0
+// - uuid 与 ble_config.json 中的写法一致（4 或 36 个字符，不区分大小写），payload 最长 BLE_MAX_PAYLOAD_SIZE
+// - 纯计算、不依赖 Arduino，设备端后端与主机回放客户端共用
+
+static const uint8_t TRANSPORT_OP_WRITE = 0x01;
+static const uint8_t TRANSPORT_OP_NOTIFY = 0x02;
+static const uint8_t TRANSPORT_OP_STATS = 0x03;
+static const uint8_t TRANSPORT_STATS_RESET_LATENCY = 0x01;     // STATS 请求标志：回复之后清空入队→处理延迟直方图
+
+static const size_t TRANSPORT_FRAME_HEADER = 4;
+static const size_t TRANSPORT_MAX_UUID = 36;
+static const size_t TRANSPORT_MAX_PAYLOAD = 512;                // 与 BLE_MAX_PAYLOAD_SIZE 默认值一致
+static const size_t TRANSPORT_MAX_FRAME = TRANSPORT_FRAME_HEADER + TRANSPORT_MAX_UUID + TRANSPORT_MAX_PAYLOAD;
+
+struct TransportFrame {
+    uint8_t op = 0;
+    const char* uuid = nullptr;                     // 指向接收缓冲，不以 0 结尾
+    uint8_t uuidLength = 0;
+    const uint8_t* payload = nullptr;
+    size_t payloadLength = 0;
+};
+
+// STATS 回复（8 个 u32，小端）：接收帧数与 MessageDispatcher 的计数、延迟分位（自上次清空以来）
+struct TransportStats {
+    uint32_t frames = 0;                            // 收到的 WRITE 帧
+    uint32_t dropped = 0;                           // 队列满 / 负载池耗尽 / 超长
+    uint32_t rejected = 0;                          // 写入没有订阅者的特征
+    uint32_t handled = 0;                           // 消费者处理完的消息
+    uint32_t latencyP50Us = 0;
+    uint32_t latencyP99Us = 0;
+    uint32_t latencyMaxUs = 0;
+    uint32_t queueDepth = 0;                        // 回复时刻写入队列中的消息数
+};
+static const size_t TRANSPORT_STATS_BYTES = 32;
+
+// 编码一帧，返回帧长度；缓冲放不下或 uuid / payload 超长时返回 0
+size_t encodeTransportFrame(uint8_t* out, size_t capacity, uint8_t op, const char* uuid,
+                            const uint8_t* payload, size_t payloadLength);
+
+// 从缓冲起始解析一帧：返回这一帧占用的字节数；数据还不完整时返回 0；长度字段非法时返回 -1（连接应当断开）
+int parseTransportFrame(const uint8_t* data, size_t len, TransportFrame& frame);
+
+void encodeTransportStats(const TransportStats& stats, uint8_t out[TRANSPORT_STATS_BYTES]);
+bool decodeTransportStats(const uint8_t* data, size_t len, TransportStats& stats);
@@ -2,23 +2,31 @@
 #include "config.h"
 #include "app_router.h"
 #include <esp_system.h>  // 添加 ESP32 系统头文件
+#include "utils/BootTimeline.h"
+#include "utils/FastLog.h"
+#include "utils/Metrics.h"
+#include "utils/SerialConsole.h"
+
+// 串口命令在命令台任务中解析执行（见 utils/SerialConsole.h），loop() 不再等待串口输入
+void registerCoreCommands() {
+    SerialConsole::add("restart", "重启系统", [](const char*, void*) {
+        Serial.println("🔄 正在重启系统...");
+        FastLog::flush();           // 输出积压的热路径日志
+        delay(1000);
+        esp_restart();  // 重启 ESP32
+    });
+    SerialConsole::add("boot", "打印启动各阶段耗时", [](const char*, void*) { BootTimeline::print(); });
+    SerialConsole::add("stats", "打印运行指标（与 Diagnostics 特征的快照相同）", [](const char*, void*) { Metrics::print(); });
+    SerialConsole::setFallback(runCommand);     // 其余命令交给当前入口模块（例如舵机测试中的标定命令）
+}
 
 void setup() {
     Serial.begin(115200);
-    runSetup();
+    registerCoreCommands();
+    runSetup();                     // 入口模块在这里登记自己的命令
+    SerialConsole::begin();
 }
 
 void loop() {
-    // 检查串口输入
-    if (Serial.available()) {
-        String cmd = Serial.readStringUntil('\n');
-        cmd.trim();
-        if (cmd == "restart") {
-            Serial.println("🔄 正在重启系统...");
-            delay(1000);
-            esp_restart();  // 重启 ESP32
-            return;
-        }
-    }
     runLoop();
 }
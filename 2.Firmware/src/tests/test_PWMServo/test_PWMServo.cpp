@@ -1,30 +1,49 @@
 #include "test_PWMServo.h"
 #include "PWMServoController.h"
+#include "MotionController.h"
+#include "ServoCalibrator.h"
 
 PWMServoController servo(18, 6);  // GPIO18, LEDC通道6
+MotionController motion;           // 轨迹插值由定时器完成，loop 中不再逐步 setAngle + delay
+uint8_t servoAxis = MotionController::INVALID_AXIS;
+ServoCalibrator calibrator(servo);  // 串口输入 cal 开始标定，标定期间暂停往返运动
 
 void setup_PWMServo() {
     Serial.begin(115200);
     Serial.println("======== [舵机测试启动] ========");
     Serial.println("初始化 PWMServoController...");
     servo.setLimits(500, 2500, 0, 180);
-    servo.begin();
+    servo.begin();                  // 有标定表时自动从 NVS 加载
+    servoAxis = motion.addAxis(&servo, 180, 720);   // 180°/s，720°/s²
+    motion.begin();
     Serial.println("舵机初始化完成 ✅");
     Serial.println("--------------------------------");
 }
 
 void loop_PWMServo() {
-    static int pos = 0;
     static bool dir = true;
+    static bool sCurve = true;
 
-    servo.setAngle(pos);
-    Serial.printf("🎯 当前目标角度: %3d° → 实际设置角度: %3d°\n", pos, servo.getCurrentAngle());
+    if (calibrator.active() || motion.isMoving(servoAxis)) {
+        delay(10);
+        return;
+    }
 
-    pos += dir ? 5 : -5;
-    if (pos >= 180 || pos <= 0) {
-        dir = !dir;
-        Serial.println("🔁 方向切换");
+    // 往返一次切换一次曲线类型，方便对比梯形与 S 曲线的平顺度
+    float target = dir ? 180 : 0;
+    if (dir) {
+        sCurve = !sCurve;
+        motion.setShape(servoAxis, sCurve ? ProfileShape::S_CURVE : ProfileShape::TRAPEZOID);
     }
+    motion.moveTo(servoAxis, target);
+    Serial.printf("🎯 %s 运动: %3.0f° → %3.0f°\n", sCurve ? "S 曲线" : "梯形", motion.position(servoAxis), target);
+    dir = !dir;
+    delay(500);                     // 到位后停顿
+}
 
-    delay(50);
+bool command_PWMServo(const char* cmd) {
+    if (strncmp(cmd, "cal", 3) == 0) {
+        motion.stop(servoAxis);     // 标定期间由标定流程直接输出脉宽
+    }
+    return calibrator.handleCommand(cmd);
 }
@@ -2,3 +2,4 @@
 
 void setup_PWMServo();
 void loop_PWMServo();
+bool command_PWMServo(const char* cmd);     // 串口标定命令（见 ServoCalibrator.h）
@@ -0,0 +1,80 @@
+#include "BootTimeline.h"
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include "serial_color_debug.h"
+
+namespace {
+struct Stage {
+    std::atomic<const char*> name;                  // 最后写入：非空表示槽位已填好，可以打印
+    uint32_t startUs;
+    std::atomic<uint32_t> endUs;                    // 0 表示尚未结束；瞬时事件与 startUs 相同
+    int8_t core;
+};
+
+Stage s_stages[BootTimeline::MAX_STAGES];
+std::atomic<uint32_t> s_allocated{0};               // 已分配的槽位数（可能超过 MAX_STAGES）
+
+uint8_t allocate(const char* name, bool instant) {
+    uint32_t id = s_allocated.fetch_add(1, std::memory_order_relaxed);
+    if (id >= BootTimeline::MAX_STAGES) return BootTimeline::INVALID;
+    Stage& stage = s_stages[id];
+    stage.startUs = (uint32_t)micros();
+    stage.core = (int8_t)xPortGetCoreID();
+    stage.endUs.store(instant ? stage.startUs : 0, std::memory_order_relaxed);
+    stage.name.store(name, std::memory_order_release);
+    return (uint8_t)id;
+}
+
+size_t recorded() {
+    uint32_t n = s_allocated.load(std::memory_order_acquire);
+    return n < BootTimeline::MAX_STAGES ? n : BootTimeline::MAX_STAGES;
+}
+}  // namespace
+
+uint8_t BootTimeline::begin(const char* stage) {
+    return allocate(stage, false);
+}
+
+void BootTimeline::end(uint8_t id) {
+    if (id >= MAX_STAGES) return;
+    s_stages[id].endUs.store((uint32_t)micros(), std::memory_order_release);
+}
+
+void BootTimeline::mark(const char* milestone) {
+    allocate(milestone, true);
+}
+
+uint32_t BootTimeline::milestoneMs(const char* milestone) {
+    for (size_t i = 0; i < recorded(); ++i) {
+        const char* name = s_stages[i].name.load(std::memory_order_acquire);
+        if (name && strcmp(name, milestone) == 0) return s_stages[i].startUs / 1000;
+    }
+    return 0;
+}
+
+void BootTimeline::print() {
+    size_t count = recorded();
+    DEBUG_INFOF("⏱️ 启动时间线（相对上电，共 %u 项）:", (unsigned)count);
+    for (size_t i = 0; i < count; ++i) {
+        const Stage& stage = s_stages[i];
+        const char* name = stage.name.load(std::memory_order_acquire);
+        if (!name) continue;                        // 另一个任务正在填写
+        uint32_t endUs = stage.endUs.load(std::memory_order_acquire);
+        if (endUs == stage.startUs) {
+            DEBUG_INFOF("   %-16s @ %6u.%03u ms                   core %d", name,
+                        stage.startUs / 1000, stage.startUs % 1000, stage.core);
+        } else if (endUs == 0) {
+            DEBUG_INFOF("   %-16s %6u.%03u ms 起   （进行中）      core %d", name,
+                        stage.startUs / 1000, stage.startUs % 1000, stage.core);
+        } else {
+            uint32_t us = endUs - stage.startUs;
+            DEBUG_INFOF("   %-16s %6u.%03u ms 起   耗时 %6u.%03u ms core %d", name,
+                        stage.startUs / 1000, stage.startUs % 1000, us / 1000, us % 1000, stage.core);
+        }
+    }
+    if (s_allocated.load(std::memory_order_relaxed) > MAX_STAGES) {
+        DEBUG_WARNF("⚠️ 启动阶段超过 %u 个，其余未记录", (unsigned)MAX_STAGES);
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// 启动时间线：记录启动各阶段的起止时间（相对上电，微秒），可以在串口输入 boot 随时打印
+// - 阶段可以在不同任务中并发记录（例如后台初始化任务），槽位用原子计数分配，不加锁
+// - 阶段名必须是字符串字面量（只保存指针）
+//
+//   uint8_t stage = BootTimeline::begin("ble_init");
+//   ... 初始化 ...
+//   BootTimeline::end(stage);
+//   BootTimeline::mark("advertising");             // 瞬时事件，只记录发生时间
+class BootTimeline {
+public:
+    static const size_t MAX_STAGES = 16;
+    static const uint8_t INVALID = 0xFF;
+
+    static uint8_t begin(const char* stage);        // 槽位用完时返回 INVALID，end() 会忽略
+    static void end(uint8_t id);
+    static void mark(const char* milestone);
+    static void print();                            // 按记录顺序打印所有阶段
+    static uint32_t milestoneMs(const char* milestone);     // 某个事件发生的时刻（ms），未发生返回 0
+};
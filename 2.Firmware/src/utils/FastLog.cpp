@@ -0,0 +1,162 @@
+#include "FastLog.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <stdio.h>
+#include "MPSCRing.h"
+#include "Metrics.h"
+
+#ifndef FAST_LOG_CORE
+#define FAST_LOG_CORE 0             // 与 Bluedroid 同核但优先级最低，只在协议栈空闲时输出
+#endif
+#ifndef FAST_LOG_DRAIN_MS
+#define FAST_LOG_DRAIN_MS 20        // 后台任务轮询间隔
+#endif
+
+static MPSCRing<FastLogRecord, FAST_LOG_SLOTS> s_ring;
+static std::atomic<uint32_t> s_records{0};
+static std::atomic<uint32_t> s_dropped{0};
+static SemaphoreHandle_t s_drainLock = nullptr;     // 队列只允许一个消费者：后台任务与 flush() 互斥
+static TaskHandle_t s_task = nullptr;
+static uint32_t s_reportedDropped = 0;
+
+static const char* const LEVEL_PREFIX[] = {
+    "",
+    "\033[31m[E]",                                  // 红
+    "\033[33m[W]",                                  // 黄
+    "\033[32m[I]",                                  // 绿
+    "\033[36m[D]",                                  // 青
+};
+
+// 按格式串逐个转换说明符取参数，参数类型由转换字符决定（长度修饰符忽略，全部按 32 位处理）
+static size_t formatRecord(const FastLogRecord& record, char* out, size_t size) {
+    size_t pos = 0;
+    uint8_t next = 0;
+    const char* p = record.format;
+    while (*p && pos + 1 < size) {
+        if (*p != '%') {
+            out[pos++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[pos++] = '%';
+            p += 2;
+            continue;
+        }
+        // 拷出说明符（去掉长度修饰符），例如 "%08lx" → "%08x"
+        char spec[16];
+        size_t n = 0;
+        spec[n++] = *p++;
+        while (*p && strchr("-+ #0123456789.", *p) && n < sizeof(spec) - 2) spec[n++] = *p++;
+        while (*p && strchr("hlzjt", *p)) p++;
+        char conv = *p;
+        if (!conv) break;
+        p++;
+        spec[n++] = conv;
+        spec[n] = '\0';
+
+        FastLogArg arg = next < record.argc ? record.args[next] : 0;
+        next++;
+        size_t room = size - pos;
+        int written;
+        switch (conv) {
+            case 'd': case 'i':
+                written = snprintf(out + pos, room, spec, (int)(int32_t)arg);
+                break;
+            case 'u': case 'x': case 'X': case 'o': case 'c':
+                written = snprintf(out + pos, room, spec, (unsigned)arg);
+                break;
+            case 's':
+                written = snprintf(out + pos, room, spec, arg ? (const char*)arg : "(null)");
+                break;
+            case 'p':
+                written = snprintf(out + pos, room, spec, (void*)arg);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': {
+                uint32_t bits = (uint32_t)arg;
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                written = snprintf(out + pos, room, spec, (double)f);
+                break;
+            }
+            default:                                // 不支持的说明符原样输出
+                written = snprintf(out + pos, room, "%s", spec);
+                break;
+        }
+        if (written < 0) break;
+        pos += (size_t)written < room ? (size_t)written : room - 1;
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+static void emit(const FastLogRecord& record) {
+    char line[256];
+    uint8_t level = record.level < sizeof(LEVEL_PREFIX) / sizeof(LEVEL_PREFIX[0]) ? record.level : 0;
+    int head = snprintf(line, sizeof(line), "%s %u.%06u\033[0m ", LEVEL_PREFIX[level],
+                        (unsigned)(record.timestampUs / 1000000), (unsigned)(record.timestampUs % 1000000));
+    if (head < 0) return;
+    size_t len = (size_t)head;
+    len += formatRecord(record, line + len, sizeof(line) - len - 1);
+    line[len++] = '\n';
+    Serial.write((const uint8_t*)line, len);
+}
+
+void FastLog::push(const FastLogRecord& record) {
+    if (s_ring.tryPush(record)) {
+        s_records.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool FastLog::begin() {
+    if (s_task) return true;
+    s_drainLock = xSemaphoreCreateMutex();
+    if (!s_drainLock) return false;
+    return xTaskCreatePinnedToCore(taskEntry, "FastLog", 3072, nullptr, tskIDLE_PRIORITY + 1, &s_task,
+                                   FAST_LOG_CORE) == pdPASS;
+}
+
+void FastLog::flush() {
+    drain();
+}
+
+void FastLog::drain() {
+    if (!s_drainLock) return;                       // begin() 之前的记录保留在队列中，等任务启动后输出
+    xSemaphoreTake(s_drainLock, portMAX_DELAY);
+    FastLogRecord record;
+    while (s_ring.tryPop(record)) {
+        emit(record);
+    }
+    uint32_t dropped = s_dropped.load(std::memory_order_relaxed);
+    if (dropped != s_reportedDropped) {
+        char line[80];
+        int len = snprintf(line, sizeof(line), "\033[33m[W]\033[0m ⚠️ 日志队列已满，丢弃 %u 条（累计 %u 条）\n",
+                           (unsigned)(dropped - s_reportedDropped), (unsigned)dropped);
+        if (len > 0) Serial.write((const uint8_t*)line, (size_t)len < sizeof(line) ? (size_t)len : sizeof(line) - 1);
+        s_reportedDropped = dropped;
+    }
+    xSemaphoreGive(s_drainLock);
+}
+
+void FastLog::taskEntry(void*) {
+    for (;;) {
+        drain();
+        vTaskDelay(pdMS_TO_TICKS(FAST_LOG_DRAIN_MS));
+    }
+}
+
+uint32_t FastLog::recordCount() {
+    return s_records.load(std::memory_order_relaxed);
+}
+
+void FastLog::registerMetrics() {
+    Metrics::addCounter("log.dropped", "", s_dropped);
+    Metrics::watchTask("stack.fast_log", s_task);
+}
+
+uint32_t FastLog::droppedCount() {
+    return s_dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// 热路径日志：FLOG_ERROR / FLOG_WARN / FLOG_INFO / FLOG_DEBUG
+// - 低于 FAST_LOG_LEVEL 的调用在编译期整体删除（连参数都不会求值）
+// - 保留下来的调用只把 {格式串指针, 时间戳, 参数} 写进无锁环形队列（约 40 字节拷贝，不格式化、不碰串口）
+// - 低优先级的日志任务在后台格式化并输出到串口；队列满时丢弃新记录并计数，不会阻塞调用方
+//
+// 与 DEBUG_INFOF 的区别：格式化被推迟到日志任务中，因此
+// ⚠️ 格式串必须是字符串字面量；%s 参数必须指向长期有效的字符串（字面量、特征注册表中的 UUID、esp_err_to_name() 的返回值等），
+//    不能传 String::c_str() 之类的临时缓冲
+// ⚠️ 每条最多 FAST_LOG_MAX_ARGS 个参数，只支持 32 位以内的整数、浮点和指针（%d %i %u %x %X %o %c %s %p %f %e %g）
+// 启动阶段、低频的日志继续使用 DEBUG_INFO 系列即可
+
+#define FAST_LOG_LEVEL_NONE  0
+#define FAST_LOG_LEVEL_ERROR 1
+#define FAST_LOG_LEVEL_WARN  2
+#define FAST_LOG_LEVEL_INFO  3
+#define FAST_LOG_LEVEL_DEBUG 4
+
+#ifndef FAST_LOG_LEVEL
+#define FAST_LOG_LEVEL FAST_LOG_LEVEL_INFO          // 编译期日志级别，可在 platformio.ini 的 build_flags 中覆盖
+#endif
+
+#ifndef FAST_LOG_SLOTS
+#define FAST_LOG_SLOTS 128                          // 队列容量（条），必须是 2 的幂
+#endif
+
+#define FAST_LOG_MAX_ARGS 6
+
+typedef uintptr_t FastLogArg;
+
+struct FastLogRecord {
+    const char* format;                             // 格式串（字面量地址即格式 id）
+    uint32_t timestampUs;
+    uint8_t level;
+    uint8_t argc;
+    FastLogArg args[FAST_LOG_MAX_ARGS];
+};
+
+class FastLog {
+public:
+    static bool begin();                            // 创建后台输出任务（在 Serial.begin 之后调用一次）
+    static void flush();                            // 在调用方任务中立即输出全部积压记录（例如重启前）
+
+    template <typename... Args>
+    static void write(uint8_t level, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= FAST_LOG_MAX_ARGS, "FastLog 每条日志最多 6 个参数");
+        FastLogRecord record;
+        record.format = format;
+        record.timestampUs = (uint32_t)micros();
+        record.level = level;
+        record.argc = (uint8_t)sizeof...(Args);
+        FastLogArg packed[] = {0, toArg(args)...};   // 首个元素占位，避免零参数时出现零长度数组
+        memcpy(record.args, packed + 1, sizeof(FastLogArg) * sizeof...(Args));
+        push(record);
+    }
+
+    static uint32_t recordCount();                  // 成功入队的记录数
+    static uint32_t droppedCount();                 // 队列满被丢弃的记录数
+    static void registerMetrics();                  // 登记到 Metrics：丢弃的记录数、输出任务栈水位
+
+private:
+    static void push(const FastLogRecord& record);
+    static void taskEntry(void* arg);
+    static void drain();
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, FastLogArg>::type
+    toArg(T value) {
+        static_assert(sizeof(T) <= sizeof(FastLogArg), "FastLog 不支持超过指针宽度的整数参数");
+        return (FastLogArg)value;
+    }
+    static FastLogArg toArg(double value) {         // 浮点按 float 位模式保存
+        float f = (float)value;
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        return bits;
+    }
+    static FastLogArg toArg(const void* value) { return (FastLogArg)value; }
+};
+
+#if FAST_LOG_LEVEL >= FAST_LOG_LEVEL_ERROR
+#define FLOG_ERROR(format, ...) FastLog::write(FAST_LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+#define FLOG_ERROR(format, ...) do {} while (0)
+#endif
+
+#if FAST_LOG_LEVEL >= FAST_LOG_LEVEL_WARN
+#define FLOG_WARN(format, ...) FastLog::write(FAST_LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+#define FLOG_WARN(format, ...) do {} while (0)
+#endif
+
+#if FAST_LOG_LEVEL >= FAST_LOG_LEVEL_INFO
+#define FLOG_INFO(format, ...) FastLog::write(FAST_LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+#define FLOG_INFO(format, ...) do {} while (0)
+#endif
+
+#if FAST_LOG_LEVEL >= FAST_LOG_LEVEL_DEBUG
+#define FLOG_DEBUG(format, ...) FastLog::write(FAST_LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+#define FLOG_DEBUG(format, ...) do {} while (0)
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+// 固定桶的延迟直方图（单位：微秒）
+// - 第 i 个桶统计 [2^(i-1), 2^i) 微秒的样本，第 0 个桶统计 0 微秒，最后一个桶兜底所有更大的值
+// - record() 只做一次原子加，不分配内存，可在任意任务中调用
+// - percentile() 返回所在桶的上界（不超过实际最大值），精度为 2 倍以内，足以区分 “1ms 级” 与 “10ms 级” 的差异
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKET_COUNT = 24;                  // 最大约 8.4 秒
+
+    void record(uint32_t micros) {
+        _buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(micros, std::memory_order_relaxed);
+        uint32_t prev = _max.load(std::memory_order_relaxed);
+        while (micros > prev && !_max.compare_exchange_weak(prev, micros, std::memory_order_relaxed)) {}
+    }
+
+    uint32_t count() const { return _count.load(std::memory_order_relaxed); }
+    uint32_t max() const { return _max.load(std::memory_order_relaxed); }
+    uint32_t mean() const {
+        uint32_t n = count();
+        return n ? (uint32_t)(_sum.load(std::memory_order_relaxed) / n) : 0;
+    }
+    uint32_t bucket(size_t i) const { return _buckets[i].load(std::memory_order_relaxed); }
+    static uint32_t bucketUpperBound(size_t i) { return i == 0 ? 0 : (1u << i) - 1; }
+
+    uint32_t percentile(uint32_t pct) const {                   // pct 取值 0~100
+        uint32_t n = count();
+        if (n == 0) return 0;
+        uint64_t target = ((uint64_t)n * pct + 99) / 100;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += bucket(i);
+            if (seen >= target) {
+                uint32_t peak = max();
+                return i == BUCKET_COUNT - 1 || bucketUpperBound(i) > peak ? peak : bucketUpperBound(i);
+            }
+        }
+        return max();
+    }
+
+    void reset() {
+        for (auto& b : _buckets) b.store(0, std::memory_order_relaxed);
+        _count.store(0, std::memory_order_relaxed);
+        _sum.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static size_t bucketOf(uint32_t v) {
+        size_t i = 0;
+        while (v && i < BUCKET_COUNT - 1) { v >>= 1; ++i; }
+        return i;
+    }
+
+    std::atomic<uint32_t> _buckets[BUCKET_COUNT] = {};
+    std::atomic<uint32_t> _count{0};
+    std::atomic<uint32_t> _sum{0};                           // 32 位足够覆盖约 71 分钟的累计延迟，调用 reset() 重新统计
+    std::atomic<uint32_t> _max{0};
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "SPSCRing.h"
+
+// 多生产者 / 单消费者无锁有界队列（每个槽位带序号，Vyukov 有界队列的单消费者版本）
+// - 任意任务都可以 tryPush()，队列满时立即返回 false，从不阻塞、不加锁
+// - 生产者用 CAS 抢占 head 上的位置，填好槽位后用序号发布；消费者按序号判断槽位是否已发布
+// - 元素按值拷入拷出，适合几十字节的小记录（例如日志记录）
+// ⚠️ 只能有一个消费者任务，多个消费者需要外部加锁
+
+template <typename T, size_t Capacity>
+class MPSCRing {
+    static_assert(Capacity >= 2, "MPSCRing 容量至少为 2");
+    static_assert((Capacity & (Capacity - 1)) == 0, "MPSCRing 容量必须是 2 的幂");
+
+public:
+    MPSCRing() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            _slots[i].seq.store((uint32_t)i, std::memory_order_relaxed);
+        }
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // ---------- 生产者侧（任意任务） ----------
+    bool tryPush(const T& value) {
+        uint32_t pos = _head.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &_slots[pos & (Capacity - 1)];
+            uint32_t seq = slot->seq.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0) {
+                // 槽位空闲：抢占这个位置，失败时 pos 被更新为最新的 head 后重试
+                if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;                                   // 消费者还没取走一圈前的数据：队列已满
+            } else {
+                pos = _head.load(std::memory_order_relaxed);    // 被其他生产者抢先，重新读取
+            }
+        }
+        slot->value = value;
+        slot->seq.store(pos + 1, std::memory_order_release);    // 发布
+        return true;
+    }
+
+    // ---------- 消费者侧（唯一任务） ----------
+    bool tryPop(T& out) {
+        uint32_t pos = _tail.load(std::memory_order_relaxed);
+        Slot& slot = _slots[pos & (Capacity - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != pos + 1) return false;   // 空，或生产者尚未发布
+        out = slot.value;
+        slot.seq.store(pos + Capacity, std::memory_order_release);              // 归还给下一圈的生产者
+        _tail.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t size() const {                                       // 近似值：包含已抢占但尚未发布的槽位
+        return _head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        T value;
+    };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> _head{0};    // 下一个被抢占的位置
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> _tail{0};    // 消费者读取位置
+    alignas(CACHE_LINE_SIZE) Slot _slots[Capacity];
+};
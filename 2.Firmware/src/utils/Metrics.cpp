@@ -0,0 +1,266 @@
+#include "Metrics.h"
+#include <Arduino.h>
+#include <string.h>
+#include <esp_timer.h>
+#include "serial_color_debug.h"
+
+namespace {
+enum Kind : uint8_t { KIND_COUNTER, KIND_GAUGE, KIND_HISTOGRAM, KIND_RATE, KIND_PROBE };
+
+struct Entry {
+    std::atomic<const char*> name;                  // 最后写入：非空表示槽位已填好
+    const char* unit;
+    Kind kind;
+    const std::atomic<uint32_t>* counter;           // KIND_COUNTER / KIND_RATE
+    MetricGauge* gauge;
+    LatencyHistogram* histogram;
+    Metrics::ProbeFn probe;
+    void* arg;
+    std::atomic<int32_t> sampled;                   // KIND_RATE / KIND_PROBE 的最近一次采样值
+    uint32_t lastCount;                             // 以下只在采样定时器中访问
+    uint32_t lastMs;
+    bool primed;
+};
+
+Entry s_entries[Metrics::MAX_METRICS];
+std::atomic<uint32_t> s_allocated{0};
+esp_timer_handle_t s_timer = nullptr;
+
+Entry* allocate(const char* name, const char* unit, Kind kind) {
+    uint32_t id = s_allocated.fetch_add(1, std::memory_order_relaxed);
+    if (id >= Metrics::MAX_METRICS) {
+        DEBUG_WARNF("⚠️ 指标槽位已满（%u），未注册: %s", (unsigned)Metrics::MAX_METRICS, name);
+        return nullptr;
+    }
+    Entry& e = s_entries[id];
+    e.unit = unit ? unit : "";
+    e.kind = kind;
+    e.counter = nullptr;
+    e.gauge = nullptr;
+    e.histogram = nullptr;
+    e.probe = nullptr;
+    e.arg = nullptr;
+    e.sampled.store(0, std::memory_order_relaxed);
+    e.lastCount = 0;
+    e.lastMs = 0;
+    e.primed = false;
+    return &e;
+}
+
+bool publish(Entry* e, const char* name) {
+    if (!e) return false;
+    e->name.store(name, std::memory_order_release);
+    return true;
+}
+
+size_t recorded() {
+    uint32_t n = s_allocated.load(std::memory_order_acquire);
+    return n < Metrics::MAX_METRICS ? n : Metrics::MAX_METRICS;
+}
+
+uint8_t wireType(Kind kind) {
+    switch (kind) {
+        case KIND_COUNTER: return Metrics::COUNTER;
+        case KIND_HISTOGRAM: return Metrics::HISTOGRAM;
+        default: return Metrics::GAUGE;
+    }
+}
+
+size_t recordBytes(Kind kind) {
+    return kind == KIND_HISTOGRAM ? 2 + 16 : 2 + 4;
+}
+
+int32_t gaugeValue(const Entry& e) {
+    if (e.kind == KIND_GAUGE) return e.gauge->value();
+    return e.sampled.load(std::memory_order_relaxed);
+}
+
+void put32(uint8_t* out, uint32_t v) {
+    memcpy(out, &v, sizeof(v));                     // ESP32 与主机都是小端
+}
+
+void onTimer(void*) {
+    Metrics::sample(millis());
+}
+
+int32_t taskStackProbe(void* task) {
+    return (int32_t)uxTaskGetStackHighWaterMark((TaskHandle_t)task);   // ESP-IDF 中单位是字节
+}
+}  // namespace
+
+bool Metrics::addCounter(const char* name, const char* unit, const std::atomic<uint32_t>& counter) {
+    Entry* e = allocate(name, unit, KIND_COUNTER);
+    if (e) e->counter = &counter;
+    return publish(e, name);
+}
+
+bool Metrics::addGauge(const char* name, const char* unit, MetricGauge& gauge) {
+    Entry* e = allocate(name, unit, KIND_GAUGE);
+    if (e) e->gauge = &gauge;
+    return publish(e, name);
+}
+
+bool Metrics::addHistogram(const char* name, const char* unit, LatencyHistogram& histogram) {
+    Entry* e = allocate(name, unit, KIND_HISTOGRAM);
+    if (e) e->histogram = &histogram;
+    return publish(e, name);
+}
+
+bool Metrics::addRate(const char* name, const char* unit, const std::atomic<uint32_t>& counter) {
+    Entry* e = allocate(name, unit, KIND_RATE);
+    if (e) e->counter = &counter;
+    return publish(e, name);
+}
+
+bool Metrics::addProbe(const char* name, const char* unit, ProbeFn probe, void* arg) {
+    Entry* e = allocate(name, unit, KIND_PROBE);
+    if (e) {
+        e->probe = probe;
+        e->arg = arg;
+    }
+    return publish(e, name);
+}
+
+bool Metrics::watchTask(const char* name, TaskHandle_t task) {
+    if (!task) return false;
+    return addProbe(name, "B", &taskStackProbe, task);
+}
+
+bool Metrics::begin() {
+    if (s_timer) return true;
+    addProbe("heap.free", "B", [](void*) { return (int32_t)ESP.getFreeHeap(); });
+    addProbe("heap.min_free", "B", [](void*) { return (int32_t)ESP.getMinFreeHeap(); });   // 启动以来的最低值
+    sample(millis());
+
+    esp_timer_create_args_t args = {};
+    args.callback = &onTimer;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "metrics";
+    if (esp_timer_create(&args, &s_timer) != ESP_OK) {
+        DEBUG_ERROR("❌ 创建指标采样定时器失败");
+        s_timer = nullptr;
+        return false;
+    }
+    esp_timer_start_periodic(s_timer, METRICS_SAMPLE_MS * 1000ULL);
+    DEBUG_INFOF("📊 指标注册表就绪：%u 项，采样周期 %u ms", (unsigned)count(), (unsigned)METRICS_SAMPLE_MS);
+    return true;
+}
+
+void Metrics::sample(uint32_t nowMs) {
+    for (size_t i = 0; i < recorded(); ++i) {
+        Entry& e = s_entries[i];
+        if (!e.name.load(std::memory_order_acquire)) continue;
+        if (e.kind == KIND_PROBE) {
+            e.sampled.store(e.probe(e.arg), std::memory_order_relaxed);
+        } else if (e.kind == KIND_RATE) {
+            uint32_t value = e.counter->load(std::memory_order_relaxed);
+            uint32_t elapsed = nowMs - e.lastMs;
+            if (e.primed && elapsed > 0) {
+                uint32_t delta = value >= e.lastCount ? value - e.lastCount : value;   // 计数器被重置（例如新的 OTA 会话）
+                e.sampled.store((int32_t)((uint64_t)delta * 1000 / elapsed), std::memory_order_relaxed);
+            }
+            e.lastCount = value;
+            e.lastMs = nowMs;
+            e.primed = true;
+        }
+    }
+}
+
+size_t Metrics::count() {
+    return recorded();
+}
+
+size_t Metrics::snapshot(uint8_t* out, size_t capacity) {
+    if (capacity < HEADER_BYTES) return 0;
+    size_t pos = HEADER_BYTES;
+    uint8_t written = 0;
+    for (size_t i = 0; i < recorded(); ++i) {
+        const Entry& e = s_entries[i];
+        if (!e.name.load(std::memory_order_acquire)) continue;
+        if (pos + recordBytes(e.kind) > capacity) continue;
+        out[pos++] = (uint8_t)i;
+        out[pos++] = wireType(e.kind);
+        if (e.kind == KIND_COUNTER) {
+            put32(&out[pos], e.counter->load(std::memory_order_relaxed));
+            pos += 4;
+        } else if (e.kind == KIND_HISTOGRAM) {
+            put32(&out[pos], e.histogram->count());
+            put32(&out[pos + 4], e.histogram->percentile(50));
+            put32(&out[pos + 8], e.histogram->percentile(99));
+            put32(&out[pos + 12], e.histogram->max());
+            pos += 16;
+        } else {
+            put32(&out[pos], (uint32_t)gaugeValue(e));
+            pos += 4;
+        }
+        written++;
+    }
+    out[0] = FRAME_VERSION;
+    out[1] = written;
+    put32(&out[2], millis());
+    return pos;
+}
+
+size_t Metrics::describe(uint8_t* out, size_t capacity) {
+    if (capacity < 2) return 0;
+    size_t pos = 2;
+    uint8_t written = 0;
+    for (size_t i = 0; i < recorded(); ++i) {
+        const Entry& e = s_entries[i];
+        const char* name = e.name.load(std::memory_order_acquire);
+        if (!name) continue;
+        size_t nameLen = strlen(name);
+        size_t unitLen = strlen(e.unit);
+        if (nameLen > 0xFF || unitLen > 0xFF || pos + 4 + nameLen + unitLen > capacity) continue;
+        out[pos++] = (uint8_t)i;
+        out[pos++] = wireType(e.kind);
+        out[pos++] = (uint8_t)nameLen;
+        memcpy(&out[pos], name, nameLen);
+        pos += nameLen;
+        out[pos++] = (uint8_t)unitLen;
+        memcpy(&out[pos], e.unit, unitLen);
+        pos += unitLen;
+        written++;
+    }
+    out[0] = FRAME_VERSION;
+    out[1] = written;
+    return pos;
+}
+
+void Metrics::reset() {
+    for (size_t i = 0; i < recorded(); ++i) {
+        Entry& e = s_entries[i];
+        if (!e.name.load(std::memory_order_acquire)) continue;
+        if (e.kind == KIND_HISTOGRAM) e.histogram->reset();
+        if (e.kind == KIND_GAUGE && e.gauge->mode() != MetricGauge::LAST) e.gauge->reset();
+    }
+}
+
+void Metrics::print() {
+    size_t n = recorded();
+    DEBUG_INFOF("📊 运行指标（%u 项，运行 %u s）:", (unsigned)n, (unsigned)(millis() / 1000));
+    for (size_t i = 0; i < n; ++i) {
+        const Entry& e = s_entries[i];
+        const char* name = e.name.load(std::memory_order_acquire);
+        if (!name) continue;
+        if (e.kind == KIND_COUNTER) {
+            DEBUG_INFOF("  %-24s %u %s", name, (unsigned)e.counter->load(std::memory_order_relaxed), e.unit);
+        } else if (e.kind == KIND_HISTOGRAM) {
+            LatencyHistogram& h = *e.histogram;
+            DEBUG_INFOF("  %-24s 样本=%u 平均=%u p50=%u p99=%u 最大=%u %s", name, h.count(), h.mean(), h.percentile(50),
+                        h.percentile(99), h.max(), e.unit);
+        } else {
+            DEBUG_INFOF("  %-24s %d %s", name, (int)gaugeValue(e), e.unit);
+        }
+    }
+}
+
+void Metrics::clear() {
+    if (s_timer) {
+        esp_timer_stop(s_timer);
+        esp_timer_delete(s_timer);
+        s_timer = nullptr;
+    }
+    for (size_t i = 0; i < MAX_METRICS; ++i) s_entries[i].name.store(nullptr, std::memory_order_relaxed);
+    s_allocated.store(0, std::memory_order_release);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "utils/LatencyHistogram.h"
+
+#ifndef METRICS_MAX
+#define METRICS_MAX 40                              // 注册表槽位数
+#endif
+
+#ifndef METRICS_SAMPLE_MS
+#define METRICS_SAMPLE_MS 1000                      // 速率与探针的采样周期
+#endif
+
+// 量规：最新值、峰值（高水位）或谷值（低水位），update() 只做原子写 / CAS，不分配内存
+class MetricGauge {
+public:
+    enum Mode : uint8_t { LAST = 0, HIGH_WATER = 1, LOW_WATER = 2 };   // 不用 HIGH/LOW：Arduino.h 中是宏
+
+    explicit MetricGauge(Mode mode = LAST) : _mode(mode) { reset(); }
+
+    void update(int32_t v) {
+        if (_mode == LAST) {
+            _value.store(v, std::memory_order_relaxed);
+            return;
+        }
+        int32_t prev = _value.load(std::memory_order_relaxed);
+        while ((_mode == HIGH_WATER ? v > prev : v < prev) &&
+               !_value.compare_exchange_weak(prev, v, std::memory_order_relaxed)) {}
+    }
+    int32_t value() const {
+        int32_t v = _value.load(std::memory_order_relaxed);
+        return _mode == LOW_WATER && v == INT32_MAX ? 0 : v;      // 谷值还没有样本时报 0
+    }
+    void reset() { _value.store(_mode == LOW_WATER ? INT32_MAX : 0, std::memory_order_relaxed); }
+    Mode mode() const { return _mode; }
+
+private:
+    Mode _mode;
+    std::atomic<int32_t> _value{0};
+};
+
+// 运行期指标注册表：计数器、量规和固定桶直方图（LatencyHistogram）
+// - 指标本身由各模块持有（成员变量），热路径上的更新就是一次原子操作；注册表只保存指针，不分配内存
+// - 计数器直接注册模块已有的 std::atomic<uint32_t>（例如 MessageDispatcher 的丢弃计数）
+// - 速率（addRate）与探针（addProbe，堆、任务栈水位、链路参数）由采样定时器每 METRICS_SAMPLE_MS 计算一次
+// - 名称与单位必须是字符串字面量（只保存指针）；注册在启动时完成，编号即注册顺序，一次启动内不变
+//
+//   Metrics::addCounter("dispatch.dropped", "", _dropped);
+//   Metrics::addHistogram("dispatch.latency", "us", _latency);
+//   Metrics::begin();                              // 系统指标 + 采样定时器
+//   Metrics::print();                              // 串口 stats 命令
+//
+// 二进制快照（小端，DiagnosticsController 经 Diagnostics 特征发出）：
+//   [0] 版本 [1] 条数 [2-5] 运行时间 ms，之后每条：
+//   [编号][类型 1=计数器] u32 | [编号][类型 2=量规] i32 | [编号][类型 3=直方图] 样本数 u32, p50 u32, p99 u32, 最大 u32
+// 名称表（describe）：[0] 版本 [1] 条数，之后每条 [编号][类型][名称长度][名称][单位长度][单位]
+class Metrics {
+public:
+    typedef int32_t (*ProbeFn)(void* arg);
+
+    enum Type : uint8_t { COUNTER = 1, GAUGE = 2, HISTOGRAM = 3 };
+
+    static const size_t MAX_METRICS = METRICS_MAX;
+    static const uint8_t FRAME_VERSION = 1;
+    static const size_t HEADER_BYTES = 6;
+
+    static bool addCounter(const char* name, const char* unit, const std::atomic<uint32_t>& counter);
+    static bool addGauge(const char* name, const char* unit, MetricGauge& gauge);
+    static bool addHistogram(const char* name, const char* unit, LatencyHistogram& histogram);
+    static bool addRate(const char* name, const char* unit, const std::atomic<uint32_t>& counter);   // 计数器每秒增量
+    static bool addProbe(const char* name, const char* unit, ProbeFn probe, void* arg = nullptr);   // 采样时读取
+    static bool watchTask(const char* name, TaskHandle_t task);     // 任务栈高水位（历史最少剩余，字节）
+
+    static bool begin();                            // 注册堆指标并启动采样定时器
+    static void sample(uint32_t nowMs);             // 计算速率与探针（定时器中调用；主机测试直接调用）
+
+    static size_t count();
+    static size_t snapshot(uint8_t* out, size_t capacity);     // 放不下的条目整条省略，返回写入字节数
+    static size_t describe(uint8_t* out, size_t capacity);
+    static void reset();                            // 清零直方图与峰值/谷值量规（计数器保持单调递增）
+    static void print();                            // 逐条打印到串口
+    static void clear();                            // 清空注册表（主机测试）
+};
@@ -0,0 +1,159 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// 定长负载缓冲池 + 引用计数切片
+// - 启动时一次性分配 BLOCK_COUNT 个 BLOCK_SIZE 字节的块，运行期不再申请堆内存
+// - 空闲块用原子位图管理，分配/释放都是无锁的，任意任务（包括 BLE 回调）都可以调用
+// - PayloadRef 是块的引用计数句柄：拷贝 +1，析构 -1，归零时自动归还到池中
+//   消息在队列、分发器、控制器之间传递时只传句柄，不拷贝负载本身
+
+class PayloadPool;
+
+class PayloadRef {
+public:
+    PayloadRef() = default;
+    PayloadRef(const PayloadRef& other);
+    PayloadRef(PayloadRef&& other) noexcept : _pool(other._pool), _index(other._index) { other._pool = nullptr; }
+    PayloadRef& operator=(const PayloadRef& other);
+    PayloadRef& operator=(PayloadRef&& other) noexcept;
+    ~PayloadRef() { release(); }
+
+    const uint8_t* data() const;
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    const uint8_t* begin() const { return data(); }
+    const uint8_t* end() const { return data() + size(); }
+    uint8_t operator[](size_t i) const { return data()[i]; }
+    explicit operator bool() const { return _pool != nullptr; }
+    void release();
+
+private:
+    friend class PayloadPool;
+    PayloadRef(PayloadPool* pool, uint16_t index) : _pool(pool), _index(index) {}
+
+    PayloadPool* _pool = nullptr;
+    uint16_t _index = 0;
+};
+
+class PayloadPool {
+public:
+    static constexpr size_t MAX_BLOCKS = 256;
+
+    // blockSize：单块容量（MTU 上限 512，或短消息用的小块）；blockCount：块数量（≤ MAX_BLOCKS）
+    PayloadPool(size_t blockSize, size_t blockCount)
+        : _blockSize(blockSize),
+          _blockCount(blockCount > MAX_BLOCKS ? MAX_BLOCKS : blockCount),
+          _storage(new uint8_t[_blockSize * _blockCount]) {
+        for (size_t i = 0; i < _blockCount; ++i) {
+            _refs[i].store(0, std::memory_order_relaxed);
+            _lengths[i] = 0;
+        }
+        for (size_t w = 0; w < WORDS; ++w) {
+            // 超出 blockCount 的位预先标记为“已占用”，分配时自然跳过
+            uint32_t used = 0;
+            for (size_t b = 0; b < 32; ++b) {
+                if (w * 32 + b >= _blockCount) used |= (1u << b);
+            }
+            _used[w].store(used, std::memory_order_relaxed);
+        }
+    }
+    ~PayloadPool() { delete[] _storage; }
+    PayloadPool(const PayloadPool&) = delete;
+    PayloadPool& operator=(const PayloadPool&) = delete;
+
+    // 从池中取一块并拷贝数据进去；池耗尽或数据超长时返回空句柄
+    PayloadRef acquire(const uint8_t* src, size_t len) {
+        if (len > _blockSize) return PayloadRef();
+        for (size_t w = 0; w < WORDS; ++w) {
+            uint32_t used = _used[w].load(std::memory_order_relaxed);
+            while (used != 0xFFFFFFFFu) {
+                uint32_t bit = firstZeroBit(used);
+                if (_used[w].compare_exchange_weak(used, used | (1u << bit),
+                                                   std::memory_order_acquire, std::memory_order_relaxed)) {
+                    uint16_t index = (uint16_t)(w * 32 + bit);
+                    if (len) memcpy(blockData(index), src, len);
+                    _lengths[index] = (uint16_t)len;
+                    _refs[index].store(1, std::memory_order_relaxed);
+                    return PayloadRef(this, index);
+                }
+            }
+        }
+        return PayloadRef();
+    }
+
+    size_t blockSize() const { return _blockSize; }
+    size_t blockCount() const { return _blockCount; }
+    size_t inUse() const {
+        size_t n = 0;
+        for (size_t i = 0; i < _blockCount; ++i) {
+            if (_refs[i].load(std::memory_order_relaxed)) ++n;
+        }
+        return n;
+    }
+
+private:
+    friend class PayloadRef;
+    static constexpr size_t WORDS = MAX_BLOCKS / 32;
+
+    static uint32_t firstZeroBit(uint32_t v) {
+        uint32_t bit = 0;
+        while (v & 1u) { v >>= 1; ++bit; }
+        return bit;
+    }
+    uint8_t* blockData(uint16_t index) { return _storage + (size_t)index * _blockSize; }
+    void retain(uint16_t index) { _refs[index].fetch_add(1, std::memory_order_relaxed); }
+    void drop(uint16_t index) {
+        if (_refs[index].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            _used[index / 32].fetch_and(~(1u << (index % 32)), std::memory_order_release);
+        }
+    }
+
+    const size_t _blockSize;
+    const size_t _blockCount;
+    uint8_t* const _storage;
+    std::atomic<uint16_t> _refs[MAX_BLOCKS];
+    uint16_t _lengths[MAX_BLOCKS];
+    std::atomic<uint32_t> _used[WORDS];
+};
+
+inline PayloadRef::PayloadRef(const PayloadRef& other) : _pool(other._pool), _index(other._index) {
+    if (_pool) _pool->retain(_index);
+}
+
+inline PayloadRef& PayloadRef::operator=(const PayloadRef& other) {
+    if (this != &other) {
+        if (other._pool) other._pool->retain(other._index);
+        release();
+        _pool = other._pool;
+        _index = other._index;
+    }
+    return *this;
+}
+
+inline PayloadRef& PayloadRef::operator=(PayloadRef&& other) noexcept {
+    if (this != &other) {
+        release();
+        _pool = other._pool;
+        _index = other._index;
+        other._pool = nullptr;
+    }
+    return *this;
+}
+
+inline const uint8_t* PayloadRef::data() const {
+    return _pool ? _pool->blockData(_index) : nullptr;
+}
+
+inline size_t PayloadRef::size() const {
+    return _pool ? _pool->_lengths[_index] : 0;
+}
+
+inline void PayloadRef::release() {
+    if (_pool) {
+        _pool->drop(_index);
+        _pool = nullptr;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// 单生产者 / 单消费者无锁环形队列
+// - 槽位在构造时一次性分配（定长数组），运行期不再申请堆内存
+// - 生产者只写 head，消费者只写 tail，两者分别独占一条 cache line，避免伪共享
+// - 生产者：beginWrite() 取得空槽 → 填充 → commitWrite() 发布
+// - 消费者：front() 取得最早的槽 → 使用/交换走数据 → popFront() 归还
+// ⚠️ 只能有一个生产者任务和一个消费者任务，否则需要外部加锁
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+// 不超过 n 的最大 2 的幂（至少为 2），用于把“字节预算”换算成槽位数量
+constexpr size_t spscFloorPow2(size_t n) {
+    return n < 4 ? 2 : 2 * spscFloorPow2(n / 2);
+}
+
+template <typename T, size_t Capacity>
+class SPSCRing {
+    static_assert(Capacity >= 2, "SPSCRing 容量至少为 2");
+    static_assert((Capacity & (Capacity - 1)) == 0, "SPSCRing 容量必须是 2 的幂");
+
+public:
+    static constexpr size_t capacity() { return Capacity; }
+
+    // ---------- 生产者侧 ----------
+    T* beginWrite() {                                           // 获取下一个可写槽位，队列已满时返回 nullptr
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= Capacity) return nullptr;
+        return &_slots[head & (Capacity - 1)];
+    }
+    void commitWrite() {                                        // 发布 beginWrite() 取得的槽位
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // ---------- 消费者侧 ----------
+    T* front() {                                                // 获取最早的已发布槽位，队列为空时返回 nullptr
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return nullptr;
+        return &_slots[tail & (Capacity - 1)];
+    }
+    void popFront() {                                           // 归还 front() 取得的槽位
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // ---------- 任意一侧 ----------
+    bool empty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+    size_t size() const {                                       // 近似值：并发读写时只保证不超过 Capacity
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+    T* slotAt(size_t index) { return &_slots[index]; }          // 初始化时遍历槽位（例如预留容量）
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _head{0};      // 生产者写入位置
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> _tail{0};      // 消费者读取位置
+    alignas(CACHE_LINE_SIZE) T _slots[Capacity];                // 预分配槽位
+};
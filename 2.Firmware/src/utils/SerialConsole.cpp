@@ -0,0 +1,160 @@
+#include "SerialConsole.h"
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+#include "serial_color_debug.h"
+#include "Metrics.h"
+
+#ifndef CONSOLE_CORE
+#define CONSOLE_CORE 0              // 与 FastLog 一样放在协议栈所在的核、最低优先级，不和 loop() 抢 CPU
+#endif
+
+namespace {
+struct Command {
+    const char* name;
+    const char* help;
+    SerialConsole::Handler handler;
+    void* ctx;
+};
+
+Command s_commands[CONSOLE_MAX_COMMANDS];
+std::atomic<uint8_t> s_count{0};                    // 槽位填好之后才发布，命令台任务读到的条目总是完整的
+SerialConsole::Fallback s_fallback = nullptr;
+TaskHandle_t s_task = nullptr;
+
+// 行缓冲只在命令台任务中访问
+char s_line[CONSOLE_LINE_MAX];
+size_t s_length = 0;
+bool s_overflow = false;
+std::atomic<uint32_t> s_overflows{0};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+const Command* find(const char* name, size_t length) {
+    uint8_t n = s_count.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < n; ++i) {
+        if (strlen(s_commands[i].name) == length && strncmp(s_commands[i].name, name, length) == 0) return &s_commands[i];
+    }
+    return nullptr;
+}
+}  // namespace
+
+bool SerialConsole::add(const char* name, const char* help, Handler handler, void* ctx) {
+    if (!name || !handler) return false;
+    if (find(name, strlen(name))) {
+        DEBUG_WARNF("⚠️ 串口命令重复注册: %s", name);
+        return false;
+    }
+    uint8_t n = s_count.load(std::memory_order_relaxed);
+    if (n >= CONSOLE_MAX_COMMANDS) {
+        DEBUG_WARNF("⚠️ 串口命令槽位已满（%u），未注册: %s", (unsigned)CONSOLE_MAX_COMMANDS, name);
+        return false;
+    }
+    s_commands[n] = {name, help ? help : "", handler, ctx};
+    s_count.store(n + 1, std::memory_order_release);
+    return true;
+}
+
+void SerialConsole::setFallback(Fallback fallback) {
+    s_fallback = fallback;
+}
+
+bool SerialConsole::begin() {
+    if (s_task) return true;
+    if (xTaskCreatePinnedToCore(taskEntry, "Console", 4096, nullptr, tskIDLE_PRIORITY + 1, &s_task, CONSOLE_CORE) != pdPASS) {
+        DEBUG_ERROR("❌ 创建串口命令台任务失败");
+        s_task = nullptr;
+        return false;
+    }
+    Metrics::watchTask("stack.console", s_task);
+    return true;
+}
+
+// Serial.read() 在没有数据时立即返回 -1：每个轮询周期读空接收缓冲，然后让出 CPU
+void SerialConsole::taskEntry(void*) {
+    while (true) {
+        while (Serial.available() > 0) {
+            int c = Serial.read();
+            if (c < 0) break;
+            feed((char)c);
+        }
+        vTaskDelay(pdMS_TO_TICKS(CONSOLE_POLL_MS));
+    }
+}
+
+bool SerialConsole::feed(char c) {
+    if (c == '\r' || c == '\n') {
+        bool overflow = s_overflow;
+        size_t length = s_length;
+        s_overflow = false;
+        s_length = 0;
+        if (overflow) {
+            s_overflows.fetch_add(1, std::memory_order_relaxed);
+            DEBUG_WARNF("⚠️ 串口命令超过 %u 字节，已丢弃", (unsigned)(CONSOLE_LINE_MAX - 1));
+            return false;
+        }
+        if (length == 0) return false;              // 空行（含 \r\n 的第二个字节）
+        s_line[length] = '\0';
+        execute(s_line);
+        return true;
+    }
+    if (c == '\b' || c == 0x7F) {                   // 退格
+        if (s_length > 0 && !s_overflow) s_length--;
+        return false;
+    }
+    if ((uint8_t)c < 0x20 && c != '\t') return false;   // 其它控制字符忽略
+    if (s_length >= CONSOLE_LINE_MAX - 1) {
+        s_overflow = true;                          // 继续吞掉本行剩余字节，直到行尾
+        return false;
+    }
+    s_line[s_length++] = c;
+    return false;
+}
+
+bool SerialConsole::execute(char* line) {
+    while (isSpace(*line)) line++;
+    size_t length = strlen(line);
+    while (length > 0 && isSpace(line[length - 1])) line[--length] = '\0';
+    if (length == 0) return false;
+
+    size_t nameLength = 0;
+    while (line[nameLength] && !isSpace(line[nameLength])) nameLength++;
+    const char* args = line + nameLength;
+    while (isSpace(*args)) args++;
+
+    if (nameLength == 4 && strncmp(line, "help", 4) == 0) {
+        printHelp();
+        return true;
+    }
+    const Command* command = find(line, nameLength);
+    if (command) {
+        command->handler(args, command->ctx);
+        return true;
+    }
+    if (s_fallback && s_fallback(line)) return true;
+    DEBUG_WARNF("⚠️ 未知命令: %s（输入 help 查看可用命令）", line);
+    return false;
+}
+
+void SerialConsole::printHelp() {
+    uint8_t n = s_count.load(std::memory_order_acquire);
+    DEBUG_INFOF("⌨️ 串口命令（%u 个）:", (unsigned)n);
+    for (uint8_t i = 0; i < n; ++i) {
+        DEBUG_INFOF("  %-10s %s", s_commands[i].name, s_commands[i].help);
+    }
+    if (s_fallback) DEBUG_INFO("  其余命令交给当前入口模块处理");
+}
+
+uint32_t SerialConsole::overflowCount() {
+    return s_overflows.load(std::memory_order_relaxed);
+}
+
+void SerialConsole::clear() {
+    s_count.store(0, std::memory_order_release);
+    s_fallback = nullptr;
+    s_length = 0;
+    s_overflow = false;
+    s_overflows.store(0, std::memory_order_relaxed);
+}
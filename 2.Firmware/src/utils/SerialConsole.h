@@ -0,0 +1,44 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef CONSOLE_LINE_MAX
+#define CONSOLE_LINE_MAX 96                         // 一行命令的最大长度（含结尾 0），超长的行整行丢弃
+#endif
+
+#ifndef CONSOLE_MAX_COMMANDS
+#define CONSOLE_MAX_COMMANDS 16                     // 命令表槽位数
+#endif
+
+#ifndef CONSOLE_POLL_MS
+#define CONSOLE_POLL_MS 20                          // 串口轮询周期
+#endif
+
+// 串口命令台：独立的低优先级任务逐字节读取串口，行缓冲是固定数组，不分配内存，也不会阻塞 loop()
+// - 模块在 setup 中登记自己的命令（名称与说明必须是字符串字面量，只保存指针）
+// - 处理函数在命令台任务中执行：只能调用线程安全的接口（MotionController、Metrics 等），耗时操作同样不影响 runLoop()
+// - 没有登记的命令整行交给 fallback（当前入口模块的 runCommand，例如舵机测试中的标定命令）
+//
+//   SerialConsole::add("boot", "打印启动各阶段耗时", [](const char*, void*) { BootTimeline::print(); });
+//   SerialConsole::setFallback(runCommand);
+//   SerialConsole::begin();
+//
+// 行以 \r 或 \n 结束（\r\n 只算一行），支持退格；命令名与参数以空格分隔，args 是去掉首尾空白的剩余部分
+class SerialConsole {
+public:
+    typedef void (*Handler)(const char* args, void* ctx);
+    typedef bool (*Fallback)(const char* line);
+
+    static bool add(const char* name, const char* help, Handler handler, void* ctx = nullptr);   // 槽位用完或重名时返回 false
+    static void setFallback(Fallback fallback);
+    static bool begin();                            // 创建命令台任务（在 Serial.begin 之后调用一次）
+
+    static bool feed(char c);                       // 解析一个字节，读完一行时执行并返回 true（主机测试直接调用）
+    static bool execute(char* line);                // 原地拆分并执行一行，未处理返回 false
+    static void printHelp();
+    static uint32_t overflowCount();                // 因超长被丢弃的行数
+    static void clear();                            // 清空命令表与行缓冲（主机测试）
+
+private:
+    static void taskEntry(void* arg);
+};
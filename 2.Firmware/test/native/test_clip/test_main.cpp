@@ -0,0 +1,389 @@
+// MotionClipReader：文件头校验、超过一批（16 条）的流式读取与截断、关键帧校验（轴 / 缓动 / BadTiming）、循环片段 rewind，
+// 以及 data/clips 中由 build-clips.py 生成的片段能完整读出；ClipPlayer 忽略空写入；逐条读取开销
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include <SPIFFS.h>
+#include "controllers/AnimationController/MotionClip.h"
+#include "controllers/AnimationController/ClipPlayer.h"
+#include "controllers/PWMServoController/PWMServoController.h"
+#include "drivers/Transport/MessageTransport.h"
+
+static const char* CLIP_CONTROL_UUID = "ef050001-1000-8000-0080-5f9b34fb0000";
+
+// 内存中的片段，记录每次 read 的长度，用来确认读取器按批读取
+class MemorySource : public ClipSource {
+public:
+    std::vector<uint8_t> bytes;
+    std::vector<size_t> reads;
+    uint32_t pos = 0;
+
+    size_t read(uint8_t* dst, size_t len) override {
+        size_t n = pos + len <= bytes.size() ? len : bytes.size() - pos;
+        memcpy(dst, bytes.data() + pos, n);
+        pos += (uint32_t)n;
+        reads.push_back(len);
+        return n;
+    }
+    bool seek(uint32_t offset) override {
+        if (offset > bytes.size()) return false;
+        pos = offset;
+        return true;
+    }
+};
+
+class SpiffsSource : public ClipSource {
+public:
+    File file;
+    size_t read(uint8_t* dst, size_t len) override { return file.read(dst, len); }
+    bool seek(uint32_t offset) override { return file.seek(offset); }
+};
+
+// 只提供句柄查询的传输层，通知直接丢弃
+class NullTransport : public MessageTransport {
+public:
+    explicit NullTransport(MessageDispatcher* dispatcher) { _dispatcher = dispatcher; }
+    const char* transportName() const override { return "null"; }
+    bool isConnected() override { return false; }
+    void notify(CharHandle, const uint8_t*, size_t) override {}
+    size_t notifyPayloadLimit() override { return 20; }
+};
+
+static MotionClipHeader makeHeader(uint8_t axisMask, uint16_t keyframes, uint32_t durationMs, uint8_t flags = 0) {
+    MotionClipHeader header = {};
+    header.magic = MOTION_CLIP_MAGIC;
+    header.version = MOTION_CLIP_VERSION;
+    header.axisMask = axisMask;
+    header.flags = flags;
+    header.keyframeCount = keyframes;
+    header.durationMs = durationMs;
+    header.startPose[0] = 9000;
+    return header;
+}
+
+// 轴 0 / 1 / 3 轮流，每 50ms 一条、每条 40ms
+static std::vector<MotionKeyframe> makeKeyframes(size_t count) {
+    static const uint8_t axes[] = {0, 1, 3};
+    std::vector<MotionKeyframe> keyframes(count);
+    for (size_t i = 0; i < count; ++i) {
+        keyframes[i].startDeltaMs = i == 0 ? 0 : 50;
+        keyframes[i].durationMs = 40;
+        keyframes[i].axis = axes[i % 3];
+        keyframes[i].easing = (uint8_t)(i % CLIP_EASE_COUNT);
+        keyframes[i].centiDegrees = (int16_t)(9000 + (i % 2 ? -1 : 1) * (int)(i * 25));
+    }
+    return keyframes;
+}
+
+static void build(MemorySource& source, const MotionClipHeader& header, const std::vector<MotionKeyframe>& keyframes) {
+    source.bytes.resize(sizeof(header) + keyframes.size() * sizeof(MotionKeyframe));
+    memcpy(source.bytes.data(), &header, sizeof(header));
+    if (!keyframes.empty()) {
+        memcpy(source.bytes.data() + sizeof(header), keyframes.data(), keyframes.size() * sizeof(MotionKeyframe));
+    }
+    source.reads.clear();
+    source.pos = 0;
+}
+
+static size_t readAll(MotionClipReader& reader, std::vector<MotionKeyframe>& out, std::vector<uint32_t>& starts) {
+    out.clear();
+    starts.clear();
+    MotionKeyframe keyframe;
+    uint32_t startMs;
+    while (reader.next(keyframe, startMs)) {
+        out.push_back(keyframe);
+        starts.push_back(startMs);
+    }
+    return out.size();
+}
+
+static void assertOpenFails(const char* expected, MemorySource& source) {
+    MotionClipReader reader;
+    TEST_ASSERT_FALSE(reader.open(&source));
+    TEST_ASSERT_FALSE(reader.isOpen());
+    TEST_ASSERT_NOT_NULL(reader.error());
+    TEST_ASSERT_EQUAL_STRING(expected, reader.error());
+}
+
+void setUp() {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_ERROR);
+}
+
+void tearDown() {}
+
+void test_header_validation() {
+    MotionClipReader reader;
+    TEST_ASSERT_FALSE(reader.open(nullptr));
+    TEST_ASSERT_EQUAL_STRING("NoSource", reader.error());
+
+    std::vector<MotionKeyframe> keyframes = makeKeyframes(3);
+    MotionClipHeader header = makeHeader(0x0B, 3, 1000);
+    MemorySource source;
+    build(source, header, keyframes);
+    TEST_ASSERT_TRUE(reader.open(&source));
+    TEST_ASSERT_NULL(reader.error());
+    TEST_ASSERT_EQUAL_UINT16(3, reader.header().keyframeCount);
+    TEST_ASSERT_EQUAL_INT16(9000, reader.header().startPose[0]);
+    TEST_ASSERT_FALSE(reader.loops());
+
+    source.bytes.resize(sizeof(MotionClipHeader) - 1);
+    assertOpenFails("ShortHeader", source);
+
+    MotionClipHeader bad = header;
+    bad.magic = 0x324C434D;                         // "MCL2"
+    build(source, bad, keyframes);
+    assertOpenFails("BadMagic", source);
+
+    bad = header;
+    bad.version = MOTION_CLIP_VERSION + 1;
+    build(source, bad, keyframes);
+    assertOpenFails("BadVersion", source);
+
+    bad = header;
+    bad.axisMask = 0;
+    build(source, bad, keyframes);
+    assertOpenFails("BadAxisMask", source);
+    bad.axisMask = 1u << MOTION_CLIP_MAX_AXES;      // 超出轴数
+    build(source, bad, keyframes);
+    assertOpenFails("BadAxisMask", source);
+
+    bad = makeHeader(0x0B, 3, 0, MOTION_CLIP_FLAG_LOOP);   // 循环片段时长为 0 会空转
+    build(source, bad, keyframes);
+    assertOpenFails("BadDuration", source);
+}
+
+void test_batches_beyond_16_keyframes() {
+    const size_t COUNT = 2 * MotionClipReader::CLIP_READ_BATCH + 8;
+    std::vector<MotionKeyframe> keyframes = makeKeyframes(COUNT);
+    MemorySource source;
+    build(source, makeHeader(0x0B, COUNT, 50 * (COUNT - 1) + 40), keyframes);
+
+    MotionClipReader reader;
+    TEST_ASSERT_TRUE(reader.open(&source));
+    std::vector<MotionKeyframe> out;
+    std::vector<uint32_t> starts;
+    TEST_ASSERT_EQUAL(COUNT, readAll(reader, out, starts));
+    TEST_ASSERT_NULL(reader.error());
+    TEST_ASSERT_TRUE(reader.isOpen());              // 正常读完不算出错
+    for (size_t i = 0; i < COUNT; ++i) {
+        TEST_ASSERT_EQUAL_MEMORY(&keyframes[i], &out[i], sizeof(MotionKeyframe));
+        TEST_ASSERT_EQUAL_UINT32(50 * i, starts[i]);
+    }
+
+    // 文件头一次 + 每批一次，每次最多 16 条
+    TEST_ASSERT_EQUAL(4, source.reads.size());
+    TEST_ASSERT_EQUAL(sizeof(MotionClipHeader), source.reads[0]);
+    TEST_ASSERT_EQUAL(16 * sizeof(MotionKeyframe), source.reads[1]);
+    TEST_ASSERT_EQUAL(16 * sizeof(MotionKeyframe), source.reads[2]);
+    TEST_ASSERT_EQUAL(8 * sizeof(MotionKeyframe), source.reads[3]);
+
+    // 第三批不完整：前两批照常读出，然后报 Truncated
+    source.bytes.resize(source.bytes.size() - 3);
+    TEST_ASSERT_TRUE(reader.open(&source));
+    TEST_ASSERT_EQUAL(2 * MotionClipReader::CLIP_READ_BATCH, readAll(reader, out, starts));
+    TEST_ASSERT_EQUAL_STRING("Truncated", reader.error());
+    TEST_ASSERT_FALSE(reader.isOpen());
+
+    // 恰好 16 条：读完一批后不再读取
+    keyframes = makeKeyframes(MotionClipReader::CLIP_READ_BATCH);
+    build(source, makeHeader(0x0B, MotionClipReader::CLIP_READ_BATCH, 2000), keyframes);
+    TEST_ASSERT_TRUE(reader.open(&source));
+    TEST_ASSERT_EQUAL(MotionClipReader::CLIP_READ_BATCH, readAll(reader, out, starts));
+    TEST_ASSERT_NULL(reader.error());
+    TEST_ASSERT_EQUAL(2, source.reads.size());
+}
+
+void test_keyframe_validation() {
+    const size_t COUNT = 20;
+    const uint32_t DURATION = 50 * (COUNT - 1) + 40;
+    MemorySource source;
+    MotionClipReader reader;
+    std::vector<MotionKeyframe> out;
+    std::vector<uint32_t> starts;
+
+    // 最后一条恰好在片段结束时到达：合法
+    std::vector<MotionKeyframe> keyframes = makeKeyframes(COUNT);
+    build(source, makeHeader(0x0B, COUNT, DURATION), keyframes);
+    TEST_ASSERT_TRUE(reader.open(&source));
+    TEST_ASSERT_EQUAL(COUNT, readAll(reader, out, starts));
+    TEST_ASSERT_NULL(reader.error());
+
+    // 第二批中的一条补间超出片段时长：之前的关键帧照常读出
+    keyframes[18].durationMs = 50 + 40 + 1;
+    build(source, makeHeader(0x0B, COUNT, DURATION), keyframes);
+    TEST_ASSERT_TRUE(reader.open(&source));
+    TEST_ASSERT_EQUAL(18, readAll(reader, out, starts));
+    TEST_ASSERT_EQUAL_STRING("BadTiming", reader.error());
+
+    // 起始时刻本身越过片段结尾
+    keyframes = makeKeyframes(COUNT);
+    keyframes[COUNT - 1].startDeltaMs = 60000;
+    keyframes[COUNT - 1].durationMs = 0;
+    build(source, makeHeader(0x0B, COUNT, DURATION), keyframes);
+    TEST_ASSERT_TRUE(reader.open(&source));
+    TEST_ASSERT_EQUAL(COUNT - 1, readAll(reader, out, starts));
+    TEST_ASSERT_EQUAL_STRING("BadTiming", reader.error());
+
+    // 轴不在 axisMask 中（轴 2）或超出轴数，缓动越界
+    keyframes = makeKeyframes(COUNT);
+    keyframes[5].axis = 2;
+    build(source, makeHeader(0x0B, COUNT, DURATION), keyframes);
+    TEST_ASSERT_TRUE(reader.open(&source));
+    TEST_ASSERT_EQUAL(5, readAll(reader, out, starts));
+    TEST_ASSERT_EQUAL_STRING("BadAxis", reader.error());
+    keyframes[5].axis = MOTION_CLIP_MAX_AXES;
+    build(source, makeHeader(0xFF >> (8 - MOTION_CLIP_MAX_AXES), COUNT, DURATION), keyframes);
+    TEST_ASSERT_TRUE(reader.open(&source));
+    TEST_ASSERT_EQUAL(5, readAll(reader, out, starts));
+    TEST_ASSERT_EQUAL_STRING("BadAxis", reader.error());
+
+    keyframes = makeKeyframes(COUNT);
+    keyframes[0].easing = CLIP_EASE_COUNT;
+    build(source, makeHeader(0x0B, COUNT, DURATION), keyframes);
+    TEST_ASSERT_TRUE(reader.open(&source));
+    TEST_ASSERT_EQUAL(0, readAll(reader, out, starts));
+    TEST_ASSERT_EQUAL_STRING("BadEasing", reader.error());
+    TEST_ASSERT_FALSE(reader.rewind());             // 出错后读取器已关闭
+}
+
+void test_rewind_for_looping_clip() {
+    const size_t COUNT = MotionClipReader::CLIP_READ_BATCH + 4;
+    std::vector<MotionKeyframe> keyframes = makeKeyframes(COUNT);
+    MemorySource source;
+    build(source, makeHeader(0x0B, COUNT, 50 * COUNT, MOTION_CLIP_FLAG_LOOP), keyframes);
+
+    MotionClipReader reader;
+    TEST_ASSERT_TRUE(reader.open(&source));
+    TEST_ASSERT_TRUE(reader.loops());
+    std::vector<MotionKeyframe> first, second;
+    std::vector<uint32_t> firstStarts, secondStarts;
+    TEST_ASSERT_EQUAL(COUNT, readAll(reader, first, firstStarts));
+
+    // 每一圈从第一条关键帧、时间轴零点重新开始
+    for (int loop = 0; loop < 3; ++loop) {
+        TEST_ASSERT_TRUE(reader.rewind());
+        TEST_ASSERT_EQUAL(COUNT, readAll(reader, second, secondStarts));
+        TEST_ASSERT_EQUAL_MEMORY(first.data(), second.data(), COUNT * sizeof(MotionKeyframe));
+        TEST_ASSERT_TRUE(firstStarts == secondStarts);
+    }
+
+    // 批中间 rewind：丢弃缓冲里剩下的关键帧
+    TEST_ASSERT_TRUE(reader.rewind());
+    MotionKeyframe keyframe;
+    uint32_t startMs = 0;
+    for (int i = 0; i < 5; ++i) TEST_ASSERT_TRUE(reader.next(keyframe, startMs));
+    TEST_ASSERT_EQUAL_UINT32(200, startMs);
+    TEST_ASSERT_TRUE(reader.rewind());
+    TEST_ASSERT_TRUE(reader.next(keyframe, startMs));
+    TEST_ASSERT_EQUAL_UINT32(0, startMs);
+    TEST_ASSERT_EQUAL_MEMORY(&keyframes[0], &keyframe, sizeof(keyframe));
+
+    reader.close();
+    TEST_ASSERT_FALSE(reader.rewind());
+}
+
+// 随固件上传的片段（scripts/build-clips.py 从 clips/*.json 生成）与读取器的格式一致
+void test_built_clips_in_spiffs() {
+    TEST_ASSERT_TRUE(SPIFFS.begin());
+    static const char* const paths[] = {"/clips/1.clip", "/clips/2.clip", "/clips/3.clip", "/clips/4.clip"};
+    for (const char* path : paths) {
+        SpiffsSource source;
+        source.file = SPIFFS.open(path, FILE_READ);
+        TEST_ASSERT_TRUE(static_cast<bool>(source.file));
+        MotionClipReader reader;
+        TEST_ASSERT_TRUE(reader.open(&source));
+        std::vector<MotionKeyframe> out;
+        std::vector<uint32_t> starts;
+        TEST_ASSERT_EQUAL(reader.header().keyframeCount, readAll(reader, out, starts));
+        TEST_ASSERT_NULL(reader.error());
+        TEST_ASSERT_EQUAL(sizeof(MotionClipHeader) + out.size() * sizeof(MotionKeyframe), source.file.size());
+        TEST_ASSERT_EQUAL_UINT32(reader.header().durationMs, starts.back() + out.back().durationMs);
+    }
+}
+
+// 空写入从负载池拿到的是复用块，块里残留上一条消息的字节；残留的 02 不能被当成 STOP
+void test_player_ignores_empty_write() {
+    static MessageDispatcher dispatcher;            // 播放任务常驻，相关对象不随用例析构
+    static PWMServoController servo(18, 6);
+    static MotionController motion;
+    static ClipPlayer player(motion);
+    static NullTransport transport(&dispatcher);
+    CharHandle handle = dispatcher.characteristics().intern(CLIP_CONTROL_UUID, "ClipControl");
+    dispatcher.subscribe("ClipControl", &player);
+    servo.begin();
+    motion.addAxis(&servo, 360, 2400);
+    motion.begin();
+    player.setTransport(&transport);
+    player.begin();
+
+    auto deliver = [&]() {
+        BLEWriteMessage msg;
+        while (dispatcher.tryPop(msg)) {
+            dispatcher.dispatch(msg);
+            dispatcher.markHandled(msg);
+        }
+    };
+    const uint8_t play[] = {0x01, 2, 0, 0, 0, 0};   // 片段 2（4.2 s），不过渡
+    TEST_ASSERT_TRUE(dispatcher.enqueue(handle, play, sizeof(play)));
+    deliver();
+    for (int spin = 0; spin < 500 && !player.isPlaying(); ++spin) delay(1);
+    TEST_ASSERT_TRUE(player.isPlaying());
+
+    // 一条 02 占用负载块后未分发就归还，下一次空写入拿到同一块
+    const uint8_t stop[] = {0x02};
+    TEST_ASSERT_TRUE(dispatcher.enqueue(handle, stop, sizeof(stop)));
+    BLEWriteMessage discarded;
+    TEST_ASSERT_TRUE(dispatcher.tryPop(discarded));
+    const uint8_t* stale = discarded.data.data();
+    discarded = BLEWriteMessage();
+    TEST_ASSERT_TRUE(dispatcher.enqueue(handle, stop, 0));
+    BLEWriteMessage empty;
+    TEST_ASSERT_TRUE(dispatcher.tryPop(empty));
+    TEST_ASSERT_EQUAL(0, empty.data.size());
+    TEST_ASSERT_TRUE(empty.data.data() == stale);
+    TEST_ASSERT_EQUAL_HEX8(0x02, empty.data.data()[0]);
+    dispatcher.dispatch(empty);
+    dispatcher.markHandled(empty);
+    delay(50);
+    TEST_ASSERT_TRUE(player.isPlaying());
+    TEST_ASSERT_EQUAL_UINT16(2, player.currentClip());
+
+    TEST_ASSERT_TRUE(dispatcher.enqueue(handle, stop, sizeof(stop)));
+    deliver();
+    for (int spin = 0; spin < 500 && player.isPlaying(); ++spin) delay(1);
+    TEST_ASSERT_FALSE(player.isPlaying());
+}
+
+// 播放任务每条关键帧调用一次 next()；每 16 条触发一次批量读取
+void bench_next_keyframe() {
+    const size_t COUNT = 1024;
+    MemorySource source;
+    build(source, makeHeader(0x0B, COUNT, 50 * (COUNT - 1) + 40, MOTION_CLIP_FLAG_LOOP), makeKeyframes(COUNT));
+    MotionClipReader reader;
+    TEST_ASSERT_TRUE(reader.open(&source));
+    MotionKeyframe keyframe;
+    uint32_t startMs = 0;
+    double ns = NativeBench::nsPerOp(2000000, [&]() {
+        if (!reader.next(keyframe, startMs)) {
+            reader.rewind();
+            source.reads.clear();
+        }
+        benchKeep(startMs);
+    });
+    NativeBench::report("clip_next_keyframe", ns, "ns/op");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_header_validation);
+    RUN_TEST(test_batches_beyond_16_keyframes);
+    RUN_TEST(test_keyframe_validation);
+    RUN_TEST(test_rewind_for_looping_clip);
+    RUN_TEST(test_built_clips_in_spiffs);
+    RUN_TEST(test_player_ignores_empty_write);
+    RUN_TEST(bench_next_keyframe);
+    return UNITY_END();
+}
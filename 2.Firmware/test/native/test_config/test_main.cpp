@@ -0,0 +1,132 @@
+// GattConfigReader：流式加载 ble_config.json 的正确性、峰值内存与加载耗时基准
+#include <unity.h>
+#include <stdio.h>
+#include <string>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include "drivers/BLE/GattConfigReader.h"
+#include "drivers/BLE/GattTable.generated.h"
+
+class StringSource : public GattConfigSource {
+public:
+    explicit StringSource(const std::string& text) : _text(text) {}
+    int read() override { return _pos < _text.size() ? (uint8_t)_text[_pos++] : -1; }
+private:
+    const std::string& _text;
+    size_t _pos = 0;
+};
+
+static std::string readProjectFile(const char* relative) {
+    std::string path = std::string(NATIVE_PROJECT_DIR) + "/" + relative;
+    std::string text;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return text;
+    char buffer[1024];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) text.append(buffer, n);
+    fclose(file);
+    return text;
+}
+
+// 合成配置：serviceCount 个结构相同的服务（每个 3 个特征），用于验证峰值内存不随服务数增长
+static std::string syntheticConfig(size_t serviceCount) {
+    std::string json = "{\"ble_device_name\":\"bench\",\"services\":[";
+    char buffer[640];
+    for (size_t s = 0; s < serviceCount; s++) {
+        snprintf(buffer, sizeof(buffer),
+                 "%s{\"name\":\"Service%u\",\"uuid\":\"ff%02x0000-1000-8000-0080-5f9b34fb0000\","
+                 "\"description\":\"synthetic\",\"characteristics\":["
+                 "{\"name\":\"Write%u\",\"uuid\":\"ef%02x0001-1000-8000-0080-5f9b34fb0000\",\"type\":[\"WRITE_NO_RESPONSE\"],"
+                 "\"value\":[170,85,3,129],\"value_format\":\"bytes\",\"description\":\"write\"},"
+                 "{\"name\":\"Read%u\",\"uuid\":\"ef%02x0002-1000-8000-0080-5f9b34fb0000\",\"type\":[\"READ\",\"NOTIFY\"],"
+                 "\"value\":[170,85,3,129],\"value_format\":\"bytes\",\"notify\":{\"mode\":\"state\",\"min_interval_ms\":20}},"
+                 "{\"name\":\"Status%u\",\"uuid\":\"ef%02x0003-1000-8000-0080-5f9b34fb0000\",\"type\":[\"READ\"],"
+                 "\"value\":\"ok\",\"value_format\":\"string\",\"description\":\"status\"}]}",
+                 s ? "," : "", (unsigned)s, (unsigned)(s & 0xFF), (unsigned)s, (unsigned)(s & 0xFF), (unsigned)s,
+                 (unsigned)(s & 0xFF), (unsigned)s, (unsigned)(s & 0xFF));
+        json += buffer;
+    }
+    json += "]}";
+    return json;
+}
+
+struct LoadResult {
+    bool ok;
+    size_t services;
+    size_t characteristics;
+    size_t peakBytes;
+    std::string deviceName;
+};
+
+static LoadResult load(const std::string& text) {
+    LoadResult result = {false, 0, 0, 0, ""};
+    GattConfigReader reader;
+    StringSource source(text);
+    result.ok = reader.read(
+        source, [&](const char* name) { result.deviceName = name; },
+        [&](JsonObjectConst service) {
+            result.characteristics += service["characteristics"].as<JsonArrayConst>().size();
+            return true;
+        });
+    result.services = reader.serviceCount();
+    result.peakBytes = reader.peakDocumentBytes();
+    return result;
+}
+
+void setUp() {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_WARN);
+}
+
+void tearDown() {}
+
+// 运行期配置与构建时生成的 GATT 表必须描述同一组服务/特征
+void test_project_config_matches_generated_table() {
+    std::string text = readProjectFile("data/ble_config.json");
+    TEST_ASSERT_FALSE(text.empty());
+    LoadResult result = load(text);
+    TEST_ASSERT_TRUE(result.ok);
+    TEST_ASSERT_EQUAL_STRING(GATT_TABLE.deviceName, result.deviceName.c_str());
+    TEST_ASSERT_EQUAL(GATT_TABLE.serviceCount, result.services);
+    TEST_ASSERT_EQUAL(GATT_TABLE.characteristicCount, result.characteristics);
+    TEST_ASSERT_LESS_OR_EQUAL(GattConfigReader::capacity(), result.peakBytes);
+}
+
+void test_peak_memory_independent_of_service_count() {
+    LoadResult small = load(syntheticConfig(4));
+    LoadResult large = load(syntheticConfig(40));
+    TEST_ASSERT_TRUE(small.ok);
+    TEST_ASSERT_TRUE(large.ok);
+    TEST_ASSERT_EQUAL(40, large.services);
+    TEST_ASSERT_EQUAL(120, large.characteristics);
+    TEST_ASSERT_EQUAL(small.peakBytes, large.peakBytes);
+}
+
+void test_truncated_config_reports_error() {
+    std::string text = syntheticConfig(2);
+    text.resize(text.size() / 2);
+    GattConfigReader reader;
+    StringSource source(text);
+    TEST_ASSERT_FALSE(reader.read(source, [](const char*) {}, [](JsonObjectConst) { return true; }));
+    TEST_ASSERT_NOT_NULL(reader.error());
+}
+
+void bench_config_load() {
+    std::string project = readProjectFile("data/ble_config.json");
+    std::string large = syntheticConfig(40);
+    double projectNs = NativeBench::nsPerOp(2000, [&]() { benchKeep(load(project).services); });
+    double largeNs = NativeBench::nsPerOp(200, [&]() { benchKeep(load(large).services); });
+    NativeBench::report("config_load_project", projectNs / 1000.0, "us");
+    NativeBench::report("config_load_40_services", largeNs / 1000.0, "us");
+    NativeBench::report("config_load_rate", large.size() / (largeNs / 1e9) / (1024.0 * 1024.0), "MiB/s");
+    NativeBench::report("config_peak_document", (double)load(large).peakBytes, "bytes");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_project_config_matches_generated_table);
+    RUN_TEST(test_peak_memory_independent_of_service_count);
+    RUN_TEST(test_truncated_config_reports_error);
+    RUN_TEST(bench_config_load);
+    return UNITY_END();
+}
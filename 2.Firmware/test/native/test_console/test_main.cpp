@@ -0,0 +1,132 @@
+// SerialConsole：逐字节行解析（分段到达、\r\n、退格、超长行）、命令表与 fallback 路由，以及解析开销基准
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include "utils/SerialConsole.h"
+
+struct Recorder {
+    std::vector<std::string> calls;
+};
+
+static void record(const char* args, void* ctx) {
+    static_cast<Recorder*>(ctx)->calls.push_back(args);
+}
+
+static std::vector<std::string> s_fallbackLines;
+
+static bool fallback(const char* line) {
+    s_fallbackLines.push_back(line);
+    return strncmp(line, "cal", 3) == 0;            // 与舵机测试入口相同：只认识标定命令
+}
+
+static size_t feedAll(const char* text) {
+    size_t lines = 0;
+    for (const char* p = text; *p; ++p) {
+        if (SerialConsole::feed(*p)) lines++;
+    }
+    return lines;
+}
+
+void setUp() {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_ERROR);
+    SerialConsole::clear();
+    s_fallbackLines.clear();
+}
+
+void tearDown() {}
+
+void test_lines_arrive_in_pieces() {
+    Recorder jog;
+    TEST_ASSERT_TRUE(SerialConsole::add("jog", "", record, &jog));
+    TEST_ASSERT_EQUAL(0, feedAll("jo"));            // 串口按任意边界分段到达，行没读完不执行
+    TEST_ASSERT_EQUAL(0, feedAll("g  0 "));
+    TEST_ASSERT_EQUAL(0, jog.calls.size());
+    TEST_ASSERT_EQUAL(1, feedAll(" -15  \r\n"));    // \r\n 只算一行
+    TEST_ASSERT_EQUAL(1, jog.calls.size());
+    TEST_ASSERT_EQUAL_STRING("0  -15", jog.calls[0].c_str());
+
+    TEST_ASSERT_EQUAL(2, feedAll("jog\njog 5\r"));
+    TEST_ASSERT_EQUAL(3, jog.calls.size());
+    TEST_ASSERT_EQUAL_STRING("", jog.calls[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("5", jog.calls[2].c_str());
+
+    feedAll("jogx 1\n");                            // 命令名整词匹配
+    TEST_ASSERT_EQUAL(3, jog.calls.size());
+}
+
+void test_backspace_and_overflow() {
+    Recorder stats;
+    SerialConsole::add("stats", "", record, &stats);
+    feedAll("statx\bs\n");
+    TEST_ASSERT_EQUAL(1, stats.calls.size());
+
+    std::string longLine(CONSOLE_LINE_MAX + 10, 'a');
+    TEST_ASSERT_EQUAL(0, feedAll((longLine + "\n").c_str()));
+    TEST_ASSERT_EQUAL_UINT32(1, SerialConsole::overflowCount());
+    TEST_ASSERT_EQUAL(0, s_fallbackLines.size());   // 超长行整行丢弃，不会截断后执行
+
+    feedAll("stats\n");                             // 下一行正常解析
+    TEST_ASSERT_EQUAL(2, stats.calls.size());
+
+    std::string exact(CONSOLE_LINE_MAX - 1 - strlen("stats "), 'b');
+    feedAll(("stats " + exact + "\n").c_str());     // 恰好放满缓冲的行仍然有效
+    TEST_ASSERT_EQUAL(3, stats.calls.size());
+    TEST_ASSERT_EQUAL_STRING(exact.c_str(), stats.calls[2].c_str());
+}
+
+void test_registry_and_fallback() {
+    Recorder boot;
+    TEST_ASSERT_TRUE(SerialConsole::add("boot", "", record, &boot));
+    TEST_ASSERT_FALSE(SerialConsole::add("boot", "", record, &boot));   // 重名
+    static const char* const names[] = {"c0", "c1", "c2", "c3", "c4", "c5", "c6", "c7",
+                                        "c8", "c9", "c10", "c11", "c12", "c13", "c14", "c15"};
+    size_t added = 1;
+    for (const char* name : names) {
+        if (SerialConsole::add(name, "", record, &boot)) added++;
+    }
+    TEST_ASSERT_EQUAL(CONSOLE_MAX_COMMANDS, added);
+
+    SerialConsole::setFallback(fallback);
+    char line1[] = "  cal 0 90 180 ";
+    TEST_ASSERT_TRUE(SerialConsole::execute(line1));    // 未登记的命令整行（去掉首尾空白）交给入口模块
+    TEST_ASSERT_EQUAL_STRING("cal 0 90 180", s_fallbackLines.back().c_str());
+    char line2[] = "+5";
+    TEST_ASSERT_FALSE(SerialConsole::execute(line2));
+    TEST_ASSERT_EQUAL(2, s_fallbackLines.size());
+    char line3[] = "help";
+    TEST_ASSERT_TRUE(SerialConsole::execute(line3));
+    char line4[] = "   ";
+    TEST_ASSERT_FALSE(SerialConsole::execute(line4));
+    TEST_ASSERT_EQUAL(2, s_fallbackLines.size());
+    TEST_ASSERT_EQUAL(0, boot.calls.size());
+}
+
+// 命令台任务每个字节调用一次 feed：行内字节只做一次拷贝，行尾时查表执行
+void bench_feed() {
+    Recorder jog;
+    SerialConsole::add("stats", "", record, &jog);
+    SerialConsole::add("boot", "", record, &jog);
+    SerialConsole::add("jog", "", [](const char*, void*) {}, nullptr);
+    const char* line = "jog 0 12.5\r\n";
+    size_t length = strlen(line);
+    size_t i = 0;
+    double ns = NativeBench::nsPerOp(5000000, [&]() {
+        SerialConsole::feed(line[i]);
+        if (++i == length) i = 0;
+    });
+    NativeBench::report("console_feed_byte", ns, "ns/op");
+    NativeBench::report("console_line_jog", ns * length, "ns/op");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_lines_arrive_in_pieces);
+    RUN_TEST(test_backspace_and_overflow);
+    RUN_TEST(test_registry_and_fallback);
+    RUN_TEST(bench_feed);
+    return UNITY_END();
+}
@@ -0,0 +1,335 @@
+// MessageDispatcher：路由/丢弃语义，入队延迟与吞吐（对照改造前的互斥量 + deque 实现），以及入队→分发的端到端延迟基准
+#include <unity.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include "drivers/BLE/MessageDispatcher.h"
+#include "drivers/BLE/MessageConsumer.h"
+#include "drivers/BLE/BLEServerWrapper.h"
+
+static const char* MOTOR_WRITE_UUID = "ef010001-1000-8000-0080-5f9b34fb0000";
+static const char* MOTOR_CLOCK_UUID = "ef010003-1000-8000-0080-5f9b34fb0000";
+
+class CountingConsumer : public MessageConsumer {
+public:
+    void begin() override {}
+    void handleMessage(const BLEWriteMessage& msg) override {
+        last.assign(msg.data.begin(), msg.data.end());
+        bytes += msg.data.size();
+        count.fetch_add(1, std::memory_order_release);
+    }
+    std::vector<uint8_t> last;
+    size_t bytes = 0;
+    std::atomic<uint32_t> count{0};
+};
+
+// 对照组：改造前的 MessageDispatcher（互斥量 + std::deque，每条消息自带堆上的 UUID 字符串与数据 vector）
+// 只在基准中使用；enqueue 返回是否入队，便于生产者在队列满时重试而不是计入丢弃
+class DequeDispatcher {
+public:
+    struct Message {
+        std::string uuid;
+        std::vector<uint8_t> data;
+    };
+
+    bool enqueue(const Message& msg) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= MAX_SIZE) return false;
+        queue.push_back(msg);
+        return true;
+    }
+    bool hasMessage() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !queue.empty();
+    }
+    Message pop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.empty()) return {};
+        auto msg = queue.front();
+        queue.pop_front();
+        return msg;
+    }
+
+private:
+    std::deque<Message> queue;
+    std::mutex mutex;
+    const size_t MAX_SIZE = 256;
+};
+
+void setUp() {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_WARN);
+}
+
+void tearDown() {}
+
+void test_routes_only_subscribed_characteristics() {
+    MessageDispatcher dispatcher;
+    dispatcher.characteristics().intern(MOTOR_WRITE_UUID, "MotorWrite");
+    CharHandle unrouted = dispatcher.characteristics().intern(MOTOR_CLOCK_UUID, "MotorClock");
+    CountingConsumer consumer;
+    CharHandle routed = dispatcher.subscribe("MotorWrite", &consumer);
+    TEST_ASSERT_NOT_EQUAL(INVALID_CHAR_HANDLE, routed);
+
+    const uint8_t payload[] = {1, 2, 3};
+    TEST_ASSERT_TRUE(dispatcher.enqueue(routed, payload, sizeof(payload)));
+    TEST_ASSERT_FALSE(dispatcher.enqueue(unrouted, payload, sizeof(payload)));
+    TEST_ASSERT_EQUAL_UINT32(1, dispatcher.rejectedCount());
+
+    BLEWriteMessage msg;
+    TEST_ASSERT_TRUE(dispatcher.tryPop(msg));
+    TEST_ASSERT_TRUE(dispatcher.dispatch(msg));
+    TEST_ASSERT_EQUAL_UINT32(1, consumer.count.load());
+    TEST_ASSERT_EQUAL(sizeof(payload), consumer.last.size());
+    TEST_ASSERT_EQUAL_MEMORY(payload, consumer.last.data(), sizeof(payload));
+    TEST_ASSERT_FALSE(dispatcher.tryPop(msg));
+}
+
+void test_drops_when_queue_full_or_payload_too_long() {
+    MessageDispatcher dispatcher;
+    dispatcher.characteristics().intern(MOTOR_WRITE_UUID, "MotorWrite");
+    CountingConsumer consumer;
+    CharHandle handle = dispatcher.subscribe("MotorWrite", &consumer);
+
+    static uint8_t big[BLE_MAX_PAYLOAD_SIZE + 1] = {};
+    TEST_ASSERT_FALSE(dispatcher.enqueue(handle, big, sizeof(big)));
+
+    size_t accepted = 0;
+    while (dispatcher.enqueue(handle, big, 20)) accepted++;
+    TEST_ASSERT_EQUAL(MessageDispatcher::SLOT_COUNT, accepted);
+    TEST_ASSERT_EQUAL_UINT32(2, dispatcher.droppedCount());
+
+    // 排空后负载块全部归还，可以再次填满
+    BLEWriteMessage msg;
+    while (dispatcher.tryPop(msg)) {}
+    msg = BLEWriteMessage();
+    TEST_ASSERT_TRUE(dispatcher.enqueue(handle, big, 20));
+}
+
+// 队列深度与负载池分开：短写入用小块，可以填满全部 256 个槽位；长写入受大块预算限制，小块被占满时借用大块
+void test_small_payloads_fill_queue_and_large_ones_use_budget() {
+    TEST_ASSERT_EQUAL(256, MessageDispatcher::SLOT_COUNT);
+    MessageDispatcher dispatcher;
+    dispatcher.characteristics().intern(MOTOR_WRITE_UUID, "MotorWrite");
+    CountingConsumer consumer;
+    CharHandle handle = dispatcher.subscribe("MotorWrite", &consumer);
+    static uint8_t payload[BLE_MAX_PAYLOAD_SIZE] = {};
+
+    size_t accepted = 0;
+    while (dispatcher.enqueue(handle, payload, 100)) accepted++;
+    TEST_ASSERT_EQUAL(MessageDispatcher::POOL_BLOCKS, accepted);   // 大块耗尽
+    while (dispatcher.enqueue(handle, payload, DISPATCHER_SMALL_PAYLOAD)) accepted++;
+    TEST_ASSERT_EQUAL(MessageDispatcher::SLOT_COUNT, accepted);    // 短写入仍能用满队列
+
+    // 消费者持有全部小块的引用：短写入借用大块，大块也用完后才丢弃
+    std::vector<BLEWriteMessage> held;
+    BLEWriteMessage msg;
+    while (dispatcher.tryPop(msg)) {
+        if (msg.data.size() == DISPATCHER_SMALL_PAYLOAD) held.push_back(msg);
+    }
+    msg = BLEWriteMessage();
+    TEST_ASSERT_EQUAL(MessageDispatcher::SMALL_BLOCKS - MessageDispatcher::POOL_BLOCKS, held.size());
+    size_t borrowed = 0;
+    while (dispatcher.enqueue(handle, payload, 8)) borrowed++;
+    TEST_ASSERT_EQUAL(MessageDispatcher::SMALL_BLOCKS - held.size() + MessageDispatcher::POOL_BLOCKS, borrowed);
+}
+
+// 分位数报桶上界，但不能超过实际观测到的最大值（[4096, 8192) 桶中只有 7145us 时报 7145 而不是 8191）
+void test_latency_percentile_clamped_to_max() {
+    LatencyHistogram h;
+    TEST_ASSERT_EQUAL_UINT32(0, h.percentile(99));
+    for (int i = 0; i < 99; ++i) h.record(100);
+    h.record(7145);
+    TEST_ASSERT_EQUAL_UINT32(127, h.percentile(50));
+    TEST_ASSERT_EQUAL_UINT32(127, h.percentile(99));
+    TEST_ASSERT_EQUAL_UINT32(7145, h.percentile(100));
+    h.reset();
+    h.record(100);
+    TEST_ASSERT_EQUAL_UINT32(100, h.percentile(50));
+}
+
+// 单线程入队 + 出队 + 分发一条消息的开销（负载拷贝进池、SPSC 环、路由表索引）
+void bench_enqueue_dispatch() {
+    MessageDispatcher dispatcher;
+    dispatcher.characteristics().intern(MOTOR_WRITE_UUID, "MotorWrite");
+    CountingConsumer consumer;
+    CharHandle handle = dispatcher.subscribe("MotorWrite", &consumer);
+    uint8_t payload[20] = {0x10, 0x01};
+
+    BLEWriteMessage msg;
+    double ns = NativeBench::nsPerOp(200000, [&]() {
+        dispatcher.enqueue(handle, payload, sizeof(payload));
+        dispatcher.tryPop(msg);
+        dispatcher.dispatch(msg);
+    });
+    TEST_ASSERT_EQUAL_UINT32(0, dispatcher.droppedCount());
+    NativeBench::report("dispatcher_enqueue_dispatch_20b", ns, "ns/msg");
+    NativeBench::report("dispatcher_throughput_20b", 1e9 / ns, "msg/s");
+}
+
+// 只计入队：每次调用单独计时（含 BLE 回调中构造消息的开销），队列将满时在计时之外排空
+// 对照组按改造前 onWrite 的做法每条消息构造 UUID 字符串与数据 vector
+void bench_enqueue_latency_vs_deque() {
+    const size_t samples = 200000;
+    uint8_t payload[20] = {0x10, 0x01};
+    std::vector<double> ring;
+    std::vector<double> deque;
+    ring.reserve(samples);
+    deque.reserve(samples);
+
+    MessageDispatcher dispatcher;
+    dispatcher.characteristics().intern(MOTOR_WRITE_UUID, "MotorWrite");
+    CountingConsumer consumer;
+    CharHandle handle = dispatcher.subscribe("MotorWrite", &consumer);
+    BLEWriteMessage msg;
+    while (ring.size() < samples) {
+        for (size_t i = 0; i < MessageDispatcher::SLOT_COUNT - 1 && ring.size() < samples; ++i) {
+            uint64_t start = NativeBench::nowNs();
+            bool ok = dispatcher.enqueue(handle, payload, sizeof(payload));
+            ring.push_back((double)(NativeBench::nowNs() - start));
+            TEST_ASSERT_TRUE(ok);
+        }
+        while (dispatcher.tryPop(msg)) {}
+    }
+
+    DequeDispatcher legacy;
+    while (deque.size() < samples) {
+        for (size_t i = 0; i < 255 && deque.size() < samples; ++i) {
+            uint64_t start = NativeBench::nowNs();
+            DequeDispatcher::Message m;
+            m.uuid = MOTOR_WRITE_UUID;
+            m.data.assign(payload, payload + sizeof(payload));
+            bool ok = legacy.enqueue(m);
+            deque.push_back((double)(NativeBench::nowNs() - start));
+            TEST_ASSERT_TRUE(ok);
+        }
+        while (legacy.hasMessage()) legacy.pop();
+    }
+
+    NativeBench::report("dispatcher_enqueue_p50_ring", NativeBench::percentile(ring, 50), "ns");
+    NativeBench::report("dispatcher_enqueue_p99_ring", NativeBench::percentile(ring, 99), "ns");
+    NativeBench::report("dispatcher_enqueue_p50_deque", NativeBench::percentile(deque, 50), "ns");
+    NativeBench::report("dispatcher_enqueue_p99_deque", NativeBench::percentile(deque, 99), "ns");
+}
+
+// 两个线程：生产者按 BLE 回调的方式入队（满时让出 CPU 重试），消费者按 bleWriteTask 改造前后的方式取出
+// 对照组的消费者与改造前一样先 hasMessage() 再 pop()（拷贝出队），新实现用 tryPop()（移动出队）
+void bench_spsc_throughput_vs_deque() {
+    const uint32_t messages = 200000;
+    uint8_t payload[20] = {0x10, 0x01};
+
+    MessageDispatcher dispatcher;
+    dispatcher.characteristics().intern(MOTOR_WRITE_UUID, "MotorWrite");
+    CountingConsumer consumer;
+    CharHandle handle = dispatcher.subscribe("MotorWrite", &consumer);
+    uint64_t start = NativeBench::nowNs();
+    std::thread ringConsumer([&]() {
+        BLEWriteMessage msg;
+        uint32_t received = 0;
+        while (received < messages) {
+            if (dispatcher.tryPop(msg)) {
+                dispatcher.dispatch(msg);
+                received++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (uint32_t i = 0; i < messages; ++i) {
+        payload[2] = (uint8_t)i;
+        while (!dispatcher.enqueue(handle, payload, sizeof(payload))) std::this_thread::yield();
+    }
+    ringConsumer.join();
+    double ringSeconds = (double)(NativeBench::nowNs() - start) / 1e9;
+    TEST_ASSERT_EQUAL_UINT32(messages, consumer.count.load());
+
+    DequeDispatcher legacy;
+    std::atomic<uint32_t> legacyCount{0};
+    start = NativeBench::nowNs();
+    std::thread dequeConsumer([&]() {
+        while (legacyCount.load(std::memory_order_relaxed) < messages) {
+            if (legacy.hasMessage()) {
+                DequeDispatcher::Message m = legacy.pop();
+                benchKeep(m);
+                legacyCount.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (uint32_t i = 0; i < messages; ++i) {
+        payload[2] = (uint8_t)i;
+        DequeDispatcher::Message m;
+        m.uuid = MOTOR_WRITE_UUID;
+        m.data.assign(payload, payload + sizeof(payload));
+        while (!legacy.enqueue(m)) std::this_thread::yield();
+    }
+    dequeConsumer.join();
+    double dequeSeconds = (double)(NativeBench::nowNs() - start) / 1e9;
+
+    NativeBench::report("dispatcher_spsc_throughput_ring", messages / ringSeconds, "msg/s");
+    NativeBench::report("dispatcher_spsc_throughput_deque", messages / dequeSeconds, "msg/s");
+}
+
+static MessageDispatcher* s_dispatcher = nullptr;
+
+// 与 app_main 的 bleWriteTask 相同的消费循环
+static void consumerTask(void*) {
+    BLEWriteMessage msg;
+    s_dispatcher->setConsumerTask(xTaskGetCurrentTaskHandle());
+    while (true) {
+        while (s_dispatcher->tryPop(msg)) {
+            s_dispatcher->dispatch(msg);
+            s_dispatcher->markHandled(msg);
+        }
+        s_dispatcher->waitForMessage();
+    }
+}
+
+// 端到端：中心设备写特征 → onWrite 回调入队 → 任务通知唤醒消费者任务 → 分发
+// 生产者在队列将满时让出 CPU（模拟链路层流控），统计吞吐与入队→处理延迟分位
+void bench_gatt_write_to_consumer() {
+    static MessageDispatcher dispatcher;            // 消费者任务常驻，对象不能随用例析构
+    static BLEServerWrapper server;
+    static CountingConsumer consumer;
+    s_dispatcher = &dispatcher;
+    server.begin(&dispatcher);
+    dispatcher.subscribe("MotorWrite", &consumer);
+    xTaskCreatePinnedToCore(consumerTask, "BLEWriteTask", 8192, nullptr, 1, nullptr, 1);
+    NativeBLE::connect(247);
+
+    const uint32_t messages = 50000;
+    uint8_t payload[20] = {0x10, 0x01};
+    uint64_t start = NativeBench::nowNs();
+    for (uint32_t i = 0; i < messages; i++) {
+        while (dispatcher.size() >= MessageDispatcher::SLOT_COUNT - 1) taskYIELD();
+        payload[2] = (uint8_t)i;
+        TEST_ASSERT_TRUE(NativeBLE::write(MOTOR_WRITE_UUID, payload, sizeof(payload)));
+    }
+    while (consumer.count.load(std::memory_order_acquire) < messages && dispatcher.droppedCount() == 0) taskYIELD();
+    double seconds = (double)(NativeBench::nowNs() - start) / 1e9;
+
+    TEST_ASSERT_EQUAL_UINT32(0, dispatcher.droppedCount());
+    TEST_ASSERT_EQUAL_UINT32(messages, consumer.count.load());
+    NativeBench::report("gatt_to_consumer_throughput", messages / seconds, "msg/s");
+    NativeBench::report("gatt_to_consumer_latency_p50", dispatcher.latency().percentile(50), "us");
+    NativeBench::report("gatt_to_consumer_latency_p99", dispatcher.latency().percentile(99), "us");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_routes_only_subscribed_characteristics);
+    RUN_TEST(test_drops_when_queue_full_or_payload_too_long);
+    RUN_TEST(test_small_payloads_fill_queue_and_large_ones_use_budget);
+    RUN_TEST(test_latency_percentile_clamped_to_max);
+    RUN_TEST(bench_enqueue_dispatch);
+    RUN_TEST(bench_enqueue_latency_vs_deque);
+    RUN_TEST(bench_spsc_throughput_vs_deque);
+    RUN_TEST(bench_gatt_write_to_consumer);
+    return UNITY_END();
+}
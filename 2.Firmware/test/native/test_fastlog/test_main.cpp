@@ -0,0 +1,199 @@
+// FastLog：延迟格式化、编译期裁剪、队列满丢弃与计数；每条调用开销、持续吞吐，以及 OTA 逐包日志开/关的写入速率对比
+// 本套件按 FAST_LOG_LEVEL=3（INFO）编译：FLOG_INFO 保留，FLOG_DEBUG 在编译期删除
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include <esp_rom_crc.h>
+#include "utils/FastLog.h"
+
+static size_t countOf(const std::string& text, const char* needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) count++;
+    return count;
+}
+
+void setUp() {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_ERROR);
+}
+
+void tearDown() {
+    FastLog::flush();                               // 不把积压记录留给下一个用例
+    NativeSerial::setMode(NativeSerial::MODE_STDOUT);
+}
+
+// 必须第一个运行：begin() 之前没有消费者，队列满后的丢弃数是确定的
+void test_full_ring_drops_and_reports() {
+    uint32_t records = FastLog::recordCount();
+    for (uint32_t i = 0; i < FAST_LOG_SLOTS + 5; ++i) FLOG_INFO("📦 填充 %u", (unsigned)i);
+    TEST_ASSERT_EQUAL_UINT32(FAST_LOG_SLOTS, FastLog::recordCount() - records);
+    TEST_ASSERT_EQUAL_UINT32(5, FastLog::droppedCount());
+
+    NativeSerial::setMode(NativeSerial::MODE_CAPTURE);
+    FastLog::flush();                               // begin() 之前 flush 不输出，记录留在队列中
+    TEST_ASSERT_EQUAL(0, NativeSerial::take().size());
+    TEST_ASSERT_TRUE(FastLog::begin());
+    FastLog::flush();
+    std::string out = NativeSerial::take();
+    TEST_ASSERT_EQUAL(FAST_LOG_SLOTS, countOf(out, "📦 填充"));
+    TEST_ASSERT_TRUE(out.find("📦 填充 0\n") != std::string::npos);          // 保留的是先到的记录
+    TEST_ASSERT_TRUE(out.find("📦 填充 127\n") != std::string::npos);
+    TEST_ASSERT_TRUE(out.find("📦 填充 128\n") == std::string::npos);
+    TEST_ASSERT_TRUE(out.find("丢弃 5 条（累计 5 条）") != std::string::npos);
+
+    FastLog::flush();                               // 丢弃数只报告一次
+    TEST_ASSERT_EQUAL(0, countOf(NativeSerial::take(), "丢弃"));
+}
+
+void test_deferred_format() {
+    NativeSerial::setMode(NativeSerial::MODE_CAPTURE);
+    uint32_t records = FastLog::recordCount();
+    int evaluated = 0;
+    FLOG_INFO("seq=%u off=%d id=%s kb=%.2f hex=%08lx", 7u, -3, "ota", 12.5, (unsigned long)0xBEEF);
+    FLOG_WARN("⚠️ 100%% %c", 'x');
+    FLOG_DEBUG("不会入队 %d", ++evaluated);         // 低于编译期级别：参数都不求值
+    TEST_ASSERT_EQUAL(0, evaluated);
+    TEST_ASSERT_EQUAL_UINT32(2, FastLog::recordCount() - records);
+
+    FastLog::flush();
+    std::string out = NativeSerial::take();
+    TEST_ASSERT_TRUE(out.find("[I]") != std::string::npos);
+    TEST_ASSERT_TRUE(out.find("seq=7 off=-3 id=ota kb=12.50 hex=0000beef\n") != std::string::npos);
+    TEST_ASSERT_TRUE(out.find("[W]") != std::string::npos);
+    TEST_ASSERT_TRUE(out.find("⚠️ 100% x\n") != std::string::npos);
+    TEST_ASSERT_TRUE(out.find("[D]") == std::string::npos);
+    TEST_ASSERT_TRUE(out.find("seq=7") < out.find("100%"));
+}
+
+// 调用方看到的每条开销：保留的 FLOG_INFO（入队约 40 字节）、编译掉的 FLOG_DEBUG，
+// 以及改造前在调用方任务里立即格式化并写串口的做法（DEBUG_INFOF 的路径）
+void bench_call_cost() {
+    NativeSerial::setMode(NativeSerial::MODE_DISCARD);
+    const size_t BURST = FAST_LOG_SLOTS / 2;        // 每批不超过队列容量，批间 flush，计时内不会丢弃
+    const size_t BATCHES = 2000;
+    uint32_t dropped = FastLog::droppedCount();
+    uint64_t elapsed = 0;
+    for (size_t b = 0; b < BATCHES; ++b) {
+        FastLog::flush();
+        uint64_t start = NativeBench::nowNs();
+        for (size_t i = 0; i < BURST; ++i) {
+            FLOG_INFO("📥 OTA包 seq=%u offset=%u len=%u", (unsigned)i, (unsigned)(i * 244), 244u);
+        }
+        elapsed += NativeBench::nowNs() - start;
+    }
+    TEST_ASSERT_EQUAL_UINT32(dropped, FastLog::droppedCount());
+    NativeBench::report("fastlog_info_call", (double)elapsed / (double)(BURST * BATCHES), "ns/op");
+
+    unsigned seq = 0;
+    double off = NativeBench::nsPerOp(10000000, [&]() {
+        FLOG_DEBUG("📥 OTA包 seq=%u offset=%u len=%u", seq, seq * 244, 244u);
+        seq++;
+        benchKeep(seq);
+    });
+    NativeBench::report("fastlog_debug_compiled_out", off, "ns/op");
+
+    double eager = NativeBench::nsPerOp(200000, [&]() {
+        char line[128];
+        int len = snprintf(line, sizeof(line), "[I] %u.%06u 📥 OTA包 seq=%u offset=%u len=%u\n", seq / 1000, seq % 1000,
+                           seq, seq * 244, 244u);
+        Serial.write((const uint8_t*)line, (size_t)len);
+        seq++;
+    });
+    NativeBench::report("fastlog_eager_printf_call", eager, "ns/op");
+}
+
+// 持续吞吐：一个生产者尽快写日志，后台任务按 FAST_LOG_DRAIN_MS 轮询输出；
+// 入队速率远高于输出速率时队列在两次轮询之间写满，多出的记录被丢弃而不是拖慢调用方
+void bench_sustained_throughput() {
+    NativeSerial::setMode(NativeSerial::MODE_DISCARD);
+    FastLog::flush();
+    uint32_t records = FastLog::recordCount();
+    uint32_t dropped = FastLog::droppedCount();
+    uint64_t calls = 0;
+    uint64_t start = NativeBench::nowNs();
+    uint64_t end = start + 200ULL * 1000 * 1000;
+    uint64_t now = start;
+    while (now < end) {
+        for (int i = 0; i < 64; ++i) FLOG_INFO("📊 持续 %u", (unsigned)calls++);
+        now = NativeBench::nowNs();
+    }
+    double seconds = (double)(now - start) / 1e9;
+    FastLog::flush();
+    uint32_t accepted = FastLog::recordCount() - records;
+    uint32_t lost = FastLog::droppedCount() - dropped;
+    TEST_ASSERT_TRUE(calls == (uint64_t)accepted + lost);       // 每次调用要么入队要么计入丢弃
+    NativeBench::report("fastlog_sustained_calls_per_s", (double)calls / seconds, "calls/s");
+    NativeBench::report("fastlog_sustained_logged_per_s", (double)accepted / seconds, "records/s");
+    NativeBench::report("fastlog_sustained_drop_pct", 100.0 * (double)lost / (double)calls, "%");
+
+    // 消费者一侧的上限：队列写满后同步 flush，测格式化 + 串口写出的速率
+    const size_t ROUNDS = 500;
+    uint64_t drainNs = 0;
+    for (size_t r = 0; r < ROUNDS; ++r) {
+        for (uint32_t i = 0; i < FAST_LOG_SLOTS; ++i) {
+            FLOG_INFO("📊 OTA进度: 已接收 %u 字节，速率 %u KB/s，%.1f%%", (unsigned)(r * i), 42u, 12.5);
+        }
+        uint64_t t0 = NativeBench::nowNs();
+        FastLog::flush();
+        drainNs += NativeBench::nowNs() - t0;
+    }
+    NativeBench::report("fastlog_drain_records_per_s", (double)(ROUNDS * FAST_LOG_SLOTS) * 1e9 / (double)drainNs,
+                        "records/s");
+}
+
+// OTA 接收路径每包一条日志时的写入速率：改造前的十六进制转储、FLOG_INFO（编译进来）、FLOG_DEBUG（编译掉）
+// 每包的“处理”用 CRC32 代替，量级与拷贝进窗口缓冲相当
+enum PacketLog { LOG_HEX_DUMP, LOG_FLOG_ON, LOG_FLOG_OFF };
+
+static double otaIngest(PacketLog mode) {
+    const size_t PACKET = 244;
+    const size_t PACKETS = 40000;
+    uint8_t packet[PACKET];
+    for (size_t i = 0; i < PACKET; ++i) packet[i] = (uint8_t)(i * 37);
+    uint32_t crc = 0;
+    FastLog::flush();
+    uint64_t start = NativeBench::nowNs();
+    for (size_t seq = 0; seq < PACKETS; ++seq) {
+        packet[0] = (uint8_t)seq;
+        if (mode == LOG_HEX_DUMP) {
+            std::string hex;                        // 与改造前 handleMessage 相同：逐字节 sprintf 拼接后整行输出
+            for (size_t i = 0; i < PACKET; ++i) {
+                char buf[4];
+                sprintf(buf, "%02X ", packet[i]);
+                hex += buf;
+            }
+            Serial.printf("[INFO] 📥 OTA消息数据(hex): %s\n", hex.c_str());
+        } else if (mode == LOG_FLOG_ON) {
+            FLOG_INFO("📥 OTA控制器收到消息 - 句柄: %d, 数据长度: %u", 42, (unsigned)PACKET);
+        } else {
+            FLOG_DEBUG("📥 OTA控制器收到消息 - 句柄: %d, 数据长度: %u", 42, (unsigned)PACKET);
+        }
+        crc = esp_rom_crc32_le(crc, packet, PACKET);
+    }
+    double seconds = (double)(NativeBench::nowNs() - start) / 1e9;
+    benchKeep(crc);
+    return (double)(PACKET * PACKETS) / 1024.0 / seconds;
+}
+
+void bench_ota_ingest_logging() {
+    NativeSerial::setMode(NativeSerial::MODE_DISCARD);
+    NativeBench::report("fastlog_ota_ingest_hex_dump", otaIngest(LOG_HEX_DUMP), "KB/s");
+    uint32_t dropped = FastLog::droppedCount();
+    NativeBench::report("fastlog_ota_ingest_flog_on", otaIngest(LOG_FLOG_ON), "KB/s");
+    NativeBench::report("fastlog_ota_ingest_flog_on_dropped", (double)(FastLog::droppedCount() - dropped), "records");
+    NativeBench::report("fastlog_ota_ingest_flog_off", otaIngest(LOG_FLOG_OFF), "KB/s");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_ring_drops_and_reports);
+    RUN_TEST(test_deferred_format);
+    RUN_TEST(bench_call_cost);
+    RUN_TEST(bench_sustained_throughput);
+    RUN_TEST(bench_ota_ingest_logging);
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+// LinkPolicy：负载档位 → 连接参数 / 数据长度 / PHY 请求，协商结果回写，以及热路径 hint 的开销基准
+#include <unity.h>
+#include <vector>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include "drivers/BLE/LinkPolicy.h"
+#include "drivers/BLE/BLEServerWrapper.h"
+#include "drivers/BLE/MessageDispatcher.h"
+
+// 记录请求的后端；phy2M 为 false 时模拟不支持 PHY 切换的芯片
+struct RecordingBackend {
+    std::vector<LinkProfile> params;
+    std::vector<uint16_t> dataLengths;
+    std::vector<LinkPhy> phys;
+    bool phySupported = true;
+
+    LinkPolicy::Backend backend() {
+        LinkPolicy::Backend b;
+        b.updateParams = [this](const LinkProfile& p) { params.push_back(p); return true; };
+        b.setDataLength = [this](uint16_t octets) { dataLengths.push_back(octets); return true; };
+        b.setPhy = [this](LinkPhy phy) { phys.push_back(phy); return phySupported; };
+        return b;
+    }
+};
+
+void setUp() {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_WARN);
+}
+
+void tearDown() {}
+
+void test_workload_selects_profile() {
+    RecordingBackend rec;
+    LinkPolicy policy;
+    policy.setBackend(rec.backend());
+    policy.onConnect(1000);
+
+    policy.evaluate(1000 + LINK_IDLE_SETTLE_MS - 1);            // 服务发现期间不放宽参数
+    TEST_ASSERT_EQUAL(0, rec.params.size());
+    policy.evaluate(1000 + LINK_IDLE_SETTLE_MS);
+    TEST_ASSERT_EQUAL(1, rec.params.size());
+    TEST_ASSERT_EQUAL_UINT16(LinkPolicy::profile(LinkWorkload::IDLE).maxInterval, rec.params.back().maxInterval);
+    TEST_ASSERT_EQUAL(0, rec.dataLengths.size());
+    TEST_ASSERT_EQUAL(0, rec.phys.size());                      // 连接时已是 1M
+
+    uint32_t now = 10000;
+    policy.hint(LinkWorkload::STREAMING, now);                  // 升档在 hint 中立即请求
+    TEST_ASSERT_EQUAL(2, rec.params.size());
+    TEST_ASSERT_EQUAL_UINT16(0, rec.params.back().latency);
+    TEST_ASSERT_EQUAL(1, rec.dataLengths.size());
+    TEST_ASSERT_EQUAL_UINT16(251, rec.dataLengths.back());
+    policy.hint(LinkWorkload::STREAMING, now + 10);             // 同一档位不重复请求
+    policy.evaluate(now + 20);
+    TEST_ASSERT_EQUAL(2, rec.params.size());
+
+    policy.hint(LinkWorkload::BULK, now + 100);
+    TEST_ASSERT_EQUAL(3, rec.params.size());
+    TEST_ASSERT_EQUAL(1, rec.dataLengths.size());               // 数据长度已经扩展过
+    TEST_ASSERT_EQUAL(1, rec.phys.size());
+    TEST_ASSERT_TRUE(rec.phys.back() == LinkPhy::PHY_2M);
+    TEST_ASSERT_TRUE(policy.status().workload == LinkWorkload::BULK);
+
+    policy.hint(LinkWorkload::STREAMING, now + 200);            // 低档位的提示不会降档
+    TEST_ASSERT_EQUAL(3, rec.params.size());
+
+    // BULK 保持期过后回到仍在保持期内的 STREAMING，再之后回到 IDLE（PHY 切回 1M）
+    uint32_t bulkEnd = now + 100 + LINK_BULK_HOLD_MS;
+    policy.hint(LinkWorkload::STREAMING, bulkEnd - 100);
+    policy.evaluate(bulkEnd - 1);
+    TEST_ASSERT_EQUAL(3, rec.params.size());
+    policy.evaluate(bulkEnd);
+    TEST_ASSERT_TRUE(policy.status().workload == LinkWorkload::STREAMING);
+    policy.evaluate(bulkEnd - 100 + LINK_STREAMING_HOLD_MS);
+    TEST_ASSERT_TRUE(policy.status().workload == LinkWorkload::IDLE);
+    TEST_ASSERT_EQUAL(5, rec.params.size());
+    TEST_ASSERT_EQUAL(2, rec.phys.size());
+    TEST_ASSERT_TRUE(rec.phys.back() == LinkPhy::PHY_1M);
+    TEST_ASSERT_EQUAL_UINT32(5, policy.status().requests);
+}
+
+void test_unsupported_phy_and_disconnect() {
+    RecordingBackend rec;
+    rec.phySupported = false;
+    LinkPolicy policy;
+    policy.setBackend(rec.backend());
+
+    policy.hint(LinkWorkload::BULK, 100);                       // 未连接：不请求
+    TEST_ASSERT_EQUAL(0, rec.params.size());
+
+    policy.onConnect(200);
+    policy.evaluate(200);                                       // 连接时 BULK 仍在保持期内，立即请求
+    TEST_ASSERT_EQUAL(1, rec.params.size());
+    TEST_ASSERT_EQUAL(1, rec.phys.size());
+    LinkStatus s = policy.status();
+    TEST_ASSERT_FALSE(s.phySupported);
+    TEST_ASSERT_EQUAL_UINT8(1, s.txPhy);
+
+    policy.onDisconnect();
+    policy.onConnect(400);
+    policy.hint(LinkWorkload::BULK, 400);
+    TEST_ASSERT_EQUAL(2, rec.params.size());
+    TEST_ASSERT_EQUAL(1, rec.phys.size());                      // 不支持之后不再请求 PHY
+    TEST_ASSERT_EQUAL(2, rec.dataLengths.size());               // 新连接重新请求数据长度
+}
+
+void test_negotiated_values_reported() {
+    LinkPolicy policy;
+    policy.onConnect(0);
+    policy.onParamsUpdated(true, 12, 0, 400);
+    policy.onDataLength(true, 251, 251);
+    policy.onPhy(false, 2, 2);                                  // 被拒绝：保持原值并计数
+    LinkStatus s = policy.status();
+    TEST_ASSERT_TRUE(s.connected);
+    TEST_ASSERT_EQUAL_UINT16(12, s.interval);
+    TEST_ASSERT_EQUAL_UINT16(400, s.timeout);
+    TEST_ASSERT_EQUAL_UINT16(251, s.txOctets);
+    TEST_ASSERT_EQUAL_UINT8(1, s.txPhy);
+    TEST_ASSERT_EQUAL_UINT32(1, s.rejected);
+}
+
+// GATT 后端：请求经 Bluedroid GAP 接口发出，中心设备（NativeBLE）的回应经 GAP 回调写回状态
+void test_gatt_backend_negotiates_through_gap() {
+    static MessageDispatcher dispatcher;
+    static BLEServerWrapper server;                 // NotifyQueue / 定时器常驻，对象不能随用例析构
+    server.begin(&dispatcher);
+    NativeBLE::connect(247);
+
+    MessageTransport* transport = &server;
+    transport->hintWorkload(LinkWorkload::BULK);
+    TEST_ASSERT_EQUAL_UINT32(1, NativeBLE::connParamRequests());
+    esp_ble_conn_update_params_t params = NativeBLE::lastConnParams();
+    TEST_ASSERT_EQUAL_UINT16(LinkPolicy::profile(LinkWorkload::BULK).minInterval, params.min_int);
+    TEST_ASSERT_EQUAL_UINT16(251, NativeBLE::dataLength());
+
+    LinkStatus s = server.linkStatus();
+    TEST_ASSERT_TRUE(s.workload == LinkWorkload::BULK);
+    TEST_ASSERT_EQUAL_UINT16(params.min_int, s.interval);
+    TEST_ASSERT_EQUAL_UINT16(251, s.txOctets);
+    TEST_ASSERT_EQUAL_UINT16(247, s.mtu);
+    TEST_ASSERT_FALSE(s.phySupported);              // 与经典 ESP32 相同：没有 BLE 5.0 PHY 接口
+
+    NativeBLE::acceptLinkRequests(false);
+    NativeBLE::disconnect();
+    NativeBLE::connect(247);
+    transport->hintWorkload(LinkWorkload::BULK);
+    s = server.linkStatus();
+    TEST_ASSERT_EQUAL_UINT16(0, s.interval);        // 被拒绝：没有协商值
+    TEST_ASSERT_GREATER_THAN_UINT32(0, s.rejected);
+}
+
+// 热路径：MotorController 每个运动帧调用一次（档位已请求时只有原子写）
+void bench_hint() {
+    RecordingBackend rec;
+    LinkPolicy policy;
+    policy.setBackend(rec.backend());
+    policy.onConnect(0);
+    policy.hint(LinkWorkload::STREAMING, 0);
+    uint32_t now = 0;
+    double ns = NativeBench::nsPerOp(5000000, [&]() { policy.hint(LinkWorkload::STREAMING, ++now >> 10); });
+    TEST_ASSERT_EQUAL(1, rec.params.size());
+    NativeBench::report("link_hint", ns, "ns/op");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_workload_selects_profile);
+    RUN_TEST(test_unsupported_phy_and_disconnect);
+    RUN_TEST(test_negotiated_values_reported);
+    RUN_TEST(test_gatt_backend_negotiates_through_gap);
+    RUN_TEST(bench_hint);
+    return UNITY_END();
+}
@@ -0,0 +1,293 @@
+// Metrics：量规语义、快照 / 名称表编码、速率采样，Diagnostics 特征分片回读，以及热路径更新与编码的开销基准
+#include <unity.h>
+#include <string.h>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include "utils/Metrics.h"
+#include "drivers/BLE/MessageDispatcher.h"
+#include "drivers/BLE/BLEServerWrapper.h"
+#include "controllers/DiagnosticsController/DiagnosticsController.h"
+
+static const char* DIAGNOSTICS_UUID = "ef060001-1000-8000-0080-5f9b34fb0000";
+
+static uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 按快照格式找到编号为 id 的条目，返回其数据起点（找不到返回 nullptr）
+static const uint8_t* findRecord(const uint8_t* frame, size_t len, uint8_t id, uint8_t* type) {
+    size_t pos = Metrics::HEADER_BYTES;
+    for (uint8_t i = 0; i < frame[1] && pos + 2 <= len; ++i) {
+        uint8_t recordId = frame[pos];
+        uint8_t recordType = frame[pos + 1];
+        if (recordId == id) {
+            *type = recordType;
+            return &frame[pos + 2];
+        }
+        pos += 2 + (recordType == Metrics::HISTOGRAM ? 16 : 4);
+    }
+    return nullptr;
+}
+
+void setUp() {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_WARN);
+    Metrics::clear();
+}
+
+void tearDown() {}
+
+void test_gauge_modes() {
+    MetricGauge last;
+    MetricGauge high(MetricGauge::HIGH_WATER);
+    MetricGauge low(MetricGauge::LOW_WATER);
+    TEST_ASSERT_EQUAL_INT32(0, low.value());        // 还没有样本
+    const int32_t samples[] = {5, 9, 3, 7};
+    for (int32_t v : samples) {
+        last.update(v);
+        high.update(v);
+        low.update(v);
+    }
+    TEST_ASSERT_EQUAL_INT32(7, last.value());
+    TEST_ASSERT_EQUAL_INT32(9, high.value());
+    TEST_ASSERT_EQUAL_INT32(3, low.value());
+    high.reset();
+    TEST_ASSERT_EQUAL_INT32(0, high.value());
+}
+
+void test_snapshot_and_describe_encoding() {
+    std::atomic<uint32_t> counter{41};
+    MetricGauge peak(MetricGauge::HIGH_WATER);
+    LatencyHistogram histogram;
+    TEST_ASSERT_TRUE(Metrics::addCounter("test.counter", "", counter));
+    TEST_ASSERT_TRUE(Metrics::addGauge("test.peak", "msg", peak));
+    TEST_ASSERT_TRUE(Metrics::addHistogram("test.latency", "us", histogram));
+    TEST_ASSERT_TRUE(Metrics::addProbe("test.probe", "", [](void* arg) { return *(int32_t*)arg; }, &peak));
+    counter++;
+    peak.update(12);
+    for (uint32_t i = 0; i < 100; ++i) histogram.record(i < 99 ? 10 : 5000);
+    Metrics::sample(0);
+
+    uint8_t frame[256];
+    size_t len = Metrics::snapshot(frame, sizeof(frame));
+    TEST_ASSERT_EQUAL(Metrics::HEADER_BYTES + 6 + 6 + 18 + 6, len);
+    TEST_ASSERT_EQUAL_UINT8(Metrics::FRAME_VERSION, frame[0]);
+    TEST_ASSERT_EQUAL_UINT8(4, frame[1]);
+
+    uint8_t type = 0;
+    const uint8_t* record = findRecord(frame, len, 0, &type);
+    TEST_ASSERT_NOT_NULL(record);
+    TEST_ASSERT_EQUAL_UINT8(Metrics::COUNTER, type);
+    TEST_ASSERT_EQUAL_UINT32(42, read32(record));
+    record = findRecord(frame, len, 1, &type);
+    TEST_ASSERT_EQUAL_UINT8(Metrics::GAUGE, type);
+    TEST_ASSERT_EQUAL_UINT32(12, read32(record));
+    record = findRecord(frame, len, 2, &type);
+    TEST_ASSERT_EQUAL_UINT8(Metrics::HISTOGRAM, type);
+    TEST_ASSERT_EQUAL_UINT32(100, read32(record));
+    TEST_ASSERT_EQUAL_UINT32(15, read32(record + 4));           // p50 落在 [8, 16) 桶，报上界
+    TEST_ASSERT_EQUAL_UINT32(5000, read32(record + 12));
+
+    // 缓冲放不下时整条省略，不写半条；后面更短的条目仍然写入
+    len = Metrics::snapshot(frame, Metrics::HEADER_BYTES + 6 + 6 + 10);
+    TEST_ASSERT_EQUAL_UINT8(3, frame[1]);
+    TEST_ASSERT_NULL(findRecord(frame, len, 2, &type));
+    TEST_ASSERT_NOT_NULL(findRecord(frame, len, 3, &type));
+
+    len = Metrics::describe(frame, sizeof(frame));
+    TEST_ASSERT_EQUAL_UINT8(4, frame[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, frame[2]);
+    TEST_ASSERT_EQUAL_UINT8(Metrics::COUNTER, frame[3]);
+    TEST_ASSERT_EQUAL_UINT8(strlen("test.counter"), frame[4]);
+    TEST_ASSERT_EQUAL_MEMORY("test.counter", &frame[5], strlen("test.counter"));
+
+    Metrics::reset();                                           // 直方图与峰值清零，计数器保留
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.count());
+    TEST_ASSERT_EQUAL_INT32(0, peak.value());
+    TEST_ASSERT_EQUAL_UINT32(42, counter.load());
+}
+
+void test_rate_sampling() {
+    std::atomic<uint32_t> bytes{0};
+    Metrics::addRate("test.rate", "B/s", bytes);
+    Metrics::sample(1000);
+    bytes += 4096;
+    Metrics::sample(1500);                                      // 半秒 4KB → 8KB/s
+    uint8_t frame[64];
+    size_t len = Metrics::snapshot(frame, sizeof(frame));
+    uint8_t type = 0;
+    const uint8_t* record = findRecord(frame, len, 0, &type);
+    TEST_ASSERT_EQUAL_UINT8(Metrics::GAUGE, type);
+    TEST_ASSERT_EQUAL_UINT32(8192, read32(record));
+
+    bytes.store(100);                                           // 计数器被重置（新的 OTA 会话）：按新值计
+    Metrics::sample(2500);
+    Metrics::snapshot(frame, sizeof(frame));
+    TEST_ASSERT_EQUAL_UINT32(100, read32(findRecord(frame, len, 0, &type)));
+}
+
+void test_dispatcher_metrics() {
+    MessageDispatcher dispatcher;
+    dispatcher.characteristics().intern(DIAGNOSTICS_UUID, "Diagnostics");
+    DiagnosticsController consumer;
+    CharHandle handle = dispatcher.subscribe("Diagnostics", &consumer);
+    dispatcher.registerMetrics();
+    const uint8_t payload[] = {1};
+    for (int i = 0; i < 5; ++i) dispatcher.enqueue(handle, payload, sizeof(payload));
+    BLEWriteMessage msg;
+    while (dispatcher.tryPop(msg)) dispatcher.markHandled(msg);
+    TEST_ASSERT_EQUAL_INT32(5, dispatcher.depthPeak());
+    TEST_ASSERT_EQUAL_UINT32(5, dispatcher.latency().count());
+    TEST_ASSERT_EQUAL(4, Metrics::count());
+}
+
+// 完整路径：中心设备写 Diagnostics → bleWriteTask（这里手动出队分发）→ 分片通知 → 按序号拼回快照
+void test_diagnostics_characteristic_round_trip() {
+    static MessageDispatcher dispatcher;
+    static BLEServerWrapper server;                 // NotifyQueue / 定时器常驻，对象不能随用例析构
+    static DiagnosticsController diagnostics;
+    server.begin(&dispatcher);
+    server.beginDeferred();
+    dispatcher.subscribe("Diagnostics", &diagnostics);
+    diagnostics.setTransport(&server);
+    dispatcher.registerMetrics();
+    server.registerMetrics();
+
+    std::mutex lock;
+    std::vector<std::string> chunks;
+    NativeBLE::onNotify([&](const char* uuid, const uint8_t* data, size_t len) {
+        if (strcmp(uuid, DIAGNOSTICS_UUID) != 0) return;
+        std::lock_guard<std::mutex> guard(lock);
+        chunks.push_back(std::string((const char*)data, len));
+    });
+    NativeBLE::connect(64);                         // 通知上限 61 字节，快照需要分片
+
+    auto request = [&](uint8_t op, std::string& frame) {   // 断言宏在失败时 return，所以用输出参数
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            chunks.clear();
+        }
+        TEST_ASSERT_TRUE(NativeBLE::write(DIAGNOSTICS_UUID, &op, 1));
+        BLEWriteMessage msg;
+        while (dispatcher.tryPop(msg)) {
+            dispatcher.dispatch(msg);
+            dispatcher.markHandled(msg);
+        }
+        frame.clear();
+        for (int spin = 0; spin < 2000; ++spin) {   // 最后一片可能经通知队列异步发出
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!chunks.empty() && chunks.size() == (uint8_t)chunks[0][2]) break;
+            }
+            delay(1);
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            TEST_ASSERT_EQUAL_UINT8(op | 0x80, (uint8_t)chunks[i][0]);
+            TEST_ASSERT_EQUAL_UINT8(i, (uint8_t)chunks[i][1]);
+            TEST_ASSERT_TRUE(chunks[i].size() <= 61);
+            frame += chunks[i].substr(DiagnosticsController::CHUNK_HEADER);
+        }
+    };
+
+    std::string snapshot;
+    request(DiagnosticsController::OP_SNAPSHOT, snapshot);
+    TEST_ASSERT_TRUE(snapshot.size() > 61);
+    TEST_ASSERT_EQUAL_UINT8(Metrics::FRAME_VERSION, (uint8_t)snapshot[0]);
+    TEST_ASSERT_EQUAL_UINT8(Metrics::count(), (uint8_t)snapshot[1]);
+    uint8_t type = 0;
+    const uint8_t* latency = findRecord((const uint8_t*)snapshot.data(), snapshot.size(), 3, &type);
+    TEST_ASSERT_NOT_NULL(latency);
+    TEST_ASSERT_EQUAL_UINT8(Metrics::HISTOGRAM, type);
+    TEST_ASSERT_EQUAL_UINT32(0, read32(latency));               // 本次请求的延迟在处理完成后才记录
+
+    std::string names;
+    request(DiagnosticsController::OP_DESCRIBE, names);
+    TEST_ASSERT_EQUAL_UINT8(Metrics::count(), (uint8_t)names[1]);
+    TEST_ASSERT_TRUE(names.find("dispatch.latency") != std::string::npos);
+    TEST_ASSERT_TRUE(names.find("link.interval") != std::string::npos);
+
+    request(DiagnosticsController::OP_SNAPSHOT, snapshot);
+    latency = findRecord((const uint8_t*)snapshot.data(), snapshot.size(), 3, &type);
+    TEST_ASSERT_EQUAL_UINT32(2, read32(latency));
+
+    // 空写入拿到的负载块残留着上一条 02：必须被拒绝，不能清零指标
+    const uint8_t reset = DiagnosticsController::OP_RESET;
+    CharHandle handle = dispatcher.characteristics().find(DIAGNOSTICS_UUID);
+    TEST_ASSERT_TRUE(dispatcher.enqueue(handle, &reset, 1));
+    BLEWriteMessage msg;
+    TEST_ASSERT_TRUE(dispatcher.tryPop(msg));
+    msg = BLEWriteMessage();                        // 未分发就归还
+    TEST_ASSERT_TRUE(dispatcher.enqueue(handle, &reset, 0));
+    TEST_ASSERT_TRUE(dispatcher.tryPop(msg));
+    TEST_ASSERT_EQUAL(0, msg.data.size());
+    TEST_ASSERT_EQUAL_HEX8(DiagnosticsController::OP_RESET, msg.data.data()[0]);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        chunks.clear();
+    }
+    dispatcher.dispatch(msg);
+    dispatcher.markHandled(msg);
+    delay(20);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        TEST_ASSERT_EQUAL(0, chunks.size());
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, dispatcher.latency().count());   // 三次请求 + 空写入，没有被清零
+
+    std::string ack;
+    request(DiagnosticsController::OP_RESET, ack);
+    TEST_ASSERT_EQUAL(0, ack.size());
+    TEST_ASSERT_EQUAL_UINT32(1, dispatcher.latency().count());   // 清零之后只剩 02 请求自己
+    NativeBLE::onNotify(nullptr);
+}
+
+// 热路径更新：计数器 / 峰值量规 / 直方图各一次原子操作；快照编码在 bleWriteTask 中按需执行
+void bench_metric_updates() {
+    std::atomic<uint32_t> counter{0};
+    MetricGauge peak(MetricGauge::HIGH_WATER);
+    LatencyHistogram histogram;
+    uint32_t i = 0;
+    double counterNs = NativeBench::nsPerOp(5000000, [&]() { counter.fetch_add(1, std::memory_order_relaxed); });
+    double gaugeNs = NativeBench::nsPerOp(5000000, [&]() { peak.update((int32_t)(++i & 31)); });
+    double histogramNs = NativeBench::nsPerOp(5000000, [&]() { histogram.record(++i & 4095); });
+    NativeBench::report("metrics_counter_inc", counterNs, "ns/op");
+    NativeBench::report("metrics_gauge_peak_update", gaugeNs, "ns/op");
+    NativeBench::report("metrics_histogram_record", histogramNs, "ns/op");
+}
+
+void bench_snapshot_encode() {
+    static std::atomic<uint32_t> counters[16];
+    static LatencyHistogram histograms[8];
+    static const char* const counterNames[16] = {"c0", "c1", "c2", "c3", "c4", "c5", "c6", "c7",
+                                                 "c8", "c9", "c10", "c11", "c12", "c13", "c14", "c15"};
+    static const char* const histogramNames[8] = {"h0", "h1", "h2", "h3", "h4", "h5", "h6", "h7"};
+    for (int i = 0; i < 16; ++i) Metrics::addCounter(counterNames[i], "", counters[i]);
+    for (int i = 0; i < 8; ++i) {
+        Metrics::addHistogram(histogramNames[i], "us", histograms[i]);
+        for (uint32_t v = 0; v < 1000; ++v) histograms[i].record(v * 7);
+    }
+    uint8_t frame[DIAG_FRAME_BYTES];
+    size_t len = 0;
+    double ns = NativeBench::nsPerOp(200000, [&]() { len = Metrics::snapshot(frame, sizeof(frame)); });
+    TEST_ASSERT_EQUAL(Metrics::HEADER_BYTES + 16 * 6 + 8 * 18, len);
+    NativeBench::report("metrics_snapshot_24", ns, "ns/op");
+    NativeBench::report("metrics_snapshot_24_bytes", (double)len, "bytes");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_gauge_modes);
+    RUN_TEST(test_snapshot_and_describe_encoding);
+    RUN_TEST(test_rate_sampling);
+    RUN_TEST(test_dispatcher_metrics);
+    RUN_TEST(test_diagnostics_characteristic_round_trip);
+    RUN_TEST(bench_metric_updates);
+    RUN_TEST(bench_snapshot_encode);
+    return UNITY_END();
+}
@@ -0,0 +1,353 @@
+// MotorWrite 协议：编码 → 解码往返（边界差值、3 字节变长整数、TIMED 帧）、截断与多余字节等错误帧、单帧样本容量；编解码开销
+// ClockSync / JitterBuffer：最小往返的偏移、窗口最优测量间的漂移、32 位时间戳回绕、reset，播放延迟的立即增大与逐帧缩短
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include "controllers/MotorController/MotorProtocol.h"
+#include "controllers/MotorController/ClockSync.h"
+#include "controllers/MotorController/JitterBuffer.h"
+
+// 解码整帧，返回错误原因（成功为 nullptr）
+static const char* decodeAll(const uint8_t* data, size_t len, std::vector<MotorSample>& samples) {
+    samples.clear();
+    MotorFrameDecoder decoder;
+    if (!decoder.begin(data, len)) return decoder.error();
+    MotorSample sample;
+    while (decoder.next(sample)) samples.push_back(sample);
+    if (decoder.error()) return decoder.error();
+    return decoder.done() ? nullptr : "NotDone";
+}
+
+static void assertError(const char* expected, const uint8_t* data, size_t len) {
+    std::vector<MotorSample> samples;
+    const char* error = decodeAll(data, len, samples);
+    TEST_ASSERT_NOT_NULL(error);
+    TEST_ASSERT_EQUAL_STRING(expected, error);
+}
+
+void setUp() {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_ERROR);
+}
+
+void tearDown() {}
+
+void test_round_trip_edge_deltas() {
+    // 相邻样本的差值取到 ±32767（zigzag 后 17 位，3 字节变长整数）以及整个 int16 范围两端
+    static const int16_t angles[][MOTOR_MAX_AXES] = {
+        {0, -32767, 32767, 100},
+        {32767, 0, 0, 100},                         // +32767 / +32767 / -32767 / 0
+        {0, -32767, 32767, 163},                    // -32767 / -32767 / +32767 / +63（1 字节的上限）
+        {-32768, 32767, -32768, 99},                // 差值超出 ±32767，编码端按 int32 计算不会溢出
+        {-32768, 32767, -32768, 99},                // 差值为 0
+    };
+    static const uint16_t dts[] = {0, 0xFFFF, 1, 127, 128};   // dt 的 1 / 2 / 3 字节边界
+    const size_t n = sizeof(dts) / sizeof(dts[0]);
+
+    uint8_t buffer[244];
+    MotorFrameEncoder encoder(buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(encoder.beginTimed(200, 0x0F, 0xFFFFFFF0u));
+    for (size_t i = 0; i < n; ++i) TEST_ASSERT_TRUE(encoder.add(dts[i], angles[i]));
+    size_t len = encoder.finish();
+    // 首个样本 1 + 1 + 3 + 3 + 2 字节；第二个样本的 dt 0xFFFF 与三个 ±32767 的差值各占 3 字节，差值为 0 的轴占 1 字节
+    const uint8_t* second = buffer + MOTOR_TIMED_FRAME_HEADER + 10;
+    static const uint8_t secondBytes[] = {0xFF, 0xFF, 0x03, 0xFE, 0xFF, 0x03, 0xFE, 0xFF, 0x03, 0xFD, 0xFF, 0x03, 0x00};
+    TEST_ASSERT_EQUAL_MEMORY(secondBytes, second, sizeof(secondBytes));
+
+    std::vector<MotorSample> samples;
+    TEST_ASSERT_NULL(decodeAll(buffer, len, samples));
+    TEST_ASSERT_EQUAL(n, samples.size());
+    MotorFrameDecoder decoder;
+    decoder.begin(buffer, len);
+    TEST_ASSERT_TRUE(decoder.timed());
+    TEST_ASSERT_EQUAL_UINT8(200, decoder.seq());
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFF0u, decoder.senderTimeUs());
+    uint32_t timeMs = 0;
+    for (size_t i = 0; i < n; ++i) {
+        timeMs += dts[i];
+        TEST_ASSERT_EQUAL_UINT16(dts[i], samples[i].dtMs);
+        TEST_ASSERT_EQUAL_UINT32(timeMs, samples[i].timeMs);
+        TEST_ASSERT_EQUAL_INT16_ARRAY(angles[i], samples[i].centiDegrees, MOTOR_MAX_AXES);
+    }
+
+    // 只有部分轴的帧：未选中的轴不占字节，解码结果保持 0
+    MotorFrameEncoder partial(buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(partial.begin(7, 0x05));
+    TEST_ASSERT_TRUE(partial.add(20, angles[0]));
+    TEST_ASSERT_TRUE(partial.add(20, angles[1]));
+    len = partial.finish();
+    TEST_ASSERT_EQUAL(MOTOR_FRAME_HEADER + (1 + 1 + 3) + (1 + 3 + 3), len);
+    TEST_ASSERT_NULL(decodeAll(buffer, len, samples));
+    TEST_ASSERT_EQUAL_INT16(32767, samples[1].centiDegrees[0]);
+    TEST_ASSERT_EQUAL_INT16(0, samples[1].centiDegrees[1]);
+    TEST_ASSERT_EQUAL_INT16(0, samples[1].centiDegrees[2]);
+}
+
+void test_frame_capacity_matches_header_comment() {
+    // 4 轴、90° 附近小幅运动：首个样本是绝对值（每轴 3 字节），之后每个样本 5 字节
+    uint8_t buffer[244];
+    MotorFrameEncoder encoder(buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(encoder.begin(0, 0x0F));
+    int16_t angles[MOTOR_MAX_AXES] = {9000, 9000, 9000, 9000};
+    while (encoder.add(20, angles)) {
+        for (uint8_t axis = 0; axis < MOTOR_MAX_AXES; ++axis) angles[axis] += (axis & 1) ? -30 : 30;
+    }
+    TEST_ASSERT_EQUAL_UINT8(46, encoder.sampleCount());
+    size_t len = encoder.finish();
+    TEST_ASSERT_EQUAL(MOTOR_FRAME_HEADER + 13 + 45 * 5, len);
+
+    uint8_t before[244];
+    memcpy(before, buffer, sizeof(buffer));
+    TEST_ASSERT_FALSE(encoder.add(20, angles));     // 放不下的样本不改动缓冲
+    TEST_ASSERT_EQUAL_MEMORY(before, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL(len, encoder.finish());
+}
+
+void test_malformed_frames() {
+    static const int16_t first[MOTOR_MAX_AXES] = {32767, -32767, 0, 0};
+    static const int16_t second[MOTOR_MAX_AXES] = {0, 0, 0, 0};
+    uint8_t frame[64];
+    MotorFrameEncoder encoder(frame, sizeof(frame) - 1);
+    encoder.begin(3, 0x03);
+    encoder.add(300, first);
+    encoder.add(20, second);
+    size_t len = encoder.finish();
+    TEST_ASSERT_EQUAL(MOTOR_FRAME_HEADER + (2 + 3 + 3) + (1 + 3 + 3), len);
+
+    // 每一个截断位置都报 Truncated（包括 3 字节变长整数的中间），不会读出缓冲之外
+    for (size_t cut = MOTOR_FRAME_HEADER; cut < len; ++cut) {
+        assertError("Truncated", frame, cut);
+    }
+    frame[len] = 0x00;
+    assertError("TrailingBytes", frame, len + 1);
+
+    uint8_t tooLong[] = {MOTOR_OP_SETPOINTS, 0, 0x01, 1, 0x80, 0x80, 0x80, 0x01, 0x00};
+    assertError("VarintTooLong", tooLong, sizeof(tooLong));
+    uint8_t badDelta[] = {MOTOR_OP_SETPOINTS, 0, 0x01, 1, 0x80, 0x80, 0x04, 0x00};     // dt = 0x10000
+    assertError("BadDelta", badDelta, sizeof(badDelta));
+    uint8_t outOfRange[] = {MOTOR_OP_SETPOINTS, 0, 0x01, 2, 0x00, 0xFE, 0xFF, 0x03, 0x00, 0x02};   // 32767 + 1
+    assertError("OutOfRange", outOfRange, sizeof(outOfRange));
+
+    uint8_t header[] = {MOTOR_OP_SETPOINTS, 0, 0x10, 1, 0x00, 0x00};
+    assertError("BadAxisMask", header, sizeof(header));
+    header[2] = 0;
+    assertError("BadAxisMask", header, sizeof(header));
+    header[2] = 0x01;
+    header[3] = 0;
+    assertError("Empty", header, sizeof(header));
+    assertError("Short", header, 3);
+    uint8_t timedShort[] = {MOTOR_OP_TIMED_SETPOINTS, 0, 0x01, 1, 0x00, 0x00, 0x00};
+    assertError("Short", timedShort, sizeof(timedShort));
+    header[0] = 0x7E;
+    assertError("BadOp", header, sizeof(header));
+
+    uint8_t stop[3];
+    TEST_ASSERT_EQUAL(2, MotorFrameEncoder::encodeStop(stop, sizeof(stop), 9));
+    std::vector<MotorSample> samples;
+    TEST_ASSERT_NULL(decodeAll(stop, 2, samples));
+    TEST_ASSERT_EQUAL(0, samples.size());
+    stop[2] = 0;
+    assertError("TrailingBytes", stop, 3);
+}
+
+// 模拟一次往返：手机时间 phoneUs 发出，上行 upUs、设备处理 holdUs、下行 downUs；设备时钟 = 手机时钟 × (1 + ppm) + offset
+static void exchange(ClockSync& clock, int64_t phoneUs, int64_t offsetUs, double ppm, int64_t upUs, int64_t downUs,
+                     int64_t holdUs = 300) {
+    double rate = 1.0 + ppm / 1e6;
+    int64_t t1 = phoneUs;
+    int64_t t2 = (int64_t)((double)(t1 + upUs) * rate) + offsetUs;
+    int64_t t3 = t2 + holdUs;
+    int64_t t4 = t1 + upUs + (int64_t)((double)holdUs / rate) + downUs;
+    clock.addExchange(t1, t2, t3, t4);
+}
+
+void test_clock_offset_from_min_rtt() {
+    const int64_t OFFSET = 1234567;
+    ClockSync clock;
+    TEST_ASSERT_FALSE(clock.hasEstimate());
+    exchange(clock, 1000000, OFFSET, 0, 20000, 2000);      // 上行排队：偏移估计偏大 9ms
+    exchange(clock, 1100000, OFFSET, 0, 3000, 3000);       // 对称且往返最短
+    exchange(clock, 1200000, OFFSET, 0, 1000, 15000);      // 下行排队：偏移估计偏小 7ms
+    TEST_ASSERT_TRUE(clock.synced());
+    TEST_ASSERT_EQUAL_UINT32(3, clock.exchangeCount());
+    TEST_ASSERT_EQUAL_UINT32(6000, clock.rttUs());
+    TEST_ASSERT_EQUAL_INT32(OFFSET, (int32_t)clock.offsetUs(2000000));
+    TEST_ASSERT_EQUAL_INT32(1500000 + OFFSET, (int32_t)clock.toLocal(1500000, 2000000));
+
+    // 窗口滑过之后以窗口内剩下的最短往返为准
+    for (int i = 0; i < CLOCK_SYNC_WINDOW; ++i) exchange(clock, 2000000 + i * 100000, OFFSET, 0, 9000, 1000);
+    TEST_ASSERT_EQUAL_UINT32(10000, clock.rttUs());
+    TEST_ASSERT_EQUAL_INT32(OFFSET + 4000, (int32_t)clock.offsetUs(3000000));
+
+    // 没有往返时退化为单向估计：到达时间 - 手机时间戳的最小值
+    ClockSync oneWay;
+    oneWay.observeOneWay(1000, 1000 + OFFSET + 8000);
+    oneWay.observeOneWay(2000, 2000 + OFFSET + 3000);
+    oneWay.observeOneWay(3000, 3000 + OFFSET + 12000);
+    TEST_ASSERT_TRUE(oneWay.hasEstimate());
+    TEST_ASSERT_FALSE(oneWay.synced());
+    TEST_ASSERT_EQUAL_INT32(OFFSET + 3000, (int32_t)oneWay.offsetUs(0));
+}
+
+// 每秒一次往返，每个窗口的第一次往返最短；窗口最优测量与锚点相隔不足 20 秒时不估计漂移
+static void runWindows(ClockSync& clock, int64_t startUs, int windows, int64_t offsetUs, double ppm) {
+    for (int w = 0; w < windows; ++w) {
+        for (int i = 0; i < CLOCK_SYNC_WINDOW; ++i) {
+            int64_t phone = startUs + (int64_t)(w * CLOCK_SYNC_WINDOW + i) * 1000000;
+            if (i == 0) {
+                exchange(clock, phone, offsetUs, ppm, 2000, 2000);
+            } else {
+                exchange(clock, phone, offsetUs, ppm, 2000 + i * 1500, 2000 + (i % 3) * 500);   // 不对称排队
+            }
+        }
+    }
+}
+
+void test_clock_drift_from_window_minima() {
+    const double PPM = 50.0;
+    ClockSync clock;
+    runWindows(clock, 0, 3, 5000000, PPM);          // 锚点在 0 s，第 3 个窗口的最优测量在 16 s
+    TEST_ASSERT_EQUAL_UINT32(3 * CLOCK_SYNC_WINDOW, clock.exchangeCount());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, clock.driftPpm());
+    runWindows(clock, 3 * CLOCK_SYNC_WINDOW * 1000000LL, 1, 5000000, PPM);     // 24 s：基线够长
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, (float)PPM, clock.driftPpm());
+
+    // 漂移用于外推：一分钟之后的偏移与真实值相差不到 1ms
+    int64_t phone = 90000000;
+    int64_t truth = (int64_t)((double)phone * (1.0 + PPM / 1e6)) + 5000000;
+    TEST_ASSERT_INT_WITHIN(1000, (int32_t)(truth - phone), (int32_t)clock.offsetUs(truth));
+
+    // 超出 ±500ppm 的斜率视为异常，保留上一次的估计
+    runWindows(clock, 40000000, 1, 5000000 + 30000, PPM);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, (float)PPM, clock.driftPpm());
+}
+
+void test_clock_reset_restarts_windows() {
+    ClockSync clock;
+    runWindows(clock, 0, 4, 5000000, 50.0);
+    TEST_ASSERT_TRUE(clock.driftPpm() > 40.0f);
+    for (int i = 0; i < 5; ++i) exchange(clock, 40000000 + i * 1000000, 5000000, 50.0, 2000, 2000);
+
+    // 手机重连（时钟基准变了）：reset 之后窗口与锚点从头开始，旧窗口剩下的计数不能让新窗口提前结束
+    clock.reset();
+    TEST_ASSERT_FALSE(clock.hasEstimate());
+    TEST_ASSERT_EQUAL_UINT32(0, clock.exchangeCount());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, clock.driftPpm());
+    TEST_ASSERT_EQUAL_UINT32(0, clock.rttUs());
+
+    runWindows(clock, 0, 3, -7000000, -20.0);
+    TEST_ASSERT_EQUAL_UINT32(3 * CLOCK_SYNC_WINDOW, clock.exchangeCount());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, clock.driftPpm());           // 新锚点在 0 s，16 s 的基线仍然不够
+    runWindows(clock, 3 * CLOCK_SYNC_WINDOW * 1000000LL, 1, -7000000, -20.0);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, -20.0f, clock.driftPpm());
+}
+
+void test_clock_unwrap_sender() {
+    ClockSync clock;
+    TEST_ASSERT_TRUE(clock.unwrapSender(0xFFFFFF00u) == 0xFFFFFF00LL);
+    TEST_ASSERT_TRUE(clock.unwrapSender(0x00000100u) == 0x100000100LL);    // 跨过 32 位回绕
+    TEST_ASSERT_TRUE(clock.unwrapSender(0xFFFFFFF0u) == 0xFFFFFFF0LL);     // 回绕之前的乱序帧
+    TEST_ASSERT_TRUE(clock.unwrapSender(0x00000200u) == 0x100000200LL);
+    TEST_ASSERT_TRUE(clock.unwrapSender(0x7FFFFFFFu) == 0x17FFFFFFFLL);    // 向前约 35 分钟仍按同一圈展开
+    TEST_ASSERT_TRUE(clock.unwrapSender(0xF0000000u) == 0x1F0000000LL);
+    TEST_ASSERT_TRUE(clock.unwrapSender(0x00000300u) == 0x200000300LL);    // 第二次回绕
+    clock.reset();
+    TEST_ASSERT_TRUE(clock.unwrapSender(0x00000300u) == 0x300LL);
+}
+
+void test_jitter_grows_immediately_shrinks_slowly() {
+    JitterBuffer jitter;
+    int64_t sent = 0;
+    for (int i = 0; i < JITTER_WINDOW; ++i, sent += 10000) jitter.onFrame(sent, sent + 8000);
+    TEST_ASSERT_EQUAL_UINT32(JITTER_MIN_DELAY_MS * 1000, jitter.delayUs());      // 8ms + 余量仍低于下限
+    TEST_ASSERT_EQUAL_UINT32(0, jitter.jitterUs());
+
+    TEST_ASSERT_EQUAL_UINT32(80000 + JitterBuffer::MARGIN_US, jitter.onFrame(sent, sent + 80000));    // 迟到一帧：立即加深
+    sent += 10000;
+    for (int i = 1; i < JITTER_WINDOW; ++i, sent += 10000) {
+        TEST_ASSERT_EQUAL_UINT32(85000, jitter.onFrame(sent, sent + 8000));  // 最大值还在窗口内
+    }
+    uint32_t expected = 85000;
+    while (expected > JITTER_MIN_DELAY_MS * 1000) {
+        uint32_t step = expected - JITTER_MIN_DELAY_MS * 1000;
+        expected -= step < JitterBuffer::JITTER_SHRINK_US ? step : JitterBuffer::JITTER_SHRINK_US;
+        TEST_ASSERT_EQUAL_UINT32(expected, jitter.onFrame(sent, sent + 8000));  // 每帧最多缩短 500us
+        sent += 10000;
+    }
+    TEST_ASSERT_EQUAL_UINT32(JITTER_MIN_DELAY_MS * 1000, jitter.onFrame(sent, sent + 8000));
+
+    // 缩短途中再次迟到：立即按新的最大值加深，不受缩短步长限制
+    jitter.reset();
+    jitter.onFrame(0, 60000);
+    TEST_ASSERT_EQUAL_UINT32(65000, jitter.delayUs());
+    TEST_ASSERT_EQUAL_UINT32(JITTER_MAX_DELAY_MS * 1000, jitter.onFrame(10000, 10000 + 2000000));   // 上限
+    TEST_ASSERT_TRUE(jitter.jitterUs() > 0);
+}
+
+// 满帧（46 个 4 轴样本）的编码与解码开销
+void bench_encode_decode() {
+    uint8_t buffer[244];
+    int16_t angles[MOTOR_MAX_AXES] = {9000, 9000, 9000, 9000};
+    size_t len = 0;
+    double encodeNs = NativeBench::nsPerOp(200000, [&]() {
+        MotorFrameEncoder encoder(buffer, sizeof(buffer));
+        encoder.begin(0, 0x0F);
+        int16_t a[MOTOR_MAX_AXES] = {angles[0], angles[1], angles[2], angles[3]};
+        while (encoder.add(20, a)) {
+            for (uint8_t axis = 0; axis < MOTOR_MAX_AXES; ++axis) a[axis] += (axis & 1) ? -30 : 30;
+        }
+        len = encoder.finish();
+        benchKeep(len);
+    });
+    uint32_t sum = 0;
+    double decodeNs = NativeBench::nsPerOp(200000, [&]() {
+        MotorFrameDecoder decoder;
+        decoder.begin(buffer, len);
+        MotorSample sample;
+        while (decoder.next(sample)) sum += (uint32_t)sample.centiDegrees[3];
+        benchKeep(sum);
+    });
+    NativeBench::report("motor_encode_frame_46", encodeNs, "ns/op");
+    NativeBench::report("motor_decode_frame_46", decodeNs, "ns/op");
+    NativeBench::report("motor_decode_sample", decodeNs / 46, "ns/op");
+}
+
+// 每个 TIMED 帧走一次 unwrapSender + toLocal + JitterBuffer::onFrame，每次往返走一次 addExchange
+void bench_clock_and_jitter() {
+    ClockSync clock;
+    JitterBuffer jitter;
+    uint32_t sender = 0xFFF00000u;
+    int64_t local = 5000000;
+    double frameNs = NativeBench::nsPerOp(2000000, [&]() {
+        int64_t sent = clock.unwrapSender(sender);
+        clock.observeOneWay(sent, local);
+        uint32_t delay = jitter.onFrame(clock.toLocal(sent, local), local + (sender & 0x3FFF));
+        benchKeep(delay);
+        sender += 10000;
+        local += 10000;
+    });
+    int64_t phone = 0;
+    double exchangeNs = NativeBench::nsPerOp(2000000, [&]() {
+        exchange(clock, phone, 5000000, 20.0, 2000 + (phone & 0xFFF), 2000);
+        phone += 1000000;
+    });
+    NativeBench::report("motor_clock_jitter_frame", frameNs, "ns/op");
+    NativeBench::report("motor_clock_exchange", exchangeNs, "ns/op");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_edge_deltas);
+    RUN_TEST(test_frame_capacity_matches_header_comment);
+    RUN_TEST(test_malformed_frames);
+    RUN_TEST(test_clock_offset_from_min_rtt);
+    RUN_TEST(test_clock_drift_from_window_minima);
+    RUN_TEST(test_clock_reset_restarts_windows);
+    RUN_TEST(test_clock_unwrap_sender);
+    RUN_TEST(test_jitter_grows_immediately_shrinks_slowly);
+    RUN_TEST(bench_encode_decode);
+    RUN_TEST(bench_clock_and_jitter);
+    return UNITY_END();
+}
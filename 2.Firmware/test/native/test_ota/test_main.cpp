@@ -0,0 +1,745 @@
+// OTA 流水线：接收窗口重排与选择性确认（含丢包 / 乱序下的有效吞吐仿真）、解压、差分补丁（含 make-delta.js 生成的固定镜像往返），以及写入任务落盘到模拟 Flash 的正确性与吞吐基准
+#include <unity.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include "OTAReceiveWindow.h"
+#include "OTAInflater.h"
+#include "OTAPatchApplier.h"
+#include "OTAFlashWriter.h"
+#include "OTAController.h"
+
+static const size_t BLE_CHUNK = 244;                // MTU 247 时单包负载
+
+#ifndef OTA_LINK_KBPS
+#define OTA_LINK_KBPS 160                           // 链路模型的 BLE 有效吞吐（kbit/s），与 scripts/build-firmware.js 的默认值一致
+#endif
+
+class VectorSink : public OTAStreamSink {
+public:
+    bool write(const uint8_t* data, size_t len) override {
+        bytes.insert(bytes.end(), data, data + len);
+        return true;
+    }
+    std::vector<uint8_t> bytes;
+};
+
+class MemoryPatchSource : public OTAPatchSource {
+public:
+    explicit MemoryPatchSource(const std::vector<uint8_t>& image) : _image(image) {}
+    bool read(uint32_t offset, uint8_t* dst, size_t len) override {
+        if (offset + len > _image.size()) return false;
+        memcpy(dst, _image.data() + offset, len);
+        return true;
+    }
+    uint32_t crc32(uint32_t len) override { return (uint32_t)::crc32(0, _image.data(), len); }
+    uint32_t size() const override { return (uint32_t)_image.size(); }
+private:
+    const std::vector<uint8_t>& _image;
+};
+
+// 类似固件的数据：以 0xE9 开头，指令/常量的局部重复使压缩率接近真实镜像（约 50%）
+static std::vector<uint8_t> makeImage(size_t size, uint32_t seed) {
+    std::vector<uint8_t> image(size);
+    uint32_t state = seed;
+    for (size_t i = 0; i < size; i++) {
+        state = state * 1664525u + 1013904223u;
+        image[i] = (state >> 28) < 12 ? (uint8_t)(i >> 6) : (uint8_t)(state >> 20);
+    }
+    image[0] = 0xE9;
+    return image;
+}
+
+// 与 scripts/build-firmware.js 相同的参数：raw deflate，窗口 4KB
+static std::vector<uint8_t> deflateRaw(const std::vector<uint8_t>& input) {
+    z_stream stream = z_stream();
+    deflateInit2(&stream, 9, Z_DEFLATED, -12, 8, Z_DEFAULT_STRATEGY);
+    std::vector<uint8_t> out(deflateBound(&stream, input.size()));
+    stream.next_in = (Bytef*)input.data();
+    stream.avail_in = (uInt)input.size();
+    stream.next_out = out.data();
+    stream.avail_out = (uInt)out.size();
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+static void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back((uint8_t)(v >> (i * 8)));
+}
+
+static OTAImageInfo describe(const std::vector<uint8_t>& image) {
+    OTAImageInfo info;
+    info.size = (uint32_t)image.size();
+    info.hasDigest = true;
+    mbedtls_sha256_ret(image.data(), image.size(), info.sha256, 0);
+    return info;
+}
+
+static bool partitionEquals(const esp_partition_t* partition, const std::vector<uint8_t>& image) {
+    std::vector<uint8_t> flash(image.size());
+    return esp_partition_read(partition, 0, flash.data(), flash.size()) == ESP_OK && flash == image;
+}
+
+// 以 BLE 包大小分块送入写入器；暂存缓冲满时 write() 整包拒收，这里像 APP 重传一样稍后再送同一块
+static bool stream(OTAFlashWriter& writer, const std::vector<uint8_t>& data) {
+    for (size_t offset = 0; offset < data.size(); offset += BLE_CHUNK) {
+        size_t len = data.size() - offset < BLE_CHUNK ? data.size() - offset : BLE_CHUNK;
+        while (!writer.write(data.data() + offset, len)) {
+            if (writer.failed()) return false;
+            taskYIELD();
+        }
+    }
+    return true;
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    out.resize((size_t)ftell(file));
+    fseek(file, 0, SEEK_SET);
+    bool ok = fread(out.data(), 1, out.size(), file) == out.size();
+    fclose(file);
+    return ok;
+}
+
+static std::string fixturePath(const char* name) {
+    return std::string(NATIVE_PROJECT_DIR) + "/test/native/test_ota/fixtures/" + name;
+}
+
+// 用 node 现场运行 scripts/make-delta.js（输出放在模拟 Flash 文件旁边），主机上没有 node 时返回 false
+static bool makeDelta(const std::string& oldPath, const std::string& newPath, std::vector<uint8_t>& patch,
+                      std::vector<uint8_t>& compressed) {
+    std::string prefix = NATIVE_FLASH_FILE;
+    prefix = prefix.substr(0, prefix.rfind('/') + 1) + "fixture-delta";
+    std::string command = "cd \"" NATIVE_PROJECT_DIR "\" && node scripts/make-delta.js \"" + oldPath + "\" \"" + newPath +
+                          "\" -o \"" + prefix + "\" > /dev/null 2>&1";
+    if (system(command.c_str()) != 0) return false;
+    return readFile(prefix + ".patch", patch) && readFile(prefix + ".patch.deflate", compressed);
+}
+
+static OTAFlashWriter s_writer;                     // 写入任务常驻，所有用例共用
+
+void setUp() {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_WARN);
+}
+
+void tearDown() {}
+
+void test_sha256_known_vector() {
+    uint8_t digest[32];
+    mbedtls_sha256_ret((const unsigned char*)"abc", 3, digest, 0);
+    const uint8_t expected[4] = {0xba, 0x78, 0x16, 0xbf};
+    TEST_ASSERT_EQUAL_MEMORY(expected, digest, sizeof(expected));
+}
+
+void test_window_reorders_and_drops_duplicates() {
+    std::vector<uint8_t> data = makeImage(8 * 100, 1);
+    static uint8_t reorder[4096];
+    OTAReceiveWindow window;
+    window.reset(reorder, sizeof(reorder));
+    VectorSink sink;
+
+    const uint16_t order[] = {1, 0, 3, 2, 2, 5, 4, 7, 6};
+    for (uint16_t seq : order) {
+        OTAPacketHeader header = {OTA_PACKET_VERSION, 0, seq, (uint32_t)seq * 100};
+        OTAReceiveWindow::Result result = window.accept(header, data.data() + seq * 100, 100, sink);
+        TEST_ASSERT_TRUE(result == OTAReceiveWindow::Result::ACCEPTED || result == OTAReceiveWindow::Result::DUPLICATE);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, window.duplicates());
+    TEST_ASSERT_FALSE(window.hasGap());
+    TEST_ASSERT_EQUAL_UINT32(data.size(), window.nextOffset());
+    TEST_ASSERT_TRUE(sink.bytes == data);
+}
+
+// Flash 写入跟不上时 sink 拒收：下一个期望的包不确认、等重传，已缓冲的乱序包在 sink 空出后交付
+void test_window_busy_sink_waits_for_resend() {
+    class GatedSink : public VectorSink {
+    public:
+        bool canAccept(size_t) override { return open; }
+        bool open = false;
+    };
+    std::vector<uint8_t> data = makeImage(6 * 100, 12);
+    static uint8_t reorder[4096];
+    OTAReceiveWindow window;
+    window.reset(reorder, sizeof(reorder));
+    GatedSink sink;
+    auto send = [&](uint16_t seq) {
+        OTAPacketHeader header = {OTA_PACKET_VERSION, 0, seq, (uint32_t)seq * 100};
+        return window.accept(header, data.data() + seq * 100, 100, sink);
+    };
+
+    TEST_ASSERT_TRUE(send(0) == OTAReceiveWindow::Result::BUSY);
+    TEST_ASSERT_TRUE(send(1) == OTAReceiveWindow::Result::ACCEPTED);       // 乱序包照常进重排缓冲
+    OTAAckState ack = window.ackState();
+    TEST_ASSERT_EQUAL_UINT16(0, ack.nextSeq);                           // seq 0 没有被确认，APP 会重传
+    TEST_ASSERT_TRUE(ack.sack == 0x1);
+    TEST_ASSERT_EQUAL(0, sink.bytes.size());
+
+    sink.open = true;
+    TEST_ASSERT_TRUE(send(0) == OTAReceiveWindow::Result::ACCEPTED);       // 重传：交付 0，接着交付缓冲中的 1
+    TEST_ASSERT_EQUAL_UINT32(200, window.nextOffset());
+
+    // 交付缓冲包时 sink 又满了：确认点停在缓冲包之前，重传的同一个包算重复，空出后下一个包到达时补交付
+    TEST_ASSERT_TRUE(send(3) == OTAReceiveWindow::Result::ACCEPTED);
+    sink.open = false;
+    TEST_ASSERT_TRUE(send(2) == OTAReceiveWindow::Result::BUSY);
+    sink.open = true;
+    TEST_ASSERT_TRUE(send(2) == OTAReceiveWindow::Result::ACCEPTED);
+    sink.open = false;
+    TEST_ASSERT_TRUE(send(5) == OTAReceiveWindow::Result::ACCEPTED);
+    TEST_ASSERT_TRUE(send(4) == OTAReceiveWindow::Result::BUSY);
+    TEST_ASSERT_EQUAL_UINT32(400, window.nextOffset());
+    TEST_ASSERT_TRUE(window.hasGap());
+    sink.open = true;
+    TEST_ASSERT_TRUE(send(4) == OTAReceiveWindow::Result::ACCEPTED);
+    TEST_ASSERT_TRUE(send(5) == OTAReceiveWindow::Result::DUPLICATE);
+    TEST_ASSERT_FALSE(window.hasGap());
+    TEST_ASSERT_EQUAL_UINT32(3, window.busy());
+    TEST_ASSERT_TRUE(sink.bytes == data);
+}
+
+// 小包（MTU 未协商时）下窗口能缓冲到第 63 个包：sack 位图必须覆盖全部，否则距离 33~63 的包永远得不到确认
+void test_window_sack_covers_whole_window() {
+    std::vector<uint8_t> data = makeImage(OTAReceiveWindow::MAX_PACKETS * 20, 3);
+    static uint8_t reorder[4096];
+    OTAReceiveWindow window;
+    window.reset(reorder, sizeof(reorder));
+    VectorSink sink;
+    for (uint16_t seq = 1; seq < OTAReceiveWindow::MAX_PACKETS; seq++) {         // 丢掉 seq 0
+        OTAPacketHeader header = {OTA_PACKET_VERSION, 0, seq, (uint32_t)seq * 20};
+        TEST_ASSERT_TRUE(window.accept(header, data.data() + seq * 20, 20, sink) == OTAReceiveWindow::Result::ACCEPTED);
+    }
+    OTAAckState ack = window.ackState();
+    TEST_ASSERT_EQUAL_UINT16(0, ack.nextSeq);
+    TEST_ASSERT_TRUE(ack.sack == (~0ULL >> 1));                 // seq 1..63 全部确认
+    OTAPacketHeader header = {OTA_PACKET_VERSION, 0, 0, 0};
+    window.accept(header, data.data(), 20, sink);
+    ack = window.ackState();
+    TEST_ASSERT_EQUAL_UINT16(OTAReceiveWindow::MAX_PACKETS, ack.nextSeq);
+    TEST_ASSERT_TRUE(ack.sack == 0);
+    TEST_ASSERT_TRUE(sink.bytes == data);
+}
+
+// 丢包 / 乱序仿真：按 BLE 连接事件推进时间，APP 端按设备的 ACK 规则（周期 100ms，异常时 20ms 内补发）选择性重传
+// 连接间隔 7.5ms、每个事件 6 包 × 244 字节（约 195KB/s 链路上限）；包在下一个事件到达，以 reorderPct 的概率再晚一个事件
+struct GoodputResult {
+    double seconds;
+    double goodput;                                 // 镜像字节 / 用时
+    uint32_t sent;                                  // 含重传的发包数
+    bool intact;
+};
+
+static GoodputResult simulateTransfer(const std::vector<uint8_t>& image, uint32_t lossPct, uint32_t reorderPct, uint32_t seed) {
+    const uint32_t EVENT_US = 7500;
+    const uint32_t PACKETS_PER_EVENT = 6;
+    const uint32_t ACK_INTERVAL_EVENTS = 100000 / EVENT_US;
+    const uint32_t ACK_MIN_GAP_EVENTS = 20000 / EVENT_US;
+    const uint32_t packets = (uint32_t)((image.size() + BLE_CHUNK - 1) / BLE_CHUNK);
+
+    struct InFlight {
+        uint32_t arrival;
+        uint16_t seq;
+    };
+    static uint8_t reorder[OTA_WINDOW_BYTES];
+    OTAReceiveWindow window;
+    window.reset(reorder, sizeof(reorder));
+    VectorSink sink;
+    sink.bytes.reserve(image.size());
+
+    std::vector<bool> acked(packets, false);
+    std::vector<uint32_t> lastSent(packets, 0);
+    std::vector<uint16_t> retransmit;
+    std::vector<InFlight> channel;
+    std::vector<std::pair<uint32_t, OTAAckState>> acks;         // (送达 APP 的事件, ACK)
+    uint32_t nextNew = 0;
+    uint32_t sent = 0;
+    uint32_t lastAck = 0;
+    bool ackPending = false;
+    uint32_t state = seed;
+    auto chance = [&](uint32_t pct) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % 100 < pct;
+    };
+
+    uint32_t event = 0;
+    for (; window.nextOffset() < image.size() && event < 1000000; event++) {
+        // 设备：本事件到达的包（晚到的包排在同一事件的准时包之后，形成乱序）
+        for (int late = 0; late < 2; late++) {
+            for (const InFlight& p : channel) {
+                if (p.arrival != event || (p.seq & 0x8000) != (late ? 0x8000 : 0)) continue;
+                uint16_t seq = p.seq & 0x7FFF;
+                size_t len = image.size() - seq * BLE_CHUNK < BLE_CHUNK ? image.size() - seq * BLE_CHUNK : BLE_CHUNK;
+                OTAPacketHeader header = {OTA_PACKET_VERSION, 0, seq, (uint32_t)(seq * BLE_CHUNK)};
+                bool inOrder = header.offset == window.nextOffset();
+                OTAReceiveWindow::Result result = window.accept(header, image.data() + header.offset, len, sink);
+                if (result == OTAReceiveWindow::Result::SINK_ERROR || result == OTAReceiveWindow::Result::INVALID) {
+                    return {0, 0, sent, false};
+                }
+                if (!inOrder) ackPending = true;
+            }
+        }
+        channel.erase(std::remove_if(channel.begin(), channel.end(), [&](const InFlight& p) { return p.arrival <= event; }),
+                      channel.end());
+        if (event - lastAck >= ACK_INTERVAL_EVENTS || (ackPending && event - lastAck >= ACK_MIN_GAP_EVENTS)) {
+            acks.push_back({event + 1, window.ackState()});           // 通知在下一个连接事件送达
+            lastAck = event;
+            ackPending = false;
+        }
+
+        // APP：处理送达的 ACK；包最迟在发出后第 2 个事件到达，ACK 生成之前就应到达却仍未确认的包判定为丢失
+        for (const auto& a : acks) {
+            if (a.first != event) continue;
+            const OTAAckState& ack = a.second;
+            for (uint32_t seq = 0; seq < ack.nextSeq && seq < packets; seq++) acked[seq] = true;
+            for (uint32_t i = 0; i < 63; i++) {
+                if ((ack.sack >> i) & 1) acked[ack.nextSeq + 1 + i] = true;
+            }
+            for (uint32_t seq = ack.nextSeq; seq < nextNew; seq++) {
+                if (!acked[seq] && lastSent[seq] + 3 <= a.first &&
+                    std::find(retransmit.begin(), retransmit.end(), seq) == retransmit.end()) {
+                    retransmit.push_back((uint16_t)seq);
+                }
+            }
+        }
+        acks.erase(std::remove_if(acks.begin(), acks.end(), [&](const std::pair<uint32_t, OTAAckState>& a) {
+                       return a.first <= event;
+                   }), acks.end());
+
+        // APP：先重传，再在窗口（包数与重排缓冲字节数）允许的范围内发新包
+        OTAAckState view = window.ackState();                      // 窗口上界只用于限速，APP 侧按最近 ACK 估计也一样
+        for (uint32_t n = 0; n < PACKETS_PER_EVENT; n++) {
+            uint16_t seq;
+            if (!retransmit.empty()) {
+                seq = retransmit.front();
+                retransmit.erase(retransmit.begin());
+                if (acked[seq]) { n--; continue; }
+            } else if (nextNew < packets && nextNew < (uint32_t)view.nextSeq + OTAReceiveWindow::MAX_PACKETS &&
+                       (nextNew + 1) * BLE_CHUNK - view.nextOffset <= OTA_WINDOW_BYTES) {
+                seq = (uint16_t)nextNew++;
+            } else {
+                break;
+            }
+            lastSent[seq] = event;
+            sent++;
+            if (chance(lossPct)) continue;
+            bool late = chance(reorderPct);
+            channel.push_back({event + (late ? 2 : 1), (uint16_t)(seq | (late ? 0x8000 : 0))});
+        }
+    }
+    double seconds = event * EVENT_US / 1e6;
+    return {seconds, image.size() / seconds, sent, sink.bytes == image};
+}
+
+void test_window_goodput_under_loss_and_reorder() {
+    std::vector<uint8_t> image = makeImage(256 * 1024, 10);
+    const uint32_t scenarios[][2] = {{0, 0}, {1, 5}, {5, 10}, {10, 20}};     // {丢包 %, 乱序 %}
+    double clean = 0;
+    for (const auto& s : scenarios) {
+        GoodputResult r = simulateTransfer(image, s[0], s[1], 42 + s[0]);
+        TEST_ASSERT_TRUE(r.intact);
+        if (s[0] == 0) clean = r.goodput;
+        char name[64];
+        snprintf(name, sizeof(name), "ota_goodput_loss%u_reorder%u", (unsigned)s[0], (unsigned)s[1]);
+        NativeBench::report(name, r.goodput / 1024, "KB/s");
+        snprintf(name, sizeof(name), "ota_retransmit_loss%u_reorder%u", (unsigned)s[0], (unsigned)s[1]);
+        NativeBench::report(name, (double)r.sent / ((image.size() + BLE_CHUNK - 1) / BLE_CHUNK) - 1.0, "ratio");
+        if (s[0] == 5) TEST_ASSERT_TRUE(r.goodput > clean * 0.6);        // 选择性重传：5% 丢包时吞吐不应塌陷
+    }
+}
+
+void test_inflater_round_trip() {
+    std::vector<uint8_t> image = makeImage(64 * 1024 + 123, 2);
+    std::vector<uint8_t> compressed = deflateRaw(image);
+    OTAInflater inflater;
+    TEST_ASSERT_TRUE(inflater.begin());
+    VectorSink sink;
+    for (size_t offset = 0; offset < compressed.size(); offset += BLE_CHUNK) {
+        size_t len = compressed.size() - offset < BLE_CHUNK ? compressed.size() - offset : BLE_CHUNK;
+        TEST_ASSERT_TRUE(inflater.feed(compressed.data() + offset, len, sink));
+    }
+    TEST_ASSERT_TRUE(inflater.finish(sink));
+    inflater.end();
+    TEST_ASSERT_TRUE(sink.bytes == image);
+}
+
+void test_patch_applier_copy_add_diff() {
+    std::vector<uint8_t> oldImage = makeImage(16 * 1024, 3);
+    std::vector<uint8_t> newImage(oldImage.begin(), oldImage.begin() + 8192);          // COPY
+    const uint8_t literal[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    newImage.insert(newImage.end(), literal, literal + sizeof(literal));                // ADD
+    std::vector<uint8_t> diff(4096, 0);
+    diff[10] = 4;
+    for (size_t i = 0; i < diff.size(); i++) newImage.push_back((uint8_t)(oldImage[8192 + i] + diff[i]));   // DIFF
+
+    std::vector<uint8_t> patch;
+    putU32(patch, OTA_PATCH_MAGIC);
+    putU32(patch, (uint32_t)oldImage.size());
+    putU32(patch, (uint32_t)crc32(0, oldImage.data(), oldImage.size()));
+    putU32(patch, (uint32_t)newImage.size());
+    patch.push_back(0x01); putU32(patch, 0); putU32(patch, 8192);
+    patch.push_back(0x02); putU32(patch, sizeof(literal));
+    patch.insert(patch.end(), literal, literal + sizeof(literal));
+    patch.push_back(0x03); putU32(patch, 8192); putU32(patch, (uint32_t)diff.size());
+    patch.insert(patch.end(), diff.begin(), diff.end());
+
+    MemoryPatchSource source(oldImage);
+    VectorSink sink;
+    OTAPatchApplier applier;
+    TEST_ASSERT_TRUE(applier.begin(source, sink));
+    for (size_t offset = 0; offset < patch.size(); offset += 100) {
+        size_t len = patch.size() - offset < 100 ? patch.size() - offset : 100;
+        TEST_ASSERT_TRUE(applier.write(patch.data() + offset, len));
+    }
+    TEST_ASSERT_TRUE(applier.finish());
+    applier.end();
+    TEST_ASSERT_TRUE(sink.bytes == newImage);
+}
+
+void test_writer_raw_session_lands_in_partition() {
+    const esp_partition_t* partition = esp_ota_get_next_update_partition(NULL);
+    TEST_ASSERT_NOT_NULL(partition);
+    std::vector<uint8_t> image = makeImage(100 * 1024 + 17, 4);
+    esp_ota_handle_t handle;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    TEST_ASSERT_TRUE(s_writer.start(handle, 0, describe(image)));
+    TEST_ASSERT_TRUE(stream(s_writer, image));
+    TEST_ASSERT_TRUE(s_writer.finish());
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_end(handle));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_set_boot_partition(partition));
+    TEST_ASSERT_TRUE(esp_ota_get_boot_partition() == partition);
+    TEST_ASSERT_TRUE(partitionEquals(partition, image));
+}
+
+void test_writer_rejects_digest_mismatch() {
+    const esp_partition_t* partition = esp_ota_get_next_update_partition(NULL);
+    std::vector<uint8_t> image = makeImage(20 * 1024, 5);
+    OTAImageInfo info = describe(image);
+    info.sha256[0] ^= 0xFF;
+    esp_ota_handle_t handle;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    TEST_ASSERT_TRUE(s_writer.start(handle, 0, info));
+    TEST_ASSERT_TRUE(stream(s_writer, image));
+    TEST_ASSERT_FALSE(s_writer.finish());
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_CRC, s_writer.lastError());
+    s_writer.abort();
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_abort(handle));
+}
+
+// 断点续传：写入任务周期性把 {偏移, 前缀 CRC32} 存进 NVS；“重启”后先只读校验前缀，再在新的 OTA 句柄中重放前缀并续写
+void test_writer_checkpoint_replay_resume() {
+    OTACheckpointStore store;
+    store.clear();
+    s_writer.setCheckpointStore(&store, 16 * 1024);
+    const esp_partition_t* partition = esp_ota_get_next_update_partition(NULL);
+    std::vector<uint8_t> image = makeImage(100 * 1024 + 333, 11);
+    OTAImageInfo info = describe(image);
+
+    OTACheckpoint session;
+    session.magic = OTACheckpoint::MAGIC;
+    session.sessionId = 0x1234;
+    session.partitionAddress = partition->address;
+    session.imageSize = info.size;
+    session.hasDigest = 1;
+    memcpy(session.sha256, info.sha256, sizeof(session.sha256));
+    session.protocol = OTA_PACKET_VERSION;
+
+    esp_ota_handle_t handle;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    TEST_ASSERT_TRUE(s_writer.start(handle, 0, info, &session));
+    std::vector<uint8_t> head(image.begin(), image.begin() + 60 * 1024 + 100);
+    TEST_ASSERT_TRUE(stream(s_writer, head));
+    s_writer.checkpointNow();                                   // 断线时控制器也这样强制保存一次
+    OTACheckpoint saved;
+    for (int i = 0; i < 2000 && !(store.load(saved) && saved.offset == 60 * 1024); i++) delay(1);
+    TEST_ASSERT_EQUAL_UINT32(60 * 1024, saved.offset);          // 只记录已整扇区落盘的字节
+    TEST_ASSERT_EQUAL_UINT32(0x1234, saved.sessionId);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)crc32(0, image.data(), saved.offset), saved.crc32);
+
+    s_writer.abort();                                           // 模拟重启：句柄与流水线状态全部丢失
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_abort(handle));
+    TEST_ASSERT_FALSE(OTAFlashWriter::verifyPrefix(partition, saved.offset, saved.crc32 ^ 1));
+    TEST_ASSERT_TRUE(OTAFlashWriter::verifyPrefix(partition, saved.offset, saved.crc32));
+
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    TEST_ASSERT_TRUE(s_writer.resume(handle, partition, info, saved));
+    std::vector<uint8_t> tail(image.begin() + saved.offset, image.end());
+    TEST_ASSERT_TRUE(stream(s_writer, tail));                   // 续传数据排在前缀重放之后
+    TEST_ASSERT_TRUE(s_writer.finish());
+    TEST_ASSERT_FALSE(s_writer.replaying());
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_end(handle));
+    TEST_ASSERT_TRUE(partitionEquals(partition, image));        // 大小与 SHA-256 在 finish 中已校验
+
+    // 前缀被改写（例如断点之后分区又被别的会话写过）时校验失败，控制器不会调用 esp_ota_begin
+    uint8_t garbage[16] = {0xE9};
+    TEST_ASSERT_TRUE(NativeFlash::program(partition->address + 4096, garbage, sizeof(garbage)));
+    TEST_ASSERT_FALSE(OTAFlashWriter::verifyPrefix(partition, saved.offset, saved.crc32));
+
+    store.clear();
+    TEST_ASSERT_FALSE(store.load(saved));
+    s_writer.setCheckpointStore(nullptr, 0);
+}
+
+// 压缩 + 差分：旧镜像来自运行分区（factory），补丁先解压再应用
+void test_writer_compressed_patch_session() {
+    std::vector<uint8_t> oldImage = makeImage(32 * 1024, 6);
+    TEST_ASSERT_TRUE(NativeFlash::program(esp_ota_get_running_partition()->address, oldImage.data(), oldImage.size()));
+    std::vector<uint8_t> newImage(oldImage.begin(), oldImage.end());
+    newImage[100] ^= 0x5A;
+
+    std::vector<uint8_t> patch;
+    putU32(patch, OTA_PATCH_MAGIC);
+    putU32(patch, (uint32_t)oldImage.size());
+    putU32(patch, (uint32_t)crc32(0, oldImage.data(), oldImage.size()));
+    putU32(patch, (uint32_t)newImage.size());
+    patch.push_back(0x03); putU32(patch, 0); putU32(patch, (uint32_t)newImage.size());
+    for (size_t i = 0; i < newImage.size(); i++) patch.push_back((uint8_t)(newImage[i] - oldImage[i]));
+
+    const esp_partition_t* partition = esp_ota_get_next_update_partition(NULL);
+    esp_ota_handle_t handle;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    TEST_ASSERT_TRUE(s_writer.start(handle, OTAFlashWriter::STREAM_DEFLATE | OTAFlashWriter::STREAM_PATCH, describe(newImage)));
+    TEST_ASSERT_TRUE(stream(s_writer, deflateRaw(patch)));
+    TEST_ASSERT_TRUE(s_writer.finish());
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_end(handle));
+    TEST_ASSERT_TRUE(partitionEquals(partition, newImage));
+}
+
+// 生成器与设备端对照：make-delta.js 对两个固定镜像生成补丁，OTAPatchApplier 还原出的镜像必须逐字节一致
+// 已提交的补丁（fixtures/base-to-target.patch.deflate）每次都验证；有 node 时再验证现场生成的补丁
+void test_patch_fixture_round_trip() {
+    std::vector<uint8_t> oldImage, newImage, committed;
+    TEST_ASSERT_TRUE(readFile(fixturePath("base.bin"), oldImage));
+    TEST_ASSERT_TRUE(readFile(fixturePath("target.bin"), newImage));
+    TEST_ASSERT_TRUE(readFile(fixturePath("base-to-target.patch.deflate"), committed));
+    std::vector<std::vector<uint8_t>> compressedPatches(1, committed);
+
+    std::vector<uint8_t> patch, fresh;
+    if (makeDelta(fixturePath("base.bin"), fixturePath("target.bin"), patch, fresh)) {
+        compressedPatches.push_back(fresh);
+        // 未压缩的补丁直接送入应用器，分块大小与扇区 / 操作边界都不对齐
+        MemoryPatchSource source(oldImage);
+        VectorSink sink;
+        OTAPatchApplier applier;
+        TEST_ASSERT_TRUE(applier.begin(source, sink));
+        for (size_t offset = 0; offset < patch.size(); offset += 97) {
+            size_t len = patch.size() - offset < 97 ? patch.size() - offset : 97;
+            TEST_ASSERT_TRUE(applier.write(patch.data() + offset, len));
+        }
+        TEST_ASSERT_TRUE(applier.finish());
+        TEST_ASSERT_EQUAL_UINT32(newImage.size(), applier.newSize());
+        TEST_ASSERT_TRUE(applier.copiedBytes() > newImage.size() * 9 / 10);     // 绝大部分来自旧镜像
+        TEST_ASSERT_EQUAL_UINT32(newImage.size(), applier.copiedBytes() + applier.literalBytes());
+        applier.end();
+        TEST_ASSERT_TRUE(sink.bytes == newImage);
+    } else {
+        printf("[INFO] 没有 node，只验证已提交的补丁\n");
+    }
+
+    for (const std::vector<uint8_t>& compressed : compressedPatches) {
+        // 内存中的解压 → 应用流水线，按 BLE 包大小送入
+        MemoryPatchSource source(oldImage);
+        VectorSink sink;
+        OTAPatchApplier applier;
+        OTAInflater inflater;
+        TEST_ASSERT_TRUE(inflater.begin());
+        TEST_ASSERT_TRUE(applier.begin(source, sink));
+        for (size_t offset = 0; offset < compressed.size(); offset += BLE_CHUNK) {
+            size_t len = compressed.size() - offset < BLE_CHUNK ? compressed.size() - offset : BLE_CHUNK;
+            TEST_ASSERT_TRUE(inflater.feed(compressed.data() + offset, len, applier));
+        }
+        TEST_ASSERT_TRUE(inflater.finish(applier));
+        TEST_ASSERT_TRUE(applier.finish());
+        inflater.end();
+        applier.end();
+        TEST_ASSERT_TRUE(sink.bytes == newImage);
+
+        // 完整会话：旧镜像在运行分区，写入任务解压 + 应用后写入下一个 OTA 分区，并按 SHA-256 校验
+        NativeHAL::reset();
+        TEST_ASSERT_TRUE(NativeFlash::program(esp_ota_get_running_partition()->address, oldImage.data(), oldImage.size()));
+        const esp_partition_t* partition = esp_ota_get_next_update_partition(NULL);
+        esp_ota_handle_t handle;
+        TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+        TEST_ASSERT_TRUE(s_writer.start(handle, OTAFlashWriter::STREAM_DEFLATE | OTAFlashWriter::STREAM_PATCH, describe(newImage)));
+        TEST_ASSERT_TRUE(stream(s_writer, compressed));
+        TEST_ASSERT_TRUE(s_writer.finish());
+        TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_end(handle));
+        TEST_ASSERT_TRUE(partitionEquals(partition, newImage));
+    }
+
+    // 基准镜像不一致（设备运行的不是补丁的旧固件）时拒绝
+    std::vector<uint8_t> wrongBase(oldImage);
+    wrongBase[oldImage.size() / 2] ^= 0x01;
+    MemoryPatchSource source(wrongBase);
+    VectorSink sink;
+    OTAPatchApplier applier;
+    OTAInflater inflater;
+    TEST_ASSERT_TRUE(inflater.begin());
+    TEST_ASSERT_TRUE(applier.begin(source, sink));
+    TEST_ASSERT_FALSE(inflater.feed(committed.data(), committed.size(), applier) && inflater.finish(applier) && applier.finish());
+    TEST_ASSERT_TRUE(applier.error() == OTAPatchApplier::Error::BASE_MISMATCH);
+    inflater.end();
+    applier.end();
+}
+
+// 链路模型：v1 协议每包 244 字节中 8 字节是包头，按 link kbit/s 传完 bytes 字节数据流需要的秒数
+// 写入任务与接收流水线并行，设备端处理速度远高于 BLE，上传时间由链路决定（与 build-firmware.js 的估算相同）
+static double linkSeconds(size_t bytes, double linkKbps) {
+    const size_t payload = BLE_CHUNK - OTA_PACKET_HEADER_SIZE;
+    size_t packets = (bytes + payload - 1) / payload;
+    return (bytes + packets * OTA_PACKET_HEADER_SIZE) * 8.0 / (linkKbps * 1000.0);
+}
+
+static double linkKbps() {
+    const char* env = getenv("OTA_LINK_KBPS");      // 运行时覆盖，例如实测 2M PHY 链路
+    return env && atof(env) > 0 ? atof(env) : OTA_LINK_KBPS;
+}
+
+// 报告整包原始上传与 stream 方式（压缩 / 差分）上传的传输时间与加速比
+static void reportTransfer(const char* name, size_t imageBytes, size_t streamBytes) {
+    double kbps = linkKbps();
+    double raw = linkSeconds(imageBytes, kbps);
+    double streamed = linkSeconds(streamBytes, kbps);
+    char metric[64];
+    snprintf(metric, sizeof(metric), "ota_%s_raw_transfer", name);
+    NativeBench::report(metric, raw, "s");
+    snprintf(metric, sizeof(metric), "ota_%s_transfer", name);
+    NativeBench::report(metric, streamed, "s");
+    snprintf(metric, sizeof(metric), "ota_%s_speedup", name);
+    NativeBench::report(metric, raw / streamed, "x");
+}
+
+// 差分补丁的体积与设备端应用耗时：优先用 scripts/make-delta-fixtures.js 构建的两次相邻提交的真实固件
+// （.pio/delta-fixtures/），没有时退回到已提交的合成镜像；结果按 BLE 包大小送入解压 → 应用流水线得到
+void bench_ota_patch_firmware() {
+    std::string dir = std::string(NATIVE_PROJECT_DIR) + "/.pio/delta-fixtures/";
+    std::vector<uint8_t> oldImage, newImage, compressed;
+    if (!readFile(dir + "base.bin", oldImage) || !readFile(dir + "target.bin", newImage) ||
+        !readFile(dir + "base-to-target.patch.deflate", compressed)) {
+        printf("[INFO] 没有 .pio/delta-fixtures（node scripts/make-delta-fixtures.js 生成），使用合成镜像\n");
+        TEST_ASSERT_TRUE(readFile(fixturePath("base.bin"), oldImage));
+        TEST_ASSERT_TRUE(readFile(fixturePath("target.bin"), newImage));
+        TEST_ASSERT_TRUE(readFile(fixturePath("base-to-target.patch.deflate"), compressed));
+    }
+
+    uint64_t best = UINT64_MAX;
+    for (int round = 0; round < 3; round++) {
+        MemoryPatchSource source(oldImage);
+        VectorSink sink;
+        sink.bytes.reserve(newImage.size());
+        OTAPatchApplier applier;
+        OTAInflater inflater;
+        uint64_t start = NativeBench::nowNs();
+        TEST_ASSERT_TRUE(inflater.begin());
+        TEST_ASSERT_TRUE(applier.begin(source, sink));
+        for (size_t offset = 0; offset < compressed.size(); offset += BLE_CHUNK) {
+            size_t len = compressed.size() - offset < BLE_CHUNK ? compressed.size() - offset : BLE_CHUNK;
+            TEST_ASSERT_TRUE(inflater.feed(compressed.data() + offset, len, applier));
+        }
+        TEST_ASSERT_TRUE(inflater.finish(applier));
+        TEST_ASSERT_TRUE(applier.finish());
+        uint64_t elapsed = NativeBench::nowNs() - start;
+        inflater.end();
+        applier.end();
+        TEST_ASSERT_TRUE(sink.bytes == newImage);
+        if (elapsed < best) best = elapsed;
+    }
+
+    NativeBench::report("ota_patch_bytes", compressed.size(), "B");
+    NativeBench::report("ota_patch_ratio", (double)compressed.size() / newImage.size(), "ratio");
+    NativeBench::report("ota_patch_apply_us", best / 1000.0, "us");
+    reportTransfer("patch", newImage.size(), compressed.size());
+}
+
+static void benchIngest(const char* name, uint8_t flags, const std::vector<uint8_t>& image,
+                        const std::vector<uint8_t>& payload) {
+    const esp_partition_t* partition = esp_ota_get_next_update_partition(NULL);
+    esp_ota_handle_t handle;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    uint64_t start = NativeBench::nowNs();
+    TEST_ASSERT_TRUE(s_writer.start(handle, flags, describe(image)));
+    TEST_ASSERT_TRUE(stream(s_writer, payload));
+    TEST_ASSERT_TRUE(s_writer.finish(60000));
+    double seconds = (double)(NativeBench::nowNs() - start) / 1e9;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_ota_end(handle));
+
+    char metric[64];
+    snprintf(metric, sizeof(metric), "ota_%s_image_rate", name);
+    NativeBench::report(metric, image.size() / seconds / (1024.0 * 1024.0), "MiB/s");
+}
+
+// 写入任务的摄入速率（分块、SHA-256、模拟 Flash 编程）：主机上的上限，用于对比流水线改动前后的开销
+// 这是主机 CPU 的处理速率，不代表 OTA 上传速度；上传时间见 bench_ota_link_model
+void bench_ota_raw_ingest() {
+    std::vector<uint8_t> image = makeImage(1024 * 1024, 7);
+    benchIngest("raw", 0, image, image);
+}
+
+void bench_ota_deflate_ingest() {
+    std::vector<uint8_t> image = makeImage(1024 * 1024, 8);
+    std::vector<uint8_t> compressed = deflateRaw(image);
+    NativeBench::report("ota_deflate_ratio", (double)compressed.size() / image.size(), "ratio");
+    benchIngest("deflate", OTAFlashWriter::STREAM_DEFLATE, image, compressed);
+}
+
+// 按链路模型估算 1MB 类固件镜像的上传时间：整包原始上传 vs 压缩上传（压缩后大小为实测值）
+void bench_ota_link_model() {
+    std::vector<uint8_t> image = makeImage(1024 * 1024, 8);
+    std::vector<uint8_t> compressed = deflateRaw(image);
+    TEST_ASSERT_TRUE(compressed.size() < image.size());
+    NativeBench::report("ota_link_kbps", linkKbps(), "kbit/s");
+    reportTransfer("deflate", image.size(), compressed.size());
+}
+
+void bench_ota_window_accept() {
+    std::vector<uint8_t> data = makeImage(BLE_CHUNK * 4096, 9);
+    static uint8_t reorder[16 * 1024];
+    OTAReceiveWindow window;
+    window.reset(reorder, sizeof(reorder));
+    VectorSink sink;
+    sink.bytes.reserve(data.size());
+    uint16_t seq = 0;
+    uint64_t start = NativeBench::nowNs();
+    for (uint16_t pair = 0; pair < 2048; pair++, seq += 2) {           // 每两包交换一次顺序
+        for (int k = 1; k >= 0; k--) {
+            uint16_t s = seq + k;
+            OTAPacketHeader header = {OTA_PACKET_VERSION, 0, s, (uint32_t)(s * BLE_CHUNK)};
+            window.accept(header, data.data() + s * BLE_CHUNK, BLE_CHUNK, sink);
+        }
+    }
+    double ns = (double)(NativeBench::nowNs() - start) / 4096;
+    TEST_ASSERT_TRUE(sink.bytes == data);
+    NativeBench::report("ota_window_accept_reordered", ns, "ns/packet");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sha256_known_vector);
+    RUN_TEST(test_window_reorders_and_drops_duplicates);
+    RUN_TEST(test_window_sack_covers_whole_window);
+    RUN_TEST(test_window_busy_sink_waits_for_resend);
+    RUN_TEST(test_window_goodput_under_loss_and_reorder);
+    RUN_TEST(test_inflater_round_trip);
+    RUN_TEST(test_patch_applier_copy_add_diff);
+    RUN_TEST(test_writer_raw_session_lands_in_partition);
+    RUN_TEST(test_writer_rejects_digest_mismatch);
+    RUN_TEST(test_writer_checkpoint_replay_resume);
+    RUN_TEST(test_writer_compressed_patch_session);
+    RUN_TEST(test_patch_fixture_round_trip);
+    RUN_TEST(bench_ota_patch_firmware);
+    RUN_TEST(bench_ota_raw_ingest);
+    RUN_TEST(bench_ota_deflate_ingest);
+    RUN_TEST(bench_ota_link_model);
+    RUN_TEST(bench_ota_window_accept);
+    return UNITY_END();
+}
@@ -0,0 +1,298 @@
+// 舵机数学：标定表插值、占空比换算（经 LEDC 替身读回）、轨迹曲线约束与解析解对照、指定用时运动，以及每次计算的开销基准
+#include <unity.h>
+#include <math.h>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include "ServoCalibration.h"
+#include "PWMServoController.h"
+#include "ServoCalibrator.h"
+#include "TrajectoryProfile.h"
+#include "MotionController.h"
+
+static const uint8_t SERVO_PIN = 18;
+static const uint8_t SERVO_CHANNEL = 6;
+
+void setUp() {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_WARN);
+}
+
+void tearDown() {}
+
+void test_linear_calibration_matches_map() {
+    ServoCalibration table = ServoCalibration::linear(0, 18000, 500, 2500);
+    TEST_ASSERT_TRUE(table.valid());
+    TEST_ASSERT_EQUAL_UINT32(500 << ServoCalibration::PULSE_SHIFT, table.pulseAt(0));
+    TEST_ASSERT_EQUAL_UINT32(1500 << ServoCalibration::PULSE_SHIFT, table.pulseAt(9000));
+    TEST_ASSERT_EQUAL_UINT32(2500 << ServoCalibration::PULSE_SHIFT, table.pulseAt(18000));
+    TEST_ASSERT_EQUAL_UINT32(500 << ServoCalibration::PULSE_SHIFT, table.pulseAt(-500));      // 超出范围钳在两端
+    TEST_ASSERT_EQUAL_UINT32(2500 << ServoCalibration::PULSE_SHIFT, table.pulseAt(20000));
+}
+
+void test_servo_duty_through_ledc() {
+    PWMServoController servo(SERVO_PIN, SERVO_CHANNEL);
+    servo.begin();
+    TEST_ASSERT_EQUAL_INT(SERVO_CHANNEL, NativeLedc::channelOfPin(SERVO_PIN));
+    TEST_ASSERT_EQUAL_UINT8(16, NativeLedc::resolution(SERVO_CHANNEL));
+    TEST_ASSERT_DOUBLE_WITHIN(0.001, 50.0, NativeLedc::frequency(SERVO_CHANNEL));
+
+    servo.setAngle(90);                             // 1500μs / 20000μs × 65536
+    TEST_ASSERT_EQUAL_UINT32(4915, NativeLedc::duty(SERVO_CHANNEL));
+    servo.writeCentiDegrees(0);                     // 500μs
+    TEST_ASSERT_EQUAL_UINT32(1638, NativeLedc::duty(SERVO_CHANNEL));
+    servo.stop();
+    TEST_ASSERT_EQUAL_UINT32(0, NativeLedc::duty(SERVO_CHANNEL));
+}
+
+void test_calibration_round_trips_through_nvs() {
+    ServoCalibration table = ServoCalibration::linear(0, 18000, 600, 2400);
+    PWMServoController servo(SERVO_PIN, SERVO_CHANNEL);
+    servo.begin();
+    TEST_ASSERT_TRUE(servo.setCalibration(table));
+    TEST_ASSERT_TRUE(servo.saveCalibration());
+
+    PWMServoController reloaded(SERVO_PIN, SERVO_CHANNEL);
+    reloaded.begin();
+    TEST_ASSERT_TRUE(reloaded.isCalibrated());
+    TEST_ASSERT_EQUAL_UINT16(600, reloaded.pulseForCentiDegrees(0));
+
+    reloaded.clearCalibration();
+    PWMServoController cleared(SERVO_PIN, SERVO_CHANNEL);
+    cleared.begin();
+    TEST_ASSERT_FALSE(cleared.isCalibrated());
+}
+
+// 逐点 ok 走完标定流程（标定表随之生效）
+static void calibrateAll(ServoCalibrator& calibrator) {
+    for (uint8_t i = 0; i < ServoCalibration::MAX_POINTS && calibrator.active(); ++i) {
+        TEST_ASSERT_TRUE(calibrator.handleCommand("ok"));
+    }
+    TEST_ASSERT_FALSE(calibrator.active());
+}
+
+// 默认标定点 0 45 90 135 180 裁剪到 setLimits 的角度范围内，裁剪后重合的点只保留一个
+void test_calibrator_clips_default_points_to_servo_range() {
+    PWMServoController servo(SERVO_PIN, SERVO_CHANNEL);
+    servo.setLimits(500, 2500, 30, 150);
+    servo.begin();
+    ServoCalibrator calibrator(servo);
+    TEST_ASSERT_TRUE(calibrator.handleCommand("cal"));
+    calibrateAll(calibrator);
+    const ServoCalibration& table = servo.getCalibration();
+    const int16_t expected[] = {3000, 4500, 9000, 13500, 15000};
+    TEST_ASSERT_EQUAL_UINT8(5, table.count);
+    for (uint8_t i = 0; i < 5; ++i) TEST_ASSERT_EQUAL_INT16(expected[i], table.centiDegrees[i]);
+
+    servo.setLimits(500, 2500, 60, 100);
+    TEST_ASSERT_TRUE(calibrator.handleCommand("cal"));
+    calibrateAll(calibrator);
+    const ServoCalibration& narrow = servo.getCalibration();
+    TEST_ASSERT_EQUAL_UINT8(3, narrow.count);
+    TEST_ASSERT_EQUAL_INT16(6000, narrow.centiDegrees[0]);
+    TEST_ASSERT_EQUAL_INT16(9000, narrow.centiDegrees[1]);
+    TEST_ASSERT_EQUAL_INT16(10000, narrow.centiDegrees[2]);
+
+    // 明确给出的标定点不裁剪
+    TEST_ASSERT_TRUE(calibrator.handleCommand("cal 10 170"));
+    calibrateAll(calibrator);
+    const ServoCalibration& explicitPoints = servo.getCalibration();
+    TEST_ASSERT_EQUAL_UINT8(2, explicitPoints.count);
+    TEST_ASSERT_EQUAL_INT16(1000, explicitPoints.centiDegrees[0]);
+    TEST_ASSERT_EQUAL_INT16(17000, explicitPoints.centiDegrees[1]);
+    servo.clearCalibration();
+}
+
+void test_s_curve_respects_limits() {
+    const float maxVelocity = 180.0f;
+    const float maxAcceleration = 720.0f;
+    TrajectoryProfile profile;
+    float duration = profile.plan(10.0f, 100.0f, maxVelocity, maxAcceleration, ProfileShape::S_CURVE);
+    TEST_ASSERT_GREATER_THAN(0.0f, duration);
+    for (int i = 0; i <= 1000; i++) {
+        float t = duration * i / 1000.0f;
+        TEST_ASSERT_TRUE(fabsf(profile.velocity(t)) <= maxVelocity * 1.001f);
+        TEST_ASSERT_TRUE(fabsf(profile.acceleration(t)) <= maxAcceleration * 1.001f);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 10.0f, profile.position(0));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 100.0f, profile.position(duration));
+}
+
+// 梯形/三角形曲线逐点对照解析解：加速段 x = a·t²/2、v = a·t，匀速段 v = vp，减速段与加速段对称
+static void assertTrapezoid(const TrajectoryProfile& profile, float start, float direction, float distance,
+                            float accel, float peak, float accelTime, float total) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, total, profile.duration());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, peak, profile.peakVelocity());
+    for (int i = 0; i <= 200; i++) {
+        float t = total * i / 200.0f;
+        float x, v, a;
+        if (t < accelTime) {
+            x = 0.5f * accel * t * t;
+            v = accel * t;
+            a = accel;
+        } else if (t < total - accelTime) {
+            x = 0.5f * accel * accelTime * accelTime + peak * (t - accelTime);
+            v = peak;
+            a = 0.0f;
+        } else {
+            float r = total - t;
+            x = distance - 0.5f * accel * r * r;
+            v = accel * r;
+            a = -accel;
+        }
+        if (i == 0) a = 0.0f;                       // 起点之前静止
+        if (i == 200) v = a = 0.0f;                 // 终点之后静止
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, start + direction * x, profile.position(t));
+        TEST_ASSERT_FLOAT_WITHIN(1e-2f, direction * v, profile.velocity(t));
+        if (fabsf(t - accelTime) > 1e-3f && fabsf(t - (total - accelTime)) > 1e-3f) {     // 段边界上加速度突变
+            TEST_ASSERT_FLOAT_WITHIN(1e-2f, direction * a, profile.acceleration(t));
+        }
+    }
+}
+
+// 能加速到上限：加速 0.5 s（25°）→ 匀速 100°/s 走 50° → 减速 0.5 s
+void test_trapezoid_matches_closed_form() {
+    TrajectoryProfile profile;
+    float duration = profile.plan(0.0f, 100.0f, 100.0f, 200.0f, ProfileShape::TRAPEZOID);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 1.5f, duration);
+    assertTrapezoid(profile, 0.0f, 1.0f, 100.0f, 200.0f, 100.0f, 0.5f, 1.5f);
+}
+
+// 短距离反向运动：10° 不够加速到 100°/s，峰值 √(d·a) = √2000，没有匀速段
+void test_triangle_never_reaches_max_velocity() {
+    TrajectoryProfile profile;
+    float duration = profile.plan(20.0f, 10.0f, 100.0f, 200.0f, ProfileShape::TRAPEZOID);
+    float peak = sqrtf(10.0f * 200.0f);
+    float accelTime = peak / 200.0f;
+    TEST_ASSERT_TRUE(peak < 100.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 2.0f * accelTime, duration);
+    assertTrapezoid(profile, 20.0f, -1.0f, 10.0f, 200.0f, peak, accelTime, 2.0f * accelTime);
+
+    // S 曲线同样退化为三角形：峰值速度按平均加速度 a/1.5 计算，只在中点达到一次
+    float sDuration = profile.plan(20.0f, 10.0f, 100.0f, 200.0f, ProfileShape::S_CURVE);
+    float sPeak = sqrtf(10.0f * 200.0f / 1.5f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 2.0f * sPeak / (200.0f / 1.5f), sDuration);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -sPeak, profile.velocity(sDuration / 2));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 15.0f, profile.position(sDuration / 2));
+}
+
+// 指定用时：整体时间缩放 k 倍（速度 ÷k、加速度 ÷k²），恰好在 T 到达终点；T 短于最短时间时仍按上限
+void test_duration_scaling_ends_at_requested_time() {
+    TrajectoryProfile profile;
+    const float requested = 2.7f;
+    float duration = profile.plan(0.0f, 100.0f, 100.0f, 200.0f, ProfileShape::TRAPEZOID, requested);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, requested, duration);
+    float k = requested / 1.5f;
+    assertTrapezoid(profile, 0.0f, 1.0f, 100.0f, 200.0f / (k * k), 100.0f / k, 0.5f * k, requested);
+    TEST_ASSERT_TRUE(profile.position(requested - 0.01f) < 100.0f);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, profile.position(requested));
+
+    duration = profile.plan(0.0f, 100.0f, 100.0f, 200.0f, ProfileShape::TRAPEZOID, 1.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 1.5f, duration);
+
+    // S 曲线缩放后同样在 T 处速度归零、到达终点
+    duration = profile.plan(10.0f, -50.0f, 180.0f, 720.0f, ProfileShape::S_CURVE, requested);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, requested, duration);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, profile.velocity(requested - 1e-4f));
+    TEST_ASSERT_EQUAL_FLOAT(-50.0f, profile.position(requested));
+}
+
+// LINEAR：全程匀速，没有加减速段；指定用时时速度按 d / T 降低
+void test_linear_profile_is_constant_velocity() {
+    TrajectoryProfile profile;
+    float duration = profile.plan(0.0f, 90.0f, 180.0f, 720.0f, ProfileShape::LINEAR);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.5f, duration);
+    for (int i = 1; i < 100; i++) {
+        float t = duration * i / 100.0f;
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, 180.0f * t, profile.position(t));
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, 180.0f, profile.velocity(t));
+        TEST_ASSERT_EQUAL_FLOAT(0.0f, profile.acceleration(t));
+    }
+
+    duration = profile.plan(90.0f, 0.0f, 180.0f, 720.0f, ProfileShape::LINEAR, 2.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 2.0f, duration);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -45.0f, profile.velocity(1.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 45.0f, profile.position(1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, profile.position(2.0f));
+}
+
+// MotionController::moveToIn 经插值定时器跑完：用时 T 后（最多晚一个插值周期加调度抖动）停在目标角度
+// 30° 在上限内最短约 0.41 s，要求 0.6 s 时走的是缩放后的曲线
+void test_move_to_in_finishes_at_requested_time() {
+    PWMServoController servo(SERVO_PIN, SERVO_CHANNEL);
+    servo.begin();
+    MotionController motion;
+    uint8_t axis = motion.addAxis(&servo, 180.0f, 720.0f, ProfileShape::TRAPEZOID);
+    TEST_ASSERT_TRUE(motion.begin());
+    float target = motion.position(axis) + 30.0f;
+    TEST_ASSERT_TRUE(motion.moveToIn(axis, target, 600));
+    int64_t start = esp_timer_get_time();
+    delay(500);
+    TEST_ASSERT_TRUE(motion.isMoving(axis));
+    while (motion.isMoving(axis) && esp_timer_get_time() - start < 2000000) delay(1);
+    int64_t elapsedMs = (esp_timer_get_time() - start) / 1000;
+    TEST_ASSERT_FALSE(motion.isMoving(axis));
+    TEST_ASSERT_TRUE(elapsedMs >= 590);
+    TEST_ASSERT_TRUE(elapsedMs <= 600 + 1000 / MOTION_TICK_HZ + 50);
+    TEST_ASSERT_EQUAL_FLOAT(target, motion.position(axis));
+}
+
+// 标定表插值（定时器回调热路径上每个舵机每周期一次）
+void bench_calibration_pulse_at() {
+    ServoCalibration table = ServoCalibration::linear(0, 18000, 500, 2500);
+    int32_t angle = 0;
+    uint32_t sink = 0;
+    double ns = NativeBench::nsPerOp(2000000, [&]() {
+        sink += table.pulseAt(angle);
+        angle = (angle + 37) % 18000;
+    });
+    benchKeep(sink);
+    NativeBench::report("servo_pulse_at", ns, "ns/op");
+}
+
+// 角度 → 占空比 → ledcWrite 的完整输出路径（主机上 ledcWrite 是一次加锁记录）
+void bench_servo_write_centi_degrees() {
+    PWMServoController servo(SERVO_PIN, SERVO_CHANNEL);
+    servo.begin();
+    int32_t angle = 0;
+    double ns = NativeBench::nsPerOp(1000000, [&]() {
+        servo.writeCentiDegrees(angle);
+        angle = (angle + 37) % 18000;
+    });
+    NativeBench::report("servo_write_centi_degrees", ns, "ns/op");
+}
+
+void bench_trajectory_sample() {
+    TrajectoryProfile profile;
+    float duration = profile.plan(0.0f, 180.0f, 240.0f, 960.0f, ProfileShape::S_CURVE);
+    float t = 0;
+    float sink = 0;
+    double ns = NativeBench::nsPerOp(2000000, [&]() {
+        sink += profile.position(t);
+        t += 0.0001f;
+        if (t > duration) t = 0;
+    });
+    benchKeep(sink);
+    NativeBench::report("trajectory_s_curve_position", ns, "ns/op");
+    double planNs = NativeBench::nsPerOp(500000, [&]() {
+        benchKeep(profile.plan(0.0f, 180.0f, 240.0f, 960.0f, ProfileShape::S_CURVE));
+    });
+    NativeBench::report("trajectory_s_curve_plan", planNs, "ns/op");
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_linear_calibration_matches_map);
+    RUN_TEST(test_servo_duty_through_ledc);
+    RUN_TEST(test_calibration_round_trips_through_nvs);
+    RUN_TEST(test_calibrator_clips_default_points_to_servo_range);
+    RUN_TEST(test_s_curve_respects_limits);
+    RUN_TEST(test_trapezoid_matches_closed_form);
+    RUN_TEST(test_triangle_never_reaches_max_velocity);
+    RUN_TEST(test_duration_scaling_ends_at_requested_time);
+    RUN_TEST(test_linear_profile_is_constant_velocity);
+    RUN_TEST(test_move_to_in_finishes_at_requested_time);
+    RUN_TEST(bench_calibration_pulse_at);
+    RUN_TEST(bench_servo_write_centi_degrees);
+    RUN_TEST(bench_trajectory_sample);
+    return UNITY_END();
+}
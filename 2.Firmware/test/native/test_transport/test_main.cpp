@@ -0,0 +1,400 @@
+// SocketTransport：帧编解码、套接字上的写入/通知，以及多客户端回放驱动完整的电机与 OTA 管线（吞吐、丢弃、延迟）
+#include <unity.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <stdio.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mbedtls/sha256.h>
+#include <esp_ota_ops.h>
+#include <NativeHAL.h>
+#include <NativeBench.h>
+#include <NativeReplay.h>
+#include "drivers/Transport/SocketTransport.h"
+#include "drivers/BLE/MessageConsumer.h"
+#include "controllers/OTAController/OTAController.h"
+#include "controllers/MotorController/MotorController.h"
+
+static const char* MOTOR_WRITE_UUID = "ef010001-1000-8000-0080-5f9b34fb0000";
+static const char* MOTOR_READ_UUID = "ef010002-1000-8000-0080-5f9b34fb0000";
+static const char* OTA_CONTROL_UUID = "ef040001-1000-8000-0080-5f9b34fb0000";
+static const char* OTA_DATA_UUID = "ef040002-1000-8000-0080-5f9b34fb0000";
+static const char* OTA_STATUS_UUID = "ef040003-1000-8000-0080-5f9b34fb0000";
+
+class CountingConsumer : public MessageConsumer {
+public:
+    void begin() override {}
+    void handleMessage(const BLEWriteMessage& msg) override {
+        last.assign(msg.data.begin(), msg.data.end());
+        count.fetch_add(1, std::memory_order_release);
+    }
+    std::vector<uint8_t> last;
+    std::atomic<uint32_t> count{0};
+};
+
+// 与 app_main 相同的管线：套接字后端 → dispatcher → bleWriteTask → OTA / 电机控制器（对象常驻，所有用例共用）
+static MessageDispatcher dispatcher;
+static SocketTransport transport;
+static OTAController ota;
+static PWMServoController headServo(18, 6);
+static MotionController motion;
+static MotorController motor(motion);
+static std::string endpoint;
+
+static void bleWriteTask(void*) {
+    BLEWriteMessage msg;
+    dispatcher.setConsumerTask(xTaskGetCurrentTaskHandle());
+    while (true) {
+        while (dispatcher.tryPop(msg)) {
+            dispatcher.dispatch(msg);
+            dispatcher.markHandled(msg);
+        }
+        dispatcher.waitForMessage();
+    }
+}
+
+// 与 loop_main 相同：周期性调用 ota.update()，推送进度和 v1 ACK
+static void otaUpdateTask(void*) {
+    while (true) {
+        ota.update();
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+static bool beginPipeline() {
+    endpoint = "unix:/tmp/mibai-transport-" + std::to_string(getpid()) + ".sock";
+    if (!transport.begin(&dispatcher, endpoint.c_str())) return false;
+    dispatcher.subscribe("OTAControl", &ota);
+    dispatcher.subscribe("OTAData", &ota);
+    dispatcher.subscribe("MotorWrite", &motor);
+    dispatcher.subscribe("MotorClock", &motor);
+    xTaskCreatePinnedToCore(bleWriteTask, "BLEWriteTask", 8192, nullptr, 1, nullptr, 1);
+
+    ota.setTransport(&transport);
+    ota.begin();
+    transport.setOTAController(&ota);
+    headServo.begin();
+    motion.addAxis(&headServo, 360, 2400);
+    motion.begin();
+    motor.setTransport(&transport);
+    motor.begin();
+    xTaskCreatePinnedToCore(otaUpdateTask, "OTAUpdate", 4096, nullptr, 1, nullptr, 1);
+    return true;
+}
+
+// 一帧电机设定点：单轴、samples 个样本，每个样本 10ms
+static std::vector<uint8_t> motorFrame(uint8_t seq, uint8_t samples) {
+    uint8_t buffer[244];
+    MotorFrameEncoder encoder(buffer, sizeof(buffer));
+    encoder.begin(seq, 0x01);
+    for (uint8_t i = 0; i < samples; i++) {
+        int16_t angles[MOTOR_MAX_AXES] = {(int16_t)(9000 + ((seq + i) % 20) * 50)};
+        encoder.add(10, angles);
+    }
+    size_t len = encoder.finish();
+    return std::vector<uint8_t>(buffer, buffer + len);
+}
+
+static std::vector<ReplayFrame> motorStream(size_t frames, uint32_t intervalUs) {
+    std::vector<ReplayFrame> stream;
+    for (size_t i = 0; i < frames; i++) {
+        ReplayFrame frame;
+        frame.atUs = (uint32_t)(i * intervalUs);
+        frame.uuid = MOTOR_WRITE_UUID;
+        frame.payload = motorFrame((uint8_t)i, 4);
+        stream.push_back(frame);
+    }
+    return stream;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_frame_codec() {
+    const uint8_t payload[] = {0x10, 0x01, 0x01, 0x00};
+    uint8_t frame[TRANSPORT_MAX_FRAME];
+    size_t len = encodeTransportFrame(frame, sizeof(frame), TRANSPORT_OP_WRITE, MOTOR_WRITE_UUID, payload, sizeof(payload));
+    TEST_ASSERT_EQUAL(TRANSPORT_FRAME_HEADER + 36 + sizeof(payload), len);
+
+    TransportFrame parsed;
+    TEST_ASSERT_EQUAL_INT(0, parseTransportFrame(frame, len - 1, parsed));      // 不完整：等更多数据
+    TEST_ASSERT_EQUAL_INT((int)len, parseTransportFrame(frame, len, parsed));
+    TEST_ASSERT_EQUAL_UINT8(TRANSPORT_OP_WRITE, parsed.op);
+    TEST_ASSERT_EQUAL(36, parsed.uuidLength);
+    TEST_ASSERT_EQUAL_MEMORY(MOTOR_WRITE_UUID, parsed.uuid, 36);
+    TEST_ASSERT_EQUAL(sizeof(payload), parsed.payloadLength);
+    TEST_ASSERT_EQUAL_MEMORY(payload, parsed.payload, sizeof(payload));
+
+    frame[3] = 200;                                 // uuidLen 超过帧长度
+    TEST_ASSERT_EQUAL_INT(-1, parseTransportFrame(frame, len, parsed));
+    static uint8_t big[TRANSPORT_MAX_PAYLOAD + 1];
+    TEST_ASSERT_EQUAL(0, encodeTransportFrame(frame, sizeof(frame), TRANSPORT_OP_WRITE, MOTOR_WRITE_UUID, big, sizeof(big)));
+
+    TransportStats stats;
+    stats.frames = 7;
+    stats.latencyP99Us = 1023;
+    stats.queueDepth = 3;
+    uint8_t encoded[TRANSPORT_STATS_BYTES];
+    encodeTransportStats(stats, encoded);
+    TransportStats decoded;
+    TEST_ASSERT_TRUE(decodeTransportStats(encoded, sizeof(encoded), decoded));
+    TEST_ASSERT_EQUAL_UINT32(7, decoded.frames);
+    TEST_ASSERT_EQUAL_UINT32(1023, decoded.latencyP99Us);
+    TEST_ASSERT_EQUAL_UINT32(3, decoded.queueDepth);
+}
+
+// TCP 上的写入 → 队列、通知 → 客户端；未知特征计数、格式错误断开连接
+void test_tcp_write_and_notify() {
+    static MessageDispatcher tcpDispatcher;
+    static SocketTransport tcp;
+    CountingConsumer consumer;
+    TEST_ASSERT_TRUE(tcp.begin(&tcpDispatcher, "tcp:127.0.0.1:0"));
+    TEST_ASSERT_NOT_EQUAL(0, tcp.port());
+    tcpDispatcher.subscribe("MotorWrite", &consumer);
+
+    ReplayConnection client;
+    std::string address = "tcp:127.0.0.1:" + std::to_string(tcp.port());
+    TEST_ASSERT_TRUE(client.connect(address.c_str()));
+    const uint8_t payload[] = {0x11, 0x05};
+    TEST_ASSERT_TRUE(client.write(MOTOR_WRITE_UUID, payload, sizeof(payload)));
+    TEST_ASSERT_TRUE(client.write("ffff0000-1000-8000-0080-5f9b34fb0000", payload, sizeof(payload)));
+
+    TransportStats stats;
+    TEST_ASSERT_TRUE(client.requestStats(stats));   // 同一连接上按顺序处理：回复时前两帧已经处理完
+    TEST_ASSERT_EQUAL_UINT32(2, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.queueDepth);
+    TEST_ASSERT_EQUAL_UINT32(1, tcp.unknownCount());
+    TEST_ASSERT_TRUE(tcp.isConnected());
+
+    BLEWriteMessage msg;
+    TEST_ASSERT_TRUE(tcpDispatcher.tryPop(msg));
+    TEST_ASSERT_TRUE(tcpDispatcher.dispatch(msg));
+    TEST_ASSERT_EQUAL_MEMORY(payload, consumer.last.data(), sizeof(payload));
+
+    const uint8_t state[] = {1, 2, 3};
+    tcp.notify(tcp.handleOf(MOTOR_READ_UUID), state, sizeof(state));
+    std::vector<uint8_t> received;
+    TEST_ASSERT_TRUE(client.waitNotification(MOTOR_READ_UUID, received, 1000));
+    TEST_ASSERT_EQUAL(sizeof(state), received.size());
+    TEST_ASSERT_EQUAL_MEMORY(state, received.data(), sizeof(state));
+
+    // 长度字段超出上限：服务端关闭这个连接，其它连接不受影响
+    int raw = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(tcp.port());
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, connect(raw, (sockaddr*)&addr, sizeof(addr)));
+    const uint8_t garbage[] = {0xFF, 0xFF, TRANSPORT_OP_WRITE, 0x00};
+    TEST_ASSERT_EQUAL_INT((int)sizeof(garbage), (int)send(raw, garbage, sizeof(garbage), 0));
+    uint8_t byte;
+    TEST_ASSERT_EQUAL_INT(0, (int)recv(raw, &byte, 1, 0));      // 对端关闭
+    close(raw);
+    TEST_ASSERT_EQUAL_UINT32(1, tcp.closedCount());
+    TEST_ASSERT_TRUE(client.requestStats(stats));
+
+    tcp.end();
+    TEST_ASSERT_FALSE(tcp.isConnected());
+}
+
+// 一帧经套接字 → dispatcher → MotorController 解码 → MotionController：解码出的每个角度都真正作用到轴上，
+// MotorRead 回报 [seq][待执行设定点数][axisMask][角度 int16] 可按协议解析
+void test_motor_frame_values_reach_axis() {
+    static const int16_t path[] = {9500, 10000, 10500, 10250};     // 每段 100ms，50°/s 在轴的速度上限以内
+    uint8_t buffer[64];
+    MotorFrameEncoder encoder(buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(encoder.begin(42, 0x01));
+    for (int16_t angle : path) {
+        int16_t angles[MOTOR_MAX_AXES] = {angle};
+        TEST_ASSERT_TRUE(encoder.add(100, angles));
+    }
+    size_t len = encoder.finish();
+
+    uint32_t framesBefore = motor.frameCount();
+    uint32_t setpointsBefore = motor.setpointCount();
+    uint32_t errorsBefore = motor.errorCount();
+    ReplayConnection client;
+    TEST_ASSERT_TRUE(client.connect(endpoint.c_str()));
+    TEST_ASSERT_TRUE(client.write(MOTOR_WRITE_UUID, buffer, len));
+    std::vector<uint8_t> state;
+    do {
+        TEST_ASSERT_TRUE(client.waitNotification(MOTOR_READ_UUID, state, 2000));
+    } while (state[0] != 42);
+    TEST_ASSERT_EQUAL(3 + 2, state.size());         // 只添加了一个轴
+    TEST_ASSERT_EQUAL_UINT8(0x01, state[2]);
+    int16_t reported = (int16_t)(state[3] | (state[4] << 8));
+    TEST_ASSERT_TRUE(reported >= 0 && reported <= 18000);
+    TEST_ASSERT_EQUAL_UINT32(framesBefore + 1, motor.frameCount());
+    TEST_ASSERT_EQUAL_UINT32(setpointsBefore + 4, motor.setpointCount());
+    TEST_ASSERT_EQUAL_UINT32(errorsBefore, motor.errorCount());
+
+    // 轨迹经过 105°（第三个样本）后停在 102.5°（最后一个样本）
+    float peak = 0;
+    uint64_t deadline = NativeBench::nowNs() + 2000ULL * 1000 * 1000;
+    while (NativeBench::nowNs() < deadline) {
+        float position = motion.position(0);
+        if (position > peak) peak = position;
+        if (motion.pendingSetpoints() == 0 && motion.isIdle()) break;
+        delay(1);
+    }
+    TEST_ASSERT_TRUE(motion.isIdle());
+    TEST_ASSERT_TRUE(peak > 104.0f && peak < 105.01f);  // 插值按定时器周期采样，峰值略低于 105°；没执行第三个样本时只有 102.5°
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 102.5f, motion.target(0));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 102.5f, motion.position(0));
+
+    // 少一个字节的帧：计入格式错误
+    TEST_ASSERT_TRUE(client.write(MOTOR_WRITE_UUID, buffer, len - 1));
+    deadline = NativeBench::nowNs() + 2000ULL * 1000 * 1000;
+    while (motor.errorCount() == errorsBefore && NativeBench::nowNs() < deadline) delay(1);
+    TEST_ASSERT_EQUAL_UINT32(errorsBefore + 1, motor.errorCount());
+}
+
+// 多个客户端按真实时间（10ms 一帧）重放电机流，每一帧都要么被 MotorController 处理，要么计入丢弃
+void test_motor_stream_replay() {
+    std::vector<ReplayFrame> stream = motorStream(100, 10000);
+
+    // 回放文件往返
+    std::string capture = "/tmp/mibai-motor-" + std::to_string(getpid()) + ".replay";
+    FILE* file = fopen(capture.c_str(), "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fprintf(file, "# 电机流回放\n");
+    for (const ReplayFrame& frame : stream) {
+        fprintf(file, "%u %s ", frame.atUs, frame.uuid.c_str());
+        for (uint8_t b : frame.payload) fprintf(file, "%02x", b);
+        fprintf(file, "\n");
+    }
+    fclose(file);
+    std::vector<ReplayFrame> loaded;
+    TEST_ASSERT_TRUE(NativeReplay::loadCapture(capture.c_str(), loaded));
+    unlink(capture.c_str());
+    TEST_ASSERT_EQUAL(stream.size(), loaded.size());
+    TEST_ASSERT_EQUAL_UINT32(stream[7].atUs, loaded[7].atUs);
+    TEST_ASSERT_TRUE(stream[7].payload == loaded[7].payload);
+
+    uint32_t framesBefore = motor.frameCount();
+    ReplayReport report;
+    TEST_ASSERT_TRUE(NativeReplay::run(endpoint.c_str(), loaded, 8, report));
+    TEST_ASSERT_EQUAL_UINT32(800, report.sent);
+    TEST_ASSERT_EQUAL_UINT32(0, report.rejected);
+    TEST_ASSERT_EQUAL_UINT32(report.sent, report.handled + report.dropped);
+    TEST_ASSERT_EQUAL_UINT32(report.handled, motor.frameCount() - framesBefore);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, report.notifications);   // MotorRead 状态通知回到客户端
+    NativeReplay::print("socket_motor_realtime", report);
+}
+
+// 不按时间表，12 个客户端尽快写入：找写入队列的吞吐上限与溢出点
+void bench_motor_flood() {
+    std::vector<ReplayFrame> stream = motorStream(2000, 0);
+    ReplayReport report;
+    TEST_ASSERT_TRUE(NativeReplay::run(endpoint.c_str(), stream, 12, report, 0));
+    TEST_ASSERT_EQUAL_UINT32(12 * 2000, report.sent);
+    TEST_ASSERT_EQUAL_UINT32(report.sent, report.handled + report.dropped);
+    NativeReplay::print("socket_motor_flood", report);
+    NativeBench::report("socket_motor_flood_drop_rate", 100.0 * report.dropped / report.sent, "%");
+}
+
+// 一个 v1 数据包：8 字节包头（版本、标志、seq、偏移）+ 负载
+static std::vector<uint8_t> otaPacket(const std::vector<uint8_t>& image, uint16_t seq, size_t payload) {
+    uint32_t offset = (uint32_t)seq * payload;
+    size_t n = image.size() - offset < payload ? image.size() - offset : payload;
+    std::vector<uint8_t> packet(OTA_PACKET_HEADER_SIZE + n);
+    packet[0] = OTA_PACKET_VERSION;
+    packet[1] = 0;
+    memcpy(&packet[2], &seq, sizeof(seq));
+    memcpy(&packet[4], &offset, sizeof(offset));
+    memcpy(&packet[OTA_PACKET_HEADER_SIZE], image.data() + offset, n);
+    return packet;
+}
+
+// 完整 OTA：START（v1 协议，声明大小与 SHA-256）→ 等 READY → OTAData 直通写入 → CONFIRM → 等 COMPLETE，启动分区切到 ota_0
+// 客户端按 APP 的做法保持 32 个包在途，按 ACK 帧重传空缺的包：暂存缓冲满时固件丢包而不阻塞回调，这里要靠重传补齐
+void test_ota_over_socket() {
+    const size_t imageSize = 256 * 1024;
+    std::vector<uint8_t> image(imageSize);
+    uint32_t state = 0x12345678;
+    for (size_t i = 0; i < imageSize; i++) {
+        state = state * 1664525u + 1013904223u;
+        image[i] = (uint8_t)(state >> 24);
+    }
+    image[0] = 0xE9;                                // 镜像魔数
+    uint8_t start[39] = {0x00, OTA_PACKET_VERSION, 0x00};   // START，协议 1（分包 + ACK），不压缩
+    uint32_t size = (uint32_t)imageSize;
+    memcpy(start + 3, &size, sizeof(size));
+    mbedtls_sha256_ret(image.data(), image.size(), start + 7, 0);
+
+    ReplayConnection client;
+    TEST_ASSERT_TRUE(client.connect(endpoint.c_str()));
+    TEST_ASSERT_TRUE(client.write(OTA_CONTROL_UUID, start, sizeof(start)));
+    std::vector<uint8_t> status;
+    do {
+        TEST_ASSERT_TRUE(client.waitNotification(OTA_STATUS_UUID, status, 2000));
+    } while (status[0] != (uint8_t)OTAStatus::READY);
+
+    const size_t payload = 244 - OTA_PACKET_HEADER_SIZE;    // MTU 247 时一次写入的负载
+    const uint16_t inFlight = 32;
+    const uint16_t packets = (uint16_t)((imageSize + payload - 1) / payload);
+    uint16_t acked = 0, sent = 0, lastAckSeq = 0xFFFF;
+    uint32_t ackedOffset = 0, resent = 0, idle = 0;
+    uint64_t begin = NativeBench::nowNs();
+    while (ackedOffset < imageSize) {
+        while (sent < packets && (uint16_t)(sent - acked) < inFlight) {
+            std::vector<uint8_t> packet = otaPacket(image, sent++, payload);
+            TEST_ASSERT_TRUE(client.write(OTA_DATA_UUID, packet.data(), packet.size()));
+        }
+        if (!client.waitNotification(OTA_STATUS_UUID, status, 50)) {
+            TEST_ASSERT_TRUE(++idle < 100);             // 5 秒没有任何通知
+            continue;
+        }
+        idle = 0;
+        TEST_ASSERT_NOT_EQUAL((uint8_t)OTAStatus::FAILED, status[0]);
+        if (status[0] != 0xA1 || status.size() < 15) continue;     // 进度帧
+        uint16_t nextSeq;
+        uint64_t sack;
+        memcpy(&nextSeq, &status[1], sizeof(nextSeq));
+        memcpy(&ackedOffset, &status[3], sizeof(ackedOffset));
+        memcpy(&sack, &status[7], sizeof(sack));
+        acked = nextSeq;
+        // 确认点两次 ACK 都没动：在途的包已被丢弃，重传确认点和 SACK 里的空缺
+        if (nextSeq == lastAckSeq) {
+            for (uint16_t seq = nextSeq; seq != sent; seq++) {
+                uint16_t bit = (uint16_t)(seq - nextSeq - 1);
+                if (seq != nextSeq && bit < 64 && (sack >> bit) & 1) continue;
+                std::vector<uint8_t> packet = otaPacket(image, seq, payload);
+                TEST_ASSERT_TRUE(client.write(OTA_DATA_UUID, packet.data(), packet.size()));
+                ++resent;
+            }
+        }
+        lastAckSeq = nextSeq;
+    }
+    const uint8_t confirm[] = {0x02};
+    TEST_ASSERT_TRUE(client.write(OTA_CONTROL_UUID, confirm, sizeof(confirm)));
+    do {
+        TEST_ASSERT_TRUE(client.waitNotification(OTA_STATUS_UUID, status, 5000));
+        TEST_ASSERT_NOT_EQUAL((uint8_t)OTAStatus::FAILED, status[0]);
+    } while (status[0] != (uint8_t)OTAStatus::COMPLETE);
+    double seconds = (double)(NativeBench::nowNs() - begin) / 1e9;
+
+    const esp_partition_t* boot = esp_ota_get_boot_partition();
+    TEST_ASSERT_NOT_NULL(boot);
+    TEST_ASSERT_EQUAL_STRING("ota_0", boot->label);
+    NativeBench::report("socket_ota_rate", imageSize / seconds / 1024.0, "KiB/s");
+    NativeBench::report("socket_ota_resent", resent, "packets");
+}
+
+int main(int, char**) {
+    NativeHAL::reset();
+    NativeLog::setLevel(NativeLog::LEVEL_WARN);
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_codec);
+    RUN_TEST(test_tcp_write_and_notify);
+    if (!beginPipeline()) return UNITY_END();
+    RUN_TEST(test_motor_frame_values_reach_axis);
+    RUN_TEST(test_motor_stream_replay);
+    RUN_TEST(bench_motor_flood);
+    RUN_TEST(test_ota_over_socket);
+    transport.end();
+    return UNITY_END();
+}